@@ -10,7 +10,8 @@ It requires some marked up base versions of these files to read in as
 templates, which are all included in the tar.
 
 This is currently a first draft, so it has some limitations:
- - Variable-length input / output payloads are not yet implemented.
+ - Variable-length input / output payloads are only handled by the
+   table-driven output (vendor.c), the per-opcode functions skip them.
  - Names for variables & flags use mnemonics verbatim and are not truncated.
  - Code is inserted directly into the relevant files instead of creating
    vendor specific source files to import. These files are duplicated, not
@@ -18,7 +19,13 @@ This is currently a first draft, so it has some limitations:
  - The traversal for the pyyml output is a bit hacky, it'll need to be made
    more robust in order to be extended to YAMLs from different vendors.
  - Input parameters greater than 8 bytes of length need to be implemented
-   manually.
+   manually in the per-opcode functions; vendor.c takes them as raw bytes.
+
+It also generates vendor.c and vendor.h, a table-driven encoder/decoder
+covering every opcode in the YAML, plus vendor_emu.c, an emulated mailbox
+answering each opcode with a randomized well-formed payload, and
+vendor_bench.c, which runs every opcode through the two and times it.
+See README.md for details.
 
 Instructions for use:
  1. $ tar git clone git@github.com:elake/ndctl.git
@@ -49,6 +56,10 @@ LIBCXLC = "libcxl.c"
 LIBCXLH = "libcxl.h"
 LIBCXLSYM = "libcxl.sym"
 MEMDEVC = "memdev.c"
+VENDORC = "vendor.c"
+VENDORH = "vendor.h"
+VENDOREMUC = "vendor_emu.c"
+VENDORBENCHC = "vendor_bench.c"
 SIMPLE = False # Only process commands with simple payloads (1, 2, 4, 8 byte param types)
 BLANK = False
 
@@ -68,9 +79,11 @@ class Payload():
         self.name = payload.get(f'{x}pl_name', "")
         self.mn = payload.get(f'{x}pl_mnemonic', "").lower()
         self.size = payload.get(f'{x}pl_size_bytes')
+        self.header_size = self.size
         if isinstance(self.size, str):
+            # "8+": an 8 byte header followed by a variable-length array
             self.fixed_size = False
-            return
+            self.header_size = int(self.size.rstrip('+'))
         self.params = []
         self.build_params(payload, x)
         self.is_simple()
@@ -156,6 +169,9 @@ class Payload():
             4: '__le32',
             8: '__le64',
             }
+        if not isinstance(i, int):
+            # variable-length array, emitted as a flexible array member
+            return (t.get(unit or 1), 0)
         if unit:
             return (t.get(unit), i // unit)
         if t.get(i): return t.get(i)
@@ -181,6 +197,8 @@ class Payload():
         mn = param.get("mn")
         if  isinstance(t, str):
             return f"{t} {mn};\n"
+        elif t[1] == 0:
+            return f"{t[0]} {mn}[];\n"
         else:
             return f"{t[0]} {mn}[{t[1]}];\n"
 
@@ -477,6 +495,262 @@ def generate_libcxl_sym(name):
     # libcxl.sym line 75
     return f"\tcxl_memdev_{name};\n"
 
+UNIT_BYTES = {
+    'u8': 1,
+    '__le16': 2,
+    '__le32': 4,
+    '__le64': 8,
+}
+
+def c_string(text):
+    text = " ".join(str(text or "").split())
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+def vendor_struct_name(mn, end):
+    return f"struct cxl_vendor_{mn}_{end}"
+
+def vendor_field_geometry(param):
+    """
+    Return (unit, count) for a parameter: count is 1 for scalars, the
+    number of elements for fixed arrays and 0 for variable-length arrays.
+    """
+    t = param.get("type")
+    if isinstance(t, str):
+        return (UNIT_BYTES[t], 1)
+    return (UNIT_BYTES[t[0]], t[1])
+
+def vendor_count_field(payload, idx):
+    """
+    A variable-length array with a known element size is sized by the
+    closest preceding "num*" parameter, if there is one.
+    """
+    if not payload.params[idx].get("unit_size"):
+        return -1
+    for i in range(idx - 1, -1, -1):
+        if payload.params[i].get("mn").startswith("num"):
+            return i
+    return -1
+
+def generate_vendor_struct(mn, payload, end="in"):
+    """
+    Packed payload struct plus compile-time checks that its layout matches
+    the YAML. A payload that is nothing but a variable-length array has no
+    struct, its table row carries the YAML offsets alone.
+    """
+    if not payload.params or payload.header_size == 0:
+        return ""
+    sname = vendor_struct_name(mn, end)
+    out = f"{sname} {{\n"
+    for param in payload.params:
+        out += f"\t{payload.declaration(param)}"
+    out += f"}} __attribute__((packed));\n"
+    out += f"_Static_assert(sizeof({sname}) == {payload.header_size},\n"
+    out += f"\t\"{mn}: {end}put payload size does not match the YAML\");\n"
+    for param in payload.params:
+        out += f"_Static_assert(offsetof({sname}, {param.get('mn')}) == {param.get('offset')},\n"
+        out += f"\t\"{mn}: {param.get('mn')} offset does not match the YAML\");\n"
+    return out
+
+def generate_vendor_fields(mn, payload, end="in"):
+    if not payload.params:
+        return ""
+    out = ""
+    for param in payload.params:
+        enums = [en for en in param.get("enums") if en.get("value") is not None]
+        if not enums:
+            continue
+        out += f"static const struct cxl_vendor_enum {mn}_{end}_{param.get('mn')}_enums[] = {{\n"
+        for en in enums:
+            out += f"\t{{ {en.get('value')}, {c_string(en.get('name'))} }},\n"
+        out += f"}};\n"
+    out += f"static const struct cxl_vendor_field {mn}_{end}[] = {{\n"
+    for i, param in enumerate(payload.params):
+        pmn = param.get("mn")
+        unit, count = vendor_field_geometry(param)
+        cf = vendor_count_field(payload, i) if count == 0 else -1
+        flags = []
+        if re.match(r"^rsvd\d*$", pmn):
+            flags.append("CXL_VENDOR_F_RSVD")
+        if param.get("contiguous"):
+            flags.append("CXL_VENDOR_F_CONTIGUOUS")
+        flags = " | ".join(flags) or "0"
+        enums = [en for en in param.get("enums") if en.get("value") is not None]
+        if enums:
+            e = f"{mn}_{end}_{pmn}_enums, ARRAY_SIZE({mn}_{end}_{pmn}_enums)"
+        else:
+            e = "NULL, 0"
+        out += f"\t{{ {c_string(param.get('name'))}, \"{pmn}\", {param.get('offset')}, {unit}, {count}, {cf}, {flags}, {e} }},\n"
+    out += f"}};\n"
+    return out
+
+def generate_vendor_row(mn, opcode, ipl, opl, fullname):
+    def fields(payload, end):
+        if not payload.params:
+            return ("NULL", "0")
+        return (f"{mn}_{end}", f"ARRAY_SIZE({mn}_{end})")
+    fin, nin = fields(ipl, "in")
+    fout, nout = fields(opl, "out")
+    var_in = "false" if ipl.fixed_size else "true"
+    var_out = "false" if opl.fixed_size else "true"
+    out = f"\t[CXL_VENDOR_{mn.upper()}] = {{ {c_string(fullname)}, \"{mn}\", {opcode:#06x},\n"
+    out += f"\t\t{ipl.header_size or 0}, {opl.header_size or 0}, {var_in}, {var_out},\n"
+    out += f"\t\t{fin}, {fout}, {nin}, {nout} }},\n"
+    return out
+
+def build_vendor(results):
+    """
+    vendor.c holds the payload structs, field tables and one row per opcode,
+    vendor.h the matching cxl_vendor_cmd_id enum.
+    """
+    with open(base(VENDORH), 'r') as bh, \
+            open(os.path.join(OUTDIR, VENDORH), 'w') as h:
+        for line in bh.readlines():
+            if re.search(r".* insert here .*/", line):
+                for v in results.get("vendor_ids").values():
+                    h.write(v)
+            else:
+                h.write(line)
+
+    with open(base(VENDORC), 'r') as bc, \
+            open(os.path.join(OUTDIR, VENDORC), 'w') as c:
+        for line in bc.readlines():
+            if not re.search(r".* insert here .*/", line):
+                c.write(line)
+                continue
+            for v in results.get("vendor_tables").values():
+                c.write(v)
+                c.write("\n")
+            c.write("const struct cxl_vendor_cmd cxl_vendor_cmds[CXL_VENDOR_NR_CMDS] = {\n")
+            for v in results.get("vendor_rows").values():
+                c.write(v)
+            c.write("};\n")
+
+
+def generate_emu_handler(mn, ipl, opl):
+    """
+    Emulator handler: validate the input size, then build an output payload
+    of the declared size with reserved fields zeroed, enumerated fields set
+    to one of their values and every variable-length array sized
+    consistently with its count field.
+    """
+    out = ""
+    for param in opl.params:
+        enums = [en for en in param.get("enums") if en.get("value") is not None]
+        if not enums:
+            continue
+        vals = ", ".join(str(en.get("value")) for en in enums)
+        out += f"static const u64 emu_{mn}_{param.get('mn')}[] = {{ {vals} }};\n"
+    out += f"static int emu_{mn}(const u8 *in, size_t in_len, u8 *out, size_t *out_len,\n"
+    out += f"\t\tunsigned int *seed)\n{{\n"
+    var = [p for p in opl.params if vendor_field_geometry(p)[1] == 0]
+    loops = [p for p in opl.params if p.get("enums")
+             and vendor_field_geometry(p)[1] != 1]
+    if var:
+        out += f"\tsize_t n, len;\n"
+    if loops:
+        out += f"\tsize_t i;\n"
+    if var or loops:
+        out += f"\n"
+    if ipl.fixed_size:
+        out += f"\tif (in_len != {ipl.header_size or 0})\n"
+    else:
+        out += f"\tif (in_len < {ipl.header_size})\n"
+    out += f"\t\treturn -EINVAL;\n"
+    hs = opl.header_size or 0
+    if hs:
+        out += f"\temu_fill(out, {hs}, seed);\n"
+    for i, param in enumerate(opl.params):
+        pmn = param.get("mn")
+        off = param.get("offset")
+        unit, count = vendor_field_geometry(param)
+        has_enums = any(en.get("value") is not None for en in param.get("enums"))
+        if count == 0:
+            # an array followed by other fields only fills its own slot
+            if i + 1 < len(opl.params):
+                limit = opl.params[i + 1].get("offset")
+            else:
+                limit = "*out_len"
+            cf = vendor_count_field(opl, i)
+            out += f"\tn = emu_count(seed, {off}, {unit}, {limit});\n"
+            if cf >= 0:
+                cparam = opl.params[cf]
+                cunit, _ = vendor_field_geometry(cparam)
+                out += f"\temu_put(out + {cparam.get('offset')}, {cunit}, n);\n"
+            if has_enums:
+                out += f"\tfor (i = 0; i < n; i++)\n"
+                out += f"\t\temu_put(out + {off} + i * {unit}, {unit},\n"
+                out += f"\t\t\temu_pick(seed, emu_{mn}_{pmn}, ARRAY_SIZE(emu_{mn}_{pmn})));\n"
+            else:
+                out += f"\temu_fill(out + {off}, n * {unit}, seed);\n"
+            out += f"\tlen = {off} + n * {unit};\n"
+            continue
+        if re.match(r"^rsvd\d*$", pmn):
+            out += f"\tmemset(out + {off}, 0, {unit * count});\n"
+        elif has_enums and count == 1:
+            out += f"\temu_put(out + {off}, {unit},\n"
+            out += f"\t\temu_pick(seed, emu_{mn}_{pmn}, ARRAY_SIZE(emu_{mn}_{pmn})));\n"
+        elif has_enums:
+            out += f"\tfor (i = 0; i < {count}; i++)\n"
+            out += f"\t\temu_put(out + {off} + i * {unit}, {unit},\n"
+            out += f"\t\t\temu_pick(seed, emu_{mn}_{pmn}, ARRAY_SIZE(emu_{mn}_{pmn})));\n"
+    if not var:
+        out += f"\t*out_len = {hs};\n"
+    elif vendor_field_geometry(opl.params[-1])[1] == 0:
+        out += f"\t*out_len = len;\n"
+    else:
+        out += f"\t*out_len = len > {hs} ? len : {hs};\n"
+    out += f"\treturn 0;\n}}\n"
+    return out
+
+def generate_bench_row(mn, ipl):
+    nr_in = 0
+    raw_fixed = 0
+    var_unit = 0
+    count_in = -1
+    args = {}
+    for i, param in enumerate(ipl.params):
+        if re.match(r"^rsvd\d*$", param.get("mn")):
+            continue
+        unit, count = vendor_field_geometry(param)
+        if count == 1:
+            args[i] = nr_in
+            nr_in += 1
+        elif count:
+            raw_fixed += unit * count
+        else:
+            var_unit = unit
+            count_in = args.get(vendor_count_field(ipl, i), -1)
+    return f"\t{{ CXL_VENDOR_{mn.upper()}, {nr_in}, {raw_fixed}, {var_unit}, {count_in} }},\n"
+
+def build_vendor_emu(results):
+    """
+    vendor_emu.c holds one emulator handler per opcode, vendor_bench.c the
+    table that drives every opcode through them.
+    """
+    with open(base(VENDOREMUC), 'r') as be, \
+            open(os.path.join(OUTDIR, VENDOREMUC), 'w') as e:
+        for line in be.readlines():
+            if not re.search(r".* insert here .*/", line):
+                e.write(line)
+                continue
+            for v in results.get("vendor_emu").values():
+                e.write(v)
+                e.write("\n")
+            e.write("static const emu_fn vendor_emu[CXL_VENDOR_NR_CMDS] = {\n")
+            for name in results.get("vendor_emu").keys():
+                e.write(results.get("vendor_emu_rows").get(name))
+            e.write("};\n")
+
+    with open(base(VENDORBENCHC), 'r') as bb, \
+            open(os.path.join(OUTDIR, VENDORBENCHC), 'w') as b:
+        for line in bb.readlines():
+            if re.search(r".* insert here .*/", line):
+                for v in results.get("vendor_bench").values():
+                    b.write(v)
+            else:
+                b.write(line)
+
+
 def build_results(results):
     bb = open(base(BUILTINH), 'r')
     bc = open(base(CXLC), 'r')
@@ -585,6 +859,12 @@ def run(opcodes):
     libcxl_h = {}
     libcxl_sym = {}
     skipped = {}
+    vendor_ids = {}
+    vendor_tables = {}
+    vendor_rows = {}
+    vendor_emu = {}
+    vendor_emu_rows = {}
+    vendor_bench = {}
 
     for command in opcodes:
         name = command.get("opcode_name", "").lower()
@@ -595,6 +875,21 @@ def run(opcodes):
         if SIMPLE and not ipl.simple:
             continue
         opl = Payload(command.get("output_payload", [{}])[0], input=False)
+        vendor_ids[name] = f"\tCXL_VENDOR_{mnemonic.upper()},\n"
+        vendor_tables[name] = (
+            generate_vendor_struct(mnemonic, ipl, end='in')
+            + generate_vendor_struct(mnemonic, opl, end='out')
+            + generate_vendor_fields(mnemonic, ipl, end='in')
+            + generate_vendor_fields(mnemonic, opl, end='out')
+        )
+        vendor_rows[name] = generate_vendor_row(
+            mnemonic, opcode, ipl, opl, command.get("opcode_name", "")
+        )
+        vendor_emu[name] = generate_emu_handler(mnemonic, ipl, opl)
+        vendor_emu_rows[name] = (
+            f"\t[CXL_VENDOR_{mnemonic.upper()}] = emu_{mnemonic},\n"
+        )
+        vendor_bench[name] = generate_bench_row(mnemonic, ipl)
         if not (ipl.fixed_size and opl.fixed_size):
             skipped.update({name: { "ipl.size": ipl.size, "opl.size": opl.size}})
             continue
@@ -646,13 +941,20 @@ def run(opcodes):
         "libcxl_h" : libcxl_h,
         "libcxl_sym" : libcxl_sym,
         "skipped" : skipped,
+        "vendor_ids" : vendor_ids,
+        "vendor_tables" : vendor_tables,
+        "vendor_rows" : vendor_rows,
+        "vendor_emu" : vendor_emu,
+        "vendor_emu_rows" : vendor_emu_rows,
+        "vendor_bench" : vendor_bench,
     }
     build_results(results)
+    build_vendor(results)
+    build_vendor_emu(results)
     print("done.")
 
 with open(YAMFILE, "r") as f:
-    yml = yaml.load(f)
-    yml_no_decode = yaml.load(f, Loader=yaml.BaseLoader)
+    yml = yaml.safe_load(f)
     command_sets = yml.get('command_sets')
     opcodes = []
     for cs in command_sets:
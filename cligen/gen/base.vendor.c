@@ -0,0 +1,286 @@
+// SPDX-License-Identifier: LGPL-2.1
+#include <stdio.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ccan/list/list.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+#include <cxl/cxl_mem.h>
+#include <cxl/libcxl.h>
+#include "private.h"
+#include "vendor.h"
+
+/* payload fields are little-endian and not necessarily aligned */
+static u64 vendor_get(const u8 *p, int size)
+{
+	u64 val = 0;
+	int i;
+
+	for (i = 0; i < size && i < 8; i++)
+		val |= (u64)p[i] << (8 * i);
+	return val;
+}
+
+static void vendor_put(u8 *p, int size, u64 val)
+{
+	int i;
+
+	for (i = 0; i < size && i < 8; i++)
+		p[i] = val >> (8 * i);
+}
+
+static const char *vendor_enum_name(const struct cxl_vendor_field *f, u64 val)
+{
+	int i;
+
+	for (i = 0; i < f->nr_enums; i++)
+		if (f->enums[i].value == val)
+			return f->enums[i].name;
+	return NULL;
+}
+
+/* number of elements in array field @f given @len bytes of payload */
+static size_t vendor_count(const struct cxl_vendor_cmd *vc,
+		const struct cxl_vendor_field *f, const u8 *payload, size_t len)
+{
+	const struct cxl_vendor_field *cf;
+	size_t avail, n;
+
+	if (len <= f->offset)
+		return 0;
+	avail = (len - f->offset) / f->unit;
+	n = f->count;
+	if (!n && f->count_field >= 0) {
+		cf = &vc->out[f->count_field];
+		n = vendor_get(payload + cf->offset, cf->unit);
+	} else if (!n)
+		n = avail;
+	return n < avail ? n : avail;
+}
+
+static void vendor_print(const struct cxl_vendor_cmd *vc, const u8 *payload,
+		size_t len, FILE *out)
+{
+	const struct cxl_vendor_field *f;
+	const char *ename;
+	size_t i, n;
+	int j;
+	u64 val;
+
+	fprintf(out, "==== %s ====\n", vc->name);
+	for (j = 0; j < vc->nr_out; j++) {
+		f = &vc->out[j];
+		if (f->flags & CXL_VENDOR_F_RSVD)
+			continue;
+
+		if (f->count == 1) {
+			if (f->offset + f->unit > len)
+				break;
+			val = vendor_get(payload + f->offset, f->unit);
+			ename = vendor_enum_name(f, val);
+			if (ename)
+				fprintf(out, "%s: %s\n", f->name, ename);
+			else
+				fprintf(out, "%s: 0x%llx\n", f->name,
+					(unsigned long long)val);
+			continue;
+		}
+
+		n = vendor_count(vc, f, payload, len);
+		fprintf(out, "%s:", f->name);
+		for (i = 0; i < n; i++) {
+			val = vendor_get(payload + f->offset + i * f->unit,
+					f->unit);
+			if (f->flags & CXL_VENDOR_F_CONTIGUOUS)
+				fprintf(out, " %llx", (unsigned long long)val);
+			else
+				fprintf(out, "\n  %s[%zu]: 0x%llx", f->mnemonic,
+					i, (unsigned long long)val);
+		}
+		fprintf(out, "\n");
+	}
+}
+
+const struct cxl_vendor_cmd *cxl_vendor_cmd_find(const char *mnemonic)
+{
+	int i;
+
+	for (i = 0; i < CXL_VENDOR_NR_CMDS; i++)
+		if (strcmp(cxl_vendor_cmds[i].mnemonic, mnemonic) == 0)
+			return &cxl_vendor_cmds[i];
+	return NULL;
+}
+
+static cxl_vendor_transport_fn vendor_transport;
+
+void cxl_vendor_set_transport(cxl_vendor_transport_fn fn)
+{
+	vendor_transport = fn;
+}
+
+/*
+ * Build the input payload for @vc. @in supplies the non-reserved scalar
+ * input fields in table order, @raw_in supplies the bytes of the array
+ * fields in table order, whatever is left over after the fixed arrays
+ * becomes the variable-length tail. The tail must be a whole number of
+ * elements, and the scalar that counts them is derived from it: pass 0
+ * for that scalar, or the matching element count, anything else is
+ * rejected.
+ */
+static int vendor_encode(const struct cxl_vendor_cmd *vc, const u64 *in,
+		int nr_in, const u8 *raw, size_t raw_len, u8 **payload,
+		size_t *size_in)
+{
+	const struct cxl_vendor_field *f, *vf = NULL;
+	size_t used = 0, n, nr_elems = 0;
+	int i, arg = 0;
+	u64 val;
+
+	for (i = 0; i < vc->nr_in; i++) {
+		f = &vc->in[i];
+		if (f->flags & CXL_VENDOR_F_RSVD)
+			continue;
+		if (f->count > 1)
+			used += f->count * f->unit;
+		else if (!f->count)
+			vf = f;
+	}
+	if (used > raw_len || (!vc->var_in && used != raw_len))
+		return -EINVAL;
+	if (vf) {
+		if ((raw_len - used) % vf->unit)
+			return -EINVAL;
+		nr_elems = (raw_len - used) / vf->unit;
+	}
+	*size_in = vc->size_in + (vc->var_in ? raw_len - used : 0);
+	*payload = NULL;
+	if (!*size_in)
+		return 0;
+
+	*payload = calloc(1, *size_in);
+	if (!*payload)
+		return -ENOMEM;
+
+	used = 0;
+	for (i = 0; i < vc->nr_in; i++) {
+		f = &vc->in[i];
+		if (f->flags & CXL_VENDOR_F_RSVD)
+			continue;
+		if (f->count == 1) {
+			if (arg >= nr_in)
+				goto err;
+			val = in[arg++];
+			if (vf && vf->count_field == i) {
+				if (val && val != nr_elems)
+					goto err;
+				val = nr_elems;
+				if (f->unit < 8 && val >> (8 * f->unit))
+					goto err;
+			}
+			vendor_put(*payload + f->offset, f->unit, val);
+			continue;
+		}
+		n = f->count ? f->count * f->unit : raw_len - used;
+		memcpy(*payload + f->offset, raw + used, n);
+		used += n;
+	}
+	return 0;
+
+ err:
+	free(*payload);
+	*payload = NULL;
+	return -EINVAL;
+}
+
+static int vendor_transport_cmd(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, u8 *payload, size_t size_in,
+		FILE *out)
+{
+	size_t out_len = CXL_VENDOR_MAX_PAYLOAD;
+	u8 *buf;
+	int rc;
+
+	buf = calloc(1, out_len);
+	if (!buf)
+		return -ENOMEM;
+	rc = vendor_transport(memdev, vc, payload, size_in, buf, &out_len);
+	if (rc == 0 && out_len < vc->size_out)
+		rc = -EIO;
+	if (rc == 0 && vc->nr_out)
+		vendor_print(vc, buf, out_len, out);
+	free(buf);
+	return rc;
+}
+
+/* issue @vc with inputs as described at vendor_encode(), print the output */
+int cxl_memdev_vendor_cmd(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, const u64 *in, int nr_in,
+		const void *raw_in, size_t raw_len, FILE *out)
+{
+	struct cxl_command_info *cinfo;
+	const char *devname;
+	struct cxl_cmd *cmd;
+	size_t size_in;
+	u8 *payload;
+	int rc;
+
+	rc = vendor_encode(vc, in, nr_in, raw_in, raw_len, &payload, &size_in);
+	if (rc)
+		return rc;
+
+	if (vendor_transport) {
+		rc = vendor_transport_cmd(memdev, vc, payload, size_in, out);
+		free(payload);
+		return rc;
+	}
+
+	devname = cxl_memdev_get_devname(memdev);
+	cmd = cxl_cmd_new_raw(memdev, vc->opcode);
+	if (!cmd) {
+		free(payload);
+		return -ENOMEM;
+	}
+
+	if (size_in) {
+		cinfo = &cmd->query_cmd->commands[cmd->query_idx];
+		cinfo->size_in = size_in;
+		/* freed with the cmd */
+		cmd->input_payload = payload;
+		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+		cmd->send_cmd->in.size = size_in;
+	}
+
+	rc = cxl_cmd_submit(cmd);
+	if (rc < 0) {
+		fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
+				devname, rc, strerror(-rc));
+		goto out;
+	}
+
+	rc = cxl_cmd_get_mbox_status(cmd);
+	if (rc != 0) {
+		fprintf(stderr, "%s: firmware status: %d\n", devname, rc);
+		rc = -ENXIO;
+		goto out;
+	}
+
+	if (cmd->send_cmd->out.size < (int) vc->size_out) {
+		fprintf(stderr, "%s: %s: short output payload (%d < %u)\n",
+				devname, vc->mnemonic, cmd->send_cmd->out.size,
+				vc->size_out);
+		rc = -EIO;
+		goto out;
+	}
+
+	if (vc->nr_out)
+		vendor_print(vc, (void *)cmd->send_cmd->out.payload,
+				cmd->send_cmd->out.size, out);
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+/* insert here */
@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: LGPL-2.1 */
+#ifndef _LIBCXL_VENDOR_H_
+#define _LIBCXL_VENDOR_H_
+#include <stdio.h>
+#include <stdbool.h>
+#include <ccan/short_types/short_types.h>
+
+/*
+ * Table-driven vendor commands. cligen.py emits one struct cxl_vendor_cmd
+ * row per YAML opcode into vendor.c, and cxl_memdev_vendor_cmd() encodes
+ * the input payload and decodes the output payload from that row.
+ */
+#define CXL_VENDOR_F_RSVD	(1 << 0)
+/* print the array on one line instead of one element per line */
+#define CXL_VENDOR_F_CONTIGUOUS	(1 << 1)
+/* output buffer handed to a transport, see cxl_vendor_set_transport() */
+#define CXL_VENDOR_MAX_PAYLOAD	4096
+
+struct cxl_vendor_enum {
+	u64 value;
+	const char *name;
+};
+
+/*
+ * One payload parameter. Scalars have count == 1. Fixed arrays have
+ * count > 1 elements of @unit bytes. A variable-length array (always the
+ * last field) has count == 0; its length comes from the field at index
+ * @count_field when that is >= 0, else from the remaining payload.
+ */
+struct cxl_vendor_field {
+	const char *name;
+	const char *mnemonic;
+	u16 offset;
+	u16 unit;
+	u16 count;
+	s16 count_field;
+	unsigned int flags;
+	const struct cxl_vendor_enum *enums;
+	int nr_enums;
+};
+
+/*
+ * @size_in and @size_out are the fixed parts of the payloads, i.e. the
+ * header size when @var_in or @var_out is set.
+ */
+struct cxl_vendor_cmd {
+	const char *name;
+	const char *mnemonic;
+	u16 opcode;
+	u32 size_in;
+	u32 size_out;
+	bool var_in;
+	bool var_out;
+	const struct cxl_vendor_field *in;
+	const struct cxl_vendor_field *out;
+	int nr_in;
+	int nr_out;
+};
+
+enum cxl_vendor_cmd_id {
+/* insert here */
+	CXL_VENDOR_NR_CMDS,
+};
+
+struct cxl_memdev;
+extern const struct cxl_vendor_cmd cxl_vendor_cmds[CXL_VENDOR_NR_CMDS];
+const struct cxl_vendor_cmd *cxl_vendor_cmd_find(const char *mnemonic);
+int cxl_memdev_vendor_cmd(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, const u64 *in, int nr_in,
+		const void *raw_in, size_t raw_len, FILE *out);
+
+/*
+ * Replace the mailbox for cxl_memdev_vendor_cmd(), e.g. with the generated
+ * emulator in vendor_emu.c. On entry *@out_len is the size of @out, the
+ * transport sets it to the output payload size. NULL restores the mailbox.
+ */
+typedef int (*cxl_vendor_transport_fn)(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, const void *in, size_t in_len,
+		void *out, size_t *out_len);
+void cxl_vendor_set_transport(cxl_vendor_transport_fn fn);
+int cxl_vendor_emu_transport(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, const void *in, size_t in_len,
+		void *out, size_t *out_len);
+extern unsigned int cxl_vendor_emu_seed;
+
+#endif /* _LIBCXL_VENDOR_H_ */
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: LGPL-2.1
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+#include "vendor.h"
+
+/*
+ * Runs every table-driven vendor command through cxl_memdev_vendor_cmd()
+ * against the emulator in vendor_emu.c and reports whether it round-trips
+ * and what a call costs. The emulator replaces the mailbox, so no cxl_cmd
+ * is allocated and cxl_cmd_submit() and the kernel are never reached: the
+ * figure is payload encode + emulator + output decode only, a measure of
+ * the table-driven codec rather than of command latency.
+ *
+ *   vendor_bench [-n iterations] [mnemonic...]
+ *
+ * Each row of the generated table gives the input shape of one opcode:
+ * the number of scalar inputs, the bytes of fixed arrays, the element
+ * size of the variable-length input tail (0 when there is none) and which
+ * scalar input counts the tail elements (-1 when none does).
+ */
+struct vendor_case {
+	enum cxl_vendor_cmd_id id;
+	int nr_in;
+	size_t raw_fixed;
+	size_t var_unit;
+	int count_in;
+};
+
+static const struct vendor_case vendor_cases[] = {
+/* insert here */
+};
+
+#define BENCH_MAX_IN 64
+#define BENCH_MAX_VAR_ELEMS 16
+
+static bool bench_selected(const char *mnemonic, int argc, char **argv)
+{
+	int i;
+
+	if (!argc)
+		return true;
+	for (i = 0; i < argc; i++)
+		if (strcmp(argv[i], mnemonic) == 0)
+			return true;
+	return false;
+}
+
+static int bench_one(const struct vendor_case *vcase, long iters, FILE *sink,
+		double *ns)
+{
+	const struct cxl_vendor_cmd *vc = &cxl_vendor_cmds[vcase->id];
+	unsigned int seed = vcase->id + 1;
+	u8 raw[CXL_VENDOR_MAX_PAYLOAD];
+	struct timespec t0, t1;
+	u64 in[BENCH_MAX_IN];
+	size_t raw_len, nr_elems;
+	long i;
+	int j, rc = 0;
+
+	if (vcase->nr_in > BENCH_MAX_IN)
+		return -E2BIG;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for (i = 0; i < iters && !rc; i++) {
+		for (j = 0; j < vcase->nr_in; j++)
+			in[j] = (u64)rand_r(&seed) << 32 | rand_r(&seed);
+		raw_len = vcase->raw_fixed;
+		if (vcase->var_unit) {
+			nr_elems = rand_r(&seed) % BENCH_MAX_VAR_ELEMS;
+			raw_len += vcase->var_unit * nr_elems;
+			if (vcase->count_in >= 0)
+				in[vcase->count_in] = nr_elems;
+		}
+		for (j = 0; j < (int)raw_len; j++)
+			raw[j] = rand_r(&seed);
+		rc = cxl_memdev_vendor_cmd(NULL, vc, in, vcase->nr_in, raw,
+				raw_len, sink);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	*ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / i;
+	return rc;
+}
+
+int main(int argc, char **argv)
+{
+	long iters = 10000;
+	unsigned int i;
+	int failed = 0, rc;
+	FILE *sink;
+	double ns;
+
+	if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+		iters = strtol(argv[2], NULL, 0);
+		argc -= 2;
+		argv += 2;
+	}
+	if (iters <= 0) {
+		fprintf(stderr, "vendor_bench: invalid iteration count\n");
+		return EXIT_FAILURE;
+	}
+
+	sink = fopen("/dev/null", "w");
+	if (!sink)
+		return EXIT_FAILURE;
+	cxl_vendor_set_transport(cxl_vendor_emu_transport);
+
+	printf("%-32s %6s %6s %12s\n", "command", "opcode", "result", "ns/call");
+	for (i = 0; i < ARRAY_SIZE(vendor_cases); i++) {
+		const struct cxl_vendor_cmd *vc =
+			&cxl_vendor_cmds[vendor_cases[i].id];
+
+		if (!bench_selected(vc->mnemonic, argc - 1, argv + 1))
+			continue;
+		rc = bench_one(&vendor_cases[i], iters, sink, &ns);
+		if (rc)
+			failed++;
+		printf("%-32s 0x%04x %6s %12.0f\n", vc->mnemonic, vc->opcode,
+				rc ? strerror(-rc) : "ok", ns);
+	}
+
+	fclose(sink);
+	return failed ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: LGPL-2.1
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+#include "vendor.h"
+
+/*
+ * Emulated device for the table-driven vendor commands. cligen.py emits one
+ * handler per YAML opcode that checks the input payload size and returns a
+ * well-formed output payload of the declared size: reserved fields zeroed,
+ * enumerated fields set to a declared value, variable-length arrays given
+ * a random element count that is also written to their count field, and
+ * everything else random. Install with
+ * cxl_vendor_set_transport(cxl_vendor_emu_transport).
+ */
+#define EMU_MAX_ELEMS 16
+
+unsigned int cxl_vendor_emu_seed = 1;
+
+typedef int (*emu_fn)(const u8 *in, size_t in_len, u8 *out, size_t *out_len,
+		unsigned int *seed);
+
+static void emu_fill(u8 *p, size_t len, unsigned int *seed)
+{
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		p[i] = rand_r(seed);
+}
+
+static void emu_put(u8 *p, int size, u64 val)
+{
+	int i;
+
+	for (i = 0; i < size && i < 8; i++)
+		p[i] = val >> (8 * i);
+}
+
+static u64 emu_pick(unsigned int *seed, const u64 *vals, int nr)
+{
+	return vals[rand_r(seed) % nr];
+}
+
+/* element count for a variable array of @unit byte elements at @offset */
+static size_t emu_count(unsigned int *seed, size_t offset, size_t unit,
+		size_t max)
+{
+	size_t n = 1 + rand_r(seed) % EMU_MAX_ELEMS;
+
+	if (offset + n * unit > max)
+		n = (max - offset) / unit;
+	return n;
+}
+
+/* insert here */
+
+int cxl_vendor_emu_transport(struct cxl_memdev *memdev,
+		const struct cxl_vendor_cmd *vc, const void *in, size_t in_len,
+		void *out, size_t *out_len)
+{
+	long id = vc - cxl_vendor_cmds;
+
+	if (id < 0 || id >= CXL_VENDOR_NR_CMDS || !vendor_emu[id])
+		return -EOPNOTSUPP;
+	memset(out, 0, *out_len);
+	return vendor_emu[id](in, in_len, out, out_len, &cxl_vendor_emu_seed);
+}
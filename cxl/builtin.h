@@ -2,14 +2,18 @@
 /* Copyright (C) 2020-2021 Intel Corporation. All rights reserved. */
 #ifndef _CXL_BUILTIN_H_
 #define _CXL_BUILTIN_H_
+#include <stdio.h>
+#include <stdbool.h>
 
 struct cxl_ctx;
+struct json_object;
 int cmd_update_fw(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_get_fw_info(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_transfer_fw(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_activate_fw(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_device_info_get(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_list(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_report(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_write_labels(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_read_labels(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_zero_labels(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -62,6 +66,7 @@ int cmd_perfcnt_mta_hif_cnt_val_latch(int argc, const char **argv, struct cxl_ct
 int cmd_perfcnt_ddr_generic_select(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_perfcnt_ddr_generic_capture(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_perfcnt_ddr_dfi_capture(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_perfcnt_snapshot(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_err_inj_drs_poison(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_err_inj_drs_ecc(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_err_inj_rxflit_crc(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -73,6 +78,7 @@ int cmd_eh_eye_cap_run(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_eye_cap_read(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_eye_cap_timeout_enable(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_eye_cap_status(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_eye_scan(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_adapt_get(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_adapt_oneoff(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_adapt_force(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -85,6 +91,7 @@ int cmd_hct_get_plat_param(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_link_dbg_cfg(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_link_dbg_entry_dump(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_link_dbg_lane_dump(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_eh_link_dbg_dump_all(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_eh_link_dbg_reset(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_fbist_stopconfig_set(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_fbist_cyclecount_set(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -106,20 +113,24 @@ int cmd_fbist_test_simpledata(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_fbist_test_addresstest(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_fbist_test_movinginversion(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_fbist_test_randomsequence(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_fbist_run(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_conf_read(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_hct_get_config(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_hct_read_buffer(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_hct_set_config(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_hct_stream(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_osa_os_patt_trig_cfg(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_osa_misc_trig_cfg(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_osa_data_read(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_dimm_spd_read(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_training_status(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_dimm_slot_info(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_ddr_inventory(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_pmic_vtmon_info(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_margin_run(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_margin_status(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_margin_get(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_ddr_margin_execute(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_stats_run(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_stats_get(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_reboot_mode_set(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -136,6 +147,7 @@ int cmd_get_ddr_bw(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_get_ddr_latency(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_i2c_read(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_i2c_write(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_i2c_batch(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_get_ddr_ecc_err_info(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_start_ddr_ecc_scrub(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_ecc_scrub_status(int argc, const char **argv, struct cxl_ctx *ctx);
@@ -176,6 +188,19 @@ int cmd_ddr_threshold_set(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_ddr_threshold_get(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_cxl_threshold_set(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_cxl_threshold_get(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_apply_config(int argc, const char **argv, struct cxl_ctx *ctx);
+int cmd_serve(int argc, const char **argv, struct cxl_ctx *ctx);
 int cmd_get_coredump(int argc, const char **argv, struct cxl_ctx *ctx);
 
+int cmd_snapshot(int argc, const char **argv, struct cxl_ctx *ctx);
+
+/* run one subcommand in a child process against @ctx, see cxl.c */
+int cxl_run_command(int argc, const char **argv, struct cxl_ctx *ctx,
+		int out_fd, int err_fd);
+/* as above, but kill the child and return -ETIMEDOUT after @timeout_ms */
+int cxl_run_command_timeout(int argc, const char **argv, struct cxl_ctx *ctx,
+		int out_fd, int err_fd, int timeout_ms);
+/* read back what a child wrote to the tmpfile @f, see serve.c */
+struct json_object *cxl_read_output(FILE *f, bool try_json);
+
 #endif /* _CXL_BUILTIN_H_ */
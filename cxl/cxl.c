@@ -8,9 +8,12 @@
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/wait.h>
 #include <ccan/array_size/array_size.h>
 #include <ccan/endian/endian.h>
 #include <ccan/short_types/short_types.h>
@@ -21,6 +24,7 @@
 #include <util/strbuf.h>
 #include <util/util.h>
 #include <util/main.h>
+#include <util/time.h>
 #include <cxl/builtin.h>
 
 const char cxl_usage_string[] = "cxl [--version] [--help] COMMAND [ARGS]";
@@ -60,13 +64,19 @@ static int cmd_help(int argc, const char **argv, struct cxl_ctx *ctx)
 	return help_show_man_page(argv[0], "cxl", "CXL_MAN_VIEWER");
 }
 
+static int cmd_batch(int argc, const char **argv, struct cxl_ctx *ctx);
+
 static struct cmd_struct commands[] = {
 	{ "update-fw", .c_fn = cmd_update_fw },
 	{ "get-fw-info", .c_fn = cmd_get_fw_info },
 	{ "activate-fw", .c_fn = cmd_activate_fw },
 	{ "device-info-get", .c_fn = cmd_device_info_get },
 	{ "version", .c_fn = cmd_version },
+	{ "batch", .c_fn = cmd_batch },
+	{ "serve", .c_fn = cmd_serve },
+	{ "snapshot", .c_fn = cmd_snapshot },
 	{ "list", .c_fn = cmd_list },
+	{ "report", .c_fn = cmd_report },
 	{ "help", .c_fn = cmd_help },
 	{ "zero-labels", .c_fn = cmd_zero_labels },
 	{ "read-labels", .c_fn = cmd_read_labels },
@@ -118,6 +128,7 @@ static struct cmd_struct commands[] = {
 	{ "perfcnt-ddr-generic-select", .c_fn = cmd_perfcnt_ddr_generic_select },
 	{ "perfcnt-ddr-generic-capture", .c_fn = cmd_perfcnt_ddr_generic_capture},
 	{ "perfcnt-ddr-dfi-capture", .c_fn = cmd_perfcnt_ddr_dfi_capture},
+	{ "perfcnt-snapshot", .c_fn = cmd_perfcnt_snapshot },
 	{ "err-inj-drs-poison", .c_fn = cmd_err_inj_drs_poison },
 	{ "err-inj-drs-ecc", .c_fn = cmd_err_inj_drs_ecc },
 	{ "err-inj-rxflit-crc", .c_fn = cmd_err_inj_rxflit_crc },
@@ -129,6 +140,7 @@ static struct cmd_struct commands[] = {
 	{ "eh-eye-cap-read", .c_fn = cmd_eh_eye_cap_read },
 	{ "eh-eye-cap-timeout-enable", .c_fn = cmd_eh_eye_cap_timeout_enable },
 	{ "eh-eye-cap-status", .c_fn = cmd_eh_eye_cap_status },
+	{ "eye-scan", .c_fn = cmd_eye_scan },
 	{ "eh-adapt-get", .c_fn = cmd_eh_adapt_get },
 	{ "eh-adapt-oneoff", .c_fn = cmd_eh_adapt_oneoff },
 	{ "eh-adapt-force", .c_fn = cmd_eh_adapt_force },
@@ -141,6 +153,7 @@ static struct cmd_struct commands[] = {
 	{ "eh-link-dbg-cfg", .c_fn = cmd_eh_link_dbg_cfg },
 	{ "eh-link-dbg-entry-dump", .c_fn = cmd_eh_link_dbg_entry_dump },
 	{ "eh-link-dbg-lane-dump", .c_fn = cmd_eh_link_dbg_lane_dump },
+	{ "eh-link-dbg-dump-all", .c_fn = cmd_eh_link_dbg_dump_all },
 	{ "eh-link-dbg-reset", .c_fn = cmd_eh_link_dbg_reset },
 	{ "fbist-stopconfig-set", .c_fn = cmd_fbist_stopconfig_set },
 	{ "fbist-cyclecount-set", .c_fn = cmd_fbist_cyclecount_set },
@@ -162,20 +175,24 @@ static struct cmd_struct commands[] = {
 	{ "fbist-test-addresstest", .c_fn = cmd_fbist_test_addresstest },
 	{ "fbist-test-movinginversion", .c_fn = cmd_fbist_test_movinginversion },
 	{ "fbist-test-randomsequence", .c_fn = cmd_fbist_test_randomsequence },
+	{ "fbist-run", .c_fn = cmd_fbist_run },
 	{ "conf-read", .c_fn = cmd_conf_read },
 	{ "hct-get-config", .c_fn = cmd_hct_get_config },
 	{ "hct-read-buffer", .c_fn = cmd_hct_read_buffer },
 	{ "hct-set-config", .c_fn = cmd_hct_set_config },
+	{ "hct-stream", .c_fn = cmd_hct_stream },
 	{ "osa-os-patt-trig-cfg", .c_fn = cmd_osa_os_patt_trig_cfg },
 	{ "osa-misc-trig-cfg", .c_fn = cmd_osa_misc_trig_cfg },
 	{ "osa-data-read", .c_fn = cmd_osa_data_read },
 	{ "dimm-spd-read", .c_fn = cmd_dimm_spd_read },
 	{ "ddr-training-status", .c_fn = cmd_ddr_training_status },
 	{ "dimm-slot-info", .c_fn = cmd_dimm_slot_info },
+	{ "ddr-inventory", .c_fn = cmd_ddr_inventory },
 	{ "pmic-vtmon-info", .c_fn = cmd_pmic_vtmon_info },
 	{ "ddr-margin-run", .c_fn = cmd_ddr_margin_run },
 	{ "ddr-margin-status", .c_fn = cmd_ddr_margin_status },
 	{ "ddr-margin-get", .c_fn = cmd_ddr_margin_get },
+	{ "ddr-margin-execute", .c_fn = cmd_ddr_margin_execute },
 	{ "ddr-stats-run", .c_fn = cmd_ddr_stats_run },
 	{ "ddr-stats-get", .c_fn = cmd_ddr_stats_get },
 	{ "reboot-mode-set", .c_fn = cmd_reboot_mode_set },
@@ -192,6 +209,7 @@ static struct cmd_struct commands[] = {
 	{ "get-ddr-latency", .c_fn = cmd_get_ddr_latency },
 	{ "i2c-read", .c_fn = cmd_i2c_read },
 	{ "i2c-write", .c_fn = cmd_i2c_write },
+	{ "i2c-batch", .c_fn = cmd_i2c_batch },
 	{ "get-ddr-ecc-err-info", .c_fn = cmd_get_ddr_ecc_err_info },
 	{ "start-ddr-ecc-scrub", .c_fn = cmd_start_ddr_ecc_scrub },
 	{ "ddr-ecc-scrub-status", .c_fn = cmd_ddr_ecc_scrub_status },
@@ -232,9 +250,231 @@ static struct cmd_struct commands[] = {
 	{ "ddr-thres-get", .c_fn = cmd_ddr_threshold_get },
 	{ "cxl-thres-set", .c_fn = cmd_cxl_threshold_set },
 	{ "cxl-thres-get", .c_fn = cmd_cxl_threshold_get },
+	{ "apply-config", .c_fn = cmd_apply_config },
 	{ "get-coredump", .c_fn = cmd_get_coredump },
 };
 
+#define BATCH_MAX_ARGS 128
+
+/* split a batch line in place; single and double quotes group words */
+static int batch_split(char *line, const char **argv, int max)
+{
+	char *src = line, *dst = line, quote;
+	int argc = 0;
+
+	for (;;) {
+		while (*src == ' ' || *src == '\t')
+			src++;
+		if (*src == '\0' || *src == '#')
+			break;
+		if (argc == max - 1)
+			return -E2BIG;
+
+		argv[argc++] = dst;
+		quote = 0;
+		for (; *src; src++) {
+			if (quote && *src == quote) {
+				quote = 0;
+			} else if (!quote && (*src == '\'' || *src == '"')) {
+				quote = *src;
+			} else if (!quote && (*src == ' ' || *src == '\t')) {
+				src++;
+				break;
+			} else {
+				*dst++ = *src;
+			}
+		}
+		if (quote)
+			return -EINVAL;
+		*dst++ = '\0';
+	}
+	argv[argc] = NULL;
+	return argc;
+}
+
+/* reap @pid, killing it if it is still running after @timeout_ms */
+static int cxl_wait_timeout(pid_t pid, int *status, int timeout_ms)
+{
+	struct timespec ts = { .tv_nsec = 1000000 };
+	u64 deadline = util_clock_ms(CLOCK_MONOTONIC) + timeout_ms;
+	pid_t rc;
+
+	for (;;) {
+		rc = waitpid(pid, status, WNOHANG);
+		if (rc < 0)
+			return -errno;
+		if (rc == pid)
+			return 0;
+		if (util_clock_ms(CLOCK_MONOTONIC) >= deadline)
+			break;
+		nanosleep(&ts, NULL);
+		/* back off to 10ms polls for long running commands */
+		if (ts.tv_nsec < 10000000)
+			ts.tv_nsec += 1000000;
+	}
+
+	kill(pid, SIGKILL);
+	waitpid(pid, status, 0);
+	return -ETIMEDOUT;
+}
+
+/*
+ * Each command runs in a forked child of the process that already holds
+ * the shared ctx and the memdevs opened with cxl_memdev_open(), so
+ * the per-command option state in the builtins starts out fresh every
+ * time and a failing command can exit() without taking the caller down.
+ * @out_fd / @err_fd, when not -1, replace the child's stdout / stderr.
+ */
+int cxl_run_command_timeout(int argc, const char **argv, struct cxl_ctx *ctx,
+		int out_fd, int err_fd, int timeout_ms)
+{
+	int status, rc;
+	pid_t pid;
+
+	fflush(stdout);
+	fflush(stderr);
+	pid = fork();
+	if (pid < 0)
+		return -errno;
+	if (pid == 0) {
+		if (out_fd >= 0)
+			dup2(out_fd, STDOUT_FILENO);
+		if (err_fd >= 0)
+			dup2(err_fd, STDERR_FILENO);
+		main_handle_internal_command(argc, argv, ctx, commands,
+				ARRAY_SIZE(commands), PROG_CXL);
+		fprintf(stderr, "Unknown command: '%s'\n", argv[0]);
+		exit(1);
+	}
+
+	if (timeout_ms > 0) {
+		rc = cxl_wait_timeout(pid, &status, timeout_ms);
+		if (rc < 0)
+			return rc;
+	} else if (waitpid(pid, &status, 0) < 0)
+		return -errno;
+	if (WIFSIGNALED(status))
+		return 128 + WTERMSIG(status);
+	return WEXITSTATUS(status);
+}
+
+int cxl_run_command(int argc, const char **argv, struct cxl_ctx *ctx,
+		int out_fd, int err_fd)
+{
+	return cxl_run_command_timeout(argc, argv, ctx, out_fd, err_fd, 0);
+}
+
+/*
+ * Batch lines run in-process, one after the other, on the shared ctx.
+ * Option values go back to their defaults before every line, the memdevs
+ * a line names are looked up and opened as it comes, and the ctx log
+ * priority and quiet setting the line may have changed are put back after
+ * it. A builtin that exits, e.g. on bad options, ends the batch.
+ */
+static int batch_run_line(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	int priority = cxl_get_log_priority(ctx);
+	bool quiet = cxl_get_quiet(ctx);
+	struct cxl_memdev *memdev;
+	int i, rc = -1;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "all") == 0) {
+			cxl_memdev_foreach(ctx, memdev)
+				cxl_memdev_open(memdev);
+			continue;
+		}
+		memdev = cxl_memdev_get_by_name(ctx, argv[i]);
+		if (memdev)
+			cxl_memdev_open(memdev);
+	}
+
+	for (i = 0; i < (int)ARRAY_SIZE(commands); i++) {
+		if (strcmp(commands[i].cmd, argv[0]) == 0) {
+			rc = commands[i].c_fn(argc, argv, ctx) & 0xff;
+			break;
+		}
+	}
+	if (rc < 0) {
+		fprintf(stderr, "Unknown command: '%s'\n", argv[0]);
+		rc = 1;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	cxl_set_log_priority(ctx, priority);
+	cxl_set_quiet(ctx, quiet);
+	return rc;
+}
+
+static int cmd_batch(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	const char *file = NULL, *cmd_argv[BATCH_MAX_ARGS];
+	bool stop_on_error = false;
+	int line = 0, failed = 0, cmd_argc, status;
+	char *buf = NULL;
+	size_t len = 0;
+	FILE *fp;
+	const struct option options[] = {
+		OPT_STRING('f', "file", &file, "file",
+			"read commands from <file> instead of stdin"),
+		OPT_BOOLEAN('e', "stop-on-error", &stop_on_error,
+			"stop at the first command that fails"),
+		OPT_END(),
+	};
+	const char * const u[] = {
+		"cxl batch [-f <file>] [<options>]",
+		NULL
+	};
+
+	argc = parse_options(argc, argv, options, u, 0);
+	if (argc)
+		usage_with_options(u, options);
+
+	fp = file && strcmp(file, "-") != 0 ? fopen(file, "r") : stdin;
+	if (!fp) {
+		fprintf(stderr, "batch: %s: %s\n", file, strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	parse_options_restore_defaults(true);
+	while (getline(&buf, &len, fp) > 0) {
+		line++;
+		buf[strcspn(buf, "\r\n")] = '\0';
+		cmd_argc = batch_split(buf, cmd_argv, ARRAY_SIZE(cmd_argv));
+		if (cmd_argc == 0)
+			continue;
+
+		if (cmd_argc < 0)
+			status = cmd_argc;
+		else if (strcmp(cmd_argv[0], "batch") == 0 ||
+			 strcmp(cmd_argv[0], "serve") == 0 ||
+			 strcmp(cmd_argv[0], "help") == 0)
+			status = -EINVAL;
+		else
+			status = batch_run_line(cmd_argc, cmd_argv, ctx);
+		if (status < 0) {
+			fprintf(stderr, "batch: line %d: %s\n", line,
+				strerror(-status));
+			status = 1;
+		}
+
+		fprintf(stderr, "batch: line %d: %s: exit %d\n", line,
+			cmd_argc > 0 ? cmd_argv[0] : "?", status);
+		if (status) {
+			failed++;
+			if (stop_on_error)
+				break;
+		}
+	}
+
+	parse_options_restore_defaults(false);
+	free(buf);
+	if (fp != stdin)
+		fclose(fp);
+	return failed ? EXIT_FAILURE : 0;
+}
+
 int main(int argc, const char **argv)
 {
 	struct cxl_ctx *ctx;
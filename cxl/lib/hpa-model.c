@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: LGPL-2.1
+#include <string.h>
+#include <ccan/array_size/array_size.h>
+
+#include "hpa-model.h"
+
+/*
+ * With the region base aligned to granularity * ways (as the decoder
+ * programming rules require), a device at interleave position 'position'
+ * maps
+ *
+ *   dpa = skew + (hpa / (gran * ways)) * gran + hpa % gran
+ *
+ * and only owns addresses with (hpa / gran) % ways == position. The model
+ * is only used once exactly one (gran, ways) candidate explains every
+ * sample.
+ */
+static const unsigned int hpa_model_ways[] = { 1, 2, 3, 4, 6, 8, 12, 16 };
+
+static u64 hpa_model_map(u64 gran, unsigned int ways, u64 hpa)
+{
+	return (hpa / (gran * ways)) * gran + hpa % gran;
+}
+
+static bool hpa_model_fits(struct hpa_model *m, u64 gran, unsigned int ways,
+		unsigned int *position, u64 *skew)
+{
+	int i;
+
+	*position = (m->hpa[0] / gran) % ways;
+	*skew = m->dpa[0] - hpa_model_map(gran, ways, m->hpa[0]);
+	for (i = 1; i < m->nr; i++) {
+		if ((m->hpa[i] / gran) % ways != *position)
+			return false;
+		if (m->dpa[i] - hpa_model_map(gran, ways, m->hpa[i]) != *skew)
+			return false;
+	}
+	return true;
+}
+
+static void hpa_model_fit(struct hpa_model *m)
+{
+	unsigned int w, ways, position, fit_position = 0, fits = 0;
+	u64 gran, skew, fit_gran = 0, fit_skew = 0;
+	unsigned int fit_ways = 0;
+	int i;
+
+	m->valid = false;
+	if (m->nr < HPA_MODEL_MIN_SAMPLES)
+		return;
+
+	for (w = 0; w < ARRAY_SIZE(hpa_model_ways); w++) {
+		ways = hpa_model_ways[w];
+		for (gran = 256; gran <= 16384; gran <<= 1) {
+			if (!hpa_model_fits(m, gran, ways, &position, &skew))
+				continue;
+			fit_gran = gran;
+			fit_ways = ways;
+			fit_position = position;
+			fit_skew = skew;
+			fits++;
+			/* granularity is meaningless without interleave */
+			if (ways == 1)
+				break;
+		}
+	}
+
+	if (fits != 1)
+		return;
+	m->gran = fit_gran;
+	m->ways = fit_ways;
+	m->position = fit_position;
+	m->skew = fit_skew;
+	m->hpa_min = m->hpa_max = m->hpa[0];
+	for (i = 1; i < m->nr; i++) {
+		if (m->hpa[i] < m->hpa_min)
+			m->hpa_min = m->hpa[i];
+		if (m->hpa[i] > m->hpa_max)
+			m->hpa_max = m->hpa[i];
+	}
+	m->valid = true;
+}
+
+/* forget every sample, e.g. after the device contradicted the model */
+void hpa_model_reset(struct hpa_model *m)
+{
+	memset(m, 0, sizeof(*m));
+}
+
+void hpa_model_add(struct hpa_model *m, u64 hpa, u64 dpa)
+{
+	m->hpa[m->next] = hpa;
+	m->dpa[m->next] = dpa;
+	m->next = (m->next + 1) % HPA_MODEL_MAX_SAMPLES;
+	if (m->nr < HPA_MODEL_MAX_SAMPLES)
+		m->nr++;
+	hpa_model_fit(m);
+}
+
+bool hpa_model_lookup(const struct hpa_model *m, u64 hpa, u64 *dpa)
+{
+	if (!m->valid || hpa < m->hpa_min || hpa > m->hpa_max)
+		return false;
+	if ((hpa / m->gran) % m->ways != m->position)
+		return false;
+	*dpa = m->skew + hpa_model_map(m->gran, m->ways, hpa);
+	return true;
+}
@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: LGPL-2.1 */
+#ifndef _LIBCXL_HPA_MODEL_H_
+#define _LIBCXL_HPA_MODEL_H_
+
+#include <stdbool.h>
+#include <ccan/short_types/short_types.h>
+
+#define HPA_MODEL_MIN_SAMPLES 4
+#define HPA_MODEL_MAX_SAMPLES 32
+
+/*
+ * Local HDM decoder model fitted from mailbox HPA to DPA translations.
+ * The newest HPA_MODEL_MAX_SAMPLES translations are kept in a ring and
+ * the model is refitted on every sample; it only answers for addresses
+ * between the lowest and highest sampled HPA.
+ */
+struct hpa_model {
+	u64 hpa[HPA_MODEL_MAX_SAMPLES];
+	u64 dpa[HPA_MODEL_MAX_SAMPLES];
+	int nr;
+	int next;
+	bool valid;
+	u64 gran;
+	unsigned int ways;
+	unsigned int position;
+	u64 skew;
+	u64 hpa_min;
+	u64 hpa_max;
+};
+
+void hpa_model_reset(struct hpa_model *m);
+void hpa_model_add(struct hpa_model *m, u64 hpa, u64 dpa);
+bool hpa_model_lookup(const struct hpa_model *m, u64 hpa, u64 *dpa);
+
+#endif /* _LIBCXL_HPA_MODEL_H_ */
@@ -8,10 +8,14 @@
 */
 #include <stdio.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <glob.h>
 #include <limits.h>
 #include <libgen.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <dirent.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -29,9 +33,13 @@
 #include <util/log.h>
 #include <util/sysfs.h>
 #include <util/bitmap.h>
+#include <util/fletcher.h>
+#include <util/time.h>
+#include <util/io.h>
 #include <cxl/cxl_mem.h>
 #include <cxl/libcxl.h>
 #include "private.h"
+#include "hpa-model.h"
 
 const char *DEVICE_ERRORS[23] = {
 	"Success: The command completed successfully.",
@@ -332,6 +340,11 @@ struct cxl_ctx {
 	struct list_head memdevs;
 	struct kmod_ctx *kmod_ctx;
 	void *private_data;
+	/* memdevs indexed by id, for duplicate checks and lookup by name */
+	struct cxl_memdev **memdev_index;
+	int memdev_index_len;
+	/* suppress the success message of commands without output */
+	bool quiet;
 };
 
 static void free_memdev(struct cxl_memdev *memdev, struct list_head *head)
@@ -339,6 +352,9 @@ static void free_memdev(struct cxl_memdev *memdev, struct list_head *head)
 	if (head)
 		list_del_from(head, &memdev->list);
 	kmod_module_unref(memdev->module);
+	if (memdev->fd >= 0)
+		close(memdev->fd);
+	free(memdev->query);
 	free(memdev->firmware_version);
 	free(memdev->dev_buf);
 	free(memdev->dev_path);
@@ -416,32 +432,42 @@ CXL_EXPORT void *cxl_get_private_data(struct cxl_ctx *ctx)
  */
 CXL_EXPORT int cxl_new(struct cxl_ctx **ctx)
 {
-	struct kmod_ctx *kmod_ctx;
 	struct cxl_ctx *c;
-	int rc = 0;
 
 	c = calloc(1, sizeof(struct cxl_ctx));
 	if (!c)
 		return -ENOMEM;
 
-	kmod_ctx = kmod_new(NULL, NULL);
-	if (check_kmod(kmod_ctx) != 0) {
-		rc = -ENXIO;
-		goto out;
-	}
-
+	/*
+	 * No kmod context here: loading the module index costs more than
+	 * most commands, and nothing on the mailbox path needs it. Module
+	 * lookups create it through cxl_kmod_ctx() when they need it.
+	 */
 	c->refcount = 1;
 	log_init(&c->ctx, "libcxl", "CXL_LOG");
 	info(c, "ctx %p created\n", c);
 	dbg(c, "log_priority=%d\n", c->ctx.log_priority);
 	*ctx = c;
 	list_head_init(&c->memdevs);
-	c->kmod_ctx = kmod_ctx;
 
 	return 0;
-out:
-	free(c);
-	return rc;
+}
+
+static struct kmod_ctx *cxl_kmod_ctx(struct cxl_ctx *ctx)
+{
+	struct kmod_ctx *kmod_ctx;
+
+	kmod_ctx = __atomic_load_n(&ctx->kmod_ctx, __ATOMIC_ACQUIRE);
+	if (kmod_ctx)
+		return kmod_ctx;
+	kmod_ctx = kmod_new(NULL, NULL);
+	if (check_kmod(kmod_ctx) != 0) {
+		err(ctx, "failed to initialize kmod context\n");
+		return NULL;
+	}
+	if (!__sync_bool_compare_and_swap(&ctx->kmod_ctx, NULL, kmod_ctx))
+		kmod_unref(kmod_ctx);
+	return ctx->kmod_ctx;
 }
 
 /**
@@ -476,7 +502,9 @@ CXL_EXPORT void cxl_unref(struct cxl_ctx *ctx)
 	list_for_each_safe(&ctx->memdevs, memdev, _d, list)
 		free_memdev(memdev, &ctx->memdevs);
 
-	kmod_unref(ctx->kmod_ctx);
+	if (ctx->kmod_ctx)
+		kmod_unref(ctx->kmod_ctx);
+	free(ctx->memdev_index);
 	info(ctx, "context %p released\n", ctx);
 	free(ctx);
 }
@@ -519,13 +547,68 @@ CXL_EXPORT void cxl_set_log_priority(struct cxl_ctx *ctx, int priority)
 	ctx->ctx.log_priority = priority;
 }
 
+/**
+ * cxl_set_quiet - stop commands that return no data from confirming success
+ * @quiet: true to drop the "command completed successfully" message and
+ *	   the echo of the values the threshold setters send
+ *
+ * For callers that issue such commands as steps of a larger operation and
+ * report the outcome themselves.
+ */
+CXL_EXPORT void cxl_set_quiet(struct cxl_ctx *ctx, bool quiet)
+{
+	ctx->quiet = quiet;
+}
+
+/**
+ * cxl_get_quiet - retrieve the current cxl_set_quiet() setting
+ * @ctx: cxl library context
+ */
+CXL_EXPORT bool cxl_get_quiet(struct cxl_ctx *ctx)
+{
+	return ctx->quiet;
+}
+
+static void cxl_cmd_done(struct cxl_memdev *memdev)
+{
+	if (!memdev->ctx->quiet)
+		fprintf(stdout, "command completed successfully\n");
+}
+
+static struct cxl_memdev *memdev_index_find(struct cxl_ctx *ctx, int id)
+{
+	if (id < 0 || id >= ctx->memdev_index_len)
+		return NULL;
+	return ctx->memdev_index[id];
+}
+
+static int memdev_index_add(struct cxl_ctx *ctx, struct cxl_memdev *memdev)
+{
+	struct cxl_memdev **index;
+	int len;
+
+	if (memdev->id < 0)
+		return -EINVAL;
+	if (memdev->id >= ctx->memdev_index_len) {
+		len = max(memdev->id + 1, ctx->memdev_index_len * 2);
+		index = realloc(ctx->memdev_index, len * sizeof(*index));
+		if (!index)
+			return -ENOMEM;
+		memset(index + ctx->memdev_index_len, 0,
+			(len - ctx->memdev_index_len) * sizeof(*index));
+		ctx->memdev_index = index;
+		ctx->memdev_index_len = len;
+	}
+	ctx->memdev_index[memdev->id] = memdev;
+	return 0;
+}
+
 static void *add_cxl_memdev(void *parent, int id, const char *cxlmem_base)
 {
 	const char *devname = devpath_to_devname(cxlmem_base);
 	char *path = calloc(1, strlen(cxlmem_base) + 100);
 	struct cxl_ctx *ctx = parent;
 	struct cxl_memdev *memdev, *memdev_dup;
-	char buf[SYSFS_ATTR_SIZE];
 	struct stat st;
 
 	if (!path)
@@ -537,6 +620,7 @@ static void *add_cxl_memdev(void *parent, int id, const char *cxlmem_base)
 		goto err_dev;
 	memdev->id = id;
 	memdev->ctx = ctx;
+	memdev->fd = -1;
 
 	sprintf(path, "/dev/cxl/%s", devname);
 	if (stat(path, &st) < 0)
@@ -544,53 +628,23 @@ static void *add_cxl_memdev(void *parent, int id, const char *cxlmem_base)
 	memdev->major = major(st.st_rdev);
 	memdev->minor = minor(st.st_rdev);
 
-	sprintf(path, "%s/pmem/size", cxlmem_base);
-	if (sysfs_read_attr(ctx, path, buf) < 0)
-		goto err_read;
-	memdev->pmem_size = strtoull(buf, NULL, 0);
-
-	sprintf(path, "%s/ram/size", cxlmem_base);
-	if (sysfs_read_attr(ctx, path, buf) < 0)
-		goto err_read;
-	memdev->ram_size = strtoull(buf, NULL, 0);
-
-	sprintf(path, "%s/payload_max", cxlmem_base);
-	if (sysfs_read_attr(ctx, path, buf) < 0)
-		goto err_read;
-	memdev->payload_max = strtoull(buf, NULL, 0);
-	if (memdev->payload_max < 0)
-		goto err_read;
-
-	sprintf(path, "%s/label_storage_size", cxlmem_base);
-	if (sysfs_read_attr(ctx, path, buf) < 0)
-		goto err_read;
-	memdev->lsa_size = strtoull(buf, NULL, 0);
-	if (memdev->lsa_size == ULLONG_MAX)
-		goto err_read;
-
 	memdev->dev_path = strdup(cxlmem_base);
 	if (!memdev->dev_path)
 		goto err_read;
 
-	sprintf(path, "%s/firmware_version", cxlmem_base);
-	if (sysfs_read_attr(ctx, path, buf) < 0)
-		goto err_read;
-
-	memdev->firmware_version = strdup(buf);
-	if (!memdev->firmware_version)
-		goto err_read;
-
 	memdev->dev_buf = calloc(1, strlen(cxlmem_base) + 50);
 	if (!memdev->dev_buf)
 		goto err_read;
 	memdev->buf_len = strlen(cxlmem_base) + 50;
 
-	cxl_memdev_foreach(ctx, memdev_dup)
-		if (memdev_dup->id == memdev->id) {
-			free_memdev(memdev, NULL);
-			free(path);
-			return memdev_dup;
-		}
+	memdev_dup = memdev_index_find(ctx, id);
+	if (memdev_dup) {
+		free_memdev(memdev, NULL);
+		free(path);
+		return memdev_dup;
+	}
+	if (memdev_index_add(ctx, memdev) < 0)
+		goto err_read;
 
 	list_add(&ctx->memdevs, &memdev->list);
 	free(path);
@@ -622,6 +676,40 @@ CXL_EXPORT struct cxl_ctx *cxl_memdev_get_ctx(struct cxl_memdev *memdev)
 	return memdev->ctx;
 }
 
+/*
+ * Look up one memdev, e.g. "mem7", loading only that device instead of
+ * enumerating the bus. Full enumeration later reuses the same object.
+ */
+CXL_EXPORT struct cxl_memdev *cxl_memdev_get_by_name(struct cxl_ctx *ctx,
+		const char *name)
+{
+	struct cxl_memdev *memdev;
+	unsigned long id;
+	char *path, *end;
+
+	/* only the canonical "mem<id>", no sign, suffix or leading zeros */
+	if (strncmp(name, "mem", 3) != 0 || !isdigit((unsigned char)name[3]) ||
+	    (name[3] == '0' && name[4]))
+		return NULL;
+	errno = 0;
+	id = strtoul(name + 3, &end, 10);
+	if (errno || *end || id > INT_MAX)
+		return NULL;
+
+	memdev = memdev_index_find(ctx, id);
+	if (memdev || ctx->memdevs_init)
+		return memdev;
+
+	if (asprintf(&path, "/sys/bus/cxl/devices/mem%lu", id) < 0)
+		return NULL;
+	if (access(path, F_OK) == 0)
+		memdev = add_cxl_memdev(ctx, id, path);
+	else
+		dbg(ctx, "%s: not found\n", name);
+	free(path);
+	return memdev;
+}
+
 CXL_EXPORT struct cxl_memdev *cxl_memdev_get_first(struct cxl_ctx *ctx)
 {
 	cxl_memdevs_init(ctx);
@@ -656,23 +744,308 @@ CXL_EXPORT int cxl_memdev_get_minor(struct cxl_memdev *memdev)
 	return memdev->minor;
 }
 
+/*
+ * Memdev attributes are read from sysfs on first use rather than at
+ * enumeration, so naming one device on a large host does not pay for
+ * every other one. Concurrent first readers store the same value, the
+ * firmware version string is published once. A failed read is reported
+ * to the caller and retried on the next call, it is never cached.
+ */
+#define MEMDEV_LOADED_PMEM_SIZE		(1 << 0)
+#define MEMDEV_LOADED_RAM_SIZE		(1 << 1)
+#define MEMDEV_LOADED_SERIAL		(1 << 2)
+#define MEMDEV_LOADED_PAYLOAD_MAX	(1 << 3)
+#define MEMDEV_LOADED_LSA_SIZE		(1 << 4)
+
+static int memdev_read_attr(struct cxl_memdev *memdev, const char *attr,
+		char *buf)
+{
+	char path[PATH_MAX];
+
+	if (snprintf(path, sizeof(path), "%s/%s", memdev->dev_path, attr) >=
+			(int)sizeof(path))
+		return -ENAMETOOLONG;
+	return sysfs_read_attr(memdev->ctx, path, buf);
+}
+
+static int memdev_read_ull(struct cxl_memdev *memdev, const char *attr,
+		unsigned long long *val)
+{
+	char buf[SYSFS_ATTR_SIZE];
+	char *end;
+	int rc;
+
+	rc = memdev_read_attr(memdev, attr, buf);
+	if (rc < 0) {
+		err(memdev->ctx, "%s: failed to read %s: %s\n",
+			cxl_memdev_get_devname(memdev), attr, strerror(-rc));
+		return rc;
+	}
+	errno = 0;
+	*val = strtoull(buf, &end, 0);
+	if (end == buf || errno || *val == ULLONG_MAX) {
+		err(memdev->ctx, "%s: invalid %s: '%s'\n",
+			cxl_memdev_get_devname(memdev), attr, buf);
+		return -EINVAL;
+	}
+	return 0;
+}
+
+static bool memdev_loaded(struct cxl_memdev *memdev, unsigned int bit)
+{
+	return __atomic_load_n(&memdev->loaded, __ATOMIC_ACQUIRE) & bit;
+}
+
+static void memdev_set_loaded(struct cxl_memdev *memdev, unsigned int bit)
+{
+	__atomic_fetch_or(&memdev->loaded, bit, __ATOMIC_RELEASE);
+}
+
+/* ULLONG_MAX with errno set when the attribute cannot be read */
 CXL_EXPORT unsigned long long cxl_memdev_get_pmem_size(struct cxl_memdev *memdev)
 {
+	unsigned long long val;
+	int rc;
+
+	if (!memdev_loaded(memdev, MEMDEV_LOADED_PMEM_SIZE)) {
+		rc = memdev_read_ull(memdev, "pmem/size", &val);
+		if (rc < 0) {
+			errno = -rc;
+			return ULLONG_MAX;
+		}
+		memdev->pmem_size = val;
+		memdev_set_loaded(memdev, MEMDEV_LOADED_PMEM_SIZE);
+	}
 	return memdev->pmem_size;
 }
 
+/* ULLONG_MAX with errno set when the attribute cannot be read */
 CXL_EXPORT unsigned long long cxl_memdev_get_ram_size(struct cxl_memdev *memdev)
 {
+	unsigned long long val;
+	int rc;
+
+	if (!memdev_loaded(memdev, MEMDEV_LOADED_RAM_SIZE)) {
+		rc = memdev_read_ull(memdev, "ram/size", &val);
+		if (rc < 0) {
+			errno = -rc;
+			return ULLONG_MAX;
+		}
+		memdev->ram_size = val;
+		memdev_set_loaded(memdev, MEMDEV_LOADED_RAM_SIZE);
+	}
 	return memdev->ram_size;
 }
 
+/*
+ * Older kernels do not expose the device serial number, so a missing
+ * attribute is not an error: it reads as ULLONG_MAX.
+ */
+CXL_EXPORT unsigned long long cxl_memdev_get_serial(struct cxl_memdev *memdev)
+{
+	char buf[SYSFS_ATTR_SIZE];
+
+	if (!memdev_loaded(memdev, MEMDEV_LOADED_SERIAL)) {
+		if (memdev_read_attr(memdev, "serial", buf) < 0)
+			memdev->serial = ULLONG_MAX;
+		else
+			memdev->serial = strtoull(buf, NULL, 0);
+		memdev_set_loaded(memdev, MEMDEV_LOADED_SERIAL);
+	}
+	return memdev->serial;
+}
+
+/* negative error code when the attribute cannot be read */
+static int memdev_payload_max(struct cxl_memdev *memdev)
+{
+	unsigned long long val;
+	int rc;
+
+	if (!memdev_loaded(memdev, MEMDEV_LOADED_PAYLOAD_MAX)) {
+		rc = memdev_read_ull(memdev, "payload_max", &val);
+		if (rc < 0)
+			return rc;
+		if (val > INT_MAX) {
+			err(memdev->ctx, "%s: invalid payload_max\n",
+				cxl_memdev_get_devname(memdev));
+			return -EINVAL;
+		}
+		memdev->payload_max = val;
+		memdev_set_loaded(memdev, MEMDEV_LOADED_PAYLOAD_MAX);
+	}
+	return memdev->payload_max;
+}
+
+/* NULL with errno set when the attribute cannot be read */
 CXL_EXPORT const char *cxl_memdev_get_firmware_verison(struct cxl_memdev *memdev)
 {
+	char buf[SYSFS_ATTR_SIZE];
+	char *fw;
+	int rc;
+
+	fw = __atomic_load_n(&memdev->firmware_version, __ATOMIC_ACQUIRE);
+	if (fw)
+		return fw;
+	rc = memdev_read_attr(memdev, "firmware_version", buf);
+	if (rc < 0) {
+		err(memdev->ctx, "%s: failed to read firmware_version: %s\n",
+			cxl_memdev_get_devname(memdev), strerror(-rc));
+		errno = -rc;
+		return NULL;
+	}
+	fw = strdup(buf);
+	if (fw && !__sync_bool_compare_and_swap(&memdev->firmware_version,
+				NULL, fw))
+		free(fw);
 	return memdev->firmware_version;
 }
 
+CXL_EXPORT int cxl_memdev_get_payload_max(struct cxl_memdev *memdev)
+{
+	return memdev_payload_max(memdev);
+}
+
+static struct kmod_module *to_module(struct cxl_ctx *ctx, const char *alias)
+{
+	struct kmod_ctx *kmod_ctx = cxl_kmod_ctx(ctx);
+	struct kmod_list *list = NULL;
+	struct kmod_module *mod;
+	int rc;
+
+	if (!kmod_ctx)
+		return NULL;
+
+	rc = kmod_module_new_from_lookup(kmod_ctx, alias, &list);
+	if (rc < 0 || !list) {
+		dbg(ctx, "failed to find module for alias: %s %d list: %s\n",
+				alias, rc, list ? "populated" : "empty");
+		return NULL;
+	}
+	mod = kmod_module_get_module(list);
+	dbg(ctx, "alias: %s module: %s\n", alias, kmod_module_get_name(mod));
+	kmod_module_unref_list(list);
+
+	return mod;
+}
+
+/* the driver module is resolved from the memdev modalias on first use */
+CXL_EXPORT const char *cxl_memdev_get_module_name(struct cxl_memdev *memdev)
+{
+	char buf[SYSFS_ATTR_SIZE];
+	struct kmod_module *mod;
+
+	mod = __atomic_load_n(&memdev->module, __ATOMIC_ACQUIRE);
+	if (!mod) {
+		if (memdev_read_attr(memdev, "modalias", buf) < 0)
+			return NULL;
+		mod = to_module(memdev->ctx, buf);
+		if (!mod)
+			return NULL;
+		if (!__sync_bool_compare_and_swap(&memdev->module, NULL, mod)) {
+			kmod_module_unref(mod);
+			mod = memdev->module;
+		}
+	}
+	return kmod_module_get_name(mod);
+}
+
+/*
+ * The attributes below live on the PCI device that hosts the memdev, i.e.
+ * the physical parent of /sys/bus/cxl/devices/memN. They can change at
+ * runtime (link retrain, hotplug), so they are read on every call.
+ */
+static int memdev_read_parent_int(struct cxl_memdev *memdev, const char *attr)
+{
+	char buf[SYSFS_ATTR_SIZE], name[64];
+	char *end;
+	long val;
+
+	snprintf(name, sizeof(name), "../%s", attr);
+	if (memdev_read_attr(memdev, name, buf) < 0)
+		return -1;
+	val = strtol(buf, &end, 0);
+	if (end == buf || val < INT_MIN || val > INT_MAX)
+		return -1;
+	return val;
+}
+
+/* -1 when the platform does not report an affinity for the device */
+CXL_EXPORT int cxl_memdev_get_numa_node(struct cxl_memdev *memdev)
+{
+	return memdev_read_parent_int(memdev, "numa_node");
+}
+
+CXL_EXPORT int cxl_memdev_get_link_width(struct cxl_memdev *memdev)
+{
+	return memdev_read_parent_int(memdev, "current_link_width");
+}
+
+/* in MT/s, parsed from e.g. "32.0 GT/s PCIe"; -1 when unknown */
+CXL_EXPORT int cxl_memdev_get_link_speed(struct cxl_memdev *memdev)
+{
+	char buf[SYSFS_ATTR_SIZE];
+	char *end;
+	double gts;
+
+	if (memdev_read_attr(memdev, "../current_link_speed", buf) < 0)
+		return -1;
+	gts = strtod(buf, &end);
+	if (end == buf || gts <= 0)
+		return -1;
+	return gts * 1000 + 0.5;
+}
+
+/*
+ * A region's targetN attributes name the endpoint decoders it interleaves
+ * across, and an endpoint decoder sits below the memdev that owns it, so
+ * resolving each decoder tells whether @memdev backs @region.
+ */
+CXL_EXPORT bool cxl_memdev_in_region(struct cxl_memdev *memdev,
+		const char *region)
+{
+	const char *devname = cxl_memdev_get_devname(memdev);
+	char path[PATH_MAX], buf[SYSFS_ATTR_SIZE], *real;
+	char match[64];
+	bool found = false;
+	int i;
+
+	snprintf(match, sizeof(match), "/%s/", devname);
+	for (i = 0; !found; i++) {
+		snprintf(path, sizeof(path), "/sys/bus/cxl/devices/%s/target%d",
+			region, i);
+		if (access(path, F_OK) != 0)
+			break;
+		if (sysfs_read_attr(memdev->ctx, path, buf) < 0 || !buf[0])
+			continue;
+		snprintf(path, sizeof(path), "/sys/bus/cxl/devices/%s", buf);
+		real = realpath(path, NULL);
+		if (!real)
+			continue;
+		found = strstr(real, match) != NULL;
+		free(real);
+	}
+	return found;
+}
+
+/*
+ * Zero when the device has no label storage area. An unreadable
+ * attribute also returns zero, with errno set, so that no caller sizes
+ * a transfer from it.
+ */
 CXL_EXPORT size_t cxl_memdev_get_lsa_size(struct cxl_memdev *memdev)
 {
+	unsigned long long val;
+	int rc;
+
+	if (!memdev_loaded(memdev, MEMDEV_LOADED_LSA_SIZE)) {
+		rc = memdev_read_ull(memdev, "label_storage_size", &val);
+		if (rc < 0 || val > SIZE_MAX) {
+			errno = rc < 0 ? -rc : EINVAL;
+			return 0;
+		}
+		memdev->lsa_size = val;
+		memdev_set_loaded(memdev, MEMDEV_LOADED_LSA_SIZE);
+	}
 	return memdev->lsa_size;
 }
 
@@ -767,40 +1140,50 @@ static int __do_cmd(struct cxl_cmd *cmd, int ioctl_cmd, int fd)
 	return rc;
 }
 
-static int do_cmd(struct cxl_cmd *cmd, int ioctl_cmd)
+static int memdev_open_fd(struct cxl_memdev *memdev)
 {
-	char *path;
-	struct stat st;
-	unsigned int major, minor;
-	int rc = 0, fd;
-	struct cxl_memdev *memdev = cmd->memdev;
 	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
 	const char *devname = cxl_memdev_get_devname(memdev);
-
-	major = cxl_memdev_get_major(memdev);
-	minor = cxl_memdev_get_minor(memdev);
+	struct stat st;
+	char *path;
+	int fd;
 
 	if (asprintf(&path, "/dev/cxl/%s", devname) < 0)
 		return -ENOMEM;
 
-	fd = open(path, O_RDWR);
+	fd = open(path, O_RDWR | O_CLOEXEC);
 	if (fd < 0) {
 		err(ctx, "failed to open %s: %s\n", path, strerror(errno));
-		rc = -errno;
+		fd = -errno;
 		goto out;
 	}
 
-	if (fstat(fd, &st) >= 0 && S_ISCHR(st.st_mode)
-			&& major(st.st_rdev) == major
-			&& minor(st.st_rdev) == minor) {
-		rc = __do_cmd(cmd, ioctl_cmd, fd);
-	} else {
+	if (fstat(fd, &st) < 0 || !S_ISCHR(st.st_mode)
+			|| major(st.st_rdev) != (unsigned int)memdev->major
+			|| minor(st.st_rdev) != (unsigned int)memdev->minor) {
 		err(ctx, "failed to validate %s as a CXL memdev node\n", path);
-		rc = -ENXIO;
+		close(fd);
+		fd = -ENXIO;
 	}
-	close(fd);
 out:
 	free(path);
+	return fd;
+}
+
+/* use the fd kept by cxl_memdev_open(), else open one for this command */
+static int do_cmd(struct cxl_cmd *cmd, int ioctl_cmd)
+{
+	struct cxl_memdev *memdev = cmd->memdev;
+	int rc, fd;
+
+	if (memdev->fd >= 0)
+		return __do_cmd(cmd, ioctl_cmd, memdev->fd);
+
+	fd = memdev_open_fd(memdev);
+	if (fd < 0)
+		return fd;
+	rc = __do_cmd(cmd, ioctl_cmd, fd);
+	close(fd);
 	return rc;
 }
 
@@ -826,7 +1209,9 @@ static int cxl_cmd_do_query(struct cxl_cmd *cmd)
 	struct cxl_memdev *memdev = cmd->memdev;
 	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
 	const char *devname = cxl_memdev_get_devname(memdev);
+	struct cxl_mem_query_commands *query;
 	int rc, n_commands;
+	size_t size;
 
 	switch (cmd->query_status) {
 	case CXL_CMD_QUERY_OK:
@@ -841,6 +1226,20 @@ static int cxl_cmd_do_query(struct cxl_cmd *cmd)
 		return -EINVAL;
 	}
 
+	/*
+	 * Callers patch sizes in their copy of the command table, so every
+	 * cmd gets a private copy of the cached one.
+	 */
+	query = memdev->query;
+	if (query) {
+		size = sizeof(*query) + query->n_commands * sizeof(query->commands[0]);
+		cmd->query_cmd = malloc(size);
+		if (!cmd->query_cmd)
+			return -ENOMEM;
+		memcpy(cmd->query_cmd, query, size);
+		return 0;
+	}
+
 	rc = alloc_do_query(cmd, 0);
 	if (rc)
 		return rc;
@@ -848,7 +1247,50 @@ static int cxl_cmd_do_query(struct cxl_cmd *cmd)
 	n_commands = cmd->query_cmd->n_commands;
 	dbg(ctx, "%s: supports %d commands\n", devname, n_commands);
 
-	return alloc_do_query(cmd, n_commands);
+	rc = alloc_do_query(cmd, n_commands);
+	if (rc || memdev->fd < 0)
+		return rc;
+
+	/* an opened memdev keeps the table for its later commands */
+	size = sizeof(*query) + n_commands * sizeof(query->commands[0]);
+	query = malloc(size);
+	if (query) {
+		memcpy(query, cmd->query_cmd, size);
+		if (!__sync_bool_compare_and_swap(&memdev->query, NULL, query))
+			free(query);
+	}
+	return 0;
+}
+
+/**
+ * cxl_memdev_open - keep the memdev's char device and command table open
+ * @memdev: memdev to open
+ *
+ * By default every command opens and closes the char device and queries
+ * the command table anew. Long-running callers that issue many commands
+ * can open the memdev once; the fd and table are then kept until the ctx
+ * is freed. Safe to call concurrently: the first opener publishes its fd
+ * and any racing opener closes its own.
+ */
+CXL_EXPORT int cxl_memdev_open(struct cxl_memdev *memdev)
+{
+	struct cxl_cmd *cmd;
+	int rc, fd;
+
+	if (memdev->fd < 0) {
+		fd = memdev_open_fd(memdev);
+		if (fd < 0)
+			return fd;
+		if (!__sync_bool_compare_and_swap(&memdev->fd, -1, fd))
+			close(fd);
+	}
+
+	cmd = cxl_cmd_new(memdev);
+	if (!cmd)
+		return -ENOMEM;
+	rc = cxl_cmd_do_query(cmd);
+	cxl_cmd_unref(cmd);
+	return rc;
 }
 
 static int cxl_cmd_validate(struct cxl_cmd *cmd, u32 cmd_id)
@@ -882,8 +1324,11 @@ CXL_EXPORT int cxl_cmd_set_input_payload(struct cxl_cmd *cmd, void *buf,
 		int size)
 {
 	struct cxl_memdev *memdev = cmd->memdev;
+	int payload_max = memdev_payload_max(memdev);
 
-	if (size > memdev->payload_max || size < 0)
+	if (payload_max < 0)
+		return payload_max;
+	if (size > payload_max || size < 0)
 		return -EINVAL;
 
 	if (!buf) {
@@ -910,8 +1355,11 @@ CXL_EXPORT int cxl_cmd_set_output_payload(struct cxl_cmd *cmd, void *buf,
 		int size)
 {
 	struct cxl_memdev *memdev = cmd->memdev;
+	int payload_max = memdev_payload_max(memdev);
 
-	if (size > memdev->payload_max || size < 0)
+	if (payload_max < 0)
+		return payload_max;
+	if (size > payload_max || size < 0)
 		return -EINVAL;
 
 	if (!buf) {
@@ -939,6 +1387,7 @@ static int cxl_cmd_alloc_send(struct cxl_cmd *cmd, u32 cmd_id)
 	struct cxl_mem_query_commands *query = cmd->query_cmd;
 	struct cxl_command_info *cinfo = &query->commands[cmd->query_idx];
 	size_t size;
+	int rc;
 
 	if (!query)
 		return -EINVAL;
@@ -961,8 +1410,12 @@ static int cxl_cmd_alloc_send(struct cxl_cmd *cmd, u32 cmd_id)
 		cmd->send_cmd->in.size = cinfo->size_in;
 	}
 
-	if (cinfo->size_out < 0)
-		cinfo->size_out = cmd->memdev->payload_max; // -1 will require update
+	if (cinfo->size_out < 0) {
+		rc = memdev_payload_max(cmd->memdev); // -1 will require update
+		if (rc < 0)
+			return rc;
+		cinfo->size_out = rc;
+	}
 
 	if (cinfo->size_out > 0) {
 		cmd->output_payload = calloc(1, cinfo->size_out);
@@ -1204,147 +1657,527 @@ CXL_EXPORT int cxl_cmd_submit(struct cxl_cmd *cmd)
 	dbg(ctx, "%s: got SEND cmd: in: %d, out: %d, retval: %d\n", devname,
 		cmd->send_cmd->in.size, cmd->send_cmd->out.size, cmd->status);
 
-	return rc;
+	return rc;
+}
+
+/*
+ * Bulk helpers reuse one raw command across many mailbox calls: switch the
+ * opcode and input size, restore the output size the kernel shrank on the
+ * previous call, submit and fold the mailbox status into the return code.
+ */
+static int cxl_cmd_raw_resubmit(struct cxl_cmd *cmd, int opcode, int size_in)
+{
+	struct cxl_memdev *memdev = cmd->memdev;
+	struct cxl_command_info *cinfo =
+		&cmd->query_cmd->commands[cmd->query_idx];
+	int rc;
+
+	cmd->send_cmd->raw.opcode = opcode;
+	cmd->send_cmd->in.size = size_in;
+	cmd->send_cmd->out.size = cinfo->size_out;
+
+	rc = cxl_cmd_submit(cmd);
+	if (rc < 0) {
+		fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
+				cxl_memdev_get_devname(memdev), rc, strerror(-rc));
+		return rc;
+	}
+
+	rc = cxl_cmd_get_mbox_status(cmd);
+	if (rc != 0) {
+		fprintf(stderr, "%s: firmware status: %d:\n%s\n",
+				cxl_memdev_get_devname(memdev), rc, DEVICE_ERRORS[rc]);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+CXL_EXPORT int cxl_cmd_get_mbox_status(struct cxl_cmd *cmd)
+{
+	return cmd->status;
+}
+
+CXL_EXPORT int cxl_cmd_get_out_size(struct cxl_cmd *cmd)
+{
+	return cmd->send_cmd->out.size;
+}
+
+CXL_EXPORT struct cxl_cmd *cxl_cmd_new_set_lsa(struct cxl_memdev *memdev,
+		void *lsa_buf, unsigned int offset, unsigned int length)
+{
+	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
+	struct cxl_cmd_set_lsa *set_lsa;
+	struct cxl_cmd *cmd;
+	int rc;
+
+	cmd = cxl_cmd_new_generic(memdev, CXL_MEM_COMMAND_ID_SET_LSA);
+	if (!cmd)
+		return NULL;
+
+	/* this will allocate 'in.payload' */
+	rc = cxl_cmd_set_input_payload(cmd, NULL, sizeof(*set_lsa) + length);
+	if (rc) {
+		err(ctx, "%s: cmd setup failed: %s\n",
+			cxl_memdev_get_devname(memdev), strerror(-rc));
+		goto out_fail;
+	}
+	set_lsa = (void *)cmd->send_cmd->in.payload;
+	set_lsa->offset = cpu_to_le32(offset);
+	memcpy(set_lsa->lsa_data, lsa_buf, length);
+
+	return cmd;
+
+out_fail:
+	cxl_cmd_unref(cmd);
+	return NULL;
+}
+
+enum lsa_op {
+	LSA_OP_GET,
+	LSA_OP_SET,
+	LSA_OP_ZERO,
+};
+
+static int lsa_submit(struct cxl_cmd *cmd)
+{
+	struct cxl_memdev *memdev = cmd->memdev;
+	const char *devname = cxl_memdev_get_devname(memdev);
+	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
+	int rc;
+
+	rc = cxl_cmd_submit(cmd);
+	if (rc < 0) {
+		err(ctx, "%s: cmd submission failed: %s\n",
+			devname, strerror(-rc));
+		return rc;
+	}
+
+	rc = cxl_cmd_get_mbox_status(cmd);
+	if (rc != 0) {
+		err(ctx, "%s: firmware status: %d:\n%s\n",
+			devname, rc, DEVICE_ERRORS[rc]);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+/* read @length bytes at @offset into @buf with a GET_LSA @cmd */
+static int lsa_get_chunk(struct cxl_cmd *cmd, void *buf, size_t length,
+		size_t offset)
+{
+	struct cxl_cmd_get_lsa_in *get_lsa = (void *)cmd->send_cmd->in.payload;
+	int rc;
+
+	get_lsa->offset = cpu_to_le32(offset);
+	get_lsa->length = cpu_to_le32(length);
+	rc = cxl_cmd_set_output_payload(cmd, buf, length);
+	if (rc)
+		return rc;
+	rc = lsa_submit(cmd);
+	if (rc)
+		return rc;
+	if ((size_t)cxl_cmd_get_out_size(cmd) != length)
+		return -EIO;
+	return 0;
+}
+
+/*
+ * Transfer the label area in payload_max sized pieces on one reused
+ * command. GET_LSA reads land directly in the caller's buffer, SET_LSA
+ * copies each piece into the command's input payload, and zeroing just
+ * resubmits a zero-filled payload at advancing offsets, so nothing is
+ * allocated in proportion to the label area. With CXL_LSA_VERIFY every
+ * piece is read back on a second command and compared.
+ *
+ * A @length of 0 covers @offset to the end of the label area.
+ *
+ * Nothing needs refreshing in the kernel after a write: while a kernel
+ * driver (cxl_pmem) consumes the labels, the kernel claims SET_LSA for
+ * itself and rejects it from userspace with -EBUSY, so a write that
+ * succeeds here has no cached copy to go stale.
+ */
+static int lsa_op(struct cxl_memdev *memdev, int op, void *buf,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats)
+{
+	const char *devname = cxl_memdev_get_devname(memdev);
+	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
+	size_t lsa_size = cxl_memdev_get_lsa_size(memdev);
+	int payload_max = memdev_payload_max(memdev);
+	struct cxl_lsa_stats st = { 0 };
+	struct cxl_cmd *cmd, *vcmd = NULL;
+	struct cxl_cmd_set_lsa *set_lsa;
+	size_t chunk, done, n;
+	u8 *vbuf = NULL;
+	u64 t0;
+	int rc = 0;
+
+	if (op != LSA_OP_ZERO && buf == NULL) {
+		err(ctx, "%s: LSA buffer cannot be NULL\n", devname);
+		return -EINVAL;
+	}
+
+	if (length == 0 && !lsa_size) {
+		err(ctx, "%s: no label storage area\n", devname);
+		return -ENXIO;
+	}
+	if (length == 0) {
+		if (offset >= lsa_size) {
+			err(ctx, "%s: offset %zu is beyond the LSA size %zu\n",
+				devname, offset, lsa_size);
+			return -EINVAL;
+		}
+		length = lsa_size - offset;
+	}
+	if (lsa_size && offset + length > lsa_size) {
+		err(ctx, "%s: %zu bytes at offset %zu exceed the LSA size %zu\n",
+			devname, length, offset, lsa_size);
+		return -EINVAL;
+	}
+	if (payload_max < 0)
+		return payload_max;
+	if (payload_max <= (int)sizeof(*set_lsa))
+		return -EINVAL;
+
+	chunk = payload_max;
+	if (op != LSA_OP_GET)
+		chunk -= sizeof(*set_lsa);
+	chunk = min(chunk, length);
+	if (!chunk)
+		return 0;
+
+	switch (op) {
+	case LSA_OP_GET:
+		cmd = cxl_cmd_new_get_lsa(memdev, offset, chunk);
+		if (!cmd)
+			return -ENOMEM;
+		break;
+	case LSA_OP_ZERO:
+	case LSA_OP_SET:
+		cmd = cxl_cmd_new_generic(memdev, CXL_MEM_COMMAND_ID_SET_LSA);
+		if (!cmd)
+			return -ENOMEM;
+		/* zero-filled, and stays that way for LSA_OP_ZERO */
+		rc = cxl_cmd_set_input_payload(cmd, NULL,
+				sizeof(*set_lsa) + chunk);
+		if (rc) {
+			err(ctx, "%s: cmd setup failed: %s\n",
+				devname, strerror(-rc));
+			goto out;
+		}
+		break;
+	default:
+		return -EOPNOTSUPP;
+	}
+
+	if (flags & CXL_LSA_VERIFY) {
+		vcmd = cxl_cmd_new_get_lsa(memdev, offset, chunk);
+		vbuf = malloc(chunk);
+		if (!vcmd || !vbuf) {
+			rc = -ENOMEM;
+			goto out;
+		}
+	}
+
+	t0 = util_clock_ns(CLOCK_MONOTONIC);
+	for (done = 0; done < length; done += n) {
+		n = min(chunk, length - done);
+
+		if (op == LSA_OP_GET) {
+			rc = lsa_get_chunk(cmd, (u8 *)buf + done, n,
+					offset + done);
+		} else {
+			set_lsa = (void *)cmd->send_cmd->in.payload;
+			set_lsa->offset = cpu_to_le32(offset + done);
+			if (op == LSA_OP_SET)
+				memcpy(set_lsa->lsa_data, (u8 *)buf + done, n);
+			cmd->send_cmd->in.size = sizeof(*set_lsa) + n;
+			rc = lsa_submit(cmd);
+		}
+		if (rc) {
+			err(ctx, "%s: LSA transfer failed at offset %zu: %s\n",
+				devname, offset + done, strerror(-rc));
+			goto out;
+		}
+		st.chunks++;
+		st.bytes += n;
+
+		if (!vcmd)
+			continue;
+		rc = lsa_get_chunk(vcmd, vbuf, n, offset + done);
+		if (rc == 0 && (op == LSA_OP_ZERO ?
+				(vbuf[0] || memcmp(vbuf, vbuf + 1, n - 1)) :
+				memcmp(vbuf, (u8 *)buf + done, n)))
+			rc = -EIO;
+		if (rc) {
+			err(ctx, "%s: LSA verify failed at offset %zu: %s\n",
+				devname, offset + done, strerror(-rc));
+			goto out;
+		}
+		st.verified += n;
+	}
+	st.nsecs = util_clock_ns(CLOCK_MONOTONIC) - t0;
+	st.chunk_size = chunk;
+
+out:
+	if (stats)
+		*stats = st;
+	free(vbuf);
+	if (vcmd)
+		cxl_cmd_unref(vcmd);
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_zero_lsa(struct cxl_memdev *memdev)
+{
+	return lsa_op(memdev, LSA_OP_ZERO, NULL, 0, 0, 0, NULL);
+}
+
+CXL_EXPORT int cxl_memdev_set_lsa(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset)
+{
+	return lsa_op(memdev, LSA_OP_SET, buf, length, offset, 0, NULL);
+}
+
+CXL_EXPORT int cxl_memdev_get_lsa(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset)
+{
+	return lsa_op(memdev, LSA_OP_GET, buf, length, offset, 0, NULL);
+}
+
+CXL_EXPORT int cxl_memdev_zero_lsa_ext(struct cxl_memdev *memdev,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats)
+{
+	return lsa_op(memdev, LSA_OP_ZERO, NULL, length, offset, flags, stats);
+}
+
+CXL_EXPORT int cxl_memdev_set_lsa_ext(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats)
+{
+	return lsa_op(memdev, LSA_OP_SET, buf, length, offset, flags, stats);
 }
 
-CXL_EXPORT int cxl_cmd_get_mbox_status(struct cxl_cmd *cmd)
+CXL_EXPORT int cxl_memdev_get_lsa_ext(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats)
 {
-	return cmd->status;
+	return lsa_op(memdev, LSA_OP_GET, buf, length, offset, flags, stats);
 }
 
-CXL_EXPORT int cxl_cmd_get_out_size(struct cxl_cmd *cmd)
+static void lsa_stats_add(struct cxl_lsa_stats *total,
+		const struct cxl_lsa_stats *st)
 {
-	return cmd->send_cmd->out.size;
+	total->bytes += st->bytes;
+	total->verified += st->verified;
+	total->chunks += st->chunks;
+	total->nsecs += st->nsecs;
+	if (st->chunk_size > total->chunk_size)
+		total->chunk_size = st->chunk_size;
 }
 
-CXL_EXPORT struct cxl_cmd *cxl_cmd_new_set_lsa(struct cxl_memdev *memdev,
-		void *lsa_buf, unsigned int offset, unsigned int length)
+/*
+ * Returns NULL with errno set: EINVAL for a slot size that is not a
+ * multiple of 4, ENXIO when @memdev has no label storage area.
+ */
+CXL_EXPORT struct cxl_lsa *cxl_lsa_new(struct cxl_memdev *memdev,
+		size_t slot_size)
 {
 	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
-	struct cxl_cmd_set_lsa *set_lsa;
-	struct cxl_cmd *cmd;
+	size_t size = cxl_memdev_get_lsa_size(memdev);
+	struct cxl_lsa *lsa;
 	int rc;
 
-	cmd = cxl_cmd_new_generic(memdev, CXL_MEM_COMMAND_ID_SET_LSA);
-	if (!cmd)
+	if (!slot_size)
+		slot_size = CXL_LSA_SLOT_SIZE;
+	if (!size) {
+		err(ctx, "%s: no label storage area\n",
+			cxl_memdev_get_devname(memdev));
+		errno = ENXIO;
 		return NULL;
+	}
 
-	/* this will allocate 'in.payload' */
-	rc = cxl_cmd_set_input_payload(cmd, NULL, sizeof(*set_lsa) + length);
+	lsa = calloc(1, sizeof(*lsa));
+	if (!lsa) {
+		errno = ENOMEM;
+		return NULL;
+	}
+	lsa->memdev = memdev;
+	rc = lsa_shadow_init(&lsa->shadow, size, slot_size);
 	if (rc) {
-		err(ctx, "%s: cmd setup failed: %s\n",
-			cxl_memdev_get_devname(memdev), strerror(-rc));
-		goto out_fail;
+		if (rc == -EINVAL)
+			err(ctx, "%s: invalid LSA slot size %zu\n",
+				cxl_memdev_get_devname(memdev), slot_size);
+		free(lsa);
+		errno = -rc;
+		return NULL;
 	}
-	set_lsa = (void *)cmd->send_cmd->in.payload;
-	set_lsa->offset = cpu_to_le32(offset);
-	memcpy(set_lsa->lsa_data, lsa_buf, length);
-
-	return cmd;
+	return lsa;
+}
 
-out_fail:
-	cxl_cmd_unref(cmd);
-	return NULL;
+CXL_EXPORT void cxl_lsa_free(struct cxl_lsa *lsa)
+{
+	if (!lsa)
+		return;
+	lsa_shadow_release(&lsa->shadow);
+	free(lsa);
 }
 
-enum lsa_op {
-	LSA_OP_GET,
-	LSA_OP_SET,
-	LSA_OP_ZERO,
-};
+CXL_EXPORT size_t cxl_lsa_get_size(struct cxl_lsa *lsa)
+{
+	return lsa->shadow.size;
+}
 
-static int lsa_op(struct cxl_memdev *memdev, int op, void **buf,
-		size_t length, size_t offset)
+CXL_EXPORT size_t cxl_lsa_get_slot_size(struct cxl_lsa *lsa)
 {
-	const char *devname = cxl_memdev_get_devname(memdev);
-	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
-	struct cxl_cmd *cmd;
-	void *zero_buf = NULL;
-	int rc = 0;
+	return lsa->shadow.slot_size;
+}
 
-	if (op != LSA_OP_ZERO && (buf == NULL || *buf == NULL)) {
-		err(ctx, "%s: LSA buffer cannot be NULL\n", devname);
-		return -EINVAL;
-	}
+CXL_EXPORT unsigned int cxl_lsa_get_nr_dirty(struct cxl_lsa *lsa)
+{
+	return lsa_shadow_nr_dirty(&lsa->shadow);
+}
 
-	/* TODO: handle the case for offset + len > mailbox payload size */
-	switch (op) {
-	case LSA_OP_GET:
-		if (length == 0)
-			length = memdev->lsa_size;
-		cmd = cxl_cmd_new_get_lsa(memdev, offset, length);
-		if (!cmd)
-			return -ENOMEM;
-		rc = cxl_cmd_set_output_payload(cmd, *buf, length);
-		if (rc) {
-			err(ctx, "%s: cmd setup failed: %s\n",
-			    cxl_memdev_get_devname(memdev), strerror(-rc));
-			goto out;
-		}
-		break;
-	case LSA_OP_ZERO:
-		if (length == 0)
-			length = memdev->lsa_size;
-		zero_buf = calloc(1, length);
-		if (!zero_buf)
-			return -ENOMEM;
-		buf = &zero_buf;
-		/* fall through */
-	case LSA_OP_SET:
-		cmd = cxl_cmd_new_set_lsa(memdev, *buf, offset, length);
-		if (!cmd) {
-			rc = -ENOMEM;
-			goto out_free;
-		}
-		break;
-	default:
-		return -EOPNOTSUPP;
-	}
+/*
+ * Read every slot touching [@offset, @offset + @length) that is not in
+ * the shadow yet, one device transfer per run of missing slots.
+ */
+CXL_EXPORT int cxl_lsa_load(struct cxl_lsa *lsa, size_t length,
+		size_t offset, unsigned int flags, struct cxl_lsa_stats *stats)
+{
+	struct cxl_lsa_stats st, total = { 0 };
+	struct lsa_shadow *s = &lsa->shadow;
+	unsigned int start = 0, end;
+	size_t off;
+	int rc;
 
-	rc = cxl_cmd_submit(cmd);
-	if (rc < 0) {
-		err(ctx, "%s: cmd submission failed: %s\n",
-			devname, strerror(-rc));
+	rc = lsa_shadow_range(s, &length, offset);
+	if (rc)
 		goto out;
-	}
 
-	rc = cxl_cmd_get_mbox_status(cmd);
-	if (rc != 0) {
-		err(ctx, "%s: firmware status: %d:\n%s\n",
-			devname, rc, DEVICE_ERRORS[rc]);
-		rc = -ENXIO;
-		goto out;
+	while (lsa_shadow_next_missing(s, length, offset, &start, &end)) {
+		off = start * s->slot_size;
+		rc = lsa_op(lsa->memdev, LSA_OP_GET, s->data + off,
+				lsa_shadow_slot_len(s, start, end), off, flags,
+				&st);
+		lsa_stats_add(&total, &st);
+		if (rc)
+			goto out;
+		lsa_shadow_set_loaded(s, start, end);
+		start = end;
 	}
-
-	if (op == LSA_OP_GET)
-		memcpy(*buf, cxl_cmd_get_lsa_get_payload(cmd), length);
-	/*
-	 * TODO: If writing, the memdev may need to be disabled/re-enabled to
-	 * refresh any cached LSA data in the kernel.
-	 */
-
 out:
-	cxl_cmd_unref(cmd);
-out_free:
-	free(zero_buf);
+	if (stats)
+		*stats = total;
 	return rc;
 }
 
-CXL_EXPORT int cxl_memdev_zero_lsa(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_lsa_read(struct cxl_lsa *lsa, void *buf, size_t length,
+		size_t offset)
 {
-	return lsa_op(memdev, LSA_OP_ZERO, NULL, 0, 0);
+	int rc;
+
+	rc = cxl_lsa_load(lsa, length, offset, 0, NULL);
+	if (rc)
+		return rc;
+	if (!length)
+		length = lsa->shadow.size - offset;
+	memcpy(buf, lsa->shadow.data + offset, length);
+	return 0;
 }
 
-CXL_EXPORT int cxl_memdev_set_lsa(struct cxl_memdev *memdev, void *buf,
-		size_t length, size_t offset)
+/* load the range, then update the shadow with @buf (zeroes when NULL) */
+static int lsa_update(struct cxl_lsa *lsa, const void *buf, size_t length,
+		size_t offset)
 {
-	return lsa_op(memdev, LSA_OP_SET, &buf, length, offset);
+	int rc;
+
+	rc = cxl_lsa_load(lsa, length, offset, 0, NULL);
+	if (rc)
+		return rc;
+	if (!length)
+		length = lsa->shadow.size - offset;
+	lsa_shadow_update(&lsa->shadow, buf, length, offset);
+	return 0;
 }
 
-CXL_EXPORT int cxl_memdev_get_lsa(struct cxl_memdev *memdev, void *buf,
+CXL_EXPORT int cxl_lsa_write(struct cxl_lsa *lsa, const void *buf,
 		size_t length, size_t offset)
 {
-	return lsa_op(memdev, LSA_OP_GET, &buf, length, offset);
+	if (!buf)
+		return -EINVAL;
+	return lsa_update(lsa, buf, length, offset);
+}
+
+CXL_EXPORT int cxl_lsa_zero(struct cxl_lsa *lsa, size_t length, size_t offset)
+{
+	return lsa_update(lsa, NULL, length, offset);
+}
+
+/*
+ * Write each run of dirty slots back in one transfer. With
+ * CXL_LSA_VERIFY the run is read back and its fletcher64 compared with
+ * the shadow's. Slots of runs that made it to the device are clean
+ * again even if a later run fails.
+ *
+ * Like cxl_memdev_set_lsa(), this goes straight to the mailbox: label
+ * data the kernel has already cached for the memdev is not refreshed,
+ * so only commit to a memdev that is not in use.
+ */
+CXL_EXPORT int cxl_lsa_commit(struct cxl_lsa *lsa, unsigned int flags,
+		struct cxl_lsa_stats *stats)
+{
+	struct cxl_memdev *memdev = lsa->memdev;
+	struct cxl_ctx *ctx = cxl_memdev_get_ctx(memdev);
+	struct cxl_lsa_stats st, total = { 0 };
+	struct lsa_shadow *s = &lsa->shadow;
+	unsigned int start = 0, end;
+	u8 *vbuf = NULL;
+	size_t off, len;
+	int rc = 0;
+
+	if (flags & CXL_LSA_VERIFY) {
+		vbuf = calloc(s->nr_slots, s->slot_size);
+		if (!vbuf)
+			return -ENOMEM;
+	}
+
+	while (lsa_shadow_next_dirty(s, &start, &end)) {
+		off = start * s->slot_size;
+		len = lsa_shadow_slot_len(s, start, end);
+
+		rc = lsa_op(memdev, LSA_OP_SET, s->data + off, len, off, 0,
+				&st);
+		lsa_stats_add(&total, &st);
+		if (rc)
+			break;
+
+		if (vbuf) {
+			rc = lsa_op(memdev, LSA_OP_GET, vbuf + off, len, off, 0,
+					&st);
+			if (rc)
+				break;
+			/* whole slots, the tail past the LSA size is zero in both */
+			len = (end - start) * s->slot_size;
+			if (fletcher64(vbuf + off, len, false) !=
+					fletcher64(s->data + off, len, false)) {
+				err(ctx, "%s: LSA checksum mismatch at offset %zu\n",
+					cxl_memdev_get_devname(memdev), off);
+				rc = -EIO;
+				break;
+			}
+			total.verified += lsa_shadow_slot_len(s, start, end);
+		}
+		lsa_shadow_set_clean(s, start, end);
+		start = end;
+	}
+
+	free(vbuf);
+	if (stats)
+		*stats = total;
+	return rc;
 }
 
 CXL_EXPORT int cxl_memdev_cmd_identify(struct cxl_memdev *memdev)
@@ -1495,12 +2328,15 @@ CXL_EXPORT int cxl_memdev_get_log(struct cxl_memdev *memdev, const char* uuid, c
 	int rc = 0;
 	int remaining_bytes = data_size;
 	unsigned int bytes_read = 0;
+	int payload_max = memdev_payload_max(memdev);
 
 	if (!uuid) {
 		fprintf(stderr, "%s: Please specify log uuid argument\n",
 				cxl_memdev_get_devname(memdev));
 		return -EINVAL;
 	}
+	if (payload_max < 0)
+		return payload_max;
 
 	do {
 		cmd = cxl_cmd_new_generic(memdev, CXL_MEM_COMMAND_ID_GET_LOG);
@@ -1513,7 +2349,7 @@ CXL_EXPORT int cxl_memdev_get_log(struct cxl_memdev *memdev, const char* uuid, c
 		get_log_input = (void *) cmd->send_cmd->in.payload;
 		uuid_parse(uuid, get_log_input->uuid);
 		get_log_input->offset = bytes_read;
-		get_log_input->length = cmd->memdev->payload_max;
+		get_log_input->length = payload_max;
 		rc = cxl_cmd_submit(cmd);
 		if (rc < 0) {
 			fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
@@ -1682,7 +2518,7 @@ CXL_EXPORT int cxl_memdev_set_event_interrupt_policy(struct cxl_memdev *memdev,
 		return -EINVAL;
 	}
 
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -1789,7 +2625,7 @@ CXL_EXPORT int cxl_memdev_set_timestamp(struct cxl_memdev *memdev, u64 timestamp
 		return -EINVAL;
 	}
 
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -1808,7 +2644,8 @@ struct cxl_mbox_get_alert_config_out {
 	__le16 corr_pers_mem_err_prog_warn_threshold;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_get_alert_config(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_get_alert_config_fetch(struct cxl_memdev *memdev,
+	struct cxl_alert_config *cfg)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mbox_get_alert_config_out *alert_config_out;
@@ -1839,37 +2676,66 @@ CXL_EXPORT int cxl_memdev_get_alert_config(struct cxl_memdev *memdev)
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_GET_ALERT_CONFIG) {
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_GET_ALERT_CONFIG);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
-	fprintf(stdout, "alert_config summary\n");
-	//fprintf(stdout, "    out size: 0x%x\n", cmd->send_cmd->out.size);
-
 	alert_config_out = (void *)cmd->send_cmd->out.payload;
+	cfg->valid_alerts = alert_config_out->valid_alerts;
+	cfg->programmable_alerts = alert_config_out->programmable_alerts;
+	cfg->life_used_critical_alert_threshold =
+		alert_config_out->life_used_critical_alert_threshold;
+	cfg->life_used_prog_warn_threshold =
+		alert_config_out->life_used_prog_warn_threshold;
+	cfg->dev_over_temp_crit_alert_threshold =
+		le16_to_cpu(alert_config_out->dev_over_temp_crit_alert_threshold);
+	cfg->dev_under_temp_crit_alert_threshold =
+		le16_to_cpu(alert_config_out->dev_under_temp_crit_alert_threshold);
+	cfg->dev_over_temp_prog_warn_threshold =
+		le16_to_cpu(alert_config_out->dev_over_temp_prog_warn_threshold);
+	cfg->dev_under_temp_prog_warn_threshold =
+		le16_to_cpu(alert_config_out->dev_under_temp_prog_warn_threshold);
+	cfg->corr_vol_mem_err_prog_warn_threshold =
+		le16_to_cpu(alert_config_out->corr_vol_mem_err_prog_warn_thresold);
+	cfg->corr_pers_mem_err_prog_warn_threshold =
+		le16_to_cpu(alert_config_out->corr_pers_mem_err_prog_warn_threshold);
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_get_alert_config(struct cxl_memdev *memdev)
+{
+	struct cxl_alert_config cfg;
+	int rc;
+
+	rc = cxl_memdev_get_alert_config_fetch(memdev, &cfg);
+	if (rc != 0)
+		return rc;
 
-	fprintf(stdout, "    valid_alerts: 0x%x\n", alert_config_out->valid_alerts);
-	fprintf(stdout, "    programmable_alerts: 0x%x\n", alert_config_out->programmable_alerts);
+	fprintf(stdout, "alert_config summary\n");
+	fprintf(stdout, "    valid_alerts: 0x%x\n", cfg.valid_alerts);
+	fprintf(stdout, "    programmable_alerts: 0x%x\n", cfg.programmable_alerts);
 	fprintf(stdout, "    life_used_critical_alert_threshold: 0x%x\n",
-		alert_config_out->life_used_critical_alert_threshold);
+		cfg.life_used_critical_alert_threshold);
 	fprintf(stdout, "    life_used_prog_warn_threshold: 0x%x\n",
-		alert_config_out->life_used_prog_warn_threshold);
+		cfg.life_used_prog_warn_threshold);
 
 	fprintf(stdout, "    dev_over_temp_crit_alert_threshold: 0x%x\n",
-		le16_to_cpu(alert_config_out->dev_over_temp_crit_alert_threshold));
+		cfg.dev_over_temp_crit_alert_threshold);
 	fprintf(stdout, "    dev_under_temp_crit_alert_threshold: 0x%x\n",
-		le16_to_cpu(alert_config_out->dev_under_temp_crit_alert_threshold));
+		cfg.dev_under_temp_crit_alert_threshold);
 	fprintf(stdout, "    dev_over_temp_prog_warn_threshold: 0x%x\n",
-		le16_to_cpu(alert_config_out->dev_over_temp_prog_warn_threshold));
+		cfg.dev_over_temp_prog_warn_threshold);
 	fprintf(stdout, "    dev_under_temp_prog_warn_threshold: 0x%x\n",
-		le16_to_cpu(alert_config_out->dev_under_temp_prog_warn_threshold));
+		cfg.dev_under_temp_prog_warn_threshold);
 	fprintf(stdout, "    corr_vol_mem_err_prog_warn_thresold: 0x%x\n",
-		le16_to_cpu(alert_config_out->corr_vol_mem_err_prog_warn_thresold));
+		cfg.corr_vol_mem_err_prog_warn_threshold);
 	fprintf(stdout, "    corr_pers_mem_err_prog_warn_threshold: 0x%x\n",
-		le16_to_cpu(alert_config_out->corr_pers_mem_err_prog_warn_threshold));
+		cfg.corr_pers_mem_err_prog_warn_threshold);
 
-out:
-	cxl_cmd_unref(cmd);
-	return rc;
+	return 0;
 }
 
 struct cxl_mbox_set_alert_config_in {
@@ -1949,7 +2815,7 @@ CXL_EXPORT int cxl_memdev_set_alert_config(struct cxl_memdev *memdev, u32 alert_
 		return -EINVAL;
 	}
 
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -2856,15 +3722,9 @@ struct cxl_mbox_hct_get_buffer_status_out {
 	u8 fill_level;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_hct_get_buffer_status(struct cxl_memdev *memdev,
-	u8 hct_inst)
+CXL_EXPORT int cxl_memdev_hct_get_buffer_status_fetch(struct cxl_memdev *memdev,
+	u8 hct_inst, u8 *buf_status, u8 *fill_level)
 {
-	const char *buf_status_descriptions[] = {
-		"Stop",
-		"Pre-Trigger",
-		"Post-Trigger"
-	};
-
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
@@ -2913,17 +3773,39 @@ CXL_EXPORT int cxl_memdev_hct_get_buffer_status(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_HCT_GET_BUFFER_STATUS) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_HCT_GET_BUFFER_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	hct_get_buffer_status_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "======================= get hif/cxl trace buffer status ========================\n");
-	fprintf(stdout, "Buffer Status: %s\n", buf_status_descriptions[hct_get_buffer_status_out->buf_status]);
-	fprintf(stdout, "Fill Level: %x\n", hct_get_buffer_status_out->fill_level);
+	*buf_status = hct_get_buffer_status_out->buf_status;
+	*fill_level = hct_get_buffer_status_out->fill_level;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_hct_get_buffer_status(struct cxl_memdev *memdev,
+	u8 hct_inst)
+{
+	const char *buf_status_descriptions[] = {
+		"Stop",
+		"Pre-Trigger",
+		"Post-Trigger"
+	};
+	u8 buf_status, fill_level;
+	int rc;
+
+	rc = cxl_memdev_hct_get_buffer_status_fetch(memdev, hct_inst,
+		&buf_status, &fill_level);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "======================= get hif/cxl trace buffer status ========================\n");
+	fprintf(stdout, "Buffer Status: %s\n", buf_status < ARRAY_SIZE(buf_status_descriptions) ?
+		buf_status_descriptions[buf_status] : "Unknown");
+	fprintf(stdout, "Fill Level: %x\n", fill_level);
 	return 0;
 }
 
@@ -3557,8 +4439,9 @@ struct cxl_mbox_ltmon_capture_stat_out {
 	u8 rsvd[3];
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_ltmon_capture_stat(struct cxl_memdev *memdev,
-	u8 cxl_mem_id)
+CXL_EXPORT int cxl_memdev_ltmon_capture_stat_fetch(struct cxl_memdev *memdev,
+	u8 cxl_mem_id, u16 *trig_cnt, u16 *watch0_trig_cnt, u16 *watch1_trig_cnt,
+	u16 *time_stamp, u8 *trig_src_stat)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -3608,20 +4491,40 @@ CXL_EXPORT int cxl_memdev_ltmon_capture_stat(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_LTMON_CAPTURE_STAT) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_LTMON_CAPTURE_STAT);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	ltmon_capture_stat_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "============================= ltmon capture status =============================\n");
-	fprintf(stdout, "Trigger Count: %x\n", le16_to_cpu(ltmon_capture_stat_out->trig_cnt));
-	fprintf(stdout, "Watch 0 Trigger Count: %x\n", le16_to_cpu(ltmon_capture_stat_out->watch0_trig_cnt));
-	fprintf(stdout, "Watch 1 Trigger Count: %x\n", le16_to_cpu(ltmon_capture_stat_out->watch1_trig_cnt));
-	fprintf(stdout, "Time Stamp: %x\n", le16_to_cpu(ltmon_capture_stat_out->time_stamp));
-	fprintf(stdout, "Trigger Source Status: %x\n", ltmon_capture_stat_out->trig_src_stat);
+	*trig_cnt = le16_to_cpu(ltmon_capture_stat_out->trig_cnt);
+	*watch0_trig_cnt = le16_to_cpu(ltmon_capture_stat_out->watch0_trig_cnt);
+	*watch1_trig_cnt = le16_to_cpu(ltmon_capture_stat_out->watch1_trig_cnt);
+	*time_stamp = le16_to_cpu(ltmon_capture_stat_out->time_stamp);
+	*trig_src_stat = ltmon_capture_stat_out->trig_src_stat;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_ltmon_capture_stat(struct cxl_memdev *memdev,
+	u8 cxl_mem_id)
+{
+	u16 trig_cnt, watch0_trig_cnt, watch1_trig_cnt, time_stamp;
+	u8 trig_src_stat;
+	int rc;
+
+	rc = cxl_memdev_ltmon_capture_stat_fetch(memdev, cxl_mem_id, &trig_cnt,
+		&watch0_trig_cnt, &watch1_trig_cnt, &time_stamp, &trig_src_stat);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "============================= ltmon capture status =============================\n");
+	fprintf(stdout, "Trigger Count: %x\n", trig_cnt);
+	fprintf(stdout, "Watch 0 Trigger Count: %x\n", watch0_trig_cnt);
+	fprintf(stdout, "Watch 1 Trigger Count: %x\n", watch1_trig_cnt);
+	fprintf(stdout, "Time Stamp: %x\n", time_stamp);
+	fprintf(stdout, "Trigger Source Status: %x\n", trig_src_stat);
 	return 0;
 }
 
@@ -3693,26 +4596,157 @@ CXL_EXPORT int cxl_memdev_ltmon_capture_log_dmp(struct cxl_memdev *memdev,
 		goto out;
 	}
 
-	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP) {
-		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
-				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP);
-		return -EINVAL;
-	}
+	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP) {
+		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
+				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP);
+		return -EINVAL;
+	}
+
+	ltmon_capture_log_dmp_out = (void *)cmd->send_cmd->out.payload;
+	fprintf(stdout, "============================ ltmon capture log dump ============================\n");
+	fprintf(stdout, "LTMON Data: ");
+	/* Procedurally generated print statement. To print this array contiguously,
+	   add "contiguous: True" to the YAML param and rerun cligen.py */
+	for (int i = 0; i < 2; i++) {
+		fprintf(stdout, "data[%d]: %lx\n", i, le64_to_cpu(ltmon_capture_log_dmp_out->data[i]));
+	}
+	fprintf(stdout, "\n");
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+	return 0;
+}
+
+
+#define CXL_LTMON_LOG_ENTRY_SIZE sizeof(struct cxl_mbox_ltmon_capture_log_dmp_out)
+
+static void ltmon_log_entry_decode(const __le64 *raw,
+	struct cxl_ltmon_log_entry *e)
+{
+	u64 lo = le64_to_cpu(raw[0]), hi = le64_to_cpu(raw[1]);
+	u32 reg1 = lo, reg2 = lo >> 32, reg3 = hi, reg4 = hi >> 32;
+
+	e->timestamp = ((u64)(reg3 & 0x1f) << 32) | reg2;
+	e->arc = reg4;
+	e->rx_l0s_substate = reg1 & 0x7;
+	e->substate = (reg1 >> 3) & 0xf;
+	e->main_state = (reg1 >> 7) & 0x3f;
+	e->link_rate = (reg1 >> 13) & 0x7;
+	e->link_width = (reg1 >> 17) & 0x7;
+	e->timestamp_rollover = (reg1 >> 16) & 0x1;
+}
+
+/*
+ * Read the whole LTMON capture log of @cxl_mem_id into a newly allocated
+ * array of decoded entries, which the caller frees. The log is paged with
+ * the largest dump_cnt that fits the mailbox payload over a single command
+ * and ends at the first page the device returns short; the trigger count
+ * of ltmon-capture-stat says nothing about the log length. With @freeze
+ * the capture is frozen for the duration of the dump and restored
+ * afterwards, so the log does not move while it is paged.
+ * Returns the number of entries read.
+ */
+CXL_EXPORT int cxl_memdev_ltmon_capture_log_dump_all(struct cxl_memdev *memdev,
+	u8 cxl_mem_id, bool freeze, struct cxl_ltmon_log_entry **entries)
+{
+	struct cxl_cmd *cmd = NULL;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_ltmon_capture_log_dmp_in *ltmon_capture_log_dmp_in;
+	__le64 *data;
+	u16 per_read, want, got, count = 0;
+	struct cxl_ltmon_log_entry *buf = NULL, *tmp;
+	int rc, i;
+
+	*entries = NULL;
+
+	if (freeze) {
+		rc = cxl_memdev_ltmon_capture_freeze_and_restore(memdev, cxl_mem_id, 1);
+		if (rc < 0)
+			return rc;
+	}
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	cinfo->size_in = CXL_MEM_COMMAND_ID_LTMON_CAPTURE_LOG_DMP_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	cmd->send_cmd->in.size = cinfo->size_in;
+
+	per_read = min_t(size_t, USHRT_MAX, cinfo->size_out / CXL_LTMON_LOG_ENTRY_SIZE);
+	ltmon_capture_log_dmp_in = (void *) cmd->send_cmd->in.payload;
+	ltmon_capture_log_dmp_in->cxl_mem_id = cxl_mem_id;
+	/* a page holds dump_cnt back-to-back log_dmp_out entries */
+	data = (void *)cmd->send_cmd->out.payload;
+
+	/* dump_idx is 16 bits wide, which bounds the log */
+	while (count < USHRT_MAX) {
+		want = min_t(u16, per_read, USHRT_MAX - count);
+		tmp = realloc(buf, (count + want) * sizeof(*buf));
+		if (!tmp) {
+			rc = -ENOMEM;
+			goto out;
+		}
+		buf = tmp;
+		ltmon_capture_log_dmp_in->dump_idx = cpu_to_le16(count);
+		ltmon_capture_log_dmp_in->dump_cnt = cpu_to_le16(want);
+		cmd->send_cmd->out.size = cinfo->size_out;
+		rc = cxl_cmd_submit(cmd);
+		if (rc < 0) {
+			fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
+					cxl_memdev_get_devname(memdev), rc, strerror(-rc));
+			goto out;
+		}
 
-	ltmon_capture_log_dmp_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "============================ ltmon capture log dump ============================\n");
-	fprintf(stdout, "LTMON Data: ");
-	/* Procedurally generated print statement. To print this array contiguously,
-	   add "contiguous: True" to the YAML param and rerun cligen.py */
-	for (int i = 0; i < 2; i++) {
-		fprintf(stdout, "data[%d]: %lx\n", i, le64_to_cpu(ltmon_capture_log_dmp_out->data[i]));
+		rc = cxl_cmd_get_mbox_status(cmd);
+		if (rc != 0) {
+			fprintf(stderr, "%s: firmware status: %d\n",
+					cxl_memdev_get_devname(memdev), rc);
+			rc = -ENXIO;
+			goto out;
+		}
+
+		got = min_t(size_t, want,
+			cmd->send_cmd->out.size / CXL_LTMON_LOG_ENTRY_SIZE);
+		for (i = 0; i < got; i++)
+			ltmon_log_entry_decode(&data[i * 2], &buf[count + i]);
+		count += got;
+		if (got < want)
+			break;
 	}
-	fprintf(stdout, "\n");
 
+	*entries = buf;
+	buf = NULL;
+	rc = count;
 out:
+	free(buf);
 	cxl_cmd_unref(cmd);
+	if (freeze) {
+		int restore_rc = cxl_memdev_ltmon_capture_freeze_and_restore(memdev,
+			cxl_mem_id, 0);
+
+		if (rc >= 0 && restore_rc < 0)
+			rc = restore_rc;
+	}
+	if (rc < 0) {
+		free(*entries);
+		*entries = NULL;
+	}
 	return rc;
-	return 0;
 }
 
 
@@ -5150,6 +6184,109 @@ out:
 }
 
 
+/*
+ * Take one consistent snapshot of a set of MTA and HIF counters.
+ *
+ * Every requested counter is latched first, back to back, and only then are
+ * the latched values read out, so the reads do not stretch the window in
+ * which the counters are sampled. A single raw command object is retargeted
+ * between opcodes instead of allocating one command per counter.
+ *
+ * @values receives nr_mta MTA values followed by nr_hif HIF values.
+ * @ts_ns is the CLOCK_REALTIME time at which latching started and
+ * @latch_ns the CLOCK_MONOTONIC time it took to latch every counter.
+ */
+CXL_EXPORT int cxl_memdev_perfcnt_snapshot(struct cxl_memdev *memdev,
+	u8 mta_type, const u32 *mta_counters, int nr_mta,
+	const u32 *hif_counters, int nr_hif, u64 *values, u64 *ts_ns,
+	u64 *latch_ns)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_perfcnt_mta_cnt_val_latch_in *mta_in;
+	struct cxl_mbox_perfcnt_mta_hif_cnt_val_latch_in *hif_in;
+	struct cxl_mbox_perfcnt_mta_latch_val_get_out *mta_out;
+	struct cxl_mbox_perfcnt_mta_hif_latch_val_get_out *hif_out;
+	u64 start, latch_start;
+	int rc = 0, i;
+
+	if (nr_mta < 0 || nr_hif < 0 || nr_mta + nr_hif == 0 || !values)
+		return -EINVAL;
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_PERFCNT_MTA_CNT_VAL_LATCH_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	/* sized for the larger (MTA) input, HIF commands send a prefix of it */
+	cinfo->size_in = CXL_MEM_COMMAND_ID_PERFCNT_MTA_CNT_VAL_LATCH_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	mta_in = cmd->input_payload;
+	hif_in = cmd->input_payload;
+	mta_out = (void *)cmd->send_cmd->out.payload;
+	hif_out = (void *)cmd->send_cmd->out.payload;
+
+	start = util_clock_ns(CLOCK_REALTIME);
+	latch_start = util_clock_ns(CLOCK_MONOTONIC);
+	for (i = 0; i < nr_mta; i++) {
+		mta_in->type = mta_type;
+		mta_in->counter = cpu_to_le32(mta_counters[i]);
+		rc = cxl_cmd_raw_resubmit(cmd,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_CNT_VAL_LATCH_OPCODE,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_CNT_VAL_LATCH_PAYLOAD_IN_SIZE);
+		if (rc)
+			goto out;
+	}
+	for (i = 0; i < nr_hif; i++) {
+		hif_in->counter = cpu_to_le32(hif_counters[i]);
+		rc = cxl_cmd_raw_resubmit(cmd,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_HIF_CNT_VAL_LATCH_OPCODE,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_HIF_CNT_VAL_LATCH_PAYLOAD_IN_SIZE);
+		if (rc)
+			goto out;
+	}
+	if (ts_ns)
+		*ts_ns = start;
+	if (latch_ns)
+		*latch_ns = util_clock_ns(CLOCK_MONOTONIC) - latch_start;
+
+	for (i = 0; i < nr_mta; i++) {
+		mta_in->type = mta_type;
+		mta_in->counter = cpu_to_le32(mta_counters[i]);
+		rc = cxl_cmd_raw_resubmit(cmd,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_LATCH_VAL_GET_OPCODE,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_LATCH_VAL_GET_PAYLOAD_IN_SIZE);
+		if (rc)
+			goto out;
+		values[i] = le64_to_cpu(mta_out->latch_val);
+	}
+	for (i = 0; i < nr_hif; i++) {
+		hif_in->counter = cpu_to_le32(hif_counters[i]);
+		rc = cxl_cmd_raw_resubmit(cmd,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_HIF_LATCH_VAL_GET_OPCODE,
+			CXL_MEM_COMMAND_ID_PERFCNT_MTA_HIF_LATCH_VAL_GET_PAYLOAD_IN_SIZE);
+		if (rc)
+			goto out;
+		values[nr_mta + i] = le64_to_cpu(hif_out->latch_val);
+	}
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+
 #define CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_SELECT CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_SELECT_OPCODE 51728
 #define CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_SELECT_PAYLOAD_IN_SIZE 13
@@ -5760,6 +6897,69 @@ out:
 }
 
 
+/*
+ * Read the BER grid of every lane in @lane_mask after an eye capture, on a
+ * single command. @ber receives, for each lane in ascending order, @nr_bins
+ * rows of CXL_EH_EYE_CAP_MAX_PHASES host-order words; @num_phase receives
+ * the number of valid phases per lane.
+ */
+CXL_EXPORT int cxl_memdev_eh_eye_cap_read_lanes(struct cxl_memdev *memdev,
+	u32 lane_mask, int nr_bins, u32 *ber, u8 *num_phase)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_eh_eye_cap_read_in *eh_eye_cap_read_in;
+	struct cxl_mbox_eh_eye_cap_read_out *eh_eye_cap_read_out;
+	int rc = 0, lane, bin, i, n = 0;
+	u32 *row;
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_EH_EYE_CAP_READ_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	cinfo->size_in = CXL_MEM_COMMAND_ID_EH_EYE_CAP_READ_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	eh_eye_cap_read_in = (void *) cmd->send_cmd->in.payload;
+	eh_eye_cap_read_out = (void *)cmd->send_cmd->out.payload;
+
+	for (lane = 0; lane < 32; lane++) {
+		if (!(lane_mask & (1u << lane)))
+			continue;
+		eh_eye_cap_read_in->lane_id = lane;
+		num_phase[n] = 0;
+		for (bin = 0; bin < nr_bins; bin++) {
+			eh_eye_cap_read_in->bin_num = bin;
+			rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_EH_EYE_CAP_READ_OPCODE,
+				CXL_MEM_COMMAND_ID_EH_EYE_CAP_READ_PAYLOAD_IN_SIZE);
+			if (rc < 0)
+				goto out;
+			num_phase[n] = min_t(u8, eh_eye_cap_read_out->num_phase,
+				CXL_EH_EYE_CAP_MAX_PHASES);
+			row = ber + ((size_t)n * nr_bins + bin) * CXL_EH_EYE_CAP_MAX_PHASES;
+			for (i = 0; i < CXL_EH_EYE_CAP_MAX_PHASES; i++)
+				row[i] = le32_to_cpu(eh_eye_cap_read_out->ber_data[i]);
+		}
+		n++;
+	}
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+
 #define CXL_MEM_COMMAND_ID_EH_ADAPT_GET CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_EH_ADAPT_GET_OPCODE 52227
 #define CXL_MEM_COMMAND_ID_EH_ADAPT_GET_PAYLOAD_IN_SIZE 4
@@ -6548,7 +7748,7 @@ CXL_EXPORT int cxl_memdev_err_inj_hif_poison(struct cxl_memdev *memdev,
 	CXL_MEM_COMMAND_ID_ERR_INJ_HIF_POISON);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -6625,7 +7825,7 @@ CXL_EXPORT int cxl_memdev_err_inj_hif_ecc(struct cxl_memdev *memdev,
 	CXL_MEM_COMMAND_ID_ERR_INJ_HIF_ECC);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -6647,8 +7847,8 @@ struct cxl_mbox_perfcnt_ddr_generic_capture_out {
 	__le32 result[32];
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
-	u8 ddr_id, u32 poll_period_ms)
+CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture_fetch(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms, u32 *counters, int nr_counters)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -6656,9 +7856,13 @@ CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
 	struct cxl_mbox_perfcnt_ddr_generic_capture_in *perfcnt_ddr_generic_capture_in;
 	struct cxl_mbox_perfcnt_ddr_generic_capture_out *perfcnt_ddr_generic_capture_out;
 	int rc = 0;
+	int i;
+
+	if (!counters || nr_counters <= 0)
+		return -EINVAL;
 
 	cmd = cxl_cmd_new_raw(memdev,
-	CXL_MEM_COMMAND_ID_GET_EVENT_INTERRUPT_POLICY_OPCODE);
+	CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_CAPTURE_OPCODE);
 	if (!cmd) {
 		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
 				cxl_memdev_get_devname(memdev));
@@ -6670,8 +7874,10 @@ CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
 	cinfo->size_in = CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_CAPTURE_PAYLOAD_IN_SIZE;
 	if (cinfo->size_in > 0) {
 		cmd->input_payload = calloc(1, cinfo->size_in);
-		if (!cmd->input_payload)
-			return -ENOMEM;
+		if (!cmd->input_payload) {
+			rc = -ENOMEM;
+			goto out;
+		}
 		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
 		cmd->send_cmd->in.size = cinfo->size_in;
 	}
@@ -6697,19 +7903,37 @@ CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 	CXL_MEM_COMMAND_ID_PERFCNT_DDR_GENERIC_CAPTURE);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
-	fprintf(stdout, "command completed successfully\n");
 
 	perfcnt_ddr_generic_capture_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "=========================== PERFCNT DDR Generic Capture ============================\n");
-	fprintf(stdout, "Generic Counter Readings:\n");
-	for(int i=0; i<8; i++) {
-		fprintf(stdout, "%x\n", le32_to_cpu(perfcnt_ddr_generic_capture_out->result[i]));
-	}
+	if (nr_counters > CXL_PERFCNT_DDR_GENERIC_COUNTERS)
+		nr_counters = CXL_PERFCNT_DDR_GENERIC_COUNTERS;
+	for (i = 0; i < nr_counters; i++)
+		counters[i] = le32_to_cpu(perfcnt_ddr_generic_capture_out->result[i]);
+	rc = nr_counters;
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms)
+{
+	u32 counters[CXL_PERFCNT_DDR_GENERIC_COUNTERS];
+	int rc, i;
+
+	rc = cxl_memdev_perfcnt_ddr_generic_capture_fetch(memdev, ddr_id,
+			poll_period_ms, counters, ARRAY_SIZE(counters));
+	if (rc < 0)
+		return rc;
+
+	cxl_cmd_done(memdev);
+	fprintf(stdout, "=========================== PERFCNT DDR Generic Capture ============================\n");
+	fprintf(stdout, "Generic Counter Readings:\n");
+	for (i = 0; i < rc; i++)
+		fprintf(stdout, "%x\n", counters[i]);
 	return 0;
 }
 
@@ -6733,18 +7957,23 @@ struct cxl_mbox_perfcnt_ddr_dfi_capture_out {
 	__le32 dfi_ch1_counter21;
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev,
-	u8 ddr_id, u32 poll_period_ms)
+CXL_EXPORT int cxl_memdev_perfcnt_ddr_dfi_capture_fetch(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms, u32 *counters, int nr_counters)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
 	struct cxl_mbox_perfcnt_ddr_dfi_capture_in *perfcnt_ddr_dfi_capture_in;
 	struct cxl_mbox_perfcnt_ddr_dfi_capture_out *perfcnt_ddr_dfi_capture_out;
+	u32 dfi[CXL_PERFCNT_DDR_DFI_COUNTERS];
 	int rc = 0;
+	int i;
+
+	if (!counters || nr_counters <= 0)
+		return -EINVAL;
 
 	cmd = cxl_cmd_new_raw(memdev,
-	CXL_MEM_COMMAND_ID_GET_EVENT_INTERRUPT_POLICY_OPCODE);
+	CXL_MEM_COMMAND_ID_PERFCNT_DDR_DFI_CAPTURE_OPCODE);
 	if (!cmd) {
 		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
 				cxl_memdev_get_devname(memdev));
@@ -6756,8 +7985,10 @@ CXL_EXPORT int cxl_memdev_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev,
 	cinfo->size_in = CXL_MEM_COMMAND_ID_PERFCNT_DDR_DFI_CAPTURE_PAYLOAD_IN_SIZE;
 	if (cinfo->size_in > 0) {
 		cmd->input_payload = calloc(1, cinfo->size_in);
-		if (!cmd->input_payload)
-			return -ENOMEM;
+		if (!cmd->input_payload) {
+			rc = -ENOMEM;
+			goto out;
+		}
 		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
 		cmd->send_cmd->in.size = cinfo->size_in;
 	}
@@ -6783,21 +8014,47 @@ CXL_EXPORT int cxl_memdev_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev,
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 	CXL_MEM_COMMAND_ID_PERFCNT_DDR_DFI_CAPTURE);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
-	fprintf(stdout, "command completed successfully\n");
+
 	perfcnt_ddr_dfi_capture_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "=========================== PERFCNT DDR DFI Capture ============================\n");
-	fprintf(stdout, "DFI Counter Readings:\n");
-	fprintf(stdout, "DFI Counter 17: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter17));
-	fprintf(stdout, "DFI Counter 20: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter20));
-	fprintf(stdout, "DFI Counter 21: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter21));
-	fprintf(stdout, "DFI CH1 Counter 17: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter17));
-	fprintf(stdout, "DFI CH1 Counter 20: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter20));
-	fprintf(stdout, "DFI CH1 Counter 21: %x\n", le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter21));
+	dfi[0] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter17);
+	dfi[1] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter20);
+	dfi[2] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_counter21);
+	dfi[3] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter17);
+	dfi[4] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter20);
+	dfi[5] = le32_to_cpu(perfcnt_ddr_dfi_capture_out->dfi_ch1_counter21);
+	if (nr_counters > CXL_PERFCNT_DDR_DFI_COUNTERS)
+		nr_counters = CXL_PERFCNT_DDR_DFI_COUNTERS;
+	for (i = 0; i < nr_counters; i++)
+		counters[i] = dfi[i];
+	rc = nr_counters;
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms)
+{
+	u32 dfi[CXL_PERFCNT_DDR_DFI_COUNTERS];
+	int rc;
+
+	rc = cxl_memdev_perfcnt_ddr_dfi_capture_fetch(memdev, ddr_id,
+			poll_period_ms, dfi, ARRAY_SIZE(dfi));
+	if (rc < 0)
+		return rc;
+
+	cxl_cmd_done(memdev);
+	fprintf(stdout, "=========================== PERFCNT DDR DFI Capture ============================\n");
+	fprintf(stdout, "DFI Counter Readings:\n");
+	fprintf(stdout, "DFI Counter 17: %x\n", dfi[0]);
+	fprintf(stdout, "DFI Counter 20: %x\n", dfi[1]);
+	fprintf(stdout, "DFI Counter 21: %x\n", dfi[2]);
+	fprintf(stdout, "DFI CH1 Counter 17: %x\n", dfi[3]);
+	fprintf(stdout, "DFI CH1 Counter 20: %x\n", dfi[4]);
+	fprintf(stdout, "DFI CH1 Counter 21: %x\n", dfi[5]);
 	return 0;
 }
 
@@ -6860,7 +8117,7 @@ CXL_EXPORT int cxl_memdev_eh_eye_cap_timeout_enable(struct cxl_memdev *memdev, u
 	CXL_MEM_COMMAND_ID_EH_EYE_CAP_TIMEOUT_ENABLE);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -6882,7 +8139,7 @@ struct cxl_mbox_eh_eye_cap_status_out {
 	u8 rsvd[3];
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_eh_eye_cap_status(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_eh_eye_cap_status_fetch(struct cxl_memdev *memdev, u8 *stat)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -6927,15 +8184,28 @@ CXL_EXPORT int cxl_memdev_eh_eye_cap_status(struct cxl_memdev *memdev)
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 	CXL_MEM_COMMAND_ID_EH_EYE_CAP_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
-	fprintf(stdout, "command completed successfully\n");
 	eh_eye_cap_status_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "=========================== EH Eye Cap Status ============================\n");
-	fprintf(stdout, "Status: %x\n", eh_eye_cap_status_out->stat);
+	*stat = eh_eye_cap_status_out->stat;
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_eh_eye_cap_status(struct cxl_memdev *memdev)
+{
+	u8 stat;
+	int rc;
+
+	rc = cxl_memdev_eh_eye_cap_status_fetch(memdev, &stat);
+	if (rc < 0)
+		return rc;
+
+	cxl_cmd_done(memdev);
+	fprintf(stdout, "=========================== EH Eye Cap Status ============================\n");
+	fprintf(stdout, "Status: %x\n", stat);
 	return 0;
 }
 
@@ -7010,7 +8280,7 @@ CXL_EXPORT int cxl_memdev_eh_link_dbg_cfg(struct cxl_memdev *memdev, u8 port_id,
 	CXL_MEM_COMMAND_ID_EH_LINK_DBG_CFG);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
@@ -7026,20 +8296,6 @@ struct cxl_mbox_eh_link_dbg_entry_dump_in {
 	u8 entry_idx;
 } __attribute__((packed));
 
-struct cxl_mbox_eh_link_dbg_entry_dump_out {
-	u8 cap_info;
-	u8 cap_reason;
-	__le32 l2r_reason;
-	__le64 start_time;
-	__le64 end_time;
-	u8 start_rate;
-	u8 end_rate;
-	u8 start_state;
-	u8 end_state;
-	__le32 start_status;
-	__le32 end_status;
-} __attribute__((packed));
-
 struct eh_link_dbg_entry_dump_fields {
 	u8 entry_idx;
 	u8 entry_num;
@@ -7100,7 +8356,7 @@ CXL_EXPORT int cxl_memdev_eh_link_dbg_entry_dump(struct cxl_memdev *memdev, u8 e
 	CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 	eh_link_dbg_entry_dump_out = (void *)cmd->send_cmd->out.payload;
 
 	cap_info_fields->entry_idx = (eh_link_dbg_entry_dump_out->cap_info & entry_idx_mask) >> entry_idx_shift;
@@ -7135,43 +8391,6 @@ struct cxl_mbox_eh_link_dbg_lane_dump_in {
 	u8 lane_idx;
 } __attribute__((packed));
 
-struct cxl_mbox_eh_link_dbg_lane_dump_out {
-	u8 cap_info;
-	u8 pga_gain;
-	u8 pga_off2;
-	u8 pga_off1;
-	u8 cdfe_a2;
-	u8 cdfe_a3;
-	u8 cdfe_a4;
-	u8 cdfe_a5;
-	u8 cdfe_a6;
-	u8 cdfe_a7;
-	u8 cdfe_a8;
-	u8 cdfe_a9;
-	u8 cdfe_a10;
-	u8 zobel_a_gain;
-	u8 zobel_b_gain;
-	__le16 zobel_dc_offset;
-	__le16 udfe_thr_0;
-	__le16 udfe_thr_1;
-	__le16 dc_offset;
-	__le16 median_amp;
-	u8 ph_ofs_t;
-	__le16 cdru_lock_time;
-	__le16 eh_workaround_stat;
-	__le16 los_toggle_cnt;
-	__le16 adapt_time;
-	__le16 cdr_lock_toggle_cnt_0;
-	__le16 jat_stat_0;
-	__le32 db_err;
-	__le32 reg_val0;
-	u8 reg_val1;
-	__le32 reg_val2;
-	__le32 reg_val3;
-	__le32 reg_val4;
-
-} __attribute__((packed));
-
 struct eh_link_dbg_cap_info_fields {
 	u8 lane_idx;
 	u8 entry_idx;
@@ -7335,7 +8554,7 @@ CXL_EXPORT int cxl_memdev_eh_link_dbg_lane_dump(struct cxl_memdev *memdev, u8 en
 	CXL_MEM_COMMAND_ID_EH_LINK_DBG_LANE_DUMP);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 	eh_link_dbg_lane_dump_out = (void *)cmd->send_cmd->out.payload;
 
 	cap_info_fields->lane_idx = (eh_link_dbg_lane_dump_out->cap_info & lane_idx_mask) >> lane_idx_shift;
@@ -7427,6 +8646,107 @@ out:
 	return 0;
 }
 
+#define EH_LINK_DBG_MAX_LANES 16
+
+/*
+ * Dump every captured entry and every lane in @lane_mask on a single raw
+ * command, switching between the entry and lane dump opcodes. The result is
+ * one buffer holding, for each entry oldest first, the entry dump payload
+ * followed by the lane dump payload of each lane in @lane_mask in ascending
+ * order. Returns the number of entries, the caller frees *@buf.
+ */
+CXL_EXPORT int cxl_memdev_eh_link_dbg_dump_all(struct cxl_memdev *memdev,
+	u16 lane_mask, void **buf, size_t *len)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_eh_link_dbg_lane_dump_in *eh_link_dbg_lane_dump_in;
+	struct cxl_mbox_eh_link_dbg_entry_dump_out *eh_link_dbg_entry_dump_out;
+	size_t entry_size, pos = 0;
+	int rc, nr_entries, nr_lanes, entry, lane;
+	u8 *out = NULL;
+
+	*buf = NULL;
+	*len = 0;
+	nr_lanes = __builtin_popcount(lane_mask);
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	/* the lane dump input is the entry dump input plus lane_idx */
+	cinfo->size_in = CXL_MEM_COMMAND_ID_EH_LINK_DBG_LANE_DUMP_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	eh_link_dbg_lane_dump_in = (void *) cmd->send_cmd->in.payload;
+	eh_link_dbg_entry_dump_out = (void *)cmd->send_cmd->out.payload;
+
+	/* entry 0 always exists and reports the number of captured entries */
+	rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP_OPCODE,
+		CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP_PAYLOAD_IN_SIZE);
+	if (rc < 0)
+		goto out;
+	nr_entries = eh_link_dbg_entry_dump_out->cap_info >> 4;
+	if (!nr_entries)
+		goto out;
+
+	entry_size = sizeof(struct cxl_mbox_eh_link_dbg_entry_dump_out) +
+		nr_lanes * sizeof(struct cxl_mbox_eh_link_dbg_lane_dump_out);
+	out = calloc(nr_entries, entry_size);
+	if (!out) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	for (entry = 0; entry < nr_entries; entry++) {
+		eh_link_dbg_lane_dump_in->entry_idx = entry;
+		if (entry) {
+			rc = cxl_cmd_raw_resubmit(cmd,
+				CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP_OPCODE,
+				CXL_MEM_COMMAND_ID_EH_LINK_DBG_ENTRY_DUMP_PAYLOAD_IN_SIZE);
+			if (rc < 0)
+				goto out;
+		}
+		memcpy(out + pos, eh_link_dbg_entry_dump_out,
+			sizeof(struct cxl_mbox_eh_link_dbg_entry_dump_out));
+		pos += sizeof(struct cxl_mbox_eh_link_dbg_entry_dump_out);
+
+		for (lane = 0; lane < EH_LINK_DBG_MAX_LANES; lane++) {
+			if (!(lane_mask & (1 << lane)))
+				continue;
+			eh_link_dbg_lane_dump_in->lane_idx = lane;
+			rc = cxl_cmd_raw_resubmit(cmd,
+				CXL_MEM_COMMAND_ID_EH_LINK_DBG_LANE_DUMP_OPCODE,
+				CXL_MEM_COMMAND_ID_EH_LINK_DBG_LANE_DUMP_PAYLOAD_IN_SIZE);
+			if (rc < 0)
+				goto out;
+			memcpy(out + pos, (void *)cmd->send_cmd->out.payload,
+				sizeof(struct cxl_mbox_eh_link_dbg_lane_dump_out));
+			pos += sizeof(struct cxl_mbox_eh_link_dbg_lane_dump_out);
+		}
+	}
+
+	*buf = out;
+	*len = pos;
+	out = NULL;
+	rc = nr_entries;
+out:
+	free(out);
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
 #define CXL_MEM_COMMAND_ID_EH_LINK_DBG_RESET CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_EH_LINK_DBG_RESET_OPCODE 0XCC09
 #define CXL_MEM_COMMAND_ID_EH_LINK_DBG_RESET_PAYLOAD_IN_SIZE 0
@@ -7476,7 +8796,7 @@ CXL_EXPORT int cxl_memdev_eh_link_dbg_reset(struct cxl_memdev *memdev)
 	CXL_MEM_COMMAND_ID_EH_LINK_DBG_RESET);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 	fprintf(stdout, "EH Link Reset Completed \n");
 out:
@@ -7552,7 +8872,7 @@ CXL_EXPORT int cxl_memdev_fbist_stopconfig_set(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_STOPCONFIG_SET);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -7627,7 +8947,7 @@ CXL_EXPORT int cxl_memdev_fbist_cyclecount_set(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_CYCLECOUNT_SET);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -7701,7 +9021,7 @@ CXL_EXPORT int cxl_memdev_fbist_reset_set(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_RESET_SET);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -7775,7 +9095,7 @@ CXL_EXPORT int cxl_memdev_fbist_run_set(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_RUN_SET);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -7798,8 +9118,8 @@ struct cxl_mbox_fbist_run_get_out {
 	u8 txg1_run;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_fbist_run_get(struct cxl_memdev *memdev,
-	u32 fbist_id)
+CXL_EXPORT int cxl_memdev_fbist_run_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 *txg0_run, u8 *txg1_run)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -7849,17 +9169,32 @@ CXL_EXPORT int cxl_memdev_fbist_run_get(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_FBIST_RUN_GET) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_RUN_GET);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	fbist_run_get_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "========================== read run flags of txg[0|1] ==========================\n");
-	fprintf(stdout, "TXG0 Run: %x\n", fbist_run_get_out->txg0_run);
-	fprintf(stdout, "TXG1 Run: %x\n", fbist_run_get_out->txg1_run);
+	*txg0_run = fbist_run_get_out->txg0_run;
+	*txg1_run = fbist_run_get_out->txg1_run;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_fbist_run_get(struct cxl_memdev *memdev,
+	u32 fbist_id)
+{
+	u8 txg0_run, txg1_run;
+	int rc;
+
+	rc = cxl_memdev_fbist_run_get_fetch(memdev, fbist_id, &txg0_run, &txg1_run);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "========================== read run flags of txg[0|1] ==========================\n");
+	fprintf(stdout, "TXG0 Run: %x\n", txg0_run);
+	fprintf(stdout, "TXG1 Run: %x\n", txg1_run);
 	return 0;
 }
 
@@ -8128,8 +9463,8 @@ struct cxl_mbox_fbist_thread_status_get_out {
 	__le16 curr_thread_desc_index;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_fbist_thread_status_get(struct cxl_memdev *memdev,
-	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+CXL_EXPORT int cxl_memdev_fbist_thread_status_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u8 *thread_state, u16 *curr_thread_desc_index)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -8181,17 +9516,34 @@ CXL_EXPORT int cxl_memdev_fbist_thread_status_get(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_FBIST_THREAD_STATUS_GET) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_THREAD_STATUS_GET);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	fbist_thread_status_get_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "========================== read a txg's thread status ==========================\n");
-	fprintf(stdout, "Thread State: %x\n", fbist_thread_status_get_out->thread_state);
-	fprintf(stdout, "curr_thread_desc_index: %x\n", le16_to_cpu(fbist_thread_status_get_out->curr_thread_desc_index));
+	*thread_state = fbist_thread_status_get_out->thread_state;
+	*curr_thread_desc_index = le16_to_cpu(fbist_thread_status_get_out->curr_thread_desc_index);
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_fbist_thread_status_get(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+{
+	u8 thread_state;
+	u16 curr_thread_desc_index;
+	int rc;
+
+	rc = cxl_memdev_fbist_thread_status_get_fetch(memdev, fbist_id, txg_nr, thread_nr,
+			&thread_state, &curr_thread_desc_index);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "========================== read a txg's thread status ==========================\n");
+	fprintf(stdout, "Thread State: %x\n", thread_state);
+	fprintf(stdout, "curr_thread_desc_index: %x\n", curr_thread_desc_index);
 	return 0;
 }
 
@@ -8294,8 +9646,8 @@ struct cxl_mbox_fbist_thread_bandwidth_get_out {
 	__le32 write_bw_cnt;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_fbist_thread_bandwidth_get(struct cxl_memdev *memdev,
-	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+CXL_EXPORT int cxl_memdev_fbist_thread_bandwidth_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u32 *read_bw_cnt, u32 *write_bw_cnt)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -8347,17 +9699,33 @@ CXL_EXPORT int cxl_memdev_fbist_thread_bandwidth_get(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_FBIST_THREAD_BANDWIDTH_GET) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_THREAD_BANDWIDTH_GET);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	fbist_thread_bandwidth_get_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "================= read a txg's thread rd/wr bandwidth counters =================\n");
-	fprintf(stdout, "Read BW Count: %x\n", le32_to_cpu(fbist_thread_bandwidth_get_out->read_bw_cnt));
-	fprintf(stdout, "Write BW Count: %x\n", le32_to_cpu(fbist_thread_bandwidth_get_out->write_bw_cnt));
+	*read_bw_cnt = le32_to_cpu(fbist_thread_bandwidth_get_out->read_bw_cnt);
+	*write_bw_cnt = le32_to_cpu(fbist_thread_bandwidth_get_out->write_bw_cnt);
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_fbist_thread_bandwidth_get(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+{
+	u32 read_bw_cnt, write_bw_cnt;
+	int rc;
+
+	rc = cxl_memdev_fbist_thread_bandwidth_get_fetch(memdev, fbist_id, txg_nr, thread_nr,
+			&read_bw_cnt, &write_bw_cnt);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "================= read a txg's thread rd/wr bandwidth counters =================\n");
+	fprintf(stdout, "Read BW Count: %x\n", read_bw_cnt);
+	fprintf(stdout, "Write BW Count: %x\n", write_bw_cnt);
 	return 0;
 }
 
@@ -8378,8 +9746,8 @@ struct cxl_mbox_fbist_thread_latency_get_out {
 	__le32 write_latency_cnt;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_fbist_thread_latency_get(struct cxl_memdev *memdev,
-	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+CXL_EXPORT int cxl_memdev_fbist_thread_latency_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u32 *read_latency_cnt, u32 *write_latency_cnt)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -8431,17 +9799,33 @@ CXL_EXPORT int cxl_memdev_fbist_thread_latency_get(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_FBIST_THREAD_LATENCY_GET) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_THREAD_LATENCY_GET);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	fbist_thread_latency_get_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "================== read a txg's thread rd/wr latency counters ==================\n");
-	fprintf(stdout, "Read Latency Count: %x\n", le32_to_cpu(fbist_thread_latency_get_out->read_latency_cnt));
-	fprintf(stdout, "Write Latency Count: %x\n", le32_to_cpu(fbist_thread_latency_get_out->write_latency_cnt));
+	*read_latency_cnt = le32_to_cpu(fbist_thread_latency_get_out->read_latency_cnt);
+	*write_latency_cnt = le32_to_cpu(fbist_thread_latency_get_out->write_latency_cnt);
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_fbist_thread_latency_get(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr)
+{
+	u32 read_latency_cnt, write_latency_cnt;
+	int rc;
+
+	rc = cxl_memdev_fbist_thread_latency_get_fetch(memdev, fbist_id, txg_nr, thread_nr,
+			&read_latency_cnt, &write_latency_cnt);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "================== read a txg's thread rd/wr latency counters ==================\n");
+	fprintf(stdout, "Read Latency Count: %x\n", read_latency_cnt);
+	fprintf(stdout, "Write Latency Count: %x\n", write_latency_cnt);
 	return 0;
 }
 
@@ -8624,8 +10008,8 @@ struct cxl_mbox_fbist_top_err_cnt_get_out {
 	__le32 wresp_err_cnt;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_fbist_top_err_cnt_get(struct cxl_memdev *memdev,
-	u32 fbist_id)
+CXL_EXPORT int cxl_memdev_fbist_top_err_cnt_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u32 *rdata_err_cnt, u32 *rresp_err_cnt, u32 *wresp_err_cnt)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -8675,18 +10059,35 @@ CXL_EXPORT int cxl_memdev_fbist_top_err_cnt_get(struct cxl_memdev *memdev,
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_FBIST_TOP_ERR_CNT_GET) {
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_TOP_ERR_CNT_GET);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	fbist_top_err_cnt_get_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "===== read read-dataframe, read-response and write-response error counters =====\n");
-	fprintf(stdout, "Read Data Error Count: %x\n", le32_to_cpu(fbist_top_err_cnt_get_out->rdata_err_cnt));
-	fprintf(stdout, "Read Response Error Count: %x\n", le32_to_cpu(fbist_top_err_cnt_get_out->rresp_err_cnt));
-	fprintf(stdout, "Write Response Error Count: %x\n", le32_to_cpu(fbist_top_err_cnt_get_out->wresp_err_cnt));
+	*rdata_err_cnt = le32_to_cpu(fbist_top_err_cnt_get_out->rdata_err_cnt);
+	*rresp_err_cnt = le32_to_cpu(fbist_top_err_cnt_get_out->rresp_err_cnt);
+	*wresp_err_cnt = le32_to_cpu(fbist_top_err_cnt_get_out->wresp_err_cnt);
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_fbist_top_err_cnt_get(struct cxl_memdev *memdev,
+	u32 fbist_id)
+{
+	u32 rdata_err_cnt, rresp_err_cnt, wresp_err_cnt;
+	int rc;
+
+	rc = cxl_memdev_fbist_top_err_cnt_get_fetch(memdev, fbist_id, &rdata_err_cnt,
+			&rresp_err_cnt, &wresp_err_cnt);
+	if (rc < 0)
+		return rc;
+
+	fprintf(stdout, "===== read read-dataframe, read-response and write-response error counters =====\n");
+	fprintf(stdout, "Read Data Error Count: %x\n", rdata_err_cnt);
+	fprintf(stdout, "Read Response Error Count: %x\n", rresp_err_cnt);
+	fprintf(stdout, "Write Response Error Count: %x\n", wresp_err_cnt);
 	return 0;
 }
 
@@ -8836,7 +10237,7 @@ CXL_EXPORT int cxl_memdev_fbist_test_simpledata(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_TEST_SIMPLEDATA);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -8915,7 +10316,7 @@ CXL_EXPORT int cxl_memdev_fbist_test_addresstest(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_TEST_ADDRESSTEST);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -8997,7 +10398,7 @@ CXL_EXPORT int cxl_memdev_fbist_test_movinginversion(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_TEST_MOVINGINVERSION);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -9081,7 +10482,7 @@ CXL_EXPORT int cxl_memdev_fbist_test_randomsequence(struct cxl_memdev *memdev,
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_FBIST_TEST_RANDOMSEQUENCE);
 		return -EINVAL;
 	}
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 
 out:
 	cxl_cmd_unref(cmd);
@@ -9155,7 +10556,7 @@ CXL_EXPORT int cxl_memdev_conf_read(struct cxl_memdev *memdev,
 		return -EINVAL;
 	}
 
-	fprintf(stdout, "command completed successfully\n");
+	cxl_cmd_done(memdev);
 	conf_read_out = (u8*)cmd->send_cmd->out.payload;
 	fprintf(stdout, "=========================== Read configuration file ============================\n");
 	fprintf(stdout, "Output Payload:");
@@ -9359,6 +10760,121 @@ out:
 	return 0;
 }
 
+#define CXL_HCT_READ_BUFFER_HDR_SIZE \
+	offsetof(struct cxl_mbox_hct_read_buffer_out, buf_entry)
+
+/*
+ * Read the trace buffer of @hct_inst until the firmware reports buf_end,
+ * @timeout_ms elapses or no entry arrives for @idle_ms (0 means no limit
+ * for either), appending the raw entry bytes of every read to @fd. Entry
+ * size depends on the instance type (HIF or FLIT), so the entry bytes are
+ * passed through untouched and the number of entries and bytes is returned
+ * separately. The first read assumes the smallest entry, a dword, and
+ * later reads are sized from the entry size it returned so that each one
+ * asks for as many entries as fit in the mailbox payload.
+ */
+CXL_EXPORT int cxl_memdev_hct_read_buffer_stream(struct cxl_memdev *memdev,
+	u8 hct_inst, int fd, unsigned int timeout_ms, unsigned int idle_ms,
+	u64 *nr_entries, u64 *nr_bytes, u8 *buf_end)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_hct_read_buffer_in *hct_read_buffer_in;
+	struct cxl_mbox_hct_read_buffer_out *hct_read_buffer_out;
+	u64 now, deadline = 0, last_entry;
+	size_t len, max_len, entry_size = sizeof(__le32);
+	int rc = 0;
+
+	*nr_entries = 0;
+	*nr_bytes = 0;
+	*buf_end = 0;
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_HCT_READ_BUFFER_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	cinfo->size_in = CXL_MEM_COMMAND_ID_HCT_READ_BUFFER_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	cmd->send_cmd->in.size = cinfo->size_in;
+
+	hct_read_buffer_in = (void *) cmd->send_cmd->in.payload;
+	hct_read_buffer_in->hct_inst = hct_inst;
+	hct_read_buffer_out = (void *)cmd->send_cmd->out.payload;
+	max_len = cinfo->size_out - CXL_HCT_READ_BUFFER_HDR_SIZE;
+
+	last_entry = util_clock_ms(CLOCK_MONOTONIC);
+	if (timeout_ms)
+		deadline = last_entry + timeout_ms;
+
+	for (;;) {
+		hct_read_buffer_in->num_entries_to_read = min_t(size_t, UCHAR_MAX,
+			max(max_len / entry_size, (size_t)1));
+		cmd->send_cmd->out.size = cinfo->size_out;
+		rc = cxl_cmd_submit(cmd);
+		if (rc < 0) {
+			fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
+					cxl_memdev_get_devname(memdev), rc, strerror(-rc));
+			goto out;
+		}
+
+		rc = cxl_cmd_get_mbox_status(cmd);
+		if (rc != 0) {
+			fprintf(stderr, "%s: firmware status: %d\n",
+					cxl_memdev_get_devname(memdev), rc);
+			rc = -ENXIO;
+			goto out;
+		}
+
+		len = 0;
+		if (cmd->send_cmd->out.size > (int) CXL_HCT_READ_BUFFER_HDR_SIZE)
+			len = cmd->send_cmd->out.size - CXL_HCT_READ_BUFFER_HDR_SIZE;
+		if (len && hct_read_buffer_out->num_buf_entries) {
+			rc = util_write_all(fd, hct_read_buffer_out->buf_entry, len);
+			if (rc) {
+				fprintf(stderr, "%s: write failed: %s\n",
+						cxl_memdev_get_devname(memdev), strerror(-rc));
+				goto out;
+			}
+			*nr_entries += hct_read_buffer_out->num_buf_entries;
+			*nr_bytes += len;
+			entry_size = max(len / hct_read_buffer_out->num_buf_entries,
+				sizeof(__le32));
+		}
+
+		/* past buf_end every read returns the last line again */
+		if (hct_read_buffer_out->buf_end) {
+			*buf_end = 1;
+			break;
+		}
+		now = util_clock_ms(CLOCK_MONOTONIC);
+		if (hct_read_buffer_out->num_buf_entries)
+			last_entry = now;
+		if (deadline && now >= deadline)
+			break;
+		if (idle_ms && now - last_entry >= idle_ms)
+			break;
+		/* capture still running but nothing new yet, don't spin */
+		if (!hct_read_buffer_out->num_buf_entries)
+			usleep(1000);
+	}
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
 #define CXL_MEM_COMMAND_ID_HCT_SET_CONFIG CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_HCT_SET_CONFIG_OPCODE 50690
 #define CXL_MEM_COMMAND_ID_HCT_SET_CONFIG_PAYLOAD_IN_SIZE 136
@@ -9707,6 +11223,119 @@ out:
 	return 0;
 }
 
+#define CXL_OSA_DATA_READ_HDR_SIZE \
+	offsetof(struct cxl_mbox_osa_data_read_out, data)
+
+/*
+ * Read every captured entry of one lane/direction, following next_entry
+ * until the device reports no entries remaining. All reads go through one
+ * command object and ask for as many entries as fit in the mailbox
+ * payload. On success *entries holds the raw (little-endian) entries in
+ * capture order and must be freed by the caller; *wrap is set if older
+ * entries were discarded by a wrap of the capture RAM.
+ */
+CXL_EXPORT int cxl_memdev_osa_data_drain(struct cxl_memdev *memdev,
+	u8 cxl_mem_id, u8 lane_id, u8 lane_dir, u32 **entries, u8 *wrap)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_osa_data_read_in *osa_data_read_in;
+	struct cxl_mbox_osa_data_read_out *osa_data_read_out;
+	u32 *buf = NULL, *tmp;
+	size_t count = 0, alloc = 0, want;
+	u16 next_entry = 0;
+	u8 per_read, read;
+	int rc = 0;
+
+	*entries = NULL;
+	*wrap = 0;
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_OSA_DATA_READ_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	cinfo->size_in = CXL_MEM_COMMAND_ID_OSA_DATA_READ_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	cmd->send_cmd->in.size = cinfo->size_in;
+
+	per_read = min_t(size_t, UCHAR_MAX,
+		(cinfo->size_out - CXL_OSA_DATA_READ_HDR_SIZE) / sizeof(u32));
+
+	osa_data_read_in = (void *) cmd->send_cmd->in.payload;
+	osa_data_read_in->cxl_mem_id = cxl_mem_id;
+	osa_data_read_in->lane_id = lane_id;
+	osa_data_read_in->lane_dir = lane_dir;
+	osa_data_read_in->num_entries = per_read;
+	osa_data_read_out = (void *)cmd->send_cmd->out.payload;
+
+	for (;;) {
+		osa_data_read_in->start_entry = cpu_to_le16(next_entry);
+		cmd->send_cmd->out.size = cinfo->size_out;
+		rc = cxl_cmd_submit(cmd);
+		if (rc < 0) {
+			fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
+					cxl_memdev_get_devname(memdev), rc, strerror(-rc));
+			goto out;
+		}
+
+		rc = cxl_cmd_get_mbox_status(cmd);
+		if (rc != 0) {
+			fprintf(stderr, "%s: firmware status: %d\n",
+					cxl_memdev_get_devname(memdev), rc);
+			rc = -ENXIO;
+			goto out;
+		}
+
+		read = min(osa_data_read_out->entries_read, per_read);
+		*wrap |= osa_data_read_out->wrap;
+
+		/* entries_rem sizes the buffer for the rest of the capture */
+		want = count + read + le16_to_cpu(osa_data_read_out->entries_rem);
+		if (want > alloc) {
+			tmp = realloc(buf, want * sizeof(u32));
+			if (!tmp) {
+				rc = -ENOMEM;
+				goto out;
+			}
+			buf = tmp;
+			alloc = want;
+		}
+		if (read)
+			memcpy(buf + count, osa_data_read_out->data,
+				read * sizeof(u32));
+		count += read;
+
+		/*
+		 * next_entry wraps back to the start of the capture RAM, so
+		 * it cannot be used to detect the end; stop on entries_rem and
+		 * on a read that makes no progress.
+		 */
+		if (!osa_data_read_out->entries_rem || !read)
+			break;
+		next_entry = le16_to_cpu(osa_data_read_out->next_entry);
+	}
+
+	*entries = buf;
+	buf = NULL;
+	rc = count;
+out:
+	free(buf);
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
 #define CXL_MEM_COMMAND_ID_DIMM_SPD_READ CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_DIMM_SPD_READ_OPCODE 50448
 #define CXL_MEM_COMMAND_ID_DIMM_SPD_READ_PAYLOAD_IN_SIZE 12
@@ -9718,6 +11347,7 @@ struct cxl_mbox_dimm_spd_read_in {
 }  __attribute__((packed));
 
 #define SPD_MODULE_SERIAL_NUMBER_LEN (328 - 325 + 1) // 4 Bytes
+#define SPD_SERIAL_NUMBER_OFFSET 325
 
 void static
 IntToString (u8 *String, u8 *Integer, u8 SizeInByte) {
@@ -9852,106 +11482,72 @@ static const char *ram_types[] = {"Unknown",   "Direct Rambus",    "Rambus",
                                   "DDR SGRAM", "DDR SDRAM",        "DDR2", "DDR3",
                                   "DDR4"};
 
+/*
+ * Dump @num_bytes of SPD @spd_id from @offset and decode the module. The
+ * bytes come from cxl_memdev_dimm_spd_fetch(), so a cached SPD costs only
+ * the serial number probe.
+ */
 CXL_EXPORT int cxl_memdev_dimm_spd_read(struct cxl_memdev *memdev,
 	u32 spd_id, u32 offset, u32 num_bytes)
 {
-	struct cxl_cmd *cmd;
-	struct cxl_mem_query_commands *query;
-	struct cxl_command_info *cinfo;
-	struct cxl_mbox_dimm_spd_read_in *dimm_spd_read_in;
-	u8 *dimm_spd_read_out;
+	u8 spd[CXL_DIMM_SPD_SIZE];
 	u8 serial[9];
-	int rc = 0;
+	bool cached;
+	int rc;
 	int buswidth;
 	RamType ram_type;
+	u32 i;
 
-	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DIMM_SPD_READ_OPCODE);
-	if (!cmd) {
-		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
-				cxl_memdev_get_devname(memdev));
-		return -ENOMEM;
-	}
-
-	query = cmd->query_cmd;
-	cinfo = &query->commands[cmd->query_idx];
-
-	/* update payload size */
-	cinfo->size_in = CXL_MEM_COMMAND_ID_DIMM_SPD_READ_PAYLOAD_IN_SIZE;
-	if (cinfo->size_in > 0) {
-		 cmd->input_payload = calloc(1, cinfo->size_in);
-		if (!cmd->input_payload)
-			return -ENOMEM;
-		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
-		cmd->send_cmd->in.size = cinfo->size_in;
-	}
-
-	dimm_spd_read_in = (void *) cmd->send_cmd->in.payload;
-
-	dimm_spd_read_in->spd_id = cpu_to_le32(spd_id);
-	dimm_spd_read_in->offset = cpu_to_le32(offset);
-	dimm_spd_read_in->num_bytes = cpu_to_le32(num_bytes);
-	rc = cxl_cmd_submit(cmd);
-	if (rc < 0) {
-		fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
-				cxl_memdev_get_devname(memdev), rc, strerror(-rc));
-		 goto out;
-	}
-
-	rc = cxl_cmd_get_mbox_status(cmd);
-	if (rc != 0) {
-		fprintf(stderr, "%s: firmware status: %d\n",
-				cxl_memdev_get_devname(memdev), rc);
-		rc = -ENXIO;
-		goto out;
-	}
-
-	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_DIMM_SPD_READ) {
-		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
-				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_DIMM_SPD_READ);
+	if (offset >= CXL_DIMM_SPD_SIZE || num_bytes > CXL_DIMM_SPD_SIZE - offset) {
+		fprintf(stderr, "%s: SPD range %u+%u exceeds %u bytes\n",
+				cxl_memdev_get_devname(memdev), offset, num_bytes,
+				CXL_DIMM_SPD_SIZE);
 		return -EINVAL;
 	}
 
-	dimm_spd_read_out = (u8*)cmd->send_cmd->out.payload;
-	ram_type = decode_ram_type(dimm_spd_read_out);
+	rc = cxl_memdev_dimm_spd_fetch(memdev, spd_id, spd, &cached);
+	if (rc)
+		return rc;
+	dbg(memdev->ctx, "%s: SPD %u %s\n", cxl_memdev_get_devname(memdev),
+		spd_id, cached ? "served from cache" : "read from device");
+
+	ram_type = decode_ram_type(spd);
 
 	fprintf(stdout, "=========================== DIMM SPD READ Data ============================\n");
 	fprintf(stdout, "Output Payload:");
-	for(int i=0; i<cmd->send_cmd->out.size; i++){
+	for (i = 0; i < num_bytes; i++) {
 		if (i % 16 == 0)
 		{
-			fprintf(stdout, "\n%04x  %02x ", i+offset, dimm_spd_read_out[i]);
+			fprintf(stdout, "\n%04x  %02x ", i+offset, spd[offset + i]);
 		}
 		else
 		{
-			fprintf(stdout, "%02x ", dimm_spd_read_out[i]);
+			fprintf(stdout, "%02x ", spd[offset + i]);
 		}
 	}
 	fprintf(stdout, "\n\n");
 
 	// Decoding SPD data for only DDR4 SDRAM.
 
-	buswidth = 8 << (dimm_spd_read_out[13] & 7);
+	buswidth = 8 << (spd[13] & 7);
 
 	fprintf(stdout, "\n\n====== DIMM SPD DECODE ============\n");
 	fprintf(stdout, "Total Width: %s\n", "TBD");
 	fprintf(stdout, "Data Width: %d bits\n", buswidth);
-	fprintf(stdout, "Size: %d GB\n", decode_ddr4_module_size(dimm_spd_read_out));
+	fprintf(stdout, "Size: %d GB\n", decode_ddr4_module_size(spd));
 	fprintf(stdout, "Form Factor: %s\n", "TBD");
 	fprintf(stdout, "Set: %s\n", "TBD");
 	fprintf(stdout, "Locator: %s\n", "DIMM_X");
 	fprintf(stdout, "Bank Locator: %s\n", "_Node1_ChannelX_DimmX");
 	fprintf(stdout, "Type: %s\n", ram_types[ram_type]);
-	fprintf(stdout, "Type Detail: %s\n", decode_ddr4_module_type(dimm_spd_read_out));
-	fprintf(stdout, "Speed: %d MT/s\n", decode_ddr4_module_speed(dimm_spd_read_out));
-	fprintf(stdout, "Manufacturer: %s\n", decode_ddr4_manufacturer(dimm_spd_read_out));
-	IntToString(serial, &dimm_spd_read_out[325], SPD_MODULE_SERIAL_NUMBER_LEN);
+	fprintf(stdout, "Type Detail: %s\n", decode_ddr4_module_type(spd));
+	fprintf(stdout, "Speed: %d MT/s\n", decode_ddr4_module_speed(spd));
+	fprintf(stdout, "Manufacturer: %s\n", decode_ddr4_manufacturer(spd));
+	IntToString(serial, &spd[SPD_SERIAL_NUMBER_OFFSET], SPD_MODULE_SERIAL_NUMBER_LEN);
 	fprintf(stdout, "Serial Number: %s\n", serial);
 	fprintf(stdout, "Asset Tag: %s\n", "TBD");
-
-out:
-	cxl_cmd_unref(cmd);
+
 	return rc;
-	return 0;
 }
 
 #define CXL_MEM_COMMAND_ID_LOG_INFO CXL_MEM_COMMAND_ID_RAW
@@ -9968,7 +11564,10 @@ CXL_EXPORT int cxl_memdev_ddr_training_status(struct cxl_memdev *memdev)
 	u8 *ddr_training_status;
 	int rc = 0;
 	int offset = 0;
+	int payload_max = memdev_payload_max(memdev);
 
+	if (payload_max < 0)
+		return payload_max;
 
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_LOG_INFO_OPCODE);
 	if (!cmd) {
@@ -9992,7 +11591,7 @@ CXL_EXPORT int cxl_memdev_ddr_training_status(struct cxl_memdev *memdev)
 	get_log_input = (void *) cmd->send_cmd->in.payload;
 	uuid_parse(DDR_TRAINING_STATUS_UUID, get_log_input->uuid);
 	get_log_input->offset = 0;
-	get_log_input->length = cmd->memdev->payload_max;
+	get_log_input->length = payload_max;
 
 
 	rc = cxl_cmd_submit(cmd);
@@ -10064,17 +11663,13 @@ struct cxl_dimm_slot_info_out {
 #define CXL_MEM_COMMAND_ID_DIMM_SLOT_INFO_OPCODE 0xC520
 #define CXL_MEM_COMMAND_ID_DIMM_SLOT_INFO_PAYLOAD_IN_SIZE 0
 
-CXL_EXPORT int cxl_memdev_dimm_slot_info(struct cxl_memdev *memdev)
+static int dimm_slot_info_fetch(struct cxl_memdev *memdev,
+	struct cxl_dimm_slot_info_out *info)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
-	struct cxl_dimm_slot_info_out *dimm_slot_info;
-	u8 *dimm_slots;
 	int rc = 0;
-	int offset = 0;
-	int indent = 2;
-	char silk_screen_char;
 
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DIMM_SLOT_INFO_OPCODE);
 	if (!cmd) {
@@ -10113,14 +11708,34 @@ CXL_EXPORT int cxl_memdev_dimm_slot_info(struct cxl_memdev *memdev)
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_DIMM_SLOT_INFO) {
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_DIMM_SLOT_INFO);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
-	dimm_slot_info = (void *)cmd->send_cmd->out.payload;
-	dimm_slots = (u8*)cmd->send_cmd->out.payload;
+	memset(info, 0, sizeof(*info));
+	memcpy(info, (void *)cmd->send_cmd->out.payload,
+		min_t(size_t, cmd->send_cmd->out.size, sizeof(*info)));
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_dimm_slot_info(struct cxl_memdev *memdev)
+{
+	struct cxl_dimm_slot_info_out info, *dimm_slot_info = &info;
+	u8 *dimm_slots = (u8 *)&info;
+	int rc = 0;
+	int offset = 0;
+	int indent = 2;
+	char silk_screen_char;
+
+	rc = dimm_slot_info_fetch(memdev, &info);
+	if (rc)
+		return rc;
+
 	fprintf(stdout, "=========================== DIMM SLOT INFO ============================\n");
 	fprintf(stdout, "Output Payload:\n");
-	for(int i=0; i<cmd->send_cmd->out.size; i++){
+	for(int i=0; i<(int)sizeof(info); i++){
 		if (i % 16 == 0)
 		{
 			fprintf(stdout, "\n%04x  %02x ", i+offset, dimm_slots[i]);
@@ -10162,11 +11777,212 @@ CXL_EXPORT int cxl_memdev_dimm_slot_info(struct cxl_memdev *memdev)
 	fprintf(stdout, "%*sI2C Address: 0x%x\n", indent+2, "", dimm_slot_info->slot3_spd_i2c_addr);
 
 	fprintf(stdout, "\n\n");
+	return rc;
+}
+
+#define SPD_CACHE_DIR "/var/cache/cxl/spd"
+
+/* read @len SPD bytes from @offset in payload_max transfers on one command */
+static int dimm_spd_read_raw(struct cxl_memdev *memdev, u32 spd_id,
+	u32 offset, u32 len, u8 *dst)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_mbox_dimm_spd_read_in *dimm_spd_read_in;
+	u32 done = 0, chunk;
+	int rc = 0;
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DIMM_SPD_READ_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	cinfo->size_in = CXL_MEM_COMMAND_ID_DIMM_SPD_READ_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	dimm_spd_read_in = (void *) cmd->send_cmd->in.payload;
+	dimm_spd_read_in->spd_id = cpu_to_le32(spd_id);
+
+	while (done < len) {
+		chunk = min_t(u32, len - done, cinfo->size_out);
+		dimm_spd_read_in->offset = cpu_to_le32(offset + done);
+		dimm_spd_read_in->num_bytes = cpu_to_le32(chunk);
+		rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_DIMM_SPD_READ_OPCODE,
+			CXL_MEM_COMMAND_ID_DIMM_SPD_READ_PAYLOAD_IN_SIZE);
+		if (rc < 0)
+			goto out;
+		if (cmd->send_cmd->out.size < (int) chunk) {
+			fprintf(stderr, "%s: short SPD read at offset %u\n",
+				cxl_memdev_get_devname(memdev), offset + done);
+			rc = -EIO;
+			goto out;
+		}
+		memcpy(dst + done, (void *)cmd->send_cmd->out.payload, chunk);
+		done += chunk;
+	}
+
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
 }
 
+static int spd_cache_load(const char *path, u8 *spd, const u8 *sn)
+{
+	ssize_t n;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return -errno;
+	n = read(fd, spd, CXL_DIMM_SPD_SIZE);
+	close(fd);
+	if (n != CXL_DIMM_SPD_SIZE || memcmp(spd + SPD_SERIAL_NUMBER_OFFSET, sn,
+			SPD_MODULE_SERIAL_NUMBER_LEN) != 0)
+		return -ESTALE;
+	return 0;
+}
+
+/*
+ * Best effort: a missing or read-only cache directory only costs the next
+ * caller a full SPD read. Entries left behind by a module that used to sit
+ * in the same slot are dropped, and the new one is renamed into place so a
+ * concurrent reader never sees a partial file.
+ */
+static void spd_cache_store(struct cxl_memdev *memdev, u32 spd_id,
+	const char *path, const u8 *spd)
+{
+	struct cxl_ctx *ctx = memdev->ctx;
+	char tmp[PATH_MAX], pattern[PATH_MAX];
+	glob_t stale;
+	size_t i;
+	int fd;
+
+	if ((mkdir("/var/cache/cxl", 0755) < 0 && errno != EEXIST) ||
+	    (mkdir(SPD_CACHE_DIR, 0755) < 0 && errno != EEXIST)) {
+		dbg(ctx, "%s: no SPD cache: %s\n", cxl_memdev_get_devname(memdev),
+			strerror(errno));
+		return;
+	}
+
+	snprintf(pattern, sizeof(pattern), SPD_CACHE_DIR "/%016llx-%u-*.spd",
+		cxl_memdev_get_serial(memdev), spd_id);
+	if (glob(pattern, 0, NULL, &stale) == 0) {
+		for (i = 0; i < stale.gl_pathc; i++)
+			unlink(stale.gl_pathv[i]);
+		globfree(&stale);
+	}
+
+	snprintf(tmp, sizeof(tmp), "%s.XXXXXX", path);
+	fd = mkstemp(tmp);
+	if (fd < 0) {
+		dbg(ctx, "%s: %s: %s\n", cxl_memdev_get_devname(memdev), tmp,
+			strerror(errno));
+		return;
+	}
+	if (write(fd, spd, CXL_DIMM_SPD_SIZE) != CXL_DIMM_SPD_SIZE ||
+	    fchmod(fd, 0644) < 0 || close(fd) < 0 || rename(tmp, path) < 0) {
+		dbg(ctx, "%s: failed to cache SPD %u\n",
+			cxl_memdev_get_devname(memdev), spd_id);
+		unlink(tmp);
+	}
+}
+
+/*
+ * Return the CXL_DIMM_SPD_SIZE bytes of SPD @spd_id. Entries under
+ * SPD_CACHE_DIR are keyed by memdev serial, SPD index and module serial
+ * number; the 4-byte serial number is probed first and a matching entry
+ * is used instead of a full read over the sideband. Devices that do not
+ * report a serial number are never cached.
+ */
+CXL_EXPORT int cxl_memdev_dimm_spd_fetch(struct cxl_memdev *memdev,
+	u32 spd_id, u8 *spd, bool *cached)
+{
+	u8 sn[SPD_MODULE_SERIAL_NUMBER_LEN];
+	u8 serial[SPD_MODULE_SERIAL_NUMBER_LEN * 2 + 1];
+	char path[PATH_MAX];
+	int rc;
+
+	*cached = false;
+	if (cxl_memdev_get_serial(memdev) == ULLONG_MAX)
+		return dimm_spd_read_raw(memdev, spd_id, 0, CXL_DIMM_SPD_SIZE, spd);
+
+	rc = dimm_spd_read_raw(memdev, spd_id, SPD_SERIAL_NUMBER_OFFSET,
+			SPD_MODULE_SERIAL_NUMBER_LEN, sn);
+	if (rc)
+		return rc;
+	IntToString(serial, sn, SPD_MODULE_SERIAL_NUMBER_LEN);
+	snprintf(path, sizeof(path), SPD_CACHE_DIR "/%016llx-%u-%s.spd",
+		cxl_memdev_get_serial(memdev), spd_id, serial);
+	if (spd_cache_load(path, spd, sn) == 0) {
+		*cached = true;
+		return 0;
+	}
+
+	rc = dimm_spd_read_raw(memdev, spd_id, 0, CXL_DIMM_SPD_SIZE, spd);
+	if (rc)
+		return rc;
+	/* don't file a module swapped since the probe under the old serial */
+	if (memcmp(spd + SPD_SERIAL_NUMBER_OFFSET, sn,
+			SPD_MODULE_SERIAL_NUMBER_LEN) == 0)
+		spd_cache_store(memdev, spd_id, path, spd);
+	return 0;
+}
+
+/*
+ * Decode every populated DIMM slot into @dimms (at most @max entries),
+ * going through the SPD cache. Returns the number of DIMMs found.
+ */
+CXL_EXPORT int cxl_memdev_dimm_inventory(struct cxl_memdev *memdev,
+	struct cxl_dimm_inventory *dimms, int max)
+{
+	struct cxl_dimm_slot_info_out info;
+	const int stride = &info.slot1_spd_i2c_addr - &info.slot0_spd_i2c_addr;
+	u8 spd[CXL_DIMM_SPD_SIZE], *slot;
+	struct cxl_dimm_inventory *d;
+	int nr_slots, i, n = 0, rc;
+
+	rc = dimm_slot_info_fetch(memdev, &info);
+	if (rc)
+		return rc;
+
+	nr_slots = min_t(int, info.num_dimm_slots, CXL_DIMM_MAX_SLOTS);
+	for (i = 0; i < nr_slots && n < max; i++) {
+		/* i2c address, channel id, silk screen, present */
+		slot = &info.slot0_spd_i2c_addr + i * stride;
+		if (!slot[3])
+			continue;
+
+		d = &dimms[n];
+		memset(d, 0, sizeof(*d));
+		rc = cxl_memdev_dimm_spd_fetch(memdev, i, spd, &d->cached);
+		if (rc)
+			return rc;
+
+		d->spd_id = i;
+		d->channel_id = slot[1];
+		d->silk_screen = slot[2];
+		d->ram_type = ram_types[decode_ram_type(spd)];
+		d->module_type = decode_ddr4_module_type(spd);
+		d->manufacturer = decode_ddr4_manufacturer(spd);
+		d->size_gb = decode_ddr4_module_size(spd);
+		d->speed_mts = decode_ddr4_module_speed(spd);
+		IntToString((u8 *)d->serial, spd + SPD_SERIAL_NUMBER_OFFSET,
+			SPD_MODULE_SERIAL_NUMBER_LEN);
+		n++;
+	}
+	return n;
+}
+
 #define MAX_PMIC 8
 #define PMIC_NAME_MAX_SIZE 20
 
@@ -10329,7 +12145,8 @@ struct cxl_ddr_margin_status_out {
 	int run_status;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_ddr_margin_status(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_ddr_margin_status_fetch(struct cxl_memdev *memdev,
+	int *running)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -10375,17 +12192,30 @@ CXL_EXPORT int cxl_memdev_ddr_margin_status(struct cxl_memdev *memdev)
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				CXL_MEM_COMMAND_ID_DDR_MARGIN_SW_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	ddr_margin_status_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "%s\n", ddr_margin_status_out->run_status ?
-			"DDR MARGIN IS RUNNING" : "DDR MARGIN IS NOT RUNNING/FINISHED");
+	*running = ddr_margin_status_out->run_status;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
 }
 
+CXL_EXPORT int cxl_memdev_ddr_margin_status(struct cxl_memdev *memdev)
+{
+	int running, rc;
+
+	rc = cxl_memdev_ddr_margin_status_fetch(memdev, &running);
+	if (rc != 0)
+		return rc;
+
+	fprintf(stdout, "%s\n", running ?
+			"DDR MARGIN IS RUNNING" : "DDR MARGIN IS NOT RUNNING/FINISHED");
+	return 0;
+}
+
 #define CXL_MEM_COMMAND_ID_DDR_MARGIN_GET_SW CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_DDR_MARGIN_GET_SW_OPCODE 0xFB0C
 
@@ -10410,15 +12240,24 @@ struct cxl_ddr_margin_get_sw_out
   struct ddr_margin_info ddr_margin_slice_data[MAX_NUM_ROWS * MAX_MARGIN_BIT_COUNT];
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_ddr_margin_get(struct cxl_memdev *memdev)
+/*
+ * Decode the rows of the last margin run into @windows, allocated here and
+ * released by the caller with free(). The row count is clamped to what the
+ * returned payload actually holds. Returns the number of windows.
+ */
+CXL_EXPORT int cxl_memdev_ddr_margin_get_fetch(struct cxl_memdev *memdev,
+	struct cxl_ddr_margin_window **windows)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
 	struct cxl_ddr_margin_get_sw_out *ddr_margin_get_sw_out;
+	struct cxl_ddr_margin_window *w;
+	struct ddr_margin_info *row;
+	u32 i, nr_rows;
 	int rc = 0;
-	uint32_t i;
 
+	*windows = NULL;
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DDR_MARGIN_GET_SW_OPCODE);
 	if (!cmd) {
 		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
@@ -10457,28 +12296,203 @@ CXL_EXPORT int cxl_memdev_ddr_margin_get(struct cxl_memdev *memdev)
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				CXL_MEM_COMMAND_ID_DDR_MARGIN_GET_SW);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	ddr_margin_get_sw_out = (struct cxl_ddr_margin_get_sw_out *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "SliceNo,bitNo, VrefLv, MinDelay, MaxDelay, MinDly(ps), MaxDly(ps)\n");
+	nr_rows = 0;
+	if (cmd->send_cmd->out.size > (int) sizeof(u32))
+		nr_rows = min_t(u32, ddr_margin_get_sw_out->row_count,
+			(cmd->send_cmd->out.size - sizeof(u32)) /
+			sizeof(struct ddr_margin_info));
+	if (!nr_rows)
+		goto out;
 
-	for(i = 0; i < ddr_margin_get_sw_out->row_count; i++)
-	{
-			fprintf(stdout, "%d,%d,%d,%d,%d,%3.2f,%3.2f\n",
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].slicenumber,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].bitnumber,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].vreflevel,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].margin_low,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].margin_high,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].min_delay_ps,
-					ddr_margin_get_sw_out->ddr_margin_slice_data[i].max_delay_ps);
+	w = calloc(nr_rows, sizeof(*w));
+	if (!w) {
+		rc = -ENOMEM;
+		goto out;
 	}
+	for (i = 0; i < nr_rows; i++) {
+		row = &ddr_margin_get_sw_out->ddr_margin_slice_data[i];
+		w[i].slice = row->slicenumber;
+		w[i].bit = row->bitnumber;
+		w[i].vref_level = row->vreflevel;
+		w[i].margin_low = row->margin_low;
+		w[i].margin_high = row->margin_high;
+		w[i].min_delay_ps = row->min_delay_ps;
+		w[i].max_delay_ps = row->max_delay_ps;
+	}
+	*windows = w;
+	rc = nr_rows;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
 }
 
+CXL_EXPORT int cxl_memdev_ddr_margin_get(struct cxl_memdev *memdev)
+{
+	struct cxl_ddr_margin_window *w;
+	int nr, i;
+
+	nr = cxl_memdev_ddr_margin_get_fetch(memdev, &w);
+	if (nr < 0)
+		return nr;
+
+	fprintf(stdout, "SliceNo,bitNo, VrefLv, MinDelay, MaxDelay, MinDly(ps), MaxDly(ps)\n");
+	for (i = 0; i < nr; i++)
+		fprintf(stdout, "%d,%d,%d,%d,%d,%3.2f,%3.2f\n",
+				w[i].slice, w[i].bit, w[i].vref_level,
+				w[i].margin_low, w[i].margin_high,
+				w[i].min_delay_ps, w[i].max_delay_ps);
+	free(w);
+	return 0;
+}
+
+#define DDR_MARGIN_POLL_MIN_MS 10
+#define DDR_MARGIN_POLL_MAX_MS 1000
+/* every ddr id x rd/wr margin x slice a u8/u8/u32 mask can select */
+#define DDR_MARGIN_MAX_POINTS (8 * 8 * 32)
+
+struct ddr_margin_point {
+	u8 ddr_id, rd_wr_margin, slice;
+};
+
+struct ddr_margin_exec {
+	int next;
+	bool running;
+	u64 started;
+};
+
+static int ddr_margin_collect(struct cxl_memdev *memdev,
+	const struct ddr_margin_point *pt, struct cxl_ddr_margin_result *res)
+{
+	struct cxl_ddr_margin_window *w, *all;
+	int nr, i;
+
+	nr = cxl_memdev_ddr_margin_get_fetch(memdev, &w);
+	if (nr <= 0)
+		return nr;
+
+	all = realloc(res->windows, (res->nr_windows + nr) * sizeof(*all));
+	if (!all) {
+		free(w);
+		return -ENOMEM;
+	}
+	for (i = 0; i < nr; i++) {
+		w[i].ddr_id = pt->ddr_id;
+		w[i].rd_wr_margin = pt->rd_wr_margin;
+	}
+	memcpy(all + res->nr_windows, w, nr * sizeof(*w));
+	res->windows = all;
+	res->nr_windows += nr;
+	free(w);
+	return 0;
+}
+
+/*
+ * Sweep every (ddr id, rd/wr margin, slice) point selected by the masks on
+ * all of @memdevs and collect the margin windows into @results, one entry
+ * per memdev. The devices are driven concurrently: each idle device is
+ * started on its next point, the running ones are polled with an interval
+ * that starts at DDR_MARGIN_POLL_MIN_MS and doubles while nothing completes,
+ * and a finished point is read back before the next one is started. A
+ * device that fails or exceeds @timeout_ms on a point stops sweeping and
+ * reports the error in its result; the others carry on. Windows are
+ * released by the caller with free(). Returns 0 or the first error seen.
+ */
+CXL_EXPORT int cxl_memdev_ddr_margin_execute(struct cxl_memdev **memdevs,
+	int nr_memdevs, u32 slice_mask, u8 rd_wr_mask, u8 ddr_mask,
+	unsigned int timeout_ms, struct cxl_ddr_margin_result *results)
+{
+	struct ddr_margin_point *points;
+	struct ddr_margin_exec *exec;
+	struct cxl_memdev *memdev;
+	int nr_points = 0, busy, running, rc = 0, i, d, m, s;
+	unsigned int interval = DDR_MARGIN_POLL_MIN_MS;
+	bool progress;
+
+	points = calloc(DDR_MARGIN_MAX_POINTS, sizeof(*points));
+	exec = calloc(nr_memdevs, sizeof(*exec));
+	if (!points || !exec) {
+		free(points);
+		free(exec);
+		return -ENOMEM;
+	}
+	for (d = 0; d < 8; d++)
+		for (m = 0; m < 8; m++)
+			for (s = 0; s < 32; s++)
+				if ((ddr_mask & (1u << d)) &&
+				    (rd_wr_mask & (1u << m)) &&
+				    (slice_mask & (1u << s)))
+					points[nr_points++] = (struct ddr_margin_point) {
+						d, m, s };
+
+	for (i = 0; i < nr_memdevs; i++) {
+		results[i].memdev = memdevs[i];
+		results[i].status = 0;
+		results[i].nr_windows = 0;
+		results[i].windows = NULL;
+	}
+
+	do {
+		busy = 0;
+		progress = false;
+		for (i = 0; i < nr_memdevs; i++) {
+			memdev = memdevs[i];
+			if (results[i].status)
+				continue;
+			if (exec[i].running) {
+				results[i].status =
+					cxl_memdev_ddr_margin_status_fetch(memdev, &running);
+				if (results[i].status)
+					continue;
+				if (running) {
+					if (timeout_ms && util_clock_ms(CLOCK_MONOTONIC) - exec[i].started >
+							timeout_ms)
+						results[i].status = -ETIMEDOUT;
+					else
+						busy++;
+					continue;
+				}
+				exec[i].running = false;
+				progress = true;
+				results[i].status = ddr_margin_collect(memdev,
+					&points[exec[i].next++], &results[i]);
+				if (results[i].status)
+					continue;
+			}
+			if (exec[i].next >= nr_points)
+				continue;
+			results[i].status = cxl_memdev_ddr_margin_run(memdev,
+				points[exec[i].next].slice,
+				points[exec[i].next].rd_wr_margin,
+				points[exec[i].next].ddr_id);
+			if (results[i].status)
+				continue;
+			exec[i].running = true;
+			exec[i].started = util_clock_ms(CLOCK_MONOTONIC);
+			busy++;
+		}
+		if (!busy)
+			break;
+		interval = progress ? DDR_MARGIN_POLL_MIN_MS :
+			min_t(unsigned int, interval * 2, DDR_MARGIN_POLL_MAX_MS);
+		usleep(interval * 1000);
+	} while (1);
+
+	for (i = 0; i < nr_memdevs; i++) {
+		if (results[i].status > 0)
+			results[i].status = -ENXIO;
+		if (results[i].status && !rc)
+			rc = results[i].status;
+	}
+	free(exec);
+	free(points);
+	return rc;
+}
+
 /* DDR STATS START */
 #define CXL_MEM_COMMAND_ID_DDR_STATS_RUN CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_DDR_STATS_RUN_OPCODE 0xFB1B
@@ -10560,7 +12574,8 @@ struct cxl_ddr_stats_status_out {
 }  __attribute__((packed));
 
 /* DDR STATS STATUS */
-CXL_EXPORT int cxl_memdev_ddr_stats_status(struct cxl_memdev *memdev, int* run_status, uint32_t* loop_count)
+CXL_EXPORT int cxl_memdev_ddr_stats_status_fetch(struct cxl_memdev *memdev,
+	int *run_status, uint32_t *loop_count)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -10607,131 +12622,71 @@ CXL_EXPORT int cxl_memdev_ddr_stats_status(struct cxl_memdev *memdev, int* run_s
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				CXL_MEM_COMMAND_ID_DDR_STATS_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	ddr_stats_status_out = (void *)cmd->send_cmd->out.payload;
 	*run_status = ddr_stats_status_out->run_status;
 	*loop_count = ddr_stats_status_out->loop_count;
-
-	fprintf(stdout, "%s\n", ddr_stats_status_out->run_status ?
-			"DDR STATS IS BUSY" : "DDR STATS IS NOT RUNNING/FINISHED");
-
-	fprintf(stdout, "Loop Count = %d\n", ddr_stats_status_out->loop_count);
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
 }
 
-#define CXL_MEM_COMMAND_ID_DDR_STATS_GET CXL_MEM_COMMAND_ID_RAW
-#define CXL_MEM_COMMAND_ID_DDR_STATS_GET_OPCODE 0xFB1D
-
-#define NUM_BANK 16
-#define NUM_CS 4
-
-struct dfi_cs_pm {
-  uint32_t mrw_cnt;
-  uint32_t refresh_cnt;
-  uint32_t act_cnt;
-  uint32_t write_cnt;
-  uint32_t read_cnt;
-  uint32_t pre_cnt;
-  uint32_t rr_cnt;
-  uint32_t ww_cnt;
-  uint32_t rw_cnt;
-} __attribute__((packed));
-
-struct dfi_cs_bank_pm {
-  uint32_t bank_act_cnt;
-  uint32_t bank_wr_cnt;
-  uint32_t bank_rd_cnt;
-  uint32_t bank_pre_cnt;
-} __attribute__((packed));
+CXL_EXPORT int cxl_memdev_ddr_stats_status(struct cxl_memdev *memdev, int* run_status, uint32_t* loop_count)
+{
+	int rc;
 
-struct dfi_mc_pm {
-  uint32_t cmd_queue_full_events;
-  uint32_t info_fifo_full_events;
-  uint32_t wrdata_hold_fifo_full_events;
-  uint32_t port_cmd_fifo0_full_events;
-  uint32_t port_wrresp_fifo0_full_events;
-  uint32_t port_wr_fifo0_full_events;
-  uint32_t port_rd_fifo0_full_events;
-  uint32_t port_cmd_fifo1_full_events;
-  uint32_t port_wrresp_fifo1_full_events;
-  uint32_t port_wr_fifo1_full_events;
-  uint32_t port_rd_fifo1_full_events;
-  uint32_t ecc_dataout_corrected;
-  uint32_t ecc_dataout_uncorrected;
-  uint32_t pd_ex;
-  uint32_t pd_en;
-  uint32_t srex;
-  uint32_t sren;
-  uint32_t write;
-  uint32_t read;
-  uint32_t rmw;
-  uint32_t bank_act;
-  uint32_t precharge;
-  uint32_t precharge_all;
-  uint32_t mrw;
-  uint32_t auto_ref;
-  uint32_t rw_auto_pre;
-  uint32_t zq_cal_short;
-  uint32_t zq_cal_long;
-  uint32_t same_addr_ww_collision;
-  uint32_t same_addr_wr_collision;
-  uint32_t same_addr_rw_collision;
-  uint32_t same_addr_rr_collision;
-} __attribute__((packed));
+	rc = cxl_memdev_ddr_stats_status_fetch(memdev, run_status, loop_count);
+	if (rc != 0)
+		return rc;
 
-struct ddr_pmon_data {
-  uint64_t fr_cnt;
-  uint32_t idle_cnt;
-  uint32_t rd_ot_cnt;
-  uint32_t wr_ot_cnt;
-  uint32_t wrd_ot_cnt;
-  uint32_t rd_cmd_cnt;
-  uint32_t rd_cmd_busy_cnt;
-  uint32_t wr_cmd_cnt;
-  uint32_t wr_cmd_busy_cnt;
-  uint32_t rd_data_cnt;
-  uint32_t rd_data_busy_cnt;
-  uint32_t wr_data_cnt;
-  uint32_t wr_data_busy_cnt;
-  uint64_t rd_avg_lat;
-  uint64_t wr_avg_lat;
-  uint32_t rd_trans_smpl_cnt;
-  uint32_t wr_trans_smpl_cnt;
-} __attribute__((packed));
+	fprintf(stdout, "%s\n", *run_status ?
+			"DDR STATS IS BUSY" : "DDR STATS IS NOT RUNNING/FINISHED");
 
-struct ddr_data {
-  struct ddr_pmon_data pmon;
-  struct dfi_cs_pm cs_pm[NUM_CS];
-  struct dfi_cs_bank_pm cs_bank_pm[NUM_CS][NUM_BANK];
-  struct dfi_mc_pm mc_pm;
-} __attribute__((packed));
+	fprintf(stdout, "Loop Count = %d\n", *loop_count);
+	return 0;
+}
 
-struct ddr_stats_data {
-  struct ddr_data stats;
-} __attribute__((packed));
+#define CXL_MEM_COMMAND_ID_DDR_STATS_GET CXL_MEM_COMMAND_ID_RAW
+#define CXL_MEM_COMMAND_ID_DDR_STATS_GET_OPCODE 0xFB1D
 
-typedef struct ddr_stats_data ddr_stats_data_t;
+/*
+ * The legacy text dump tags rows with "[iteration]"; the CSV form prepends
+ * plain memdev, snapshot and iteration columns so successive --loop
+ * snapshots of several memdevs can be concatenated into one table.
+ */
+static void ddr_stats_hdr_prefix(FILE *fp, int snapshot)
+{
+  if (snapshot >= 0)
+    fprintf(fp, "memdev, snapshot, ");
+}
 
-#define MAX_CXL_TRANSFER_SZ (16 * 1024)
+static void ddr_stats_row_prefix(FILE *fp, const char *devname, int snapshot,
+    uint32_t loop)
+{
+  if (snapshot < 0)
+    fprintf(fp, "[%d], ", loop);
+  else
+    fprintf(fp, "%s, %d, %u, ", devname, snapshot, loop);
+}
 
-static void display_pmon_stats(ddr_stats_data_t* disp_stats, uint32_t loop_count) {
+static void display_pmon_stats(FILE *fp, const char *devname, int snapshot, ddr_stats_data_t* disp_stats, uint32_t loop_count) {
   uint32_t loop;
-  fprintf(stderr,"PMON STATS:\n");
-  fprintf(stderr,
+  fprintf(fp,"PMON STATS:\n");
+  ddr_stats_hdr_prefix(fp, snapshot);
+  fprintf(fp,
       "iteration, fr_cnt, idle_cnt, rd_ot_cnt, wr_ot_cnt, wrd_ot_cnt, "
       "rd_cmd_cnt, rd_cmd_busy_cnt, wr_cmd_cnt, wr_cmd_busy_cnt, rd_data_cnt, "
       "rd_data_busy_cnt, wr_data_cnt, wr_data_busy_cnt, "
       "rd_avg_lat, wr_avg_lat, rd_trans_smpl_cnt, wr_trans_smpl_cnt\n");
   for (loop = 0; loop < loop_count; loop++) {
-    fprintf(stderr,
-        "[%d], %lu, %u, %u, %u, %u, "
+    ddr_stats_row_prefix(fp, devname, snapshot, loop);
+    fprintf(fp,
+        "%lu, %u, %u, %u, %u, "
         "%u, %u, %u, %u, %u, "
         "%u, %u, %u, "
         "%lu, %lu, %u, %u\n",
-        loop,
         disp_stats->stats.pmon.fr_cnt,
         disp_stats->stats.pmon.idle_cnt,
         disp_stats->stats.pmon.rd_ot_cnt,
@@ -10751,23 +12706,24 @@ static void display_pmon_stats(ddr_stats_data_t* disp_stats, uint32_t loop_count
         disp_stats->stats.pmon.wr_trans_smpl_cnt);
     disp_stats++;
   }
-  fprintf(stderr,"\n");
+  fprintf(fp,"\n");
 }
 
-static void display_cs_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_count) {
+static void display_cs_pm_stats(FILE *fp, const char *devname, int snapshot, ddr_stats_data_t* disp_stats, uint32_t loop_count) {
   uint32_t rank, loop;
 
-  fprintf(stderr, "CS PM STATS:\n");
-  fprintf(stderr,
+  fprintf(fp, "CS PM STATS:\n");
+  ddr_stats_hdr_prefix(fp, snapshot);
+  fprintf(fp,
       "iteration, rank, mrw_cnt, refresh_cnt, act_cnt, write_cnt, "
-      "read_cnt, pre_cnt, rr_cnt, ww_cnt, rw_cnt\n ");
+      "read_cnt, pre_cnt, rr_cnt, ww_cnt, rw_cnt\n");
 
   for (loop = 0; loop < loop_count; loop++) {
     for (rank = 0; rank < NUM_CS; rank++) {
-      fprintf(stderr,
-          "[%d], %d, %u, %u, %u, %u, "
+      ddr_stats_row_prefix(fp, devname, snapshot, loop);
+      fprintf(fp,
+          "%d, %u, %u, %u, %u, "
           "%u, %u, %u, %u, %u\n",
-          loop,
           rank,
           disp_stats->stats.cs_pm[rank].mrw_cnt,
           disp_stats->stats.cs_pm[rank].refresh_cnt,
@@ -10781,21 +12737,22 @@ static void display_cs_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_coun
     }
     disp_stats++;
   }
-  fprintf(stderr, "\n");
+  fprintf(fp, "\n");
 }
 
-static void display_cs_bank_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_count) {
+static void display_cs_bank_pm_stats(FILE *fp, const char *devname, int snapshot, ddr_stats_data_t* disp_stats, uint32_t loop_count) {
   uint32_t rank, bank, loop;
 
-  fprintf(stderr, "CS BANK STATS:\n");
-  fprintf(stderr,
+  fprintf(fp, "CS BANK STATS:\n");
+  ddr_stats_hdr_prefix(fp, snapshot);
+  fprintf(fp,
       "iteration, rank, bank, bank_act_cnt, bank_wr_cnt, bank_rd_cnt, bank_pre_cnt\n");
   for (loop = 0; loop < loop_count; loop++) {
     for (rank = 0; rank < NUM_CS; rank++) {
       for (bank = 0; bank < NUM_BANK; bank++) {
-        fprintf(stderr,
-            "[%d], %d, %d, %u, %u, %u, %u\n",
-            loop,
+        ddr_stats_row_prefix(fp, devname, snapshot, loop);
+        fprintf(fp,
+            "%d, %d, %u, %u, %u, %u\n",
             rank,
             bank,
             disp_stats->stats.cs_bank_pm[rank][bank].bank_act_cnt,
@@ -10806,14 +12763,15 @@ static void display_cs_bank_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop
     }
     disp_stats++;
   }
-  fprintf(stderr, "\n");
+  fprintf(fp, "\n");
 }
 
-static void display_mc_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_count) {
+static void display_mc_pm_stats(FILE *fp, const char *devname, int snapshot, ddr_stats_data_t* disp_stats, uint32_t loop_count) {
   uint32_t loop;
 
-  fprintf(stderr, "PM STATS:\n");
-  fprintf(stderr,
+  fprintf(fp, "PM STATS:\n");
+  ddr_stats_hdr_prefix(fp, snapshot);
+  fprintf(fp,
       "iteration, cmd_queue_full_events, info_fifo_full_events, "
       "wrdata_hold_fifo_full_events, port_cmd_fifo0_full_events, "
       "port_wrresp_fifo0_full_events, port_wr_fifo0_full_events, "
@@ -10827,8 +12785,9 @@ static void display_mc_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_coun
       "same_addr_rw_collision, same_addr_rr_collision\n");
 
   for (loop = 0; loop < loop_count; loop++) {
-    fprintf(stderr,
-        "[%d], %u, %u, "
+    ddr_stats_row_prefix(fp, devname, snapshot, loop);
+    fprintf(fp,
+        "%u, %u, "
         "%u, %u, "
         "%u, %u, "
         "%u, %u, "
@@ -10839,7 +12798,6 @@ static void display_mc_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_coun
         "%u, %u, %u, %u, %u,"
         "%u, %u, "
         "%u, %u\n",
-        loop,
         disp_stats->stats.mc_pm.cmd_queue_full_events,
         disp_stats->stats.mc_pm.info_fifo_full_events,
         disp_stats->stats.mc_pm.wrdata_hold_fifo_full_events,
@@ -10874,7 +12832,7 @@ static void display_mc_pm_stats(ddr_stats_data_t* disp_stats, uint32_t loop_coun
         disp_stats->stats.mc_pm.same_addr_rr_collision);
     disp_stats++;
   }
-  fprintf(stderr, "\n");
+  fprintf(fp, "\n");
 }
 
 struct cxl_ddr_stats_get_in {
@@ -10884,105 +12842,139 @@ struct cxl_ddr_stats_get_in {
 
 #define CXL_MEM_COMMAND_ID_DDR_STATS_GET_PAYLOAD_IN_SIZE 8
 
-static int cxl_ddr_stats_get(struct cxl_memdev *memdev, unsigned char *dst, int offset, int bytes_to_cpy)
+/*
+ * Pull @loop_count snapshots of the last ddr-stats-run into a buffer
+ * allocated here, in payload_max sized transfers on a single command.
+ */
+static int ddr_stats_fetch(struct cxl_memdev *memdev, uint32_t loop_count,
+	ddr_stats_data_t **stats)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
 	struct cxl_ddr_stats_get_in *ddr_stats_get_in;
+	size_t total_bytes, bytes_copied = 0, bytes_to_cpy;
+	unsigned char *buf;
 	int rc = 0;
 
+	*stats = NULL;
+	total_bytes = sizeof(ddr_stats_data_t) * loop_count;
+	if (!total_bytes)
+		return 0;
+
+	buf = malloc(total_bytes);
+	if (!buf)
+		return -ENOMEM;
+
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DDR_STATS_GET_OPCODE);
 	if (!cmd) {
 		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
 				cxl_memdev_get_devname(memdev));
+		free(buf);
 		return -ENOMEM;
 	}
 
 	query = cmd->query_cmd;
 	cinfo = &query->commands[cmd->query_idx];
 
-	/* update payload size */
 	cinfo->size_in = CXL_MEM_COMMAND_ID_DDR_STATS_GET_PAYLOAD_IN_SIZE;
-	if (cinfo->size_in > 0) {
-		 cmd->input_payload = calloc(1, cinfo->size_in);
-		if (!cmd->input_payload)
-			return -ENOMEM;
-		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
-		cmd->send_cmd->in.size = cinfo->size_in;
-	}
-
-	ddr_stats_get_in = (void *) cmd->send_cmd->in.payload;
-	ddr_stats_get_in->offset = offset;
-	ddr_stats_get_in->transfer_sz = bytes_to_cpy;
-	rc = cxl_cmd_submit(cmd);
-	if (rc < 0) {
-		fprintf(stderr, "%s: cmd submission failed: %d (%s)\n",
-				cxl_memdev_get_devname(memdev), rc, strerror(-rc));
-		 goto out;
-	}
-
-	rc = cxl_cmd_get_mbox_status(cmd);
-	if (rc != 0) {
-		fprintf(stderr, "%s: firmware status: %d\n",
-				cxl_memdev_get_devname(memdev), rc);
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
 		goto out;
 	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	ddr_stats_get_in = (void *) cmd->send_cmd->in.payload;
 
-	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_DDR_STATS_GET) {
-		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
-				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
-				CXL_MEM_COMMAND_ID_DDR_STATS_GET);
-		return -EINVAL;
+	while (bytes_copied < total_bytes) {
+		bytes_to_cpy = min_t(size_t, total_bytes - bytes_copied,
+			cinfo->size_out);
+		ddr_stats_get_in->offset = bytes_copied;
+		ddr_stats_get_in->transfer_sz = bytes_to_cpy;
+		rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_DDR_STATS_GET_OPCODE,
+			CXL_MEM_COMMAND_ID_DDR_STATS_GET_PAYLOAD_IN_SIZE);
+		if (rc < 0)
+			goto out;
+		if (cmd->send_cmd->out.size < (int) bytes_to_cpy) {
+			fprintf(stderr, "%s: short ddr stats transfer at offset %zu\n",
+				cxl_memdev_get_devname(memdev), bytes_copied);
+			rc = -EIO;
+			goto out;
+		}
+		memcpy(buf + bytes_copied, (void *)cmd->send_cmd->out.payload,
+			bytes_to_cpy);
+		bytes_copied += bytes_to_cpy;
 	}
 
-	memcpy(dst, (unsigned char*) cmd->send_cmd->out.payload, cmd->send_cmd->out.size);
-
-
 out:
 	cxl_cmd_unref(cmd);
-	return rc;
+	if (rc < 0) {
+		free(buf);
+		return rc;
+	}
+	*stats = (ddr_stats_data_t *)buf;
+	return loop_count;
 }
 
-/* DDR GET STATS */
-CXL_EXPORT int cxl_memdev_ddr_stats_get(struct cxl_memdev *memdev)
+/*
+ * Print the snapshots of the last ddr-stats-run. CXL_DDR_STATS_TEXT keeps
+ * the historical stderr dump; CSV goes to stdout with memdev, snapshot and
+ * iteration columns and JSON prints one object per line, both tagged with
+ * @snapshot so the output of successive runs can be concatenated.
+ */
+CXL_EXPORT int cxl_memdev_ddr_stats_dump(struct cxl_memdev *memdev,
+	enum cxl_ddr_stats_format format, int snapshot)
 {
-	unsigned char *buf;
-	int total_bytes = 0, bytes_to_cpy = 0, bytes_copied = 0;
-	ddr_stats_data_t* ddr_stats_start;
-	int rc = 0;
-	int run_status;
+	const char *devname = cxl_memdev_get_devname(memdev);
+	ddr_stats_data_t *stats;
+	struct json_object *jstats;
 	uint32_t loop_count;
+	int run_status, rc;
+	FILE *fp = stdout;
 
-	rc = cxl_memdev_ddr_stats_status(memdev, &run_status, &loop_count);
-	if (rc < 0)
-		return rc;
+	rc = cxl_memdev_ddr_stats_status_fetch(memdev, &run_status, &loop_count);
+	if (rc != 0)
+		return rc < 0 ? rc : -ENXIO;
 
 	if (run_status)
 		return -EBUSY;
 
-	total_bytes = sizeof(ddr_stats_data_t) * loop_count;
-
-	buf =(unsigned char *)malloc(total_bytes);
-	ddr_stats_start = (ddr_stats_data_t*)buf;
+	rc = ddr_stats_fetch(memdev, loop_count, &stats);
+	if (rc < 0)
+		return rc;
 
-	while(bytes_copied < total_bytes)
-	{
-		bytes_to_cpy = (total_bytes - bytes_copied) < MAX_CXL_TRANSFER_SZ ?
-			       (total_bytes - bytes_copied) : MAX_CXL_TRANSFER_SZ;
-		rc = cxl_ddr_stats_get(memdev, buf + bytes_copied, bytes_copied, bytes_to_cpy);
-		bytes_copied = bytes_copied + bytes_to_cpy;
-		if (rc < 0)
-			goto out;
+	switch (format) {
+	case CXL_DDR_STATS_JSON:
+		jstats = util_cxl_memdev_ddr_stats_to_json(devname, snapshot,
+			stats, loop_count);
+		if (!jstats) {
+			rc = -ENOMEM;
+			break;
+		}
+		fprintf(stdout, "%s\n", json_object_to_json_string_ext(jstats,
+			JSON_C_TO_STRING_PLAIN));
+		json_object_put(jstats);
+		break;
+	case CXL_DDR_STATS_TEXT:
+		fp = stderr;
+		snapshot = -1;
+		/* fallthrough */
+	case CXL_DDR_STATS_CSV:
+		display_pmon_stats(fp, devname, snapshot, stats, loop_count);
+		display_cs_pm_stats(fp, devname, snapshot, stats, loop_count);
+		display_cs_bank_pm_stats(fp, devname, snapshot, stats, loop_count);
+		display_mc_pm_stats(fp, devname, snapshot, stats, loop_count);
+		break;
 	}
 
-	display_pmon_stats(ddr_stats_start, loop_count);
-	display_cs_pm_stats(ddr_stats_start, loop_count);
-	display_cs_bank_pm_stats(ddr_stats_start, loop_count);
-	display_mc_pm_stats(ddr_stats_start, loop_count);
-out:
-	free(buf);
-	return rc;
+	free(stats);
+	return rc < 0 ? rc : 0;
+}
+
+/* DDR GET STATS */
+CXL_EXPORT int cxl_memdev_ddr_stats_get(struct cxl_memdev *memdev)
+{
+	return cxl_memdev_ddr_stats_dump(memdev, CXL_DDR_STATS_TEXT, 0);
 }
 
 /* REBOOT MODE SET */
@@ -11145,8 +13137,8 @@ struct cxl_pcie_eye_run_out {
 	int pcie_eye_run_status;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_pcie_eye_run(struct cxl_memdev *memdev,
-	u8 lane, u8 sw_scan, u8 ber)
+CXL_EXPORT int cxl_memdev_pcie_eye_run_fetch(struct cxl_memdev *memdev,
+	u8 lane, u8 sw_scan, u8 ber, int *run_status)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -11199,18 +13191,31 @@ CXL_EXPORT int cxl_memdev_pcie_eye_run(struct cxl_memdev *memdev,
 		 fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				 cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				 CXL_MEM_COMMAND_ID_PCIE_EYE_SW_RUN);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 
 	pcie_eye_run_out = (void *)cmd->send_cmd->out.payload;
-	if (!pcie_eye_run_out->pcie_eye_run_status)
-		fprintf(stdout, "pcie eye is running\n");
-	else
-		fprintf(stdout, "pcie eye already running OR fault, error : %d\n",
-				pcie_eye_run_out->pcie_eye_run_status);
+	*run_status = pcie_eye_run_out->pcie_eye_run_status;
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_pcie_eye_run(struct cxl_memdev *memdev,
+	u8 lane, u8 sw_scan, u8 ber)
+{
+	int run_status, rc;
+
+	rc = cxl_memdev_pcie_eye_run_fetch(memdev, lane, sw_scan, ber, &run_status);
+	if (rc < 0)
+		return rc;
+
+	if (!run_status)
+		fprintf(stdout, "pcie eye is running\n");
+	else
+		fprintf(stdout, "pcie eye already running OR fault, error : %d\n",
+				run_status);
 	return 0;
 }
 
@@ -11222,7 +13227,8 @@ struct cxl_pcie_eye_status_out {
 	int error;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_pcie_eye_status(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_pcie_eye_status_fetch(struct cxl_memdev *memdev,
+	int *running, int *error)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -11268,17 +13274,30 @@ CXL_EXPORT int cxl_memdev_pcie_eye_status(struct cxl_memdev *memdev)
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				CXL_MEM_COMMAND_ID_PCIE_EYE_SW_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	pcie_eye_status_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "%s\n", pcie_eye_status_out->pcie_eye_status ?
-			"PCIE EYE SW IS RUNNING" : "PCIE EYE SW IS NOT RUNNING/FINISHED");
-	if(pcie_eye_status_out->error)
-		fprintf(stdout, "pcie eye run error %d:\n", pcie_eye_status_out->error);
+	*running = pcie_eye_status_out->pcie_eye_status;
+	*error = pcie_eye_status_out->error;
 
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
+}
+
+CXL_EXPORT int cxl_memdev_pcie_eye_status(struct cxl_memdev *memdev)
+{
+	int running, error, rc;
+
+	rc = cxl_memdev_pcie_eye_status_fetch(memdev, &running, &error);
+	if (rc != 0)
+		return rc;
+
+	fprintf(stdout, "%s\n", running ?
+			"PCIE EYE SW IS RUNNING" : "PCIE EYE SW IS NOT RUNNING/FINISHED");
+	if(error)
+		fprintf(stdout, "pcie eye run error %d:\n", error);
 	return 0;
 }
 
@@ -11507,7 +13526,12 @@ struct cxl_pcie_eye_get_sw_ber_out {
 	float vert_margin;
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_pcie_eye_get_sw_ber(struct cxl_memdev *memdev)
+/* pass thresholds for the BER 1e-12 extrapolation, in UI and mV */
+#define CXL_PCIE_EYE_MIN_HORIZ_MARGIN_UI 0.2f
+#define CXL_PCIE_EYE_MIN_VERT_MARGIN_MV 18.0f
+
+CXL_EXPORT int cxl_memdev_pcie_eye_get_sw_ber_fetch(struct cxl_memdev *memdev,
+	float *horiz_margin, float *vert_margin)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
@@ -11552,20 +13576,49 @@ CXL_EXPORT int cxl_memdev_pcie_eye_get_sw_ber(struct cxl_memdev *memdev)
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_PCIE_EYE_SW_BER) {
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_PCIE_EYE_SW_BER);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	pcie_eye_get_sw_ber_out = (void *)cmd->send_cmd->out.payload;
+	*horiz_margin = pcie_eye_get_sw_ber_out->horiz_margin;
+	*vert_margin = pcie_eye_get_sw_ber_out->vert_margin;
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
+/**
+ * cxl_pcie_eye_margins_pass - judge an extrapolated BER 1e-12 eye
+ * @horiz_margin: eye width margin in UI
+ * @vert_margin: eye height margin in mV
+ *
+ * Both margins, as returned by cxl_memdev_pcie_eye_get_sw_ber_fetch(), must
+ * exceed 0.2 UI and 18 mV respectively.
+ */
+CXL_EXPORT bool cxl_pcie_eye_margins_pass(float horiz_margin, float vert_margin)
+{
+	return horiz_margin > CXL_PCIE_EYE_MIN_HORIZ_MARGIN_UI &&
+		vert_margin > CXL_PCIE_EYE_MIN_VERT_MARGIN_MV;
+}
+
+CXL_EXPORT int cxl_memdev_pcie_eye_get_sw_ber(struct cxl_memdev *memdev)
+{
+	float horiz_margin, vert_margin;
+	int rc;
+
+	rc = cxl_memdev_pcie_eye_get_sw_ber_fetch(memdev, &horiz_margin, &vert_margin);
+	if (rc != 0)
+		return rc;
+
 	fprintf(stdout, "Extrapolation for BER at 1e-12\n");
-	if(pcie_eye_get_sw_ber_out->vert_margin > 18 && pcie_eye_get_sw_ber_out->horiz_margin > 0.2) {
+	if (cxl_pcie_eye_margins_pass(horiz_margin, vert_margin)) {
 		fprintf(stdout, "Eye Height and width margins are > 0.2UI and 18mV, Test PASSED\n");
-		fprintf(stdout, "Eye width margin at 1e-12 is %f UI\n", pcie_eye_get_sw_ber_out->horiz_margin);
-		fprintf(stdout, "Eye height margin at 1e-12 is %f mV\n", pcie_eye_get_sw_ber_out->vert_margin);
+		fprintf(stdout, "Eye width margin at 1e-12 is %f UI\n", horiz_margin);
+		fprintf(stdout, "Eye height margin at 1e-12 is %f mV\n", vert_margin);
 	} else {
 		fprintf(stdout, "Eye Height and width margins are not greater than 0.2UI and 18mV, Test FAILED\n");
 	}
-out:
-	cxl_cmd_unref(cmd);
-	return rc;
+	return 0;
 }
 
 #define CXL_MEM_COMMAND_ID_GET_CXL_LINK_STATUS CXL_MEM_COMMAND_ID_RAW
@@ -11877,6 +13930,134 @@ out:
 	return rc;
 }
 
+static int hpa_to_dpa_submit(struct cxl_cmd *cmd, u64 hpa, u64 *dpa)
+{
+	u64 *hpa_in = cmd->input_payload;
+	int rc;
+
+	*hpa_in = hpa;
+	rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA_OPCODE,
+			CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA_IN_PAYLOAD_SIZE);
+	if (rc < 0)
+		return rc;
+	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA) {
+		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
+				cxl_memdev_get_devname(cmd->memdev), cmd->send_cmd->id,
+				CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA);
+		return -EINVAL;
+	}
+	*dpa = *(u64 *)cmd->send_cmd->out.payload;
+	return 0;
+}
+
+/*
+ * Translate @nr addresses on one reused command. When @verify_interval is
+ * non-zero, addresses the fitted model (see hpa-model.c) owns are answered
+ * locally and every @verify_interval'th local answer is cross-checked with
+ * the device. A wrong or failed check drops the model and every local
+ * answer given since the previous check is translated again by the device.
+ * Failed translations are reported as CXL_DPA_INVALID. Returns the number
+ * of addresses translated or a negative error if the mailbox went away.
+ */
+CXL_EXPORT int cxl_memdev_hpa_to_dpa_bulk(struct cxl_memdev *memdev,
+		const u64 *hpa, u64 *dpa, int nr, unsigned int verify_interval,
+		struct cxl_hpa_dpa_stats *stats)
+{
+	struct cxl_cmd *cmd = NULL;
+	struct hpa_model *model;
+	unsigned int since_verify = 0;
+	int rc = 0, i, j, done = 0, nr_pending = 0, *pending = NULL;
+	bool have_local;
+	u64 local = 0;
+
+	memset(stats, 0, sizeof(*stats));
+	model = calloc(1, sizeof(*model));
+	if (verify_interval)
+		pending = calloc(min_t(unsigned int, verify_interval, nr) + 1,
+				sizeof(*pending));
+	if (!model || (verify_interval && !pending)) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	cmd->input_payload = calloc(1, CXL_MEM_COMMAND_ID_CXL_HPA_TO_DPA_IN_PAYLOAD_SIZE);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+
+	for (i = 0; i < nr; i++) {
+		have_local = verify_interval &&
+			hpa_model_lookup(model, hpa[i], &local);
+		if (have_local && ++since_verify < verify_interval) {
+			dpa[i] = local;
+			pending[nr_pending++] = i;
+			stats->modeled++;
+			done++;
+			continue;
+		}
+
+		rc = hpa_to_dpa_submit(cmd, hpa[i], &dpa[i]);
+		if (rc < 0 && rc != -ENXIO)
+			goto out;
+		if (rc == 0) {
+			stats->mailbox++;
+			done++;
+		} else
+			dpa[i] = CXL_DPA_INVALID;
+
+		if (have_local) {
+			since_verify = 0;
+			stats->verified++;
+			if (rc || local != dpa[i]) {
+				stats->mismatches++;
+				hpa_model_reset(model);
+				for (j = 0; j < nr_pending; j++) {
+					int k = pending[j];
+
+					stats->modeled--;
+					rc = hpa_to_dpa_submit(cmd, hpa[k], &dpa[k]);
+					if (rc == -ENXIO) {
+						dpa[k] = CXL_DPA_INVALID;
+						done--;
+						continue;
+					}
+					if (rc < 0)
+						goto out;
+					stats->mailbox++;
+					hpa_model_add(model, hpa[k], dpa[k]);
+				}
+			}
+			nr_pending = 0;
+		}
+
+		if (dpa[i] != CXL_DPA_INVALID && verify_interval)
+			hpa_model_add(model, hpa[i], dpa[i]);
+		rc = 0;
+	}
+
+out:
+	stats->model_valid = model && model->valid;
+	if (stats->model_valid) {
+		stats->granularity = model->gran;
+		stats->ways = model->ways;
+		stats->position = model->position;
+	}
+	free(pending);
+	free(model);
+	cxl_cmd_unref(cmd);
+	return rc < 0 ? rc : done;
+}
+
 #define CXL_MEM_COMMAND_ID_GET_CXL_MEMBRIDGE_ERRORS CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_GET_CXL_MEMBRIDGE_ERRORS_OPCODE 0xFB13
 
@@ -12172,17 +14353,20 @@ struct cxl_get_ddr_bw_out {
 	float peak_bw[DDR_MAX_SUBSYS];
 }  __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout, u32 iterations)
+CXL_EXPORT int cxl_memdev_get_ddr_bw_fetch(struct cxl_memdev *memdev,
+	u32 timeout, u32 iterations, float *peak_bw, int nr_subsys)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
 	struct cxl_get_ddr_bw_in *get_ddr_bw_in;
 	struct cxl_get_ddr_bw_out *get_ddr_bw_out;
-	float total_peak_bw = 0;
 	int rc = 0;
 	int i;
 
+	if (!peak_bw || nr_subsys <= 0)
+		return -EINVAL;
+
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_GET_DDR_BW_OPCODE);
 	if (!cmd) {
 		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
@@ -12197,8 +14381,10 @@ CXL_EXPORT int cxl_memdev_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout, u32
 	cinfo->size_in = CXL_MEM_COMMAND_ID_LOG_INFO_PAYLOAD_IN_SIZE;
 	if (cinfo->size_in > 0) {
 		cmd->input_payload = calloc(1, cinfo->size_in);
-		if (!cmd->input_payload)
-			return -ENOMEM;
+		if (!cmd->input_payload) {
+			rc = -ENOMEM;
+			goto out;
+		}
 		cmd->send_cmd->in.payload = (u64)cmd->input_payload;
 		cmd->send_cmd->in.size = cinfo->size_in;
 	}
@@ -12218,28 +14404,48 @@ CXL_EXPORT int cxl_memdev_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout, u32
 	if (rc != 0) {
 		fprintf(stderr, "%s: Read failed, firmware status: %d\n",
 				cxl_memdev_get_devname(memdev), rc);
+		rc = -ENXIO;
 		goto out;
 	}
 
 	if (cmd->send_cmd->id != CXL_MEM_COMMAND_ID_GET_DDR_BW) {
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id, CXL_MEM_COMMAND_ID_GET_DDR_BW);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	get_ddr_bw_out = (void *)cmd->send_cmd->out.payload;
-	for(i = 0; i < DDR_MAX_SUBSYS; i++) {
-		fprintf(stdout, "ddr%d peak bandwidth = %f GB/s\n", i, get_ddr_bw_out->peak_bw[i]);
-		total_peak_bw += get_ddr_bw_out->peak_bw[i];
-	}
-	fprintf(stdout, "total peak bandwidth = %f GB/s\n", total_peak_bw);
+	if (nr_subsys > DDR_MAX_SUBSYS)
+		nr_subsys = DDR_MAX_SUBSYS;
+	for (i = 0; i < nr_subsys; i++)
+		peak_bw[i] = get_ddr_bw_out->peak_bw[i];
+	rc = nr_subsys;
 out:
 	cxl_cmd_unref(cmd);
 	return rc;
 }
 
+CXL_EXPORT int cxl_memdev_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout, u32 iterations)
+{
+	float peak_bw[DDR_MAX_SUBSYS];
+	float total_peak_bw = 0;
+	int rc, i;
+
+	rc = cxl_memdev_get_ddr_bw_fetch(memdev, timeout, iterations, peak_bw,
+			ARRAY_SIZE(peak_bw));
+	if (rc < 0)
+		return rc;
+
+	for (i = 0; i < rc; i++) {
+		fprintf(stdout, "ddr%d peak bandwidth = %f GB/s\n", i, peak_bw[i]);
+		total_peak_bw += peak_bw[i];
+	}
+	fprintf(stdout, "total peak bandwidth = %f GB/s\n", total_peak_bw);
+	return 0;
+}
+
 #define CXL_MEM_COMMAND_ID_I2C_READ CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_I2C_READ_OPCODE 0xFB10
-#define I2C_MAX_SIZE_NUM_BYTES 128
 
 struct cxl_i2c_read_in {
 	u16 slave_addr;
@@ -12248,7 +14454,7 @@ struct cxl_i2c_read_in {
 }  __attribute__((packed));
 
 struct cxl_i2c_read_out {
-	char buf[I2C_MAX_SIZE_NUM_BYTES];
+	char buf[CXL_I2C_MAX_SIZE_NUM_BYTES];
 	u8 num_bytes;
 }  __attribute__((packed));
 
@@ -12262,9 +14468,9 @@ CXL_EXPORT int cxl_memdev_i2c_read(struct cxl_memdev *memdev, u16 slave_addr, u8
         int rc = 0;
         int i;
 
-	if(num_bytes > I2C_MAX_SIZE_NUM_BYTES) {
+	if(num_bytes > CXL_I2C_MAX_SIZE_NUM_BYTES) {
                 fprintf(stderr, "%s: Max number of bytes supported is %d, cmd submission failed: %d (%s)\n",
-                                cxl_memdev_get_devname(memdev), I2C_MAX_SIZE_NUM_BYTES, rc, strerror(-rc));
+                                cxl_memdev_get_devname(memdev), CXL_I2C_MAX_SIZE_NUM_BYTES, rc, strerror(-rc));
                 return -EINVAL;
 	}
 
@@ -12394,6 +14600,108 @@ out:
         return rc;
 }
 
+/*
+ * Run @ops in order on a single raw command, switching its opcode between
+ * I2C read and write. Back-to-back reads of consecutive registers on the
+ * same slave are merged into one transaction of up to
+ * CXL_I2C_MAX_SIZE_NUM_BYTES, relying on the register auto-increment that
+ * multi-byte reads already use. Read data is packed into @results in op
+ * order, each read's position recorded in its result_offset. On a failure
+ * the op gets the error, the remaining ops get -ECANCELED and the error is
+ * returned; otherwise the number of result bytes is returned.
+ */
+CXL_EXPORT int cxl_memdev_i2c_batch(struct cxl_memdev *memdev,
+	struct cxl_i2c_op *ops, int nr_ops, u8 *results, size_t results_len)
+{
+	struct cxl_cmd *cmd;
+	struct cxl_mem_query_commands *query;
+	struct cxl_command_info *cinfo;
+	struct cxl_i2c_read_in *i2c_read_in;
+	struct cxl_i2c_write_in *i2c_write_in;
+	struct cxl_i2c_read_out *i2c_read_out;
+	size_t used = 0, len;
+	int rc = 0, i, j, k;
+
+	for (i = 0; i < nr_ops; i++) {
+		ops[i].status = -ECANCELED;
+		if (ops[i].type == CXL_I2C_OP_READ &&
+		    (!ops[i].num_bytes || ops[i].num_bytes > CXL_I2C_MAX_SIZE_NUM_BYTES))
+			return -EINVAL;
+	}
+
+	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_I2C_READ_OPCODE);
+	if (!cmd) {
+		fprintf(stderr, "%s: cxl_cmd_new_raw returned Null output\n",
+				cxl_memdev_get_devname(memdev));
+		return -ENOMEM;
+	}
+
+	query = cmd->query_cmd;
+	cinfo = &query->commands[cmd->query_idx];
+
+	/* used to force correct payload size */
+	cinfo->size_in = CXL_MEM_COMMAND_ID_LOG_INFO_PAYLOAD_IN_SIZE;
+	cmd->input_payload = calloc(1, cinfo->size_in);
+	if (!cmd->input_payload) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	cmd->send_cmd->in.payload = (u64)cmd->input_payload;
+	i2c_read_in = (void *) cmd->send_cmd->in.payload;
+	i2c_write_in = (void *) cmd->send_cmd->in.payload;
+	i2c_read_out = (void *)cmd->send_cmd->out.payload;
+
+	for (i = 0; i < nr_ops; i = j) {
+		j = i + 1;
+		if (ops[i].type == CXL_I2C_OP_WRITE) {
+			i2c_write_in->slave_addr = ops[i].slave_addr;
+			i2c_write_in->reg_addr = ops[i].reg_addr;
+			i2c_write_in->data = ops[i].data;
+			rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_I2C_WRITE_OPCODE,
+				CXL_MEM_COMMAND_ID_LOG_INFO_PAYLOAD_IN_SIZE);
+			ops[i].status = rc;
+			if (rc < 0)
+				goto out;
+			continue;
+		}
+
+		len = ops[i].num_bytes;
+		while (j < nr_ops && ops[j].type == CXL_I2C_OP_READ &&
+		       ops[j].slave_addr == ops[i].slave_addr &&
+		       ops[j].reg_addr == ops[i].reg_addr + len &&
+		       len + ops[j].num_bytes <= CXL_I2C_MAX_SIZE_NUM_BYTES)
+			len += ops[j++].num_bytes;
+		if (used + len > results_len) {
+			rc = -ENOSPC;
+			ops[i].status = rc;
+			goto out;
+		}
+
+		i2c_read_in->slave_addr = ops[i].slave_addr;
+		i2c_read_in->reg_addr = ops[i].reg_addr;
+		i2c_read_in->num_bytes = len;
+		rc = cxl_cmd_raw_resubmit(cmd, CXL_MEM_COMMAND_ID_I2C_READ_OPCODE,
+			CXL_MEM_COMMAND_ID_LOG_INFO_PAYLOAD_IN_SIZE);
+		if (rc == 0 && i2c_read_out->num_bytes < len)
+			rc = -EIO;
+		if (rc < 0) {
+			ops[i].status = rc;
+			goto out;
+		}
+		memcpy(results + used, i2c_read_out->buf, len);
+		for (k = i; k < j; k++) {
+			ops[k].status = 0;
+			ops[k].result_offset = used;
+			used += ops[k].num_bytes;
+		}
+	}
+	rc = used;
+
+out:
+	cxl_cmd_unref(cmd);
+	return rc;
+}
+
 #define CXL_MEM_COMMAND_ID_GET_DDR_LATENCY CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_GET_DDR_LATENCY_OPCODE 0xFB12
 
@@ -12883,14 +15191,14 @@ struct cxl_ddr_cont_scrub_status_out {
   uint32_t cont_scrub_status;
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_ddr_cont_scrub_status(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_ddr_cont_scrub_status_fetch(struct cxl_memdev *memdev,
+	u32 *cont_scrub_status)
 {
 	struct cxl_cmd *cmd;
 	struct cxl_mem_query_commands *query;
 	struct cxl_command_info *cinfo;
 	struct cxl_ddr_cont_scrub_status_out *ddr_cont_scrub_status_out;
 	int rc = 0;
-	int subsys;
 
 	cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DDR_CONT_SCRUB_STATUS_OPCODE);
 	if (!cmd) {
@@ -12930,17 +15238,31 @@ CXL_EXPORT int cxl_memdev_ddr_cont_scrub_status(struct cxl_memdev *memdev)
 		fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
 				cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
 				CXL_MEM_COMMAND_ID_DDR_CONT_SCRUB_STATUS);
-		return -EINVAL;
+		rc = -EINVAL;
+		goto out;
 	}
 	ddr_cont_scrub_status_out = (void *)cmd->send_cmd->out.payload;
-	fprintf(stdout, "%s\n", ddr_cont_scrub_status_out->cont_scrub_status ?
-		"CONTINUOUS SCRUB IS ON" : "CONTINUOUS SCRUB IS OFF");
+	*cont_scrub_status = ddr_cont_scrub_status_out->cont_scrub_status;
 
 out:
         cxl_cmd_unref(cmd);
         return rc;
 }
 
+CXL_EXPORT int cxl_memdev_ddr_cont_scrub_status(struct cxl_memdev *memdev)
+{
+	u32 cont_scrub_status;
+	int rc;
+
+	rc = cxl_memdev_ddr_cont_scrub_status_fetch(memdev, &cont_scrub_status);
+	if (rc != 0)
+		return rc;
+
+	fprintf(stdout, "%s\n", cont_scrub_status ?
+		"CONTINUOUS SCRUB IS ON" : "CONTINUOUS SCRUB IS OFF");
+	return 0;
+}
+
 /* DDR CONTINUOUS SCRUB SET */
 #define CXL_MEM_COMMAND_ID_DDR_CONT_SRUB_SET CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_DDR_CONT_SRUB_SET_OPCODE 0xFB29
@@ -15745,7 +18067,8 @@ struct cxl_mbox_handle_cxl_ddr_irq_status_out {
 } __attribute__((packed));
 
 
-CXL_EXPORT int cxl_memdev_cxl_ddr_irq_status_get(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_cxl_ddr_irq_status_fetch(struct cxl_memdev *memdev,
+                 u8 *enabled_mask)
 {
     struct cxl_cmd *cmd;
     struct cxl_mem_query_commands *query;
@@ -15790,22 +18113,47 @@ CXL_EXPORT int cxl_memdev_cxl_ddr_irq_status_get(struct cxl_memdev *memdev)
         fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
                 cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
                 CXL_MEM_COMMAND_ID_CXL_DDR_IRQ_STATUS_GET);
-        return -EINVAL;
+        rc = -EINVAL;
+        goto out;
     }
 
+    /* bit n - 1 follows cxl-ddr-irq-enable option n; the device reports disables */
     handle_cxl_ddr_irq_status = (struct cxl_mbox_handle_cxl_ddr_irq_status_out *)cmd->send_cmd->out.payload;
-    fprintf(stdout, "IRQ Status:\n");
-    fprintf(stdout, "CXL Correctable IRQ is %s\n", handle_cxl_ddr_irq_status->irq_status.cxl_corr_irq ? "disabled" : "enabled");
-    fprintf(stdout, "CXL Uncorrectable IRQ is %s\n", handle_cxl_ddr_irq_status->irq_status.cxl_uncorr_irq ? "disabled" : "enabled");
-    fprintf(stdout, "CXL Configuration IRQ is %s\n", handle_cxl_ddr_irq_status->irq_status.cxl_cfg_irq ? "disabled" : "enabled");
-    fprintf(stdout, "DDR[0] IRQ is %s\n", handle_cxl_ddr_irq_status->irq_status.ddr_ctrl_irq[0] ? "disabled" : "enabled");
-    fprintf(stdout, "DDR[1] IRQ is %s\n", handle_cxl_ddr_irq_status->irq_status.ddr_ctrl_irq[1] ? "disabled" : "enabled");
+    *enabled_mask = 0;
+    if (!handle_cxl_ddr_irq_status->irq_status.cxl_corr_irq)
+        *enabled_mask |= CXL_IRQ_CXL_CORR;
+    if (!handle_cxl_ddr_irq_status->irq_status.cxl_uncorr_irq)
+        *enabled_mask |= CXL_IRQ_CXL_UNCORR;
+    if (!handle_cxl_ddr_irq_status->irq_status.cxl_cfg_irq)
+        *enabled_mask |= CXL_IRQ_CXL_CFG;
+    if (!handle_cxl_ddr_irq_status->irq_status.ddr_ctrl_irq[0])
+        *enabled_mask |= CXL_IRQ_DDR0;
+    if (!handle_cxl_ddr_irq_status->irq_status.ddr_ctrl_irq[1])
+        *enabled_mask |= CXL_IRQ_DDR1;
 
 out:
     cxl_cmd_unref(cmd);
     return rc;
 }
 
+CXL_EXPORT int cxl_memdev_cxl_ddr_irq_status_get(struct cxl_memdev *memdev)
+{
+    u8 enabled;
+    int rc;
+
+    rc = cxl_memdev_cxl_ddr_irq_status_fetch(memdev, &enabled);
+    if (rc != 0)
+        return rc;
+
+    fprintf(stdout, "IRQ Status:\n");
+    fprintf(stdout, "CXL Correctable IRQ is %s\n", enabled & CXL_IRQ_CXL_CORR ? "enabled" : "disabled");
+    fprintf(stdout, "CXL Uncorrectable IRQ is %s\n", enabled & CXL_IRQ_CXL_UNCORR ? "enabled" : "disabled");
+    fprintf(stdout, "CXL Configuration IRQ is %s\n", enabled & CXL_IRQ_CXL_CFG ? "enabled" : "disabled");
+    fprintf(stdout, "DDR[0] IRQ is %s\n", enabled & CXL_IRQ_DDR0 ? "enabled" : "disabled");
+    fprintf(stdout, "DDR[1] IRQ is %s\n", enabled & CXL_IRQ_DDR1 ? "enabled" : "disabled");
+    return 0;
+}
+
 /* CXL DDR ENABLE IRQ */
 #define CXL_MEM_COMMAND_ID_CXL_DDR_IRQ_ENABLE_SET CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_CXL_DDR_IRQ_ENABLE_SET_OPCODE 0xFB3B
@@ -15925,7 +18273,7 @@ CXL_EXPORT int cxl_memdev_ddr_threshold_set(struct cxl_memdev *memdev,
             "Error: Time limit option must be between 1 and %d\n",
             UPPER_THRESHOLD_COUNT,
             UPPER_TIME_LIMIT);
-        goto out;
+        return -EINVAL;
     }
 
     cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_DDR_THRES_SET_OPCODE);
@@ -15953,10 +18301,12 @@ CXL_EXPORT int cxl_memdev_ddr_threshold_set(struct cxl_memdev *memdev,
     handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_threshold_cnt = uncorr_err_threshold_cnt;
     handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_time_limit = uncorr_err_time_limit;
 
-    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.corr_err_time_limit));
-    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_time_limit));
+    if (!memdev->ctx->quiet) {
+        fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
+                        le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.corr_err_time_limit));
+        fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
+                        le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_set->rlc_ddr_cfg.uncorr_err_time_limit));
+    }
 
     rc = cxl_cmd_submit(cmd);
     if (rc < 0) {
@@ -15993,7 +18343,8 @@ struct cxl_mbox_handle_ddr_threshold_get_out {
     struct rlc_cfg rlc_ddr_cfg;
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_ddr_threshold_get(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_ddr_threshold_get_fetch(struct cxl_memdev *memdev,
+                struct cxl_error_threshold *thres)
 {
     struct cxl_cmd *cmd;
     struct cxl_mem_query_commands *query;
@@ -16038,20 +18389,37 @@ CXL_EXPORT int cxl_memdev_ddr_threshold_get(struct cxl_memdev *memdev)
         fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
                 cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
                 CXL_MEM_COMMAND_ID_DDR_THRES_GET);
-        return -EINVAL;
+        rc = -EINVAL;
+        goto out;
     }
 
     handle_ddr_threshold_get = (struct cxl_mbox_handle_ddr_threshold_get_out *)cmd->send_cmd->out.payload;
-    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.corr_err_time_limit));
-    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.uncorr_err_time_limit));
+    thres->corr_err_threshold_cnt = le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.corr_err_threshold_cnt);
+    thres->corr_err_time_limit = le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.corr_err_time_limit);
+    thres->uncorr_err_threshold_cnt = le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.uncorr_err_threshold_cnt);
+    thres->uncorr_err_time_limit = le16_to_cpu(handle_ddr_threshold_get->rlc_ddr_cfg.uncorr_err_time_limit);
 
 out:
     cxl_cmd_unref(cmd);
     return rc;
 }
 
+CXL_EXPORT int cxl_memdev_ddr_threshold_get(struct cxl_memdev *memdev)
+{
+    struct cxl_error_threshold thres;
+    int rc;
+
+    rc = cxl_memdev_ddr_threshold_get_fetch(memdev, &thres);
+    if (rc != 0)
+        return rc;
+
+    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
+                    thres.corr_err_threshold_cnt, thres.corr_err_time_limit);
+    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
+                    thres.uncorr_err_threshold_cnt, thres.uncorr_err_time_limit);
+    return 0;
+}
+
 /* CXL_THRES_SET */
 #define CXL_MEM_COMMAND_ID_CXL_THRES_SET CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_CXL_THRES_SET_OPCODE 0xFB3E
@@ -16080,7 +18448,7 @@ CXL_EXPORT int cxl_memdev_cxl_threshold_set(struct cxl_memdev *memdev,
             "Error: Time limit option must be between 1 and %d\n",
             UPPER_THRESHOLD_COUNT,
             UPPER_TIME_LIMIT);
-        goto out;
+        return -EINVAL;
     }
 
     cmd = cxl_cmd_new_raw(memdev, CXL_MEM_COMMAND_ID_CXL_THRES_SET_OPCODE);
@@ -16108,10 +18476,12 @@ CXL_EXPORT int cxl_memdev_cxl_threshold_set(struct cxl_memdev *memdev,
     handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_threshold_cnt = uncorr_err_threshold_cnt;
     handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_time_limit = uncorr_err_time_limit;
 
-    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.corr_err_time_limit));
-    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_time_limit));
+    if (!memdev->ctx->quiet) {
+        fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
+                        le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.corr_err_time_limit));
+        fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
+                        le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_set->rlc_cxl_cfg.uncorr_err_time_limit));
+    }
 
     rc = cxl_cmd_submit(cmd);
     if (rc < 0) {
@@ -16148,7 +18518,8 @@ struct cxl_mbox_handle_cxl_threshold_get_out {
     struct rlc_cfg rlc_cxl_cfg;
 } __attribute__((packed));
 
-CXL_EXPORT int cxl_memdev_cxl_threshold_get(struct cxl_memdev *memdev)
+CXL_EXPORT int cxl_memdev_cxl_threshold_get_fetch(struct cxl_memdev *memdev,
+                struct cxl_error_threshold *thres)
 {
     struct cxl_cmd *cmd;
     struct cxl_mem_query_commands *query;
@@ -16193,20 +18564,37 @@ CXL_EXPORT int cxl_memdev_cxl_threshold_get(struct cxl_memdev *memdev)
         fprintf(stderr, "%s: invalid command id 0x%x (expecting 0x%x)\n",
                 cxl_memdev_get_devname(memdev), cmd->send_cmd->id,
                 CXL_MEM_COMMAND_ID_CXL_THRES_GET);
-        return -EINVAL;
+        rc = -EINVAL;
+        goto out;
     }
 
     handle_cxl_threshold_get = (struct cxl_mbox_handle_cxl_threshold_get_out *)cmd->send_cmd->out.payload;
-    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.corr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.corr_err_time_limit));
-    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
-                    le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.uncorr_err_threshold_cnt), le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.uncorr_err_time_limit));
+    thres->corr_err_threshold_cnt = le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.corr_err_threshold_cnt);
+    thres->corr_err_time_limit = le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.corr_err_time_limit);
+    thres->uncorr_err_threshold_cnt = le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.uncorr_err_threshold_cnt);
+    thres->uncorr_err_time_limit = le16_to_cpu(handle_cxl_threshold_get->rlc_cxl_cfg.uncorr_err_time_limit);
 
 out:
     cxl_cmd_unref(cmd);
     return rc;
 }
 
+CXL_EXPORT int cxl_memdev_cxl_threshold_get(struct cxl_memdev *memdev)
+{
+    struct cxl_error_threshold thres;
+    int rc;
+
+    rc = cxl_memdev_cxl_threshold_get_fetch(memdev, &thres);
+    if (rc != 0)
+        return rc;
+
+    fprintf(stdout, "Correctable error: threshold count %d, time limit %d\n",
+                    thres.corr_err_threshold_cnt, thres.corr_err_time_limit);
+    fprintf(stdout, "Uncorrectable error: threshold count %d, time limit %d\n",
+                    thres.uncorr_err_threshold_cnt, thres.uncorr_err_time_limit);
+    return 0;
+}
+
 #define CXL_MEM_COMMAND_ID_GET_COREDUMP CXL_MEM_COMMAND_ID_RAW
 #define CXL_MEM_COMMAND_ID_GET_COREDUMP_OPCODE 0xFB40
 #define MAX_BUFF_LEN 16384
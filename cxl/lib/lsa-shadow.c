@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: LGPL-2.1
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/bitmap.h>
+#include <ccan/minmax/minmax.h>
+
+#include "lsa-shadow.h"
+
+int lsa_shadow_init(struct lsa_shadow *s, size_t size, size_t slot_size)
+{
+	memset(s, 0, sizeof(*s));
+	/* whole u32 words per slot for fletcher64() */
+	if (!size || !slot_size || slot_size % sizeof(u32))
+		return -EINVAL;
+
+	s->size = size;
+	s->slot_size = slot_size;
+	s->nr_slots = DIV_ROUND_UP(size, slot_size);
+	s->data = calloc(s->nr_slots, slot_size);
+	s->loaded = bitmap_alloc(s->nr_slots);
+	s->dirty = bitmap_alloc(s->nr_slots);
+	if (!s->data || !s->loaded || !s->dirty) {
+		lsa_shadow_release(s);
+		return -ENOMEM;
+	}
+	return 0;
+}
+
+void lsa_shadow_release(struct lsa_shadow *s)
+{
+	free(s->dirty);
+	free(s->loaded);
+	free(s->data);
+	memset(s, 0, sizeof(*s));
+}
+
+/* resolve @length == 0 to the rest of the area and bounds check */
+int lsa_shadow_range(const struct lsa_shadow *s, size_t *length,
+		size_t offset)
+{
+	if (offset > s->size)
+		return -EINVAL;
+	if (*length == 0)
+		*length = s->size - offset;
+	if (*length > s->size - offset)
+		return -EINVAL;
+	return 0;
+}
+
+/* byte range covered by slots [@start, @end), clipped to the LSA size */
+size_t lsa_shadow_slot_len(const struct lsa_shadow *s, unsigned int start,
+		unsigned int end)
+{
+	return min((size_t)end * s->slot_size, s->size) -
+		start * s->slot_size;
+}
+
+/*
+ * Find the next run [@start, @end) of slots touching [@offset, @offset +
+ * @length) that is not loaded yet. *@start must be 0 on the first call
+ * and @end on the next.
+ */
+bool lsa_shadow_next_missing(const struct lsa_shadow *s, size_t length,
+		size_t offset, unsigned int *start, unsigned int *end)
+{
+	unsigned int first = offset / s->slot_size;
+	unsigned int last = DIV_ROUND_UP(offset + length, s->slot_size);
+
+	if (!length)
+		return false;
+	*start = find_next_zero_bit(s->loaded, last, max(*start, first));
+	if (*start >= last)
+		return false;
+	*end = find_next_bit(s->loaded, last, *start);
+	return true;
+}
+
+void lsa_shadow_set_loaded(struct lsa_shadow *s, unsigned int start,
+		unsigned int end)
+{
+	bitmap_set(s->loaded, start, end - start);
+}
+
+/*
+ * Copy @buf (zeroes when NULL) into the shadow and mark dirty only the
+ * slots whose contents actually change. The range must be loaded.
+ */
+void lsa_shadow_update(struct lsa_shadow *s, const void *buf, size_t length,
+		size_t offset)
+{
+	unsigned int slot;
+	size_t pos, n;
+	u8 *p;
+
+	for (pos = 0; pos < length; pos += n) {
+		slot = (offset + pos) / s->slot_size;
+		n = min((slot + 1) * s->slot_size - (offset + pos),
+				length - pos);
+		p = s->data + offset + pos;
+		if (buf) {
+			if (memcmp(p, (const u8 *)buf + pos, n) == 0)
+				continue;
+			memcpy(p, (const u8 *)buf + pos, n);
+		} else {
+			if (p[0] == 0 && memcmp(p, p + 1, n - 1) == 0)
+				continue;
+			memset(p, 0, n);
+		}
+		bitmap_set(s->dirty, slot, 1);
+	}
+}
+
+/* next run [@start, @end) of dirty slots at or after *@start */
+bool lsa_shadow_next_dirty(const struct lsa_shadow *s, unsigned int *start,
+		unsigned int *end)
+{
+	*start = find_next_bit(s->dirty, s->nr_slots, *start);
+	if (*start >= s->nr_slots)
+		return false;
+	*end = find_next_zero_bit(s->dirty, s->nr_slots, *start);
+	return true;
+}
+
+void lsa_shadow_set_clean(struct lsa_shadow *s, unsigned int start,
+		unsigned int end)
+{
+	bitmap_clear(s->dirty, start, end - start);
+}
+
+unsigned int lsa_shadow_nr_dirty(const struct lsa_shadow *s)
+{
+	unsigned int i, nr = 0;
+
+	for (i = 0; i < s->nr_slots; i++)
+		nr += test_bit(i, s->dirty);
+	return nr;
+}
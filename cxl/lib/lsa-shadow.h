@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: LGPL-2.1 */
+#ifndef _LIBCXL_LSA_SHADOW_H_
+#define _LIBCXL_LSA_SHADOW_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <ccan/short_types/short_types.h>
+
+/**
+ * struct lsa_shadow - slot bookkeeping behind struct cxl_lsa
+ * @data: shadow buffer, @nr_slots * @slot_size bytes
+ * @size: LSA size in bytes
+ * @slot_size: granularity of loading and dirty tracking
+ * @nr_slots: number of slots covering @size
+ * @loaded: slots that have been read from the device
+ * @dirty: slots changed in the shadow and not yet committed
+ *
+ * No device access happens here; libcxl moves the slot runs reported by
+ * lsa_shadow_next_missing() and lsa_shadow_next_dirty() over the mailbox.
+ */
+struct lsa_shadow {
+	u8 *data;
+	size_t size;
+	size_t slot_size;
+	unsigned int nr_slots;
+	unsigned long *loaded;
+	unsigned long *dirty;
+};
+
+int lsa_shadow_init(struct lsa_shadow *s, size_t size, size_t slot_size);
+void lsa_shadow_release(struct lsa_shadow *s);
+int lsa_shadow_range(const struct lsa_shadow *s, size_t *length,
+		size_t offset);
+size_t lsa_shadow_slot_len(const struct lsa_shadow *s, unsigned int start,
+		unsigned int end);
+bool lsa_shadow_next_missing(const struct lsa_shadow *s, size_t length,
+		size_t offset, unsigned int *start, unsigned int *end);
+void lsa_shadow_set_loaded(struct lsa_shadow *s, unsigned int start,
+		unsigned int end);
+void lsa_shadow_update(struct lsa_shadow *s, const void *buf, size_t length,
+		size_t offset);
+bool lsa_shadow_next_dirty(const struct lsa_shadow *s, unsigned int *start,
+		unsigned int *end);
+void lsa_shadow_set_clean(struct lsa_shadow *s, unsigned int start,
+		unsigned int end);
+unsigned int lsa_shadow_nr_dirty(const struct lsa_shadow *s);
+
+#endif /* _LIBCXL_LSA_SHADOW_H_ */
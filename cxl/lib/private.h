@@ -8,6 +8,8 @@
 #include <ccan/endian/endian.h>
 #include <ccan/short_types/short_types.h>
 
+#include "lsa-shadow.h"
+
 #define CXL_EXPORT __attribute__ ((visibility("default")))
 
 struct cxl_memdev {
@@ -18,11 +20,17 @@ struct cxl_memdev {
 	char *firmware_version;
 	struct cxl_ctx *ctx;
 	struct list_node list;
+	/* sysfs attributes below are read on first use, see MEMDEV_LOADED_* */
+	unsigned int loaded;
 	unsigned long long pmem_size;
 	unsigned long long ram_size;
+	unsigned long long serial;
 	int payload_max;
 	size_t lsa_size;
 	struct kmod_module *module;
+	/* only set once opened, see cxl_memdev_open() */
+	int fd;
+	struct cxl_mem_query_commands *query;
 };
 
 enum cxl_cmd_query_status {
@@ -55,6 +63,16 @@ struct cxl_cmd {
 	int status;
 };
 
+/**
+ * struct cxl_lsa - shadow copy of a memdev's label storage area
+ * @memdev: the memory device whose LSA is shadowed
+ * @shadow: shadow buffer and its loaded / dirty slot tracking
+ */
+struct cxl_lsa {
+	struct cxl_memdev *memdev;
+	struct lsa_shadow shadow;
+};
+
 #define CXL_CMD_IDENTIFY_FW_REV_LENGTH 0x10
 
 struct cxl_cmd_identify {
@@ -125,6 +143,147 @@ struct cxl_mbox_health_counters_get_out {
         __le32 num_ddr_dimm3_uncorrectable_ecc_errors;
 }  __attribute__((packed));
 
+struct cxl_mbox_eh_link_dbg_entry_dump_out {
+	u8 cap_info;
+	u8 cap_reason;
+	__le32 l2r_reason;
+	__le64 start_time;
+	__le64 end_time;
+	u8 start_rate;
+	u8 end_rate;
+	u8 start_state;
+	u8 end_state;
+	__le32 start_status;
+	__le32 end_status;
+} __attribute__((packed));
+
+struct cxl_mbox_eh_link_dbg_lane_dump_out {
+	u8 cap_info;
+	u8 pga_gain;
+	u8 pga_off2;
+	u8 pga_off1;
+	u8 cdfe_a2;
+	u8 cdfe_a3;
+	u8 cdfe_a4;
+	u8 cdfe_a5;
+	u8 cdfe_a6;
+	u8 cdfe_a7;
+	u8 cdfe_a8;
+	u8 cdfe_a9;
+	u8 cdfe_a10;
+	u8 zobel_a_gain;
+	u8 zobel_b_gain;
+	__le16 zobel_dc_offset;
+	__le16 udfe_thr_0;
+	__le16 udfe_thr_1;
+	__le16 dc_offset;
+	__le16 median_amp;
+	u8 ph_ofs_t;
+	__le16 cdru_lock_time;
+	__le16 eh_workaround_stat;
+	__le16 los_toggle_cnt;
+	__le16 adapt_time;
+	__le16 cdr_lock_toggle_cnt_0;
+	__le16 jat_stat_0;
+	__le32 db_err;
+	__le32 reg_val0;
+	u8 reg_val1;
+	__le32 reg_val2;
+	__le32 reg_val3;
+	__le32 reg_val4;
+} __attribute__((packed));
+
+/* DDR stats snapshot, one per ddr-stats-run loop iteration */
+#define NUM_BANK 16
+#define NUM_CS 4
+
+struct dfi_cs_pm {
+  uint32_t mrw_cnt;
+  uint32_t refresh_cnt;
+  uint32_t act_cnt;
+  uint32_t write_cnt;
+  uint32_t read_cnt;
+  uint32_t pre_cnt;
+  uint32_t rr_cnt;
+  uint32_t ww_cnt;
+  uint32_t rw_cnt;
+} __attribute__((packed));
+
+struct dfi_cs_bank_pm {
+  uint32_t bank_act_cnt;
+  uint32_t bank_wr_cnt;
+  uint32_t bank_rd_cnt;
+  uint32_t bank_pre_cnt;
+} __attribute__((packed));
+
+struct dfi_mc_pm {
+  uint32_t cmd_queue_full_events;
+  uint32_t info_fifo_full_events;
+  uint32_t wrdata_hold_fifo_full_events;
+  uint32_t port_cmd_fifo0_full_events;
+  uint32_t port_wrresp_fifo0_full_events;
+  uint32_t port_wr_fifo0_full_events;
+  uint32_t port_rd_fifo0_full_events;
+  uint32_t port_cmd_fifo1_full_events;
+  uint32_t port_wrresp_fifo1_full_events;
+  uint32_t port_wr_fifo1_full_events;
+  uint32_t port_rd_fifo1_full_events;
+  uint32_t ecc_dataout_corrected;
+  uint32_t ecc_dataout_uncorrected;
+  uint32_t pd_ex;
+  uint32_t pd_en;
+  uint32_t srex;
+  uint32_t sren;
+  uint32_t write;
+  uint32_t read;
+  uint32_t rmw;
+  uint32_t bank_act;
+  uint32_t precharge;
+  uint32_t precharge_all;
+  uint32_t mrw;
+  uint32_t auto_ref;
+  uint32_t rw_auto_pre;
+  uint32_t zq_cal_short;
+  uint32_t zq_cal_long;
+  uint32_t same_addr_ww_collision;
+  uint32_t same_addr_wr_collision;
+  uint32_t same_addr_rw_collision;
+  uint32_t same_addr_rr_collision;
+} __attribute__((packed));
+
+struct ddr_pmon_data {
+  uint64_t fr_cnt;
+  uint32_t idle_cnt;
+  uint32_t rd_ot_cnt;
+  uint32_t wr_ot_cnt;
+  uint32_t wrd_ot_cnt;
+  uint32_t rd_cmd_cnt;
+  uint32_t rd_cmd_busy_cnt;
+  uint32_t wr_cmd_cnt;
+  uint32_t wr_cmd_busy_cnt;
+  uint32_t rd_data_cnt;
+  uint32_t rd_data_busy_cnt;
+  uint32_t wr_data_cnt;
+  uint32_t wr_data_busy_cnt;
+  uint64_t rd_avg_lat;
+  uint64_t wr_avg_lat;
+  uint32_t rd_trans_smpl_cnt;
+  uint32_t wr_trans_smpl_cnt;
+} __attribute__((packed));
+
+struct ddr_data {
+  struct ddr_pmon_data pmon;
+  struct dfi_cs_pm cs_pm[NUM_CS];
+  struct dfi_cs_bank_pm cs_bank_pm[NUM_CS][NUM_BANK];
+  struct dfi_mc_pm mc_pm;
+} __attribute__((packed));
+
+struct ddr_stats_data {
+  struct ddr_data stats;
+} __attribute__((packed));
+
+typedef struct ddr_stats_data ddr_stats_data_t;
+
 static inline int check_kmod(struct kmod_ctx *kmod_ctx)
 {
 	return kmod_ctx ? 0 : -ENXIO;
@@ -33,6 +33,8 @@ void cxl_set_log_fn(struct cxl_ctx *ctx,
 			const char *format, va_list args));
 int cxl_get_log_priority(struct cxl_ctx *ctx);
 void cxl_set_log_priority(struct cxl_ctx *ctx, int priority);
+void cxl_set_quiet(struct cxl_ctx *ctx, bool quiet);
+bool cxl_get_quiet(struct cxl_ctx *ctx);
 void cxl_set_userdata(struct cxl_ctx *ctx, void *userdata);
 void *cxl_get_userdata(struct cxl_ctx *ctx);
 void cxl_set_private_data(struct cxl_ctx *ctx, void *data);
@@ -43,12 +45,22 @@ struct cxl_memdev *cxl_memdev_get_first(struct cxl_ctx *ctx);
 struct cxl_memdev *cxl_memdev_get_next(struct cxl_memdev *memdev);
 int cxl_memdev_get_id(struct cxl_memdev *memdev);
 const char *cxl_memdev_get_devname(struct cxl_memdev *memdev);
+int cxl_memdev_open(struct cxl_memdev *memdev);
+struct cxl_memdev *cxl_memdev_get_by_name(struct cxl_ctx *ctx,
+		const char *name);
 int cxl_memdev_get_major(struct cxl_memdev *memdev);
 int cxl_memdev_get_minor(struct cxl_memdev *memdev);
 struct cxl_ctx *cxl_memdev_get_ctx(struct cxl_memdev *memdev);
 unsigned long long cxl_memdev_get_pmem_size(struct cxl_memdev *memdev);
 unsigned long long cxl_memdev_get_ram_size(struct cxl_memdev *memdev);
+unsigned long long cxl_memdev_get_serial(struct cxl_memdev *memdev);
 const char *cxl_memdev_get_firmware_verison(struct cxl_memdev *memdev);
+int cxl_memdev_get_payload_max(struct cxl_memdev *memdev);
+const char *cxl_memdev_get_module_name(struct cxl_memdev *memdev);
+int cxl_memdev_get_numa_node(struct cxl_memdev *memdev);
+int cxl_memdev_get_link_width(struct cxl_memdev *memdev);
+int cxl_memdev_get_link_speed(struct cxl_memdev *memdev);
+bool cxl_memdev_in_region(struct cxl_memdev *memdev, const char *region);
 size_t cxl_memdev_get_lsa_size(struct cxl_memdev *memdev);
 int cxl_memdev_is_active(struct cxl_memdev *memdev);
 int cxl_memdev_zero_lsa(struct cxl_memdev *memdev);
@@ -56,6 +68,51 @@ int cxl_memdev_get_lsa(struct cxl_memdev *memdev, void *buf, size_t length,
 		size_t offset);
 int cxl_memdev_set_lsa(struct cxl_memdev *memdev, void *buf, size_t length,
 		size_t offset);
+
+/* read back and compare every piece of an LSA transfer */
+#define CXL_LSA_VERIFY (1 << 0)
+
+struct cxl_lsa_stats {
+	size_t bytes;
+	size_t verified;
+	size_t chunk_size;
+	unsigned int chunks;
+	unsigned long long nsecs;
+};
+
+/* a @length of 0 covers @offset to the end of the label area */
+int cxl_memdev_zero_lsa_ext(struct cxl_memdev *memdev, size_t length,
+		size_t offset, unsigned int flags, struct cxl_lsa_stats *stats);
+int cxl_memdev_set_lsa_ext(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats);
+int cxl_memdev_get_lsa_ext(struct cxl_memdev *memdev, void *buf,
+		size_t length, size_t offset, unsigned int flags,
+		struct cxl_lsa_stats *stats);
+
+/*
+ * Shadow of the label storage area: slots are read from the device on
+ * first access, writes only touch the shadow and mark the slots they
+ * change dirty, and cxl_lsa_commit() writes back just the dirty slots.
+ * As with the _ext calls, a @length of 0 runs to the end of the area.
+ */
+#define CXL_LSA_SLOT_SIZE 256
+
+struct cxl_lsa;
+struct cxl_lsa *cxl_lsa_new(struct cxl_memdev *memdev, size_t slot_size);
+void cxl_lsa_free(struct cxl_lsa *lsa);
+size_t cxl_lsa_get_size(struct cxl_lsa *lsa);
+size_t cxl_lsa_get_slot_size(struct cxl_lsa *lsa);
+unsigned int cxl_lsa_get_nr_dirty(struct cxl_lsa *lsa);
+int cxl_lsa_load(struct cxl_lsa *lsa, size_t length, size_t offset,
+		unsigned int flags, struct cxl_lsa_stats *stats);
+int cxl_lsa_read(struct cxl_lsa *lsa, void *buf, size_t length,
+		size_t offset);
+int cxl_lsa_write(struct cxl_lsa *lsa, const void *buf, size_t length,
+		size_t offset);
+int cxl_lsa_zero(struct cxl_lsa *lsa, size_t length, size_t offset);
+int cxl_lsa_commit(struct cxl_lsa *lsa, unsigned int flags,
+		struct cxl_lsa_stats *stats);
 int cxl_memdev_cmd_identify(struct cxl_memdev *memdev);
 int cxl_memdev_device_info_get(struct cxl_memdev *memdev);
 int cxl_memdev_get_fw_info(struct cxl_memdev *memdev, bool is_os_img);
@@ -70,6 +127,20 @@ int cxl_memdev_set_event_interrupt_policy(struct cxl_memdev *memdev, u32 int_pol
 int cxl_memdev_get_timestamp(struct cxl_memdev *memdev);
 int cxl_memdev_set_timestamp(struct cxl_memdev *memdev, u64 timestamp);
 int cxl_memdev_get_alert_config(struct cxl_memdev *memdev);
+struct cxl_alert_config {
+	u8 valid_alerts;
+	u8 programmable_alerts;
+	u8 life_used_critical_alert_threshold;
+	u8 life_used_prog_warn_threshold;
+	u16 dev_over_temp_crit_alert_threshold;
+	u16 dev_under_temp_crit_alert_threshold;
+	u16 dev_over_temp_prog_warn_threshold;
+	u16 dev_under_temp_prog_warn_threshold;
+	u16 corr_vol_mem_err_prog_warn_threshold;
+	u16 corr_pers_mem_err_prog_warn_threshold;
+};
+int cxl_memdev_get_alert_config_fetch(struct cxl_memdev *memdev,
+	struct cxl_alert_config *cfg);
 int cxl_memdev_set_alert_config(struct cxl_memdev *memdev, u32 alert_prog_threshold,
     u32 device_temp_threshold, u32 mem_error_threshold);
 int cxl_memdev_get_health_info(struct cxl_memdev *memdev);
@@ -82,6 +153,8 @@ int cxl_memdev_hct_start_stop_trigger(struct cxl_memdev *memdev,
 	u8 hct_inst, u8 buf_control);
 int cxl_memdev_hct_get_buffer_status(struct cxl_memdev *memdev,
 	u8 hct_inst);
+int cxl_memdev_hct_get_buffer_status_fetch(struct cxl_memdev *memdev,
+	u8 hct_inst, u8 *buf_status, u8 *fill_level);
 int cxl_memdev_hct_enable(struct cxl_memdev *memdev, u8 hct_inst);
 int cxl_memdev_ltmon_capture_clear(struct cxl_memdev *memdev, u8 cxl_mem_id);
 int cxl_memdev_ltmon_capture(struct cxl_memdev *memdev, u8 cxl_mem_id,
@@ -98,8 +171,23 @@ int cxl_memdev_ltmon_watch(struct cxl_memdev *memdev, u8 cxl_mem_id,
 	u8 watch_id, u8 watch_mode, u8 src_maj_st, u8 src_min_st, u8 src_l0_st,
 	u8 dst_maj_st, u8 dst_min_st, u8 dst_l0_st);
 int cxl_memdev_ltmon_capture_stat(struct cxl_memdev *memdev, u8 cxl_mem_id);
+int cxl_memdev_ltmon_capture_stat_fetch(struct cxl_memdev *memdev,
+	u8 cxl_mem_id, u16 *trig_cnt, u16 *watch0_trig_cnt, u16 *watch1_trig_cnt,
+	u16 *time_stamp, u8 *trig_src_stat);
 int cxl_memdev_ltmon_capture_log_dmp(struct cxl_memdev *memdev,
 	u8 cxl_mem_id, u16 dump_idx, u16 dump_cnt);
+struct cxl_ltmon_log_entry {
+	u64 timestamp;
+	u32 arc;
+	u8 main_state;
+	u8 substate;
+	u8 rx_l0s_substate;
+	u8 link_rate;
+	u8 link_width;
+	bool timestamp_rollover;
+};
+int cxl_memdev_ltmon_capture_log_dump_all(struct cxl_memdev *memdev,
+	u8 cxl_mem_id, bool freeze, struct cxl_ltmon_log_entry **entries);
 int cxl_memdev_ltmon_capture_trigger(struct cxl_memdev *memdev,
 	u8 cxl_mem_id, u8 trig_src);
 int cxl_memdev_ltmon_enable(struct cxl_memdev *memdev, u8 cxl_mem_id,
@@ -134,12 +222,21 @@ int cxl_memdev_perfcnt_mta_hif_counter_clear(struct cxl_memdev *memdev,
 	u32 counter);
 int cxl_memdev_perfcnt_mta_hif_cnt_val_latch(struct cxl_memdev *memdev,
 	u32 counter);
+int cxl_memdev_perfcnt_snapshot(struct cxl_memdev *memdev, u8 mta_type,
+	const u32 *mta_counters, int nr_mta, const u32 *hif_counters,
+	int nr_hif, u64 *values, u64 *ts_ns, u64 *latch_ns);
 int cxl_memdev_perfcnt_ddr_generic_select(struct cxl_memdev *memdev,
 	u8 ddr_id, u8 cid, u8 rank, u8 bank, u8 bankgroup, u64 event);
 int cxl_memdev_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev,
 	u8 ddr_id, u32 poll_period_ms);
 int cxl_memdev_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev,
 	u8 ddr_id, u32 poll_period_ms);
+#define CXL_PERFCNT_DDR_GENERIC_COUNTERS 8
+#define CXL_PERFCNT_DDR_DFI_COUNTERS 6
+int cxl_memdev_perfcnt_ddr_generic_capture_fetch(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms, u32 *counters, int nr_counters);
+int cxl_memdev_perfcnt_ddr_dfi_capture_fetch(struct cxl_memdev *memdev,
+	u8 ddr_id, u32 poll_period_ms, u32 *counters, int nr_counters);
 int cxl_memdev_err_inj_drs_poison(struct cxl_memdev *memdev, u8 ch_id,
 	u8 duration, u8 inj_mode, u16 tag);
 int cxl_memdev_err_inj_drs_ecc(struct cxl_memdev *memdev, u8 ch_id,
@@ -153,6 +250,10 @@ int cxl_memdev_eh_eye_cap_read(struct cxl_memdev *memdev, u8 lane_id,
 	u8 bin_num);
 int cxl_memdev_eh_eye_cap_timeout_enable(struct cxl_memdev *memdev, u8 enable);
 int cxl_memdev_eh_eye_cap_status(struct cxl_memdev *memdev);
+int cxl_memdev_eh_eye_cap_status_fetch(struct cxl_memdev *memdev, u8 *stat);
+#define CXL_EH_EYE_CAP_MAX_PHASES 60
+int cxl_memdev_eh_eye_cap_read_lanes(struct cxl_memdev *memdev, u32 lane_mask,
+	int nr_bins, u32 *ber, u8 *num_phase);
 int cxl_memdev_eh_adapt_get(struct cxl_memdev *memdev, u32 lane_id);
 int cxl_memdev_eh_adapt_oneoff(struct cxl_memdev *memdev, u32 lane_id,
 	u32 preload, u32 loops, u32 objects);
@@ -177,6 +278,8 @@ int cxl_memdev_eh_link_dbg_cfg(struct cxl_memdev *memdev, u8 port_id, u8 op_mode
 	u8 cap_type, u16 lane_mask, u8 rate_mask, u32 timer_us, u32 cap_delay_us, u8 max_cap);
 int cxl_memdev_eh_link_dbg_entry_dump(struct cxl_memdev *memdev, u8 entry_idx);
 int cxl_memdev_eh_link_dbg_lane_dump(struct cxl_memdev *memdev, u8 entry_idx, u8 lane_idx);
+int cxl_memdev_eh_link_dbg_dump_all(struct cxl_memdev *memdev, u16 lane_mask,
+	void **buf, size_t *len);
 int cxl_memdev_eh_link_dbg_reset(struct cxl_memdev *memdev);
 int cxl_memdev_fbist_stopconfig_set(struct cxl_memdev *memdev,
 	u32 fbist_id, u8 stop_on_wresp, u8 stop_on_rresp, u8 stop_on_rdataerr);
@@ -220,10 +323,27 @@ int cxl_memdev_fbist_test_movinginversion(struct cxl_memdev *memdev,
 int cxl_memdev_fbist_test_randomsequence(struct cxl_memdev *memdev,
 	u32 fbist_id, u8 phase_nr, u64 start_address, u64 num_bytes, u32 ddrpage_size,
 	u32 seed_dr0, u32 seed_dr1);
+int cxl_memdev_fbist_run_get_fetch(struct cxl_memdev *memdev, u32 fbist_id,
+	u8 *txg0_run, u8 *txg1_run);
+int cxl_memdev_fbist_thread_status_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u8 *thread_state,
+	u16 *curr_thread_desc_index);
+int cxl_memdev_fbist_thread_bandwidth_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u32 *read_bw_cnt,
+	u32 *write_bw_cnt);
+int cxl_memdev_fbist_thread_latency_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u8 txg_nr, u8 thread_nr, u32 *read_latency_cnt,
+	u32 *write_latency_cnt);
+int cxl_memdev_fbist_top_err_cnt_get_fetch(struct cxl_memdev *memdev,
+	u32 fbist_id, u32 *rdata_err_cnt, u32 *rresp_err_cnt,
+	u32 *wresp_err_cnt);
 int cxl_memdev_conf_read(struct cxl_memdev *memdev, u32 offset,
 	u32 length);
 int cxl_memdev_hct_get_config(struct cxl_memdev *memdev, u8 hct_inst);
 int cxl_memdev_hct_read_buffer(struct cxl_memdev *memdev, u8 hct_inst, u8 num_entries_to_read);
+int cxl_memdev_hct_read_buffer_stream(struct cxl_memdev *memdev, u8 hct_inst,
+	int fd, unsigned int timeout_ms, unsigned int idle_ms, u64 *nr_entries,
+	u64 *nr_bytes, u8 *buf_end);
 int cxl_memdev_hct_set_config(struct cxl_memdev *memdev, u8 hct_inst, u8 config_flags,
 	u8 port_trig_depth, u8 ignore_invalid, int filesize, u8 *trig_config_buffer);
 int cxl_memdev_osa_os_patt_trig_cfg(struct cxl_memdev *memdev,
@@ -233,38 +353,132 @@ int cxl_memdev_osa_misc_trig_cfg(struct cxl_memdev *memdev, u8 cxl_mem_id,
 	u8 trig_en_mask);
 int cxl_memdev_osa_data_read(struct cxl_memdev *memdev, u8 cxl_mem_id,
 	u8 lane_id, u8 lane_dir, u16 start_entry, u8 num_entries);
+int cxl_memdev_osa_data_drain(struct cxl_memdev *memdev, u8 cxl_mem_id,
+	u8 lane_id, u8 lane_dir, u32 **entries, u8 *wrap);
 int cxl_memdev_dimm_spd_read(struct cxl_memdev *memdev, u32 spd_id,
 	u32 offset, u32 num_bytes);
 int cxl_memdev_ddr_training_status(struct cxl_memdev *memdev);
 int cxl_memdev_dimm_slot_info(struct cxl_memdev *memdev);
+#define CXL_DIMM_SPD_SIZE 512
+#define CXL_DIMM_MAX_SLOTS 4
+struct cxl_dimm_inventory {
+	u32 spd_id;
+	u8 channel_id;
+	char silk_screen;
+	const char *ram_type;
+	const char *module_type;
+	const char *manufacturer;
+	int size_gb;
+	int speed_mts;
+	char serial[9];
+	bool cached;
+};
+int cxl_memdev_dimm_spd_fetch(struct cxl_memdev *memdev, u32 spd_id, u8 *spd,
+	bool *cached);
+int cxl_memdev_dimm_inventory(struct cxl_memdev *memdev,
+	struct cxl_dimm_inventory *dimms, int max);
 int cxl_memdev_pmic_vtmon_info(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_margin_run(struct cxl_memdev *memdev, u8 slice_num, u8 rd_wr_margin, u8 ddr_id);
 int cxl_memdev_ddr_margin_status(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_margin_get(struct cxl_memdev *memdev);
+int cxl_memdev_ddr_margin_status_fetch(struct cxl_memdev *memdev, int *running);
+struct cxl_ddr_margin_window {
+	u8 ddr_id;
+	u8 rd_wr_margin;
+	u32 slice;
+	u32 bit;
+	int vref_level;
+	int margin_low;
+	int margin_high;
+	double min_delay_ps;
+	double max_delay_ps;
+};
+struct cxl_ddr_margin_result {
+	struct cxl_memdev *memdev;
+	int status;
+	int nr_windows;
+	struct cxl_ddr_margin_window *windows;
+};
+int cxl_memdev_ddr_margin_get_fetch(struct cxl_memdev *memdev,
+	struct cxl_ddr_margin_window **windows);
+int cxl_memdev_ddr_margin_execute(struct cxl_memdev **memdevs,
+	int nr_memdevs, u32 slice_mask, u8 rd_wr_mask, u8 ddr_mask,
+	unsigned int timeout_ms, struct cxl_ddr_margin_result *results);
 int cxl_memdev_ddr_stats_run(struct cxl_memdev *memdev, u8 ddr_id,
 							u32 monitor_time, u32 loop_count);
 int cxl_memdev_ddr_stats_status(struct cxl_memdev *memdev, int* run_status, uint32_t* loop_count);
 int cxl_memdev_ddr_stats_get(struct cxl_memdev *memdev);
+int cxl_memdev_ddr_stats_status_fetch(struct cxl_memdev *memdev,
+	int *run_status, uint32_t *loop_count);
+enum cxl_ddr_stats_format {
+	CXL_DDR_STATS_TEXT,
+	CXL_DDR_STATS_CSV,
+	CXL_DDR_STATS_JSON,
+};
+int cxl_memdev_ddr_stats_dump(struct cxl_memdev *memdev,
+	enum cxl_ddr_stats_format format, int snapshot);
 int cxl_memdev_reboot_mode_set(struct cxl_memdev *memdev, u8 reboot_mode);
 int cxl_memdev_curr_cxl_boot_mode_get(struct cxl_memdev *memdev);
 int cxl_memdev_pcie_eye_run(struct cxl_memdev *memdev, u8 lane, u8 sw_scan, u8 ber);
+int cxl_memdev_pcie_eye_run_fetch(struct cxl_memdev *memdev, u8 lane, u8 sw_scan,
+	u8 ber, int *run_status);
 int cxl_memdev_pcie_eye_status(struct cxl_memdev *memdev);
+int cxl_memdev_pcie_eye_status_fetch(struct cxl_memdev *memdev, int *running,
+	int *error);
 int cxl_memdev_pcie_eye_get_sw(struct cxl_memdev *memdev, uint offset);
 int cxl_memdev_pcie_eye_get_hw(struct cxl_memdev *memdev);
 int cxl_memdev_pcie_eye_get_sw_ber(struct cxl_memdev *memdev);
+int cxl_memdev_pcie_eye_get_sw_ber_fetch(struct cxl_memdev *memdev,
+	float *horiz_margin, float *vert_margin);
+bool cxl_pcie_eye_margins_pass(float horiz_margin, float vert_margin);
 int cxl_memdev_get_cxl_link_status(struct cxl_memdev *memdev);
 int cxl_memdev_get_device_info(struct cxl_memdev *memdev);
 int cxl_memdev_read_ddr_temp(struct cxl_memdev *memdev);
 int cxl_memdev_cxl_hpa_to_dpa(struct cxl_memdev *memdev, u64 hpa_address);
+#define CXL_DPA_INVALID ((u64)-1)
+struct cxl_hpa_dpa_stats {
+	unsigned int mailbox;
+	unsigned int modeled;
+	unsigned int verified;
+	unsigned int mismatches;
+	bool model_valid;
+	u64 granularity;
+	unsigned int ways;
+	unsigned int position;
+};
+int cxl_memdev_hpa_to_dpa_bulk(struct cxl_memdev *memdev, const u64 *hpa,
+	u64 *dpa, int nr, unsigned int verify_interval,
+	struct cxl_hpa_dpa_stats *stats);
 int cxl_memdev_get_cxl_membridge_errors(struct cxl_memdev *memdev);
 int cxl_memdev_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout, u32 iterations);
+#define CXL_DDR_BW_SUBSYS 2
+int cxl_memdev_get_ddr_bw_fetch(struct cxl_memdev *memdev,
+	u32 timeout, u32 iterations, float *peak_bw, int nr_subsys);
 int cxl_memdev_get_ddr_latency(struct cxl_memdev *memdev, u32 measure_time);
 int cxl_memdev_i2c_read(struct cxl_memdev *memdev, u16 slave_addr, u8 reg_addr, u8 num_bytes);
 int cxl_memdev_i2c_write(struct cxl_memdev *memdev, u16 slave_addr, u8 reg_addr, u8 data);
+#define CXL_I2C_MAX_SIZE_NUM_BYTES 128
+enum cxl_i2c_op_type {
+	CXL_I2C_OP_READ,
+	CXL_I2C_OP_WRITE,
+};
+struct cxl_i2c_op {
+	enum cxl_i2c_op_type type;
+	u16 slave_addr;
+	u8 reg_addr;
+	u8 num_bytes;
+	u8 data;
+	int status;
+	u32 result_offset;
+};
+int cxl_memdev_i2c_batch(struct cxl_memdev *memdev, struct cxl_i2c_op *ops,
+	int nr_ops, u8 *results, size_t results_len);
 int cxl_memdev_get_ddr_ecc_err_info(struct cxl_memdev *memdev);
 int cxl_memdev_start_ddr_ecc_scrub(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_ecc_scrub_status(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_cont_scrub_status(struct cxl_memdev *memdev);
+int cxl_memdev_ddr_cont_scrub_status_fetch(struct cxl_memdev *memdev,
+	u32 *cont_scrub_status);
 int cxl_memdev_ddr_cont_scrub_set(struct cxl_memdev *memdev, u32 cont_scrub_status);
 int cxl_memdev_ddr_init_status(struct cxl_memdev *memdev);
 int cxl_memdev_get_cxl_membridge_stats(struct cxl_memdev *memdev);
@@ -297,11 +511,29 @@ int cxl_memdev_ddr_bist_err_info_clr(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_spd_err_info_get(struct cxl_memdev *memdev);
 int cxl_memdev_ddr_spd_err_info_clr(struct cxl_memdev *memdev, u8 spd_err_clr_dimm_id_option);
 int cxl_memdev_cxl_ddr_irq_status_get(struct cxl_memdev *memdev);
+/* enabled_mask bits, bit n - 1 is cxl-ddr-irq-enable option n */
+#define CXL_IRQ_CXL_CORR	(1 << 0)
+#define CXL_IRQ_CXL_UNCORR	(1 << 1)
+#define CXL_IRQ_CXL_CFG		(1 << 2)
+#define CXL_IRQ_DDR0		(1 << 3)
+#define CXL_IRQ_DDR1		(1 << 4)
+int cxl_memdev_cxl_ddr_irq_status_fetch(struct cxl_memdev *memdev,
+	u8 *enabled_mask);
 int cxl_memdev_cxl_ddr_irq_enable_set(struct cxl_memdev *memdev, u8 irq_num_option);
 int cxl_memdev_ddr_threshold_set(struct cxl_memdev *memdev, u16 corr_err_threshold_cnt, u16 corr_err_time_limit, u16 uncorr_err_threshold_cnt, u16 uncorr_err_time_limit);
 int cxl_memdev_ddr_threshold_get(struct cxl_memdev *memdev);
+struct cxl_error_threshold {
+	u16 corr_err_threshold_cnt;
+	u16 corr_err_time_limit;
+	u16 uncorr_err_threshold_cnt;
+	u16 uncorr_err_time_limit;
+};
+int cxl_memdev_ddr_threshold_get_fetch(struct cxl_memdev *memdev,
+	struct cxl_error_threshold *thres);
 int cxl_memdev_cxl_threshold_set(struct cxl_memdev *memdev, u16 corr_err_threshold_cnt, u16 corr_err_time_limit, u16 uncorr_err_threshold_cnt, u16 uncorr_err_time_limit);
 int cxl_memdev_cxl_threshold_get(struct cxl_memdev *memdev);
+int cxl_memdev_cxl_threshold_get_fetch(struct cxl_memdev *memdev,
+	struct cxl_error_threshold *thres);
 int cxl_memdev_get_coredump(struct cxl_memdev *memdev);
 
 #define cxl_memdev_foreach(ctx, memdev) \
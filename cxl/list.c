@@ -11,11 +11,21 @@
 #include <cxl/libcxl.h>
 #include <util/parse-options.h>
 #include <ccan/array_size/array_size.h>
+#include <daxctl/libdaxctl.h>
+#include "parallel.h"
 
 static struct {
 	bool memdevs;
 	bool idle;
 	bool human;
+	bool serial;
+	bool firmware;
+	bool payload_max;
+	bool numa;
+	bool dax;
+	bool link;
+	bool health;
+	bool verbose;
 } list;
 
 static unsigned long listopts_to_flags(void)
@@ -26,6 +36,20 @@ static unsigned long listopts_to_flags(void)
 		flags |= UTIL_JSON_IDLE;
 	if (list.human)
 		flags |= UTIL_JSON_HUMAN;
+	if (list.serial || list.verbose)
+		flags |= UTIL_JSON_SERIAL;
+	if (list.firmware || list.verbose)
+		flags |= UTIL_JSON_FIRMWARE;
+	if (list.payload_max || list.verbose)
+		flags |= UTIL_JSON_PAYLOAD_MAX;
+	if (list.numa || list.verbose)
+		flags |= UTIL_JSON_NUMA;
+	if (list.dax || list.verbose)
+		flags |= UTIL_JSON_DAX;
+	if (list.link || list.verbose)
+		flags |= UTIL_JSON_LINK;
+	if (list.health || list.verbose)
+		flags |= UTIL_JSON_HEALTH;
 	return flags;
 }
 
@@ -47,6 +71,89 @@ static int num_list_flags(void)
 	return list.memdevs;
 }
 
+static int list_add_memdev(struct cxl_memdev *memdev,
+		struct cxl_memdev ***memdevs, int *nr)
+{
+	struct cxl_memdev **tmp;
+
+	tmp = realloc(*memdevs, (*nr + 1) * sizeof(*tmp));
+	if (!tmp)
+		return -ENOMEM;
+	tmp[(*nr)++] = memdev;
+	*memdevs = tmp;
+	return 0;
+}
+
+struct list_job {
+	struct json_object **jdev;
+	unsigned long flags;
+};
+
+static int list_memdev_json(struct cxl_memdev *memdev, int idx, void *arg)
+{
+	struct list_job *job = arg;
+
+	job->jdev[idx] = util_cxl_memdev_to_json(memdev, job->flags);
+	return job->jdev[idx] ? 0 : -ENOMEM;
+}
+
+static struct json_object *list_memdevs(struct cxl_memdev **memdevs, int nr,
+		unsigned long list_flags)
+{
+	struct list_job job = { .flags = list_flags };
+	struct json_object *jdevs, **jdev, *jobj;
+	struct daxctl_ctx *daxctl_ctx = NULL;
+	int i, *status;
+
+	jdevs = json_object_new_array();
+	jdev = calloc(nr, sizeof(*jdev));
+	status = calloc(nr, sizeof(*status));
+	if (!jdevs || !jdev || !status) {
+		fail("\n");
+		json_object_put(jdevs);
+		free(status);
+		free(jdev);
+		return NULL;
+	}
+	job.jdev = jdev;
+
+	/*
+	 * Only the health summary needs the mailbox, overlap those across
+	 * devices, everything else is a sysfs read.
+	 */
+	if (list_flags & UTIL_JSON_HEALTH)
+		memdev_parallel(memdevs, nr, list_memdev_json, &job, status);
+	else
+		for (i = 0; i < nr; i++)
+			list_memdev_json(memdevs[i], i, &job);
+
+	if ((list_flags & UTIL_JSON_DAX) && daxctl_new(&daxctl_ctx) < 0) {
+		fail("daxctl_new failed\n");
+		daxctl_ctx = NULL;
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (!jdev[i]) {
+			fail("\n");
+			continue;
+		}
+		if (daxctl_ctx) {
+			jobj = util_cxl_memdev_regions_to_json(memdevs[i],
+					daxctl_ctx, list_flags);
+			if (jobj)
+				json_object_object_add(jdev[i], "regions",
+						jobj);
+		}
+		json_object_array_add(jdevs, jdev[i]);
+	}
+
+	if (daxctl_ctx)
+		daxctl_unref(daxctl_ctx);
+	free(status);
+	free(jdev);
+	return jdevs;
+}
+
 int cmd_list(int argc, const char **argv, struct cxl_ctx *ctx)
 {
 	const struct option options[] = {
@@ -57,16 +164,33 @@ int cmd_list(int argc, const char **argv, struct cxl_ctx *ctx)
 		OPT_BOOLEAN('i', "idle", &list.idle, "include idle devices"),
 		OPT_BOOLEAN('u', "human", &list.human,
 				"use human friendly number formats "),
+		OPT_BOOLEAN('S', "serial", &list.serial,
+				"include the device serial number"),
+		OPT_BOOLEAN('F', "firmware", &list.firmware,
+				"include the firmware version"),
+		OPT_BOOLEAN('P', "payload-max", &list.payload_max,
+				"include the maximum mailbox payload size"),
+		OPT_BOOLEAN('N', "numa", &list.numa,
+				"include the NUMA node of the device"),
+		OPT_BOOLEAN('X', "dax", &list.dax,
+				"include the regions and dax devices it backs"),
+		OPT_BOOLEAN('L', "link", &list.link,
+				"include the PCIe link width and speed"),
+		OPT_BOOLEAN('H', "health", &list.health,
+				"include a health summary (mailbox command)"),
+		OPT_BOOLEAN('v', "verbose", &list.verbose,
+				"include all of the optional fields"),
 		OPT_END(),
 	};
 	const char * const u[] = {
 		"cxl list [<options>]",
 		NULL
 	};
+	struct cxl_memdev **memdevs = NULL, *memdev;
 	struct json_object *jdevs = NULL;
 	unsigned long list_flags;
-	struct cxl_memdev *memdev;
-	int i;
+	char name[32];
+	int i, id, nr = 0;
 
 	argc = parse_options(argc, argv, options, u, 0);
 	for (i = 0; i < argc; i++)
@@ -80,30 +204,27 @@ int cmd_list(int argc, const char **argv, struct cxl_ctx *ctx)
 
 	list_flags = listopts_to_flags();
 
-	cxl_memdev_foreach(ctx, memdev) {
-		struct json_object *jdev = NULL;
-
-		if (!util_cxl_memdev_filter(memdev, param.memdev))
-			continue;
-
-		if (list.memdevs) {
-			if (!jdevs) {
-				jdevs = json_object_new_array();
-				if (!jdevs) {
-					fail("\n");
-					continue;
-				}
-			}
-
-			jdev = util_cxl_memdev_to_json(memdev, list_flags);
-			if (!jdev) {
+	/* a single named memdev is looked up without enumerating the bus */
+	if (param.memdev && strcmp(param.memdev, "all") != 0) {
+		if (sscanf(param.memdev, "%d", &id) == 1)
+			snprintf(name, sizeof(name), "mem%d", id);
+		else
+			snprintf(name, sizeof(name), "%s", param.memdev);
+		memdev = cxl_memdev_get_by_name(ctx, name);
+		if (memdev && list_add_memdev(memdev, &memdevs, &nr) < 0)
+			fail("\n");
+	} else {
+		cxl_memdev_foreach(ctx, memdev)
+			if (list_add_memdev(memdev, &memdevs, &nr) < 0) {
 				fail("\n");
-				continue;
+				break;
 			}
-			json_object_array_add(jdevs, jdev);
-		}
 	}
 
+	if (list.memdevs && nr)
+		jdevs = list_memdevs(memdevs, nr, list_flags);
+	free(memdevs);
+
 	if (jdevs)
 		util_display_json_array(stdout, jdevs, list_flags);
 
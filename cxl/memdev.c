@@ -5,17 +5,27 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <limits.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <util/log.h>
+#include <util/json.h>
 #include <util/filter.h>
+#include <util/io.h>
+#include <util/time.h>
 #include <util/parse-options.h>
 #include <ccan/list/list.h>
 #include <ccan/minmax/minmax.h>
 #include <ccan/array_size/array_size.h>
 #include <ccan/endian/endian.h>
 #include <ccan/short_types/short_types.h>
+#include <json-c/json.h>
 #include <cxl/libcxl.h>
+#include "record.h"
+#include "parallel.h"
 
 
 
@@ -29,6 +39,7 @@ static struct parameters {
   const char *infile;
   unsigned len;
   unsigned offset;
+  bool verify;
   bool verbose;
 } param;
 
@@ -50,14 +61,32 @@ OPT_STRING('i', "input", &param.infile, "input-file", \
   "filename to read label area data")
 
 #define LABEL_OPTIONS() \
-OPT_UINTEGER('s', "size", &param.len, "number of label bytes to operate"), \
+OPT_UINTEGER('s', "size", &param.len, \
+  "number of label bytes to operate on (0: up to the end of the label area)"), \
 OPT_UINTEGER('O', "offset", &param.offset, \
-  "offset into the label area to start operation")
+  "offset into the label area to start operation"), \
+OPT_BOOLEAN('V', "verify", &param.verify, \
+  "read back every chunk and compare")
 
 u64 hpa_address;
 #define HPA_OPTIONS() \
 OPT_U64('h', "hpa", &hpa_address, "host physical address")
 
+static struct _hpa_bulk_params {
+	const char *file;
+	unsigned int verify;
+	u64 *hpa;
+	int nr;
+} hpa_bulk_params = {
+	.verify = 64,
+};
+
+#define HPA_BULK_OPTIONS() \
+OPT_STRING('f', "file", &hpa_bulk_params.file, "file", \
+  "translate every address in file ('-' for stdin), print HPA,DPA pairs"), \
+OPT_UINTEGER('V', "verify-interval", &hpa_bulk_params.verify, \
+  "with --file, check every Nth modeled translation with the device (0 = mailbox only)")
+
 static const struct option read_options[] = {
   BASE_OPTIONS(),
   LABEL_OPTIONS(),
@@ -500,6 +529,11 @@ static struct _ltmon_capture_log_dmp_params {
   u32 cxl_mem_id;
   u32 dump_idx;
   u32 dump_cnt;
+  bool all;
+  bool freeze;
+  const char *format;
+  const char *outfile;
+  FILE *out;
   bool verbose;
 } ltmon_capture_log_dmp_params;
 
@@ -507,7 +541,11 @@ static struct _ltmon_capture_log_dmp_params {
 #define LTMON_CAPTURE_LOG_DMP_OPTIONS() \
 OPT_UINTEGER('c', "cxl_mem_id", &ltmon_capture_log_dmp_params.cxl_mem_id, "CXL.MEM ID"), \
 OPT_UINTEGER('d', "dump_idx", &ltmon_capture_log_dmp_params.dump_idx, "Dump Index"), \
-OPT_UINTEGER('e', "dump_cnt", &ltmon_capture_log_dmp_params.dump_cnt, "Dump Count")
+OPT_UINTEGER('e', "dump_cnt", &ltmon_capture_log_dmp_params.dump_cnt, "Dump Count"), \
+OPT_BOOLEAN('a', "all", &ltmon_capture_log_dmp_params.all, "dump the whole capture log, ignores --dump_idx/--dump_cnt"), \
+OPT_BOOLEAN('F', "freeze", &ltmon_capture_log_dmp_params.freeze, "freeze the capture during --all and restore it afterwards"), \
+OPT_STRING('f', "format", &ltmon_capture_log_dmp_params.format, "format", "--all output format: 'json' (default) or 'binary'"), \
+OPT_STRING('o', "output", &ltmon_capture_log_dmp_params.outfile, "file", "--all output file ('-' for stdout, the default)")
 
 static const struct option cmd_ltmon_capture_log_dmp_options[] = {
   BASE_OPTIONS(),
@@ -844,6 +882,9 @@ static struct _perfcnt_ddr_generic_select_params {
   u32 bank;
   u32 bankgroup;
   u64 event;
+  const char *mux_events;
+  u32 slice_ms;
+  u32 slices;
   bool verbose;
 } perfcnt_ddr_generic_select_params;
 
@@ -854,7 +895,13 @@ OPT_UINTEGER('c', "cid", &perfcnt_ddr_generic_select_params.cid, "CID selection"
 OPT_UINTEGER('r', "rank", &perfcnt_ddr_generic_select_params.rank, "Rank selection"), \
 OPT_UINTEGER('b', "bank", &perfcnt_ddr_generic_select_params.bank, "Bank selection"), \
 OPT_UINTEGER('e', "bankgroup", &perfcnt_ddr_generic_select_params.bankgroup, "Bank Group selection"), \
-OPT_U64('f', "event", &perfcnt_ddr_generic_select_params.event, "Events selection")
+OPT_U64('f', "event", &perfcnt_ddr_generic_select_params.event, "Events selection"), \
+OPT_STRING('m', "mux-events", &perfcnt_ddr_generic_select_params.mux_events, "list", \
+  "multiplex these events over the counters and report scaled counts, e.g. 0-3,9,0x18"), \
+OPT_UINTEGER('s', "slice-ms", &perfcnt_ddr_generic_select_params.slice_ms, \
+  "multiplexing time slice in ms (default 100)"), \
+OPT_UINTEGER('l', "slices", &perfcnt_ddr_generic_select_params.slices, \
+  "number of time slices (default: every event scheduled 4 times)")
 
 static const struct option cmd_perfcnt_ddr_generic_select_options[] = {
   BASE_OPTIONS(),
@@ -862,6 +909,40 @@ static const struct option cmd_perfcnt_ddr_generic_select_options[] = {
   OPT_END(),
 };
 
+static struct _record_params {
+  const char *file;
+  u32 samples;
+  struct record *rec;
+} record_params;
+
+#define RECORD_OPTIONS() \
+OPT_STRING('R', "record", &record_params.file, "capture-file", \
+  "append samples to a columnar capture file (see 'cxl report')"), \
+OPT_UINTEGER('n', "samples", &record_params.samples, \
+  "samples to record per memdev, 0 records one memdev until interrupted")
+
+#define PERFCNT_SNAPSHOT_MAX_COUNTERS 32
+
+static struct _perfcnt_snapshot_params {
+  u32 mta_type;
+  const char *mta_counters;
+  const char *hif_counters;
+} perfcnt_snapshot_params;
+
+#define PERFCNT_SNAPSHOT_OPTIONS() \
+OPT_UINTEGER('t', "type", &perfcnt_snapshot_params.mta_type, "MTA interface type (0: LTIF, 1: HIF)"), \
+OPT_STRING('m', "mta-counters", &perfcnt_snapshot_params.mta_counters, "list", \
+  "MTA counters to latch, e.g. 0-3,6"), \
+OPT_STRING('f', "hif-counters", &perfcnt_snapshot_params.hif_counters, "list", \
+  "HIF counters to latch, e.g. 0-7")
+
+static const struct option cmd_perfcnt_snapshot_options[] = {
+  BASE_OPTIONS(),
+  PERFCNT_SNAPSHOT_OPTIONS(),
+  RECORD_OPTIONS(),
+  OPT_END(),
+};
+
 static struct _perfcnt_ddr_generic_capture_params {
 	u32 ddr_id;
 	u32 poll_period_ms;
@@ -878,6 +959,7 @@ OPT_UINTEGER('c', "poll_period_ms", &perfcnt_ddr_generic_capture_params.poll_per
 static const struct option cmd_perfcnt_ddr_generic_capture_options[] = {
 	PERFCNT_DDR_GENERIC_CAPTURE_BASE_OPTIONS(),
 	PERFCNT_DDR_GENERIC_CAPTURE_OPTIONS(),
+	RECORD_OPTIONS(),
 	OPT_END(),
 };
 
@@ -897,6 +979,7 @@ OPT_UINTEGER('c', "poll_period_ms", &perfcnt_ddr_dfi_capture_params.poll_period_
 static const struct option cmd_perfcnt_ddr_dfi_capture_options[] = {
 	PERFCNT_DDR_DFI_CAPTURE_BASE_OPTIONS(),
 	PERFCNT_DDR_DFI_CAPTURE_OPTIONS(),
+	RECORD_OPTIONS(),
 	OPT_END(),
 };
 
@@ -1051,6 +1134,46 @@ static const struct option cmd_eh_eye_cap_status_options[] = {
   OPT_END(),
 };
 
+static struct _eye_scan_params {
+	const char *lanes;
+	u32 depth;
+	u32 bins;
+	u32 threshold;
+	u32 min_width;
+	u32 min_height;
+	bool pcie;
+	u32 timeout_s;
+	u32 poll_min_ms;
+	u32 poll_max_ms;
+	bool header_done;
+	bool verbose;
+} eye_scan_params = {
+	.bins = 1,
+	.timeout_s = 60,
+};
+
+#define EYE_SCAN_BASE_OPTIONS() \
+OPT_BOOLEAN('v',"verbose", &eye_scan_params.verbose, "turn on debug")
+
+#define EYE_SCAN_OPTIONS() \
+OPT_STRING('l', "lanes", &eye_scan_params.lanes, "list", \
+  "Lanes to scan, e.g. 0-7,12 (default 0-15)"), \
+OPT_UINTEGER('d', "depth", &eye_scan_params.depth, "EH capture depth (BT_DEPTH_MIN to BT_DEPTH_MAX)"), \
+OPT_UINTEGER('b', "bins", &eye_scan_params.bins, "EH bins to read per lane (default 1)"), \
+OPT_UINTEGER('t', "threshold", &eye_scan_params.threshold, "Highest BER count treated as open (default 0)"), \
+OPT_UINTEGER('w', "min-width", &eye_scan_params.min_width, "EH eye width in phases needed to pass"), \
+OPT_UINTEGER('H', "min-height", &eye_scan_params.min_height, "EH eye height in bins needed to pass"), \
+OPT_BOOLEAN('p', "pcie", &eye_scan_params.pcie, "Use the PCIe SW eye scan instead of the EH capture"), \
+OPT_UINTEGER('T', "timeout", &eye_scan_params.timeout_s, "Give up on a capture after this many seconds (default 60)"), \
+OPT_UINTEGER('m', "poll-min-ms", &eye_scan_params.poll_min_ms, "Shortest poll interval (default 10)"), \
+OPT_UINTEGER('M', "poll-max-ms", &eye_scan_params.poll_max_ms, "Longest poll interval (default 1000)")
+
+static const struct option cmd_eye_scan_options[] = {
+	EYE_SCAN_BASE_OPTIONS(),
+	EYE_SCAN_OPTIONS(),
+	OPT_END(),
+};
+
 static struct _eh_adapt_get_params {
   u32 lane_id;
   bool verbose;
@@ -1513,6 +1636,44 @@ static const struct option cmd_fbist_test_randomsequence_options[] = {
 	OPT_END(),
 };
 
+static struct _fbist_run_params {
+	const char *test;
+	u32 test_nr;
+	u32 instances;
+	u32 threads;
+	u64 start_address;
+	u64 num_bytes;
+	u32 ddrpage_size;
+	u32 seed;
+	u32 timeout_s;
+	u32 poll_min_ms;
+	u32 poll_max_ms;
+	bool verbose;
+} fbist_run_params;
+
+#define FBIST_RUN_BASE_OPTIONS() \
+OPT_BOOLEAN('v',"verbose", &fbist_run_params.verbose, "turn on debug")
+
+#define FBIST_RUN_OPTIONS() \
+OPT_STRING('g', "test", &fbist_run_params.test, "group", \
+  "simpledata, addresstest, movinginversion or randomsequence"), \
+OPT_UINTEGER('t', "test_nr", &fbist_run_params.test_nr, "Test number within the group"), \
+OPT_UINTEGER('i', "instances", &fbist_run_params.instances, "Flex BIST instances to spread the range over (default 1)"), \
+OPT_UINTEGER('r', "threads", &fbist_run_params.threads, "Threads per TXG to monitor (default 1)"), \
+OPT_U64('s', "start_address", &fbist_run_params.start_address, "Start DPA"), \
+OPT_U64('n', "num_bytes", &fbist_run_params.num_bytes, "Bytes to test (default: rest of the device)"), \
+OPT_UINTEGER('d', "ddrpage_size", &fbist_run_params.ddrpage_size, "DDR Page size"), \
+OPT_UINTEGER('e', "seed", &fbist_run_params.seed, "Seed for addresstest/randomsequence"), \
+OPT_UINTEGER('T', "timeout", &fbist_run_params.timeout_s, "Abort a phase after this many seconds (default: no limit)"), \
+OPT_UINTEGER('m', "poll-min-ms", &fbist_run_params.poll_min_ms, "Shortest poll interval (default 10)"), \
+OPT_UINTEGER('M', "poll-max-ms", &fbist_run_params.poll_max_ms, "Longest poll interval (default 1000)")
+
+static const struct option cmd_fbist_run_options[] = {
+	FBIST_RUN_BASE_OPTIONS(),
+	FBIST_RUN_OPTIONS(),
+	OPT_END(),
+};
+
 static struct _eh_adapt_force_params {
   u32 lane_id;
   u32 rate;
@@ -1742,6 +1903,29 @@ static const struct option cmd_eh_link_dbg_lane_dump_options[] = {
 	OPT_END(),
 };
 
+static struct _eh_link_dbg_dump_all_params {
+	u32 lane_mask;
+	const char *format;
+	const char *outfile;
+	FILE *out;
+	struct json_object *jdumps;
+	bool verbose;
+} eh_link_dbg_dump_all_params = { .lane_mask = 0xffff };
+
+#define EH_LINK_DBG_DUMP_ALL_BASE_OPTIONS() \
+OPT_BOOLEAN('v', "verbose", &eh_link_dbg_dump_all_params.verbose, "turn on debug")
+
+#define EH_LINK_DBG_DUMP_ALL_OPTIONS() \
+OPT_UINTEGER('l', "lane_mask", &eh_link_dbg_dump_all_params.lane_mask, "lanes to dump (default 0xffff)"), \
+OPT_STRING('f', "format", &eh_link_dbg_dump_all_params.format, "format", "'json' (default) or 'binary'"), \
+OPT_STRING('o', "output", &eh_link_dbg_dump_all_params.outfile, "file", "output file ('-' for stdout, the default)")
+
+static const struct option cmd_eh_link_dbg_dump_all_options[] = {
+	EH_LINK_DBG_DUMP_ALL_BASE_OPTIONS(),
+	EH_LINK_DBG_DUMP_ALL_OPTIONS(),
+	OPT_END(),
+};
+
 static struct _eh_link_dbg_reset_params {
 	bool verbose;
 } eh_link_dbg_reset_params;
@@ -1835,6 +2019,44 @@ static const struct option cmd_hct_set_config_options[] = {
 	OPT_END(),
 };
 
+static struct _hct_stream_params {
+	u32 hct_inst;
+	bool enable;
+	u32 config_flags;
+	u32 post_trig_depth;
+	u32 ignore_valid;
+	const char *trig_config_file;
+	u32 buf_control;
+	const char *outfile;
+	u32 time_limit;
+	u32 idle_limit;
+	bool keep;
+	bool verbose;
+} hct_stream_params = { .buf_control = 2, .time_limit = 10, .idle_limit = 5 };
+
+#define HCT_STREAM_BASE_OPTIONS() \
+OPT_BOOLEAN('v',"verbose", &hct_stream_params.verbose, "turn on debug")
+
+#define HCT_STREAM_OPTIONS() \
+OPT_UINTEGER('i', "hct_inst", &hct_stream_params.hct_inst, "HCT Instance"), \
+OPT_BOOLEAN('e', "enable", &hct_stream_params.enable, "enable the HCT instance before streaming"), \
+OPT_UINTEGER('c', "config_flags", &hct_stream_params.config_flags, "hct-set-config flags, 0 keeps the current config"), \
+OPT_UINTEGER('p', "post_trig_depth", &hct_stream_params.post_trig_depth, "Post Trigger Depth"), \
+OPT_UINTEGER('n', "ignore_valid", &hct_stream_params.ignore_valid, "Ignore Valid"), \
+OPT_FILENAME('t', "trig_config_file", &hct_stream_params.trig_config_file, "Trigger Config filepath", \
+  "Filepath containing trigger config"), \
+OPT_UINTEGER('b', "buf_control", &hct_stream_params.buf_control, "buffer control to start with (1: pre-trigger, 2: post-trigger)"), \
+OPT_STRING('o', "output", &hct_stream_params.outfile, "file", "file the raw entries are written to ('-' for stdout)"), \
+OPT_UINTEGER('T', "time-limit", &hct_stream_params.time_limit, "stop streaming after this many seconds (0: until buf_end)"), \
+OPT_UINTEGER('I', "idle-limit", &hct_stream_params.idle_limit, "stop streaming after this many seconds without new entries (0: never)"), \
+OPT_BOOLEAN('k', "keep", &hct_stream_params.keep, "leave the trace buffer running when done")
+
+static const struct option cmd_hct_stream_options[] = {
+	HCT_STREAM_BASE_OPTIONS(),
+	HCT_STREAM_OPTIONS(),
+	OPT_END(),
+};
+
 static struct _osa_os_patt_trig_cfg_params {
 	u32 cxl_mem_id;
 	u32 lane_mask;
@@ -1887,8 +2109,14 @@ static struct _osa_data_read_params {
 	u32 lane_dir;
 	u32 start_entry;
 	u32 num_entries;
+	bool drain;
+	const char *outfile;
+	int fd;
+	bool close_fd;
+	const char *lanes;
+	const char *dirs;
 	bool verbose;
-} osa_data_read_params;
+} osa_data_read_params = { .fd = -1 };
 
 #define OSA_DATA_READ_BASE_OPTIONS() \
 OPT_BOOLEAN('v',"verbose", &osa_data_read_params.verbose, "turn on debug")
@@ -1898,7 +2126,12 @@ OPT_UINTEGER('c', "cxl_mem_id", &osa_data_read_params.cxl_mem_id, "CXL.MEM ID"),
 OPT_UINTEGER('l', "lane_id", &osa_data_read_params.lane_id, "Lane ID"), \
 OPT_UINTEGER('m', "lane_dir", &osa_data_read_params.lane_dir, "lane direction (see osa_lane_dir_enum)"), \
 OPT_UINTEGER('s', "start_entry", &osa_data_read_params.start_entry, "index of the first entry to read"), \
-OPT_UINTEGER('n', "num_entries", &osa_data_read_params.num_entries, "maximum number of entries to read")
+OPT_UINTEGER('n', "num_entries", &osa_data_read_params.num_entries, "maximum number of entries to read"), \
+OPT_BOOLEAN('d', "drain", &osa_data_read_params.drain, "read all captured entries and write them as raw binary"), \
+OPT_STRING('o', "output", &osa_data_read_params.outfile, "file", "drain output file ('-' for stdout, the default)"), \
+OPT_INTEGER('f', "fd", &osa_data_read_params.fd, "drain to this already open file descriptor"), \
+OPT_STRING('L', "lanes", &osa_data_read_params.lanes, "list", "drain these lanes instead of --lane_id, e.g. 0-15"), \
+OPT_STRING('M', "dirs", &osa_data_read_params.dirs, "list", "drain these directions instead of --lane_dir, e.g. 0,1")
 
 static const struct option cmd_osa_data_read_options[] = {
 	OSA_DATA_READ_BASE_OPTIONS(),
@@ -1937,6 +2170,19 @@ static const struct option cmd_dimm_slot_info_options[] = {
   OPT_END(),
 };
 
+static struct _ddr_inventory_params {
+	struct json_object *jdevs;
+	bool verbose;
+} ddr_inventory_params;
+
+#define DDR_INVENTORY_BASE_OPTIONS() \
+OPT_BOOLEAN('v',"verbose", &ddr_inventory_params.verbose, "also report whether each SPD was served from the cache")
+
+static const struct option cmd_ddr_inventory_options[] = {
+  DDR_INVENTORY_BASE_OPTIONS(),
+  OPT_END(),
+};
+
 static const struct option cmd_pmic_vtmon_info_options[] = {
   BASE_OPTIONS(),
   OPT_END(),
@@ -1970,6 +2216,33 @@ static const struct option cmd_ddr_margin_get_options[] = {
   OPT_END(),
 };
 
+static struct _ddr_margin_execute_params {
+	const char *slices;
+	const char *rd_wr_margins;
+	const char *ddr_ids;
+	u32 timeout_s;
+	struct cxl_memdev **memdevs;
+	int nr_memdevs;
+	bool verbose;
+} ddr_margin_execute_params = {
+	.timeout_s = 600,
+};
+
+#define DDR_MARGIN_EXECUTE_OPTIONS() \
+OPT_STRING('s', "slices", &ddr_margin_execute_params.slices, "list", \
+  "Slices to sweep, e.g. 0-3,8 (default 0-8)"), \
+OPT_STRING('m', "rd_wr_margins", &ddr_margin_execute_params.rd_wr_margins, "list", \
+  "RD/WR margin selections to sweep (default 0-1)"), \
+OPT_STRING('i', "ddr_ids", &ddr_margin_execute_params.ddr_ids, "list", \
+  "DDR ids to sweep (default 0-1)"), \
+OPT_UINTEGER('T', "timeout", &ddr_margin_execute_params.timeout_s, "Give up on a sweep point after this many seconds (default 600, 0: no limit)")
+
+static const struct option cmd_ddr_margin_execute_options[] = {
+  BASE_OPTIONS(),
+  DDR_MARGIN_EXECUTE_OPTIONS(),
+  OPT_END(),
+};
+
 static struct _ddr_stats_run_params {
 	u32 ddr_id;
 	u32 monitor_time;
@@ -1988,8 +2261,31 @@ static const struct option cmd_ddr_stats_run_options[] = {
   OPT_END(),
 };
 
+static struct _ddr_stats_get_params {
+	const char *format;
+	u32 loop;
+	u32 ddr_id;
+	u32 monitor_time;
+	u32 loop_count;
+	u32 timeout_s;
+	bool verbose;
+} ddr_stats_get_params = {
+	.loop_count = 1,
+	.timeout_s = 60,
+};
+
+#define DDR_STATS_GET_OPTIONS() \
+OPT_STRING('f', "format", &ddr_stats_get_params.format, "format", \
+  "text (default), csv or json"), \
+OPT_UINTEGER('l', "loop", &ddr_stats_get_params.loop, "Re-run ddr-stats-run this many times and collect every snapshot"), \
+OPT_UINTEGER('i', "ddr_id", &ddr_stats_get_params.ddr_id, "DDR ID for --loop runs"), \
+OPT_UINTEGER('m', "monitor_time", &ddr_stats_get_params.monitor_time, "MONITOR TIME MSEC for --loop runs"), \
+OPT_UINTEGER('n', "loop_count", &ddr_stats_get_params.loop_count, "NUM ITERATION for --loop runs (default 1)"), \
+OPT_UINTEGER('T', "timeout", &ddr_stats_get_params.timeout_s, "Give up on a --loop run after this many seconds past its monitor time (default 60)")
+
 static const struct option cmd_ddr_stats_get_options[] = {
   BASE_OPTIONS(),
+  DDR_STATS_GET_OPTIONS(),
   OPT_END(),
 };
 
@@ -2069,6 +2365,7 @@ static const struct option cmd_read_ddr_temp_options[] = {
 static const struct option cmd_cxl_hpa_to_dpa_options[] = {
   BASE_OPTIONS(),
   HPA_OPTIONS(),
+  HPA_BULK_OPTIONS(),
   OPT_END(),
 };
 
@@ -2090,6 +2387,7 @@ OPT_UINTEGER('i', "iterations", &get_ddr_bw_params.iterations, "No Iterations")
 static const struct option cmd_get_ddr_bw_options[] = {
   BASE_OPTIONS(),
   GET_DDR_BW_OPTIONS(),
+  RECORD_OPTIONS(),
   OPT_END(),
 };
 
@@ -2143,6 +2441,24 @@ static const struct option cmd_i2c_write_options[] = {
   OPT_END(),
 };
 
+static struct _i2c_batch_params {
+	const char *file;
+	struct cxl_i2c_op *ops;
+	int nr_ops;
+	struct json_object *jdevs;
+	bool verbose;
+} i2c_batch_params;
+
+#define I2C_BATCH_OPTIONS() \
+OPT_STRING('f', "file", &i2c_batch_params.file, "file", \
+  "ops, one per line: 'r <slave> <reg> [<num_bytes>]' or 'w <slave> <reg> <data>' ('-' for stdin)")
+
+static const struct option cmd_i2c_batch_options[] = {
+  BASE_OPTIONS(),
+  I2C_BATCH_OPTIONS(),
+  OPT_END(),
+};
+
 static const struct option cmd_get_ddr_ecc_err_info_options[] = {
   BASE_OPTIONS(),
   OPT_END(),
@@ -2531,6 +2847,25 @@ static const struct option cmd_cxl_threshold_get_options[] = {
   OPT_END(),
 };
 
+static struct _apply_config_params {
+	const char *config;
+	bool dry_run;
+	struct cxl_memdev **memdevs;
+	int nr_memdevs;
+} apply_config_params;
+
+#define APPLY_CONFIG_OPTIONS() \
+OPT_STRING('c', "config", &apply_config_params.config, "file", \
+  "desired settings, 'key = value' lines with optional [memN] sections"), \
+OPT_BOOLEAN('n', "dry-run", &apply_config_params.dry_run, \
+  "report the changes without issuing any set command")
+
+static const struct option cmd_apply_config_options[] = {
+  BASE_OPTIONS(),
+  APPLY_CONFIG_OPTIONS(),
+  OPT_END(),
+};
+
 static int action_cmd_clear_event_records(struct cxl_memdev *memdev, struct action_context *actx)
 {
   u16 record_handle;
@@ -3112,6 +3447,119 @@ static int action_cmd_ltmon_capture_stat(struct cxl_memdev *memdev, struct actio
   return cxl_memdev_ltmon_capture_stat(memdev, ltmon_capture_stat_params.cxl_mem_id);
 }
 
+/*
+ * ltmon-capture-log-dmp --all: the decoded log is written either as one
+ * JSON object per line, or as a struct ltmon_dump_hdr followed by
+ * nr_entries struct ltmon_dump_entry records, per memdev.
+ */
+struct ltmon_dump_hdr {
+	char magic[4];
+	u8 cxl_mem_id;
+	u8 rsvd[3];
+	__le32 nr_entries;
+} __attribute__((packed));
+
+struct ltmon_dump_entry {
+	__le64 timestamp;
+	__le32 arc;
+	u8 main_state;
+	u8 substate;
+	u8 rx_l0s_substate;
+	u8 link;		/* [7:5] rate, [4:2] width, [0] timestamp rollover */
+} __attribute__((packed));
+
+#define LTMON_DUMP_MAGIC "LTMD"
+
+static void ltmon_dump_pack(const struct cxl_ltmon_log_entry *l,
+		struct ltmon_dump_entry *e)
+{
+	e->timestamp = cpu_to_le64(l->timestamp);
+	e->arc = cpu_to_le32(l->arc);
+	e->rx_l0s_substate = l->rx_l0s_substate;
+	e->substate = l->substate;
+	e->main_state = l->main_state;
+	e->link = l->link_rate << 5 | l->link_width << 2 | l->timestamp_rollover;
+}
+
+static FILE *ltmon_dump_out(void)
+{
+	struct _ltmon_capture_log_dmp_params *p = &ltmon_capture_log_dmp_params;
+
+	if (p->out)
+		return p->out;
+	if (!p->outfile || strcmp(p->outfile, "-") == 0)
+		p->out = stdout;
+	else {
+		p->out = fopen(p->outfile, "w");
+		if (!p->out)
+			fprintf(stderr, "failed to open %s: %s\n", p->outfile,
+				strerror(errno));
+	}
+	return p->out;
+}
+
+static int ltmon_capture_log_dump_all(struct cxl_memdev *memdev)
+{
+	struct _ltmon_capture_log_dmp_params *p = &ltmon_capture_log_dmp_params;
+	const char *devname = cxl_memdev_get_devname(memdev);
+	struct cxl_ltmon_log_entry *entries;
+	struct ltmon_dump_entry e;
+	struct ltmon_dump_hdr hdr;
+	struct json_object *jentry;
+	bool binary = false;
+	FILE *out;
+	int rc, i;
+
+	if (p->format && strcmp(p->format, "binary") == 0)
+		binary = true;
+	else if (p->format && strcmp(p->format, "json") != 0) {
+		fprintf(stderr, "%s: unknown --format '%s'\n", devname, p->format);
+		return -EINVAL;
+	}
+
+	out = ltmon_dump_out();
+	if (!out)
+		return -errno;
+
+	rc = cxl_memdev_ltmon_capture_log_dump_all(memdev, p->cxl_mem_id,
+		p->freeze, &entries);
+	if (rc < 0)
+		return rc;
+
+	if (binary) {
+		memcpy(hdr.magic, LTMON_DUMP_MAGIC, sizeof(hdr.magic));
+		hdr.cxl_mem_id = p->cxl_mem_id;
+		memset(hdr.rsvd, 0, sizeof(hdr.rsvd));
+		hdr.nr_entries = cpu_to_le32(rc);
+		fwrite(&hdr, sizeof(hdr), 1, out);
+	}
+	for (i = 0; i < rc; i++) {
+		if (binary) {
+			ltmon_dump_pack(&entries[i], &e);
+			fwrite(&e, sizeof(e), 1, out);
+			continue;
+		}
+		jentry = util_cxl_memdev_ltmon_log_entry_to_json(devname,
+			p->cxl_mem_id, i, &entries[i]);
+		if (!jentry) {
+			free(entries);
+			return -ENOMEM;
+		}
+		fprintf(out, "%s\n", json_object_to_json_string_ext(jentry,
+			JSON_C_TO_STRING_PLAIN));
+		json_object_put(jentry);
+	}
+	free(entries);
+
+	if (fflush(out) || ferror(out)) {
+		fprintf(stderr, "%s: write failed\n", devname);
+		return -EIO;
+	}
+	if (p->verbose)
+		fprintf(stderr, "%s: dumped %d ltmon entries\n", devname, i);
+	return 0;
+}
+
 static int action_cmd_ltmon_capture_log_dmp(struct cxl_memdev *memdev, struct action_context *actx)
 {
   if (cxl_memdev_is_active(memdev)) {
@@ -3120,6 +3568,9 @@ static int action_cmd_ltmon_capture_log_dmp(struct cxl_memdev *memdev, struct ac
     return -EBUSY;
   }
 
+  if (ltmon_capture_log_dmp_params.all)
+    return ltmon_capture_log_dump_all(memdev);
+
   return cxl_memdev_ltmon_capture_log_dmp(memdev, ltmon_capture_log_dmp_params.cxl_mem_id,
     ltmon_capture_log_dmp_params.dump_idx, ltmon_capture_log_dmp_params.dump_cnt);
 }
@@ -3339,6 +3790,182 @@ static int action_cmd_perfcnt_mta_hif_cnt_val_latch(struct cxl_memdev *memdev, s
   return cxl_memdev_perfcnt_mta_hif_cnt_val_latch(memdev, perfcnt_mta_hif_cnt_val_latch_params.counter);
 }
 
+/*
+ * Parse a counter list such as "0-3,6" into @counters. Returns the number
+ * of counters or a negative errno.
+ */
+static int parse_counter_list(const char *list, u32 *counters, int max)
+{
+	const char *p = list;
+	unsigned long first, last;
+	char *end;
+	int n = 0;
+
+	if (!list)
+		return 0;
+
+	while (*p) {
+		first = strtoul(p, &end, 0);
+		if (end == p)
+			return -EINVAL;
+		last = first;
+		if (*end == '-') {
+			p = end + 1;
+			last = strtoul(p, &end, 0);
+			if (end == p || last < first)
+				return -EINVAL;
+		}
+		for (; first <= last; first++) {
+			if (n >= max)
+				return -E2BIG;
+			counters[n++] = first;
+		}
+		if (*end == ',')
+			end++;
+		else if (*end)
+			return -EINVAL;
+		p = end;
+	}
+	return n;
+}
+
+/*
+ * perfcnt-ddr-generic-select --mux-events: measure more events than there
+ * are generic counters by rotating the event selection across the counter
+ * slots every time slice. Each event accumulates its counts and the time
+ * it was actually counting, measured around every capture; counts are
+ * then scaled by total/enabled time, like perf does for multiplexed
+ * events.
+ *
+ * The error estimate is the standard error of the scaled count derived
+ * from the per-slice variance of the event, with a finite population
+ * correction so that an event that was never descheduled reports zero.
+ */
+#define PERFCNT_DDR_MUX_MAX_EVENTS 64
+#define PERFCNT_DDR_MUX_SLICE_MS 100
+#define PERFCNT_DDR_MUX_PASSES 4
+
+struct perfcnt_ddr_mux_event {
+	u32 event;
+	u64 raw;
+	double sum_sq;
+	u32 slices;
+	u64 enabled_ns;
+};
+
+static void perfcnt_ddr_mux_report(struct cxl_memdev *memdev,
+		struct perfcnt_ddr_mux_event *ev, int nr_events, u32 slices,
+		u32 slice_ms, u64 total_ns)
+{
+	double k, mean, var, scaled, rel;
+	int i;
+
+	fprintf(stdout, "======================== perfcnt ddr generic multiplexed ========================\n");
+	fprintf(stdout, "%s: %u slices of %u ms, %d events on %d counters\n",
+		cxl_memdev_get_devname(memdev), slices, slice_ms, nr_events,
+		CXL_PERFCNT_DDR_GENERIC_COUNTERS);
+	fprintf(stdout, "%-8s %16s %12s %12s %18s %10s\n", "event", "raw",
+		"enabled_ms", "total_ms", "scaled", "error");
+
+	for (i = 0; i < nr_events; i++) {
+		k = ev[i].slices;
+		scaled = ev[i].enabled_ns ?
+			ev[i].raw * ((double)total_ns / ev[i].enabled_ns) : 0;
+
+		fprintf(stdout, "0x%-6x %16llu %12.1f %12.1f %18.0f ", ev[i].event,
+			(unsigned long long)ev[i].raw, ev[i].enabled_ns / 1e6,
+			total_ns / 1e6, scaled);
+
+		if (ev[i].slices == slices) {
+			fprintf(stdout, "%9.2f%%\n", 0.0);
+			continue;
+		}
+		if (ev[i].slices < 2 || scaled == 0) {
+			fprintf(stdout, "%10s\n", "n/a");
+			continue;
+		}
+		mean = ev[i].raw / k;
+		var = (ev[i].sum_sq - k * mean * mean) / (k - 1);
+		if (var < 0)
+			var = 0;
+		rel = sqrt(var / k) * sqrt(1 - k / slices) / mean;
+		fprintf(stdout, "%9.2f%%\n", 100 * rel);
+	}
+}
+
+static int perfcnt_ddr_generic_mux(struct cxl_memdev *memdev)
+{
+	struct _perfcnt_ddr_generic_select_params *p = &perfcnt_ddr_generic_select_params;
+	struct perfcnt_ddr_mux_event ev[PERFCNT_DDR_MUX_MAX_EVENTS];
+	u32 ids[PERFCNT_DDR_MUX_MAX_EVENTS];
+	u32 counters[CXL_PERFCNT_DDR_GENERIC_COUNTERS];
+	int slot[CXL_PERFCNT_DDR_GENERIC_COUNTERS];
+	int nr_events, nr_slots, next = 0, rc, i;
+	u32 slice_ms, slices, rounds, n;
+	u64 event, t0, dt, total_ns = 0;
+
+	nr_events = parse_counter_list(p->mux_events, ids, ARRAY_SIZE(ids));
+	if (nr_events <= 0) {
+		fprintf(stderr, "%s: invalid --mux-events list (at most %d events)\n",
+			cxl_memdev_get_devname(memdev), PERFCNT_DDR_MUX_MAX_EVENTS);
+		return -EINVAL;
+	}
+	for (i = 0; i < nr_events; i++) {
+		if (ids[i] > 0xff) {
+			fprintf(stderr, "%s: invalid event 0x%x\n",
+				cxl_memdev_get_devname(memdev), ids[i]);
+			return -EINVAL;
+		}
+		ev[i] = (struct perfcnt_ddr_mux_event) { .event = ids[i] };
+	}
+
+	nr_slots = min(nr_events, CXL_PERFCNT_DDR_GENERIC_COUNTERS);
+	rounds = (nr_events + CXL_PERFCNT_DDR_GENERIC_COUNTERS - 1) /
+		CXL_PERFCNT_DDR_GENERIC_COUNTERS;
+	slice_ms = p->slice_ms ? p->slice_ms : PERFCNT_DDR_MUX_SLICE_MS;
+	slices = p->slices ? p->slices : rounds * PERFCNT_DDR_MUX_PASSES;
+	if (slices < rounds)
+		fprintf(stderr, "%s: %u slices cannot schedule every event, need at least %u\n",
+			cxl_memdev_get_devname(memdev), slices, rounds);
+
+	for (n = 0; n < slices; n++) {
+		/* next nr_slots events, wrapping around the event list */
+		event = 0;
+		for (i = 0; i < CXL_PERFCNT_DDR_GENERIC_COUNTERS; i++) {
+			slot[i] = (next + i % nr_slots) % nr_events;
+			event |= (u64)ev[slot[i]].event << (8 * i);
+		}
+		next = (next + nr_slots) % nr_events;
+
+		/* only reports on failure, so the slices stay quiet */
+		rc = cxl_memdev_perfcnt_ddr_generic_select(memdev, p->ddr_id,
+			p->cid, p->rank, p->bank, p->bankgroup, event);
+		if (rc)
+			return rc;
+
+		/* the counters run for the capture, not for the select */
+		t0 = util_clock_ns(CLOCK_MONOTONIC);
+		rc = cxl_memdev_perfcnt_ddr_generic_capture_fetch(memdev,
+			p->ddr_id, slice_ms, counters, ARRAY_SIZE(counters));
+		dt = util_clock_ns(CLOCK_MONOTONIC) - t0;
+		if (rc < 0)
+			return rc;
+		total_ns += dt;
+
+		for (i = 0; i < nr_slots; i++) {
+			struct perfcnt_ddr_mux_event *e = &ev[slot[i]];
+
+			e->raw += counters[i];
+			e->sum_sq += (double)counters[i] * counters[i];
+			e->slices++;
+			e->enabled_ns += dt;
+		}
+	}
+
+	perfcnt_ddr_mux_report(memdev, ev, nr_events, n, slice_ms, total_ns);
+	return 0;
+}
+
 static int action_cmd_perfcnt_ddr_generic_select(struct cxl_memdev *memdev, struct action_context *actx)
 {
   if (cxl_memdev_is_active(memdev)) {
@@ -3347,12 +3974,202 @@ static int action_cmd_perfcnt_ddr_generic_select(struct cxl_memdev *memdev, stru
     return -EBUSY;
   }
 
+  if (perfcnt_ddr_generic_select_params.mux_events)
+    return perfcnt_ddr_generic_mux(memdev);
+
   return cxl_memdev_perfcnt_ddr_generic_select(memdev, perfcnt_ddr_generic_select_params.ddr_id,
     perfcnt_ddr_generic_select_params.cid, perfcnt_ddr_generic_select_params.rank,
     perfcnt_ddr_generic_select_params.bank, perfcnt_ddr_generic_select_params.bankgroup,
     perfcnt_ddr_generic_select_params.event);
 }
 
+/*
+ * --record support: keep sampling the capture command and append each
+ * result as one row of the capture file. The file is opened on the first
+ * memdev and shared by all memdevs named on the command line.
+ */
+static int record_open_once(const char *source,
+		const struct record_column *cols, int ncols)
+{
+	if (record_params.rec)
+		return 0;
+	record_params.rec = record_open(record_params.file, source, cols, ncols);
+	return record_params.rec ? 0 : -EINVAL;
+}
+
+static int record_finish(void)
+{
+	int rc = record_close(record_params.rec);
+
+	record_params.rec = NULL;
+	return rc;
+}
+
+static bool record_more(u32 sample)
+{
+	if (record_interrupted())
+		return false;
+	return record_params.samples == 0 || sample < record_params.samples;
+}
+
+typedef int (*perfcnt_ddr_fetch_fn)(struct cxl_memdev *memdev, u8 ddr_id,
+		u32 poll_period_ms, u32 *counters, int nr_counters);
+
+static int record_perfcnt_ddr_capture(struct cxl_memdev *memdev,
+		const char *source, u8 ddr_id, u32 poll_period_ms, int nr_counters,
+		perfcnt_ddr_fetch_fn fetch)
+{
+	struct record_column cols[2 + CXL_PERFCNT_DDR_GENERIC_COUNTERS];
+	union record_cell cells[ARRAY_SIZE(cols)];
+	u32 counters[CXL_PERFCNT_DDR_GENERIC_COUNTERS];
+	char names[CXL_PERFCNT_DDR_GENERIC_COUNTERS][RECORD_NAME_LEN];
+	u32 sample;
+	int rc, i;
+
+	cols[0] = (struct record_column) { "memdev", RECORD_U32 };
+	cols[1] = (struct record_column) { "ddr_id", RECORD_U32 };
+	for (i = 0; i < nr_counters; i++) {
+		snprintf(names[i], sizeof(names[i]), "counter%d", i);
+		cols[2 + i] = (struct record_column) { names[i], RECORD_U32 };
+	}
+
+	rc = record_open_once(source, cols, 2 + nr_counters);
+	if (rc)
+		return rc;
+
+	for (sample = 0; record_more(sample); sample++) {
+		rc = fetch(memdev, ddr_id, poll_period_ms, counters, nr_counters);
+		if (rc < 0)
+			return rc;
+
+		cells[0].u32 = cxl_memdev_get_id(memdev);
+		cells[1].u32 = ddr_id;
+		for (i = 0; i < nr_counters; i++)
+			cells[2 + i].u32 = counters[i];
+		rc = record_append(record_params.rec, cells);
+		if (rc)
+			return rc;
+	}
+	fprintf(stderr, "%s: recorded %u samples\n",
+			cxl_memdev_get_devname(memdev), sample);
+	return 0;
+}
+
+static int record_get_ddr_bw(struct cxl_memdev *memdev, u32 timeout,
+		u32 iterations)
+{
+	static const struct record_column cols[] = {
+		{ "memdev", RECORD_U32 },
+		{ "ddr0_peak_bw", RECORD_F32 },
+		{ "ddr1_peak_bw", RECORD_F32 },
+		{ "total_peak_bw", RECORD_F32 },
+	};
+	union record_cell cells[ARRAY_SIZE(cols)];
+	float peak_bw[CXL_DDR_BW_SUBSYS];
+	u32 sample;
+	int rc;
+
+	rc = record_open_once("get-ddr-bw", cols, ARRAY_SIZE(cols));
+	if (rc)
+		return rc;
+
+	for (sample = 0; record_more(sample); sample++) {
+		rc = cxl_memdev_get_ddr_bw_fetch(memdev, timeout, iterations,
+				peak_bw, ARRAY_SIZE(peak_bw));
+		if (rc < 0)
+			return rc;
+
+		cells[0].u32 = cxl_memdev_get_id(memdev);
+		cells[1].f32 = peak_bw[0];
+		cells[2].f32 = peak_bw[1];
+		cells[3].f32 = peak_bw[0] + peak_bw[1];
+		rc = record_append(record_params.rec, cells);
+		if (rc)
+			return rc;
+	}
+	fprintf(stderr, "%s: recorded %u samples\n",
+			cxl_memdev_get_devname(memdev), sample);
+	return 0;
+}
+
+static int action_cmd_perfcnt_snapshot(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	u32 counters[2 * PERFCNT_SNAPSHOT_MAX_COUNTERS];
+	u64 values[ARRAY_SIZE(counters)];
+	struct record_column cols[1 + ARRAY_SIZE(counters)];
+	union record_cell cells[ARRAY_SIZE(cols)];
+	char names[ARRAY_SIZE(counters)][RECORD_NAME_LEN];
+	u32 *hif_counters;
+	u64 ts_ns, latch_ns;
+	int nr_mta, nr_hif, rc, i;
+	u32 sample;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort perfcnt_snapshot\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	nr_mta = parse_counter_list(perfcnt_snapshot_params.mta_counters,
+			counters, PERFCNT_SNAPSHOT_MAX_COUNTERS);
+	hif_counters = counters + max(nr_mta, 0);
+	nr_hif = parse_counter_list(perfcnt_snapshot_params.hif_counters,
+			hif_counters, PERFCNT_SNAPSHOT_MAX_COUNTERS);
+	if (nr_mta < 0 || nr_hif < 0 || nr_mta + nr_hif == 0) {
+		fprintf(stderr, "%s: invalid counter list, use --mta-counters and/or --hif-counters (at most %d each)\n",
+			cxl_memdev_get_devname(memdev), PERFCNT_SNAPSHOT_MAX_COUNTERS);
+		return -EINVAL;
+	}
+
+	if (!record_params.file) {
+		rc = cxl_memdev_perfcnt_snapshot(memdev,
+			perfcnt_snapshot_params.mta_type, counters, nr_mta,
+			hif_counters, nr_hif, values, &ts_ns, &latch_ns);
+		if (rc)
+			return rc;
+
+		fprintf(stdout, "=============================== perfcnt snapshot ===============================\n");
+		fprintf(stdout, "Timestamp (ns): %llu\n", (unsigned long long)ts_ns);
+		fprintf(stdout, "Latch window (ns): %llu\n", (unsigned long long)latch_ns);
+		for (i = 0; i < nr_mta; i++)
+			fprintf(stdout, "MTA counter %u: %llx\n", counters[i],
+				(unsigned long long)values[i]);
+		for (i = 0; i < nr_hif; i++)
+			fprintf(stdout, "HIF counter %u: %llx\n", hif_counters[i],
+				(unsigned long long)values[nr_mta + i]);
+		return 0;
+	}
+
+	cols[0] = (struct record_column) { "memdev", RECORD_U32 };
+	for (i = 0; i < nr_mta + nr_hif; i++) {
+		snprintf(names[i], sizeof(names[i]), "%s%u",
+			i < nr_mta ? "mta" : "hif", counters[i]);
+		cols[1 + i] = (struct record_column) { names[i], RECORD_U64 };
+	}
+
+	rc = record_open_once("perfcnt-snapshot", cols, 1 + nr_mta + nr_hif);
+	if (rc)
+		return rc;
+
+	for (sample = 0; record_more(sample); sample++) {
+		rc = cxl_memdev_perfcnt_snapshot(memdev,
+			perfcnt_snapshot_params.mta_type, counters, nr_mta,
+			hif_counters, nr_hif, values, &ts_ns, &latch_ns);
+		if (rc)
+			return rc;
+
+		cells[0].u32 = cxl_memdev_get_id(memdev);
+		for (i = 0; i < nr_mta + nr_hif; i++)
+			cells[1 + i].u64 = values[i];
+		rc = record_append(record_params.rec, cells);
+		if (rc)
+			return rc;
+	}
+	fprintf(stderr, "%s: recorded %u samples\n",
+			cxl_memdev_get_devname(memdev), sample);
+	return 0;
+}
+
 static int action_cmd_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev, struct action_context *actx)
 {
 	if (cxl_memdev_is_active(memdev)) {
@@ -3361,6 +4178,13 @@ static int action_cmd_perfcnt_ddr_generic_capture(struct cxl_memdev *memdev, str
 		return -EBUSY;
 	}
 
+	if (record_params.file)
+		return record_perfcnt_ddr_capture(memdev, "perfcnt-ddr-generic-capture",
+			perfcnt_ddr_generic_capture_params.ddr_id,
+			perfcnt_ddr_generic_capture_params.poll_period_ms,
+			CXL_PERFCNT_DDR_GENERIC_COUNTERS,
+			cxl_memdev_perfcnt_ddr_generic_capture_fetch);
+
 	return cxl_memdev_perfcnt_ddr_generic_capture(memdev, perfcnt_ddr_generic_capture_params.ddr_id,
 		perfcnt_ddr_generic_capture_params.poll_period_ms
 	);
@@ -3374,6 +4198,13 @@ static int action_cmd_perfcnt_ddr_dfi_capture(struct cxl_memdev *memdev, struct
 		return -EBUSY;
 	}
 
+	if (record_params.file)
+		return record_perfcnt_ddr_capture(memdev, "perfcnt-ddr-dfi-capture",
+			perfcnt_ddr_dfi_capture_params.ddr_id,
+			perfcnt_ddr_dfi_capture_params.poll_period_ms,
+			CXL_PERFCNT_DDR_DFI_COUNTERS,
+			cxl_memdev_perfcnt_ddr_dfi_capture_fetch);
+
 	return cxl_memdev_perfcnt_ddr_dfi_capture(memdev, perfcnt_ddr_dfi_capture_params.ddr_id,
 		perfcnt_ddr_dfi_capture_params.poll_period_ms
 	);
@@ -3657,6 +4488,89 @@ static int action_cmd_eh_link_dbg_lane_dump(struct cxl_memdev *memdev, struct ac
 		eh_link_dbg_lane_dump_params.lane_idx);
 }
 
+/*
+ * eh-link-dbg-dump-all: JSON output is one document covering every memdev,
+ * printed once all of them are dumped. Binary output is, per memdev, a
+ * struct eh_link_dbg_dump_hdr followed by the len bytes returned by
+ * cxl_memdev_eh_link_dbg_dump_all().
+ */
+struct eh_link_dbg_dump_hdr {
+	char magic[4];
+	char memdev[16];
+	__le16 lane_mask;
+	u8 nr_entries;
+	u8 rsvd;
+	__le32 len;
+} __attribute__((packed));
+
+#define EH_LINK_DBG_DUMP_MAGIC "EHLD"
+
+static int action_cmd_eh_link_dbg_dump_all(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	struct _eh_link_dbg_dump_all_params *p = &eh_link_dbg_dump_all_params;
+	const char *devname = cxl_memdev_get_devname(memdev);
+	struct eh_link_dbg_dump_hdr hdr;
+	struct json_object *jdump;
+	void *buf;
+	size_t len;
+	int rc;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort eh_link_dbg_dump_all\n",
+			devname);
+		return -EBUSY;
+	}
+
+	if (!p->out) {
+		if (p->format && strcmp(p->format, "binary") != 0 &&
+		    strcmp(p->format, "json") != 0) {
+			fprintf(stderr, "unknown --format '%s'\n", p->format);
+			return -EINVAL;
+		}
+		if (!p->outfile || strcmp(p->outfile, "-") == 0)
+			p->out = stdout;
+		else if (!(p->out = fopen(p->outfile, "w"))) {
+			fprintf(stderr, "failed to open %s: %s\n", p->outfile,
+				strerror(errno));
+			return -errno;
+		}
+		if (!p->format || strcmp(p->format, "json") == 0) {
+			p->jdumps = json_object_new_array();
+			if (!p->jdumps)
+				return -ENOMEM;
+		}
+	}
+
+	rc = cxl_memdev_eh_link_dbg_dump_all(memdev, p->lane_mask, &buf, &len);
+	if (rc < 0)
+		return rc;
+	if (p->verbose)
+		fprintf(stderr, "%s: %d entries, %zu bytes\n", devname, rc, len);
+
+	if (p->jdumps) {
+		jdump = util_cxl_memdev_eh_link_dbg_to_json(devname, p->lane_mask,
+			buf, rc);
+		free(buf);
+		if (!jdump)
+			return -ENOMEM;
+		json_object_array_add(p->jdumps, jdump);
+		return 0;
+	}
+
+	memset(&hdr, 0, sizeof(hdr));
+	memcpy(hdr.magic, EH_LINK_DBG_DUMP_MAGIC, sizeof(hdr.magic));
+	strncpy(hdr.memdev, devname, sizeof(hdr.memdev) - 1);
+	hdr.lane_mask = cpu_to_le16(p->lane_mask);
+	hdr.nr_entries = rc;
+	hdr.len = cpu_to_le32(len);
+	rc = 0;
+	if (fwrite(&hdr, sizeof(hdr), 1, p->out) != 1 ||
+	    (len && fwrite(buf, len, 1, p->out) != 1))
+		rc = -EIO;
+	free(buf);
+	return rc;
+}
+
 static int action_cmd_eh_link_dbg_reset(struct cxl_memdev *memdev, struct action_context *actx)
 {
 	if (cxl_memdev_is_active(memdev)) {
@@ -3913,56 +4827,672 @@ static int action_cmd_fbist_test_randomsequence(struct cxl_memdev *memdev, struc
 }
 
 
-static int action_cmd_conf_read(struct cxl_memdev *memdev, struct action_context *actx)
-{
+/*
+ * fbist-run: set up one of the predefined FBIST testcases on a number of
+ * Flex BIST instances, each covering its own slice of the DPA range, run
+ * every phase of the testcase and collect per-thread status, bandwidth
+ * and latency while it runs.
+ *
+ * The DPA range is only split across instances. The testcase commands
+ * take one start address and length per instance and the firmware
+ * programs that instance's thread descriptors from it; there is no
+ * mailbox command to give a thread its own range, so --threads only
+ * selects how many threads are polled and reported.
+ *
+ * All instances share the memdev mailbox, so they are polled from one
+ * loop rather than from separate threads. The poll interval starts at
+ * --poll-min-ms and doubles, up to --poll-max-ms, for as long as no
+ * thread makes progress.
+ */
+#define FBIST_RUN_MAX_INSTANCES 8
+#define FBIST_RUN_MAX_THREADS 16
+#define FBIST_RUN_TXGS 2
+#define FBIST_RUN_ALIGN 64
+
+static const struct fbist_run_test {
+	const char *name;
+	int phases;
+	bool both_txgs;
+} fbist_run_tests[] = {
+	{ "simpledata", 1, false },
+	{ "addresstest", 1, false },
+	{ "movinginversion", 6, true },
+	{ "randomsequence", 2, true },
+};
+
+/*
+ * Bandwidth and latency are sampled on every poll while the thread's TXG
+ * runs, over all phases, and reported as averages and maxima.
+ */
+struct fbist_run_thread {
+	u8 state;
+	u16 desc_index;
+	u32 samples;
+	u64 rd_bw, wr_bw;
+	u64 rd_lat, wr_lat;
+	u32 rd_lat_max, wr_lat_max;
+};
+
+struct fbist_run_instance {
+	u64 start, len;
+	u32 rdata_err, rresp_err, wresp_err;
+	struct fbist_run_thread thread[FBIST_RUN_TXGS][FBIST_RUN_MAX_THREADS];
+};
+
+static int fbist_run_setup(struct cxl_memdev *memdev, int test, u32 id,
+		int phase, struct fbist_run_instance *inst)
+{
+	struct _fbist_run_params *p = &fbist_run_params;
+
+	switch (test) {
+	case 0:
+		return cxl_memdev_fbist_test_simpledata(memdev, id, p->test_nr,
+			inst->start, inst->len);
+	case 1:
+		return cxl_memdev_fbist_test_addresstest(memdev, id, p->test_nr,
+			inst->start, inst->len, p->seed);
+	case 2:
+		return cxl_memdev_fbist_test_movinginversion(memdev, id,
+			p->test_nr, phase, inst->start, inst->len, p->ddrpage_size);
+	default:
+		return cxl_memdev_fbist_test_randomsequence(memdev, id, phase,
+			inst->start, inst->len, p->ddrpage_size, p->seed, ~p->seed);
+	}
+}
+
+/* one poll pass over every instance; returns running TXGs or -errno */
+static int fbist_run_poll(struct cxl_memdev *memdev,
+		struct fbist_run_instance *inst, int nr_inst, int nr_txgs,
+		int nr_threads, bool *progress)
+{
+	struct fbist_run_thread *t;
+	u8 txg_run[FBIST_RUN_TXGS], state;
+	u32 rd_bw, wr_bw, rd_lat, wr_lat;
+	int running = 0, rc, i, g, n;
+	u16 desc_index;
+
+	for (i = 0; i < nr_inst; i++) {
+		rc = cxl_memdev_fbist_run_get_fetch(memdev, i, &txg_run[0],
+				&txg_run[1]);
+		if (rc < 0)
+			return rc;
+
+		for (g = 0; g < nr_txgs; g++) {
+			running += !!txg_run[g];
+			for (n = 0; n < nr_threads; n++) {
+				t = &inst[i].thread[g][n];
+				rc = cxl_memdev_fbist_thread_status_get_fetch(memdev,
+					i, g, n, &state, &desc_index);
+				if (rc < 0)
+					return rc;
+				if (state != t->state || desc_index != t->desc_index)
+					*progress = true;
+				t->state = state;
+				t->desc_index = desc_index;
+				if (!txg_run[g])
+					continue;
+
+				rc = cxl_memdev_fbist_thread_bandwidth_get_fetch(memdev,
+					i, g, n, &rd_bw, &wr_bw);
+				if (rc < 0)
+					return rc;
+				rc = cxl_memdev_fbist_thread_latency_get_fetch(memdev,
+					i, g, n, &rd_lat, &wr_lat);
+				if (rc < 0)
+					return rc;
+				t->rd_bw += rd_bw;
+				t->wr_bw += wr_bw;
+				t->rd_lat += rd_lat;
+				t->wr_lat += wr_lat;
+				t->rd_lat_max = max(t->rd_lat_max, rd_lat);
+				t->wr_lat_max = max(t->wr_lat_max, wr_lat);
+				t->samples++;
+			}
+		}
+	}
+	return running;
+}
+
+static void fbist_run_report(struct cxl_memdev *memdev,
+		const struct fbist_run_test *test, struct fbist_run_instance *inst,
+		int nr_inst, int nr_txgs, int nr_threads, u64 elapsed_ms, int rc)
+{
+	u64 rd_bw = 0, wr_bw = 0, rd_lat = 0, wr_lat = 0, errors = 0;
+	u32 rd_lat_max = 0, wr_lat_max = 0, avg;
+	struct fbist_run_thread *t;
+	int i, g, n, samples = 0;
+
+	fprintf(stdout, "================================ fbist run report ===============================\n");
+	fprintf(stdout, "%s: %s test %u, %d instance(s), %llu ms, %s\n",
+		cxl_memdev_get_devname(memdev), test->name,
+		fbist_run_params.test_nr, nr_inst,
+		(unsigned long long)elapsed_ms,
+		rc == -ETIMEDOUT ? "TIMEOUT" : rc < 0 ? "ABORTED" : "COMPLETED");
+	fprintf(stdout, "%-4s %-18s %-18s %4s %6s %5s %7s %10s %10s %10s %10s\n",
+		"inst", "start", "length", "txg", "thread", "state", "samples",
+		"rd_bw", "wr_bw", "rd_lat", "wr_lat");
+
+	/* per thread averages over its samples, summed for the totals */
+	for (i = 0; i < nr_inst; i++) {
+		for (g = 0; g < nr_txgs; g++) {
+			for (n = 0; n < nr_threads; n++) {
+				t = &inst[i].thread[g][n];
+				avg = max(t->samples, 1U);
+				fprintf(stdout, "%-4d 0x%-16llx 0x%-16llx %4d %6d %5x %7u %10llu %10llu %10llu %10llu\n",
+					i, (unsigned long long)inst[i].start,
+					(unsigned long long)inst[i].len, g, n,
+					t->state, t->samples,
+					(unsigned long long)(t->rd_bw / avg),
+					(unsigned long long)(t->wr_bw / avg),
+					(unsigned long long)(t->rd_lat / avg),
+					(unsigned long long)(t->wr_lat / avg));
+				if (!t->samples)
+					continue;
+				rd_bw += t->rd_bw / t->samples;
+				wr_bw += t->wr_bw / t->samples;
+				rd_lat += t->rd_lat / t->samples;
+				wr_lat += t->wr_lat / t->samples;
+				rd_lat_max = max(rd_lat_max, t->rd_lat_max);
+				wr_lat_max = max(wr_lat_max, t->wr_lat_max);
+				samples++;
+			}
+		}
+		errors += inst[i].rdata_err + inst[i].rresp_err + inst[i].wresp_err;
+	}
+	samples = max(samples, 1);
+
+	fprintf(stdout, "Total BW Count (avg): read %llu write %llu\n",
+		(unsigned long long)rd_bw, (unsigned long long)wr_bw);
+	fprintf(stdout, "Latency Count: read avg %llu max %u, write avg %llu max %u\n",
+		(unsigned long long)(rd_lat / samples), rd_lat_max,
+		(unsigned long long)(wr_lat / samples), wr_lat_max);
+	for (i = 0; i < nr_inst; i++)
+		fprintf(stdout, "Instance %d Errors: read data %u, read response %u, write response %u\n",
+			i, inst[i].rdata_err, inst[i].rresp_err, inst[i].wresp_err);
+	fprintf(stdout, "Result: %s\n", rc == 0 && errors == 0 ? "PASS" : "FAIL");
+}
+
+static int action_cmd_fbist_run(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	struct _fbist_run_params *p = &fbist_run_params;
+	const struct fbist_run_test *test = NULL;
+	struct fbist_run_instance *inst;
+	int nr_inst, nr_txgs, nr_threads, running, phase, rc = 0, i;
+	u32 rdata, rresp, wresp, interval;
+	u64 size, capacity, chunk, t_start, t_phase;
+	unsigned long long pmem_size, ram_size;
+	bool progress, quiet;
+
 	if (cxl_memdev_is_active(memdev)) {
-		fprintf(stderr, "%s: memdev active, abort conf_read\n",
+		fprintf(stderr, "%s: memdev active, abort fbist_run\n",
 			cxl_memdev_get_devname(memdev));
 		return -EBUSY;
 	}
 
-	return cxl_memdev_conf_read(memdev, conf_read_params.offset, conf_read_params.length);
+	for (i = 0; i < (int)ARRAY_SIZE(fbist_run_tests); i++)
+		if (p->test && strcmp(p->test, fbist_run_tests[i].name) == 0)
+			test = &fbist_run_tests[i];
+	if (!test) {
+		fprintf(stderr, "%s: --test must be one of simpledata, addresstest, movinginversion, randomsequence\n",
+			cxl_memdev_get_devname(memdev));
+		return -EINVAL;
+	}
+
+	nr_inst = p->instances ? p->instances : 1;
+	nr_threads = p->threads ? p->threads : 1;
+	nr_txgs = test->both_txgs ? 2 : 1;
+	if (nr_inst > FBIST_RUN_MAX_INSTANCES || nr_threads > FBIST_RUN_MAX_THREADS) {
+		fprintf(stderr, "%s: at most %d instances and %d threads\n",
+			cxl_memdev_get_devname(memdev), FBIST_RUN_MAX_INSTANCES,
+			FBIST_RUN_MAX_THREADS);
+		return -EINVAL;
+	}
+
+	pmem_size = cxl_memdev_get_pmem_size(memdev);
+	ram_size = cxl_memdev_get_ram_size(memdev);
+	if (pmem_size == ULLONG_MAX || ram_size == ULLONG_MAX) {
+		rc = -errno;
+		fprintf(stderr, "%s: cannot read the device capacity\n",
+			cxl_memdev_get_devname(memdev));
+		return rc;
+	}
+	capacity = pmem_size + ram_size;
+	if (capacity <= p->start_address) {
+		fprintf(stderr, "%s: start address beyond device capacity\n",
+			cxl_memdev_get_devname(memdev));
+		return -EINVAL;
+	}
+	size = p->num_bytes;
+	if (!size)
+		size = capacity - p->start_address;
+	if (size > capacity - p->start_address) {
+		fprintf(stderr, "%s: range 0x%llx+0x%llx exceeds the device capacity 0x%llx\n",
+			cxl_memdev_get_devname(memdev),
+			(unsigned long long)p->start_address,
+			(unsigned long long)size, (unsigned long long)capacity);
+		return -EINVAL;
+	}
+	chunk = (size / nr_inst) & ~(u64)(FBIST_RUN_ALIGN - 1);
+	if (!chunk) {
+		fprintf(stderr, "%s: range too small for %d instances\n",
+			cxl_memdev_get_devname(memdev), nr_inst);
+		return -EINVAL;
+	}
+
+	inst = calloc(nr_inst, sizeof(*inst));
+	if (!inst)
+		return -ENOMEM;
+	for (i = 0; i < nr_inst; i++) {
+		inst[i].start = p->start_address + i * chunk;
+		inst[i].len = chunk;
+	}
+	/* the last instance also covers the rounding remainder */
+	inst[nr_inst - 1].len = (size - (nr_inst - 1) * chunk) &
+		~(u64)(FBIST_RUN_ALIGN - 1);
+
+	/* setup and run commands confirm success, the report covers them */
+	quiet = cxl_get_quiet(cxl_memdev_get_ctx(memdev));
+	cxl_set_quiet(cxl_memdev_get_ctx(memdev), true);
+	t_start = util_clock_ms(CLOCK_MONOTONIC);
+	for (phase = 0; phase < test->phases && rc == 0; phase++) {
+		for (i = 0; i < nr_inst && rc == 0; i++)
+			rc = fbist_run_setup(memdev, test - fbist_run_tests, i,
+					phase, &inst[i]);
+		for (i = 0; i < nr_inst && rc == 0; i++)
+			rc = cxl_memdev_fbist_run_set(memdev, i, 1,
+					test->both_txgs);
+		if (rc)
+			break;
+
+		interval = p->poll_min_ms ? p->poll_min_ms : 10;
+		t_phase = util_clock_ms(CLOCK_MONOTONIC);
+		for (;;) {
+			usleep(interval * 1000);
+			progress = false;
+			running = fbist_run_poll(memdev, inst, nr_inst, nr_txgs,
+					nr_threads, &progress);
+			if (running <= 0) {
+				rc = running;
+				break;
+			}
+			if (p->timeout_s && util_clock_ms(CLOCK_MONOTONIC) - t_phase >
+					(u64)p->timeout_s * 1000) {
+				fprintf(stderr, "%s: phase %d timed out, stopping\n",
+					cxl_memdev_get_devname(memdev), phase);
+				for (i = 0; i < nr_inst; i++)
+					cxl_memdev_fbist_run_set(memdev, i, 0, 0);
+				rc = -ETIMEDOUT;
+				break;
+			}
+			if (progress)
+				interval = p->poll_min_ms ? p->poll_min_ms : 10;
+			else
+				interval = min(interval * 2,
+					p->poll_max_ms ? p->poll_max_ms : 1000);
+		}
+
+		/* the counters are cumulative, the last read covers all phases */
+		for (i = 0; i < nr_inst; i++) {
+			if (cxl_memdev_fbist_top_err_cnt_get_fetch(memdev, i,
+					&rdata, &rresp, &wresp) < 0)
+				continue;
+			inst[i].rdata_err = rdata;
+			inst[i].rresp_err = rresp;
+			inst[i].wresp_err = wresp;
+		}
+	}
+	cxl_set_quiet(cxl_memdev_get_ctx(memdev), quiet);
+
+	fbist_run_report(memdev, test, inst, nr_inst, nr_txgs, nr_threads,
+		util_clock_ms(CLOCK_MONOTONIC) - t_start, rc);
+	free(inst);
+	return rc;
 }
 
-static int action_zero(struct cxl_memdev *memdev, struct action_context *actx)
+/*
+ * eye-scan: capture a set of lanes, poll with an exponential backoff until
+ * the capture finishes and reduce the BER grids to per-lane eye metrics.
+ *
+ * The EH capture gives, per lane, nr_bins rows (vertical offsets) of up to
+ * CXL_EH_EYE_CAP_MAX_PHASES phases. A point is open when its BER count is
+ * at most --threshold. The eye width is the longest open run of phases in
+ * the centre bin, the eye centre is the middle of that run, and the height
+ * is the open run of bins through the centre bin in that phase column.
+ * Margins are the distance from the centre to the nearest closed point.
+ * The EH capture has no spec limit in phases and bins, so a lane is only
+ * judged against --min-width / --min-height when either is given. PCIe
+ * scans are judged by cxl_pcie_eye_margins_pass() against the BER 1e-12
+ * margins.
+ */
+#define EYE_SCAN_MAX_LANES 32
+#define EYE_SCAN_DEFAULT_LANES 16
+#define EH_EYE_CAP_STATE_BUSY 1
+
+struct eye_scan_result {
+	int width, height, h_margin, v_margin;
+	float h_margin_ui, v_margin_mv;
+	bool judged;
+	bool pass;
+};
+
+static void eye_scan_print(struct cxl_memdev *memdev, int lane,
+		struct eye_scan_result *r, int rc)
+{
+	if (!eye_scan_params.header_done) {
+		fprintf(stdout, "%-8s %4s %6s %6s %9s %9s %s\n", "memdev", "lane",
+			"width", "height", "h_margin", "v_margin", "result");
+		eye_scan_params.header_done = true;
+	}
+	if (rc < 0)
+		fprintf(stdout, "%-8s %4d %6s %6s %9s %9s %s\n",
+			cxl_memdev_get_devname(memdev), lane, "-", "-", "-",
+			"-", rc == -ETIMEDOUT ? "TIMEOUT" : "ERROR");
+	else if (eye_scan_params.pcie)
+		fprintf(stdout, "%-8s %4d %6s %6s %7.3fUI %7.2fmV %s\n",
+			cxl_memdev_get_devname(memdev), lane, "-", "-",
+			r->h_margin_ui, r->v_margin_mv, r->pass ? "PASS" : "FAIL");
+	else
+		fprintf(stdout, "%-8s %4d %6d %6d %9d %9d %s\n",
+			cxl_memdev_get_devname(memdev), lane, r->width,
+			r->height, r->h_margin, r->v_margin,
+			!r->judged ? "-" : r->pass ? "PASS" : "FAIL");
+}
+
+/* poll the running capture until it finishes; 0, -ETIMEDOUT or -errno */
+static int eye_scan_wait(struct cxl_memdev *memdev)
+{
+	struct _eye_scan_params *p = &eye_scan_params;
+	u32 interval = p->poll_min_ms ? p->poll_min_ms : 10;
+	u64 t_start = util_clock_ms(CLOCK_MONOTONIC);
+	int running, error, rc;
+	u8 stat = 0;
+
+	for (;;) {
+		usleep(interval * 1000);
+		if (p->pcie) {
+			rc = cxl_memdev_pcie_eye_status_fetch(memdev, &running,
+					&error);
+			if (rc == 0 && error) {
+				fprintf(stderr, "%s: pcie eye run error %d\n",
+					cxl_memdev_get_devname(memdev), error);
+				return -EIO;
+			}
+		} else {
+			rc = cxl_memdev_eh_eye_cap_status_fetch(memdev, &stat);
+			running = stat == EH_EYE_CAP_STATE_BUSY;
+		}
+		if (rc)
+			return rc < 0 ? rc : -ENXIO;
+		if (!running)
+			return 0;
+		if (p->timeout_s && util_clock_ms(CLOCK_MONOTONIC) - t_start >
+				(u64)p->timeout_s * 1000)
+			return -ETIMEDOUT;
+		interval = min(interval * 2, p->poll_max_ms ? p->poll_max_ms : 1000);
+	}
+}
+
+static void eye_scan_reduce(const u8 *open, int nr_bins, int num_phase,
+		struct eye_scan_result *r)
 {
-  int rc;
+	const u8 *row = open + (nr_bins / 2) * CXL_EH_EYE_CAP_MAX_PHASES;
+	int run = 0, start = 0, best = 0, best_start = 0, c, lo, hi, i;
 
-  if (cxl_memdev_is_active(memdev)) {
-    fprintf(stderr, "%s: memdev active, abort label write\n",
-      cxl_memdev_get_devname(memdev));
-    return -EBUSY;
-  }
+	for (i = 0; i < num_phase; i++) {
+		if (!row[i]) {
+			run = 0;
+			continue;
+		}
+		if (!run++)
+			start = i;
+		if (run > best) {
+			best = run;
+			best_start = start;
+		}
+	}
 
-  rc = cxl_memdev_zero_lsa(memdev);
-  if (rc < 0)
-    fprintf(stderr, "%s: label zeroing failed: %s\n",
-      cxl_memdev_get_devname(memdev), strerror(-rc));
+	memset(r, 0, sizeof(*r));
+	if (!best)
+		return;
+
+	r->width = best;
+	c = best_start + best / 2;
+	r->h_margin = min(c - best_start, best_start + best - 1 - c);
+
+	for (lo = nr_bins / 2; lo > 0 && open[(lo - 1) * CXL_EH_EYE_CAP_MAX_PHASES + c]; lo--)
+		;
+	for (hi = nr_bins / 2; hi < nr_bins - 1 && open[(hi + 1) * CXL_EH_EYE_CAP_MAX_PHASES + c]; hi++)
+		;
+	r->height = hi - lo + 1;
+	r->v_margin = min(nr_bins / 2 - lo, hi - nr_bins / 2);
+}
+
+static int eye_scan_eh(struct cxl_memdev *memdev, u32 *lanes, int nr_lanes)
+{
+	struct _eye_scan_params *p = &eye_scan_params;
+	int nr_bins = p->bins ? p->bins : 1, rc, i;
+	size_t grid = (size_t)nr_bins * CXL_EH_EYE_CAP_MAX_PHASES;
+	u8 num_phase[EYE_SCAN_MAX_LANES], *open;
+	struct eye_scan_result r;
+	u32 lane_mask = 0, *ber;
+
+	for (i = 0; i < nr_lanes; i++)
+		lane_mask |= 1u << lanes[i];
+
+	rc = cxl_memdev_eh_eye_cap_run(memdev, p->depth, lane_mask);
+	if (rc == 0)
+		rc = eye_scan_wait(memdev);
+	if (rc) {
+		for (i = 0; i < nr_lanes; i++)
+			eye_scan_print(memdev, lanes[i], NULL, rc < 0 ? rc : -ENXIO);
+		return rc < 0 ? rc : -ENXIO;
+	}
 
-  return rc;
+	ber = calloc(nr_lanes * grid, sizeof(*ber));
+	open = calloc(nr_lanes * grid, sizeof(*open));
+	if (!ber || !open) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	rc = cxl_memdev_eh_eye_cap_read_lanes(memdev, lane_mask, nr_bins, ber,
+			num_phase);
+	if (rc < 0)
+		goto out;
+
+	/* one flat, branch-free pass over every lane's grid */
+	for (i = 0; i < (int)(nr_lanes * grid); i++)
+		open[i] = ber[i] <= p->threshold;
+
+	/* lanes[] is ascending, matching the read_lanes layout */
+	for (i = 0; i < nr_lanes; i++) {
+		eye_scan_reduce(open + i * grid, nr_bins, num_phase[i], &r);
+		r.judged = p->min_width || p->min_height;
+		r.pass = r.width && (u32)r.width >= p->min_width &&
+			(u32)r.height >= p->min_height;
+		eye_scan_print(memdev, lanes[i], &r, 0);
+	}
+out:
+	free(open);
+	free(ber);
+	return rc;
 }
 
-static int action_cmd_hct_get_config(struct cxl_memdev *memdev, struct action_context *actx)
+static int eye_scan_pcie(struct cxl_memdev *memdev, u32 *lanes, int nr_lanes)
 {
+	struct eye_scan_result r;
+	int run_status, rc, ret = 0, i;
+
+	for (i = 0; i < nr_lanes; i++) {
+		memset(&r, 0, sizeof(r));
+		rc = cxl_memdev_pcie_eye_run_fetch(memdev, lanes[i], 1, 1,
+				&run_status);
+		if (rc == 0 && run_status) {
+			fprintf(stderr, "%s: lane %u: pcie eye already running or fault: %d\n",
+				cxl_memdev_get_devname(memdev), lanes[i], run_status);
+			rc = -EBUSY;
+		}
+		if (rc == 0)
+			rc = eye_scan_wait(memdev);
+		if (rc == 0)
+			rc = cxl_memdev_pcie_eye_get_sw_ber_fetch(memdev,
+					&r.h_margin_ui, &r.v_margin_mv);
+		if (rc == 0)
+			r.pass = cxl_pcie_eye_margins_pass(r.h_margin_ui,
+					r.v_margin_mv);
+		if (rc > 0)
+			rc = -ENXIO;
+		eye_scan_print(memdev, lanes[i], &r, rc);
+		if (rc < 0)
+			ret = rc;
+	}
+	return ret;
+}
+
+static int action_cmd_eye_scan(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	u32 lanes[EYE_SCAN_MAX_LANES];
+	int nr_lanes, i, j;
+	u32 tmp;
+
 	if (cxl_memdev_is_active(memdev)) {
-		fprintf(stderr, "%s: memdev active, abort hct_get_config\n",
+		fprintf(stderr, "%s: memdev active, abort eye_scan\n",
 			cxl_memdev_get_devname(memdev));
 		return -EBUSY;
 	}
 
-	return cxl_memdev_hct_get_config(memdev, hct_get_config_params.hct_inst);
+	if (eye_scan_params.lanes) {
+		nr_lanes = parse_counter_list(eye_scan_params.lanes, lanes,
+				EYE_SCAN_MAX_LANES);
+	} else {
+		for (nr_lanes = 0; nr_lanes < EYE_SCAN_DEFAULT_LANES; nr_lanes++)
+			lanes[nr_lanes] = nr_lanes;
+	}
+	if (nr_lanes <= 0) {
+		fprintf(stderr, "%s: invalid --lanes list\n",
+			cxl_memdev_get_devname(memdev));
+		return -EINVAL;
+	}
+	for (i = 0; i < nr_lanes; i++) {
+		if (lanes[i] >= EYE_SCAN_MAX_LANES) {
+			fprintf(stderr, "%s: lane %u out of range\n",
+				cxl_memdev_get_devname(memdev), lanes[i]);
+			return -EINVAL;
+		}
+	}
+	/* sort and drop duplicates so results line up with the lane mask */
+	for (i = 1; i < nr_lanes; i++)
+		for (j = i; j > 0 && lanes[j - 1] > lanes[j]; j--) {
+			tmp = lanes[j];
+			lanes[j] = lanes[j - 1];
+			lanes[j - 1] = tmp;
+		}
+	for (i = 1, j = 1; i < nr_lanes; i++)
+		if (lanes[i] != lanes[j - 1])
+			lanes[j++] = lanes[i];
+	nr_lanes = j;
+
+	if (eye_scan_params.pcie)
+		return eye_scan_pcie(memdev, lanes, nr_lanes);
+	return eye_scan_eh(memdev, lanes, nr_lanes);
 }
 
-static int action_cmd_hct_read_buffer(struct cxl_memdev *memdev, struct action_context *actx)
+static int action_cmd_conf_read(struct cxl_memdev *memdev, struct action_context *actx)
 {
 	if (cxl_memdev_is_active(memdev)) {
-		fprintf(stderr, "%s: memdev active, abort hct_read_buffer\n",
+		fprintf(stderr, "%s: memdev active, abort conf_read\n",
 			cxl_memdev_get_devname(memdev));
 		return -EBUSY;
 	}
 
-	return cxl_memdev_hct_read_buffer(memdev, hct_read_buffer_params.hct_inst,
-		hct_read_buffer_params.num_entries_to_read);
+	return cxl_memdev_conf_read(memdev, conf_read_params.offset, conf_read_params.length);
+}
+
+/* with --verbose, report how a label transfer went */
+static void lsa_report(struct cxl_memdev *memdev, const char *op,
+    const struct cxl_lsa_stats *stats)
+{
+  double secs = stats->nsecs / 1e9;
+
+  if (!param.verbose)
+    return;
+  fprintf(stderr, "%s: %s %zu bytes in %u chunks of %zu, %.1f KiB/s%s\n",
+    cxl_memdev_get_devname(memdev), op, stats->bytes, stats->chunks,
+    stats->chunk_size, secs > 0 ? stats->bytes / 1024.0 / secs : 0.0,
+    stats->verified ? " (verified)" : "");
+}
+
+/*
+ * Update the label area through a shadow so that only the label slots
+ * whose contents change are written back. @buf NULL zeroes the range.
+ */
+static int memdev_lsa_update(struct cxl_memdev *memdev, const void *buf,
+    size_t size)
+{
+  struct cxl_lsa_stats stats;
+  struct cxl_lsa *lsa;
+  int rc;
+
+  lsa = cxl_lsa_new(memdev, 0);
+  if (!lsa)
+    return -errno;
+
+  if (buf)
+    rc = cxl_lsa_write(lsa, buf, size, param.offset);
+  else
+    rc = cxl_lsa_zero(lsa, size, param.offset);
+  if (rc == 0) {
+    if (param.verbose)
+      fprintf(stderr, "%s: %u of %zu label slots changed\n",
+        cxl_memdev_get_devname(memdev), cxl_lsa_get_nr_dirty(lsa),
+        cxl_lsa_get_size(lsa) / cxl_lsa_get_slot_size(lsa));
+    rc = cxl_lsa_commit(lsa, param.verify ? CXL_LSA_VERIFY : 0, &stats);
+    if (rc == 0)
+      lsa_report(memdev, buf ? "wrote" : "zeroed", &stats);
+  }
+
+  cxl_lsa_free(lsa);
+  return rc;
+}
+
+static int action_zero(struct cxl_memdev *memdev, struct action_context *actx)
+{
+  int rc;
+
+  if (cxl_memdev_is_active(memdev)) {
+    fprintf(stderr, "%s: memdev active, abort label write\n",
+      cxl_memdev_get_devname(memdev));
+    return -EBUSY;
+  }
+
+  rc = memdev_lsa_update(memdev, NULL, param.len);
+  if (rc < 0)
+    fprintf(stderr, "%s: label zeroing failed: %s\n",
+      cxl_memdev_get_devname(memdev), strerror(-rc));
+
+  return rc;
+}
+
+static int action_cmd_hct_get_config(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort hct_get_config\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	return cxl_memdev_hct_get_config(memdev, hct_get_config_params.hct_inst);
+}
+
+static int action_cmd_hct_read_buffer(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort hct_read_buffer\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	return cxl_memdev_hct_read_buffer(memdev, hct_read_buffer_params.hct_inst,
+		hct_read_buffer_params.num_entries_to_read);
 }
 
 static int action_cmd_hct_set_config(struct cxl_memdev *memdev, struct action_context *actx)
@@ -4015,6 +5545,157 @@ static int action_cmd_hct_set_config(struct cxl_memdev *memdev, struct action_co
     hct_set_config_params.ignore_valid, filesize, trig_config_buffer);
 }
 
+static int hct_stream_read_trig_config(const char *path, u8 **buf)
+{
+	struct stat filestat;
+	FILE *f;
+	int rc;
+
+	*buf = NULL;
+	if (!path)
+		return 0;
+
+	f = fopen(path, "rb");
+	if (!f) {
+		fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+		return -errno;
+	}
+	if (fstat(fileno(f), &filestat) != 0) {
+		rc = -errno;
+		goto out;
+	}
+	*buf = malloc(filestat.st_size ? filestat.st_size : 1);
+	if (!*buf) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	rc = filestat.st_size;
+	if (fread(*buf, 1, filestat.st_size, f) != (size_t)filestat.st_size) {
+		fprintf(stderr, "short read from %s\n", path);
+		free(*buf);
+		*buf = NULL;
+		rc = -EIO;
+	}
+out:
+	fclose(f);
+	return rc;
+}
+
+/*
+ * hct-stream: optionally enable and configure the trace buffer, start it
+ * with --buf_control, then drain it to --output (one memdev per output)
+ * with the largest reads the mailbox allows until buf_end, --time-limit or
+ * --idle-limit. The buffer status sampled right after the last read tells
+ * whether the stream kept up: a non-zero fill level on a buffer that is
+ * still capturing means entries were left behind, and a buffer that
+ * stopped before buf_end was read may have lost entries.
+ */
+static int action_cmd_hct_stream(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	static const char *buf_status_names[] = { "stop", "pre-trigger", "post-trigger" };
+	struct _hct_stream_params *p = &hct_stream_params;
+	const char *devname = cxl_memdev_get_devname(memdev);
+	u64 nr_entries, nr_bytes, t0;
+	u8 buf_end, buf_status, fill_level;
+	u8 *trig_config;
+	double secs;
+	int fd, rc, size;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort hct_stream\n", devname);
+		return -EBUSY;
+	}
+
+	if (!p->outfile) {
+		fprintf(stderr, "%s: --output is required\n", devname);
+		return -EINVAL;
+	}
+	if (p->buf_control != 1 && p->buf_control != 2) {
+		fprintf(stderr, "%s: --buf_control must be 1 or 2\n", devname);
+		return -EINVAL;
+	}
+	if (!p->time_limit && !p->idle_limit) {
+		fprintf(stderr, "%s: --time-limit 0 needs a non-zero --idle-limit\n",
+			devname);
+		return -EINVAL;
+	}
+
+	if (p->enable) {
+		rc = cxl_memdev_hct_enable(memdev, p->hct_inst);
+		if (rc < 0)
+			return rc;
+	}
+
+	if (p->config_flags || p->trig_config_file) {
+		size = hct_stream_read_trig_config(p->trig_config_file, &trig_config);
+		if (size < 0)
+			return size;
+		rc = cxl_memdev_hct_set_config(memdev, p->hct_inst, p->config_flags,
+			p->post_trig_depth, p->ignore_valid, size, trig_config);
+		free(trig_config);
+		if (rc < 0)
+			return rc;
+	}
+
+	if (strcmp(p->outfile, "-") == 0)
+		fd = STDOUT_FILENO;
+	else {
+		fd = open(p->outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd < 0) {
+			fprintf(stderr, "failed to open %s: %s\n", p->outfile,
+				strerror(errno));
+			return -errno;
+		}
+	}
+
+	rc = cxl_memdev_hct_start_stop_trigger(memdev, p->hct_inst, p->buf_control);
+	if (rc < 0)
+		goto out;
+
+	t0 = util_clock_ns(CLOCK_MONOTONIC);
+	rc = cxl_memdev_hct_read_buffer_stream(memdev, p->hct_inst, fd,
+		p->time_limit * 1000, p->idle_limit * 1000, &nr_entries,
+		&nr_bytes, &buf_end);
+	secs = (util_clock_ns(CLOCK_MONOTONIC) - t0) / 1e9;
+	if (rc < 0)
+		goto stop;
+
+	fprintf(stderr, "%s: hct%u: %llu entries (%llu bytes) in %.3f s, %.0f entries/s, %.2f MiB/s, %s\n",
+		devname, p->hct_inst, (unsigned long long)nr_entries,
+		(unsigned long long)nr_bytes, secs,
+		secs > 0 ? nr_entries / secs : 0.0,
+		secs > 0 ? nr_bytes / secs / (1024 * 1024) : 0.0,
+		buf_end ? "buffer end reached" :
+		p->time_limit && secs >= p->time_limit ? "time limit reached" :
+		"idle limit reached");
+
+	rc = cxl_memdev_hct_get_buffer_status_fetch(memdev, p->hct_inst,
+		&buf_status, &fill_level);
+	if (rc < 0)
+		goto stop;
+	fprintf(stderr, "%s: hct%u: buffer status %s, fill level %u\n", devname,
+		p->hct_inst, buf_status < ARRAY_SIZE(buf_status_names) ?
+		buf_status_names[buf_status] : "unknown", fill_level);
+	if (!buf_end && buf_status && fill_level)
+		fprintf(stderr, "%s: hct%u: fill level %u while capturing, stream fell behind\n",
+			devname, p->hct_inst, fill_level);
+	else if (!buf_end && !buf_status)
+		fprintf(stderr, "%s: hct%u: buffer stopped before buf_end was read, entries may be lost\n",
+			devname, p->hct_inst);
+
+stop:
+	if (!p->keep) {
+		int stop_rc = cxl_memdev_hct_start_stop_trigger(memdev, p->hct_inst, 0);
+
+		if (rc >= 0)
+			rc = stop_rc;
+	}
+out:
+	if (fd != STDOUT_FILENO)
+		close(fd);
+	return rc;
+}
+
 static int action_cmd_osa_os_patt_trig_cfg(struct cxl_memdev *memdev, struct action_context *actx)
 {
   u32 pattern_val;
@@ -4044,6 +5725,120 @@ static int action_cmd_osa_misc_trig_cfg(struct cxl_memdev *memdev, struct action
 		osa_misc_trig_cfg_params.trig_en_mask);
 }
 
+/*
+ * osa-data-read --drain: every lane/direction pair is written as a
+ * struct osa_drain_hdr followed by nr_entries raw little-endian entries.
+ * A capture that wrapped has lost its oldest entries and is not in
+ * capture order from entry 0; it is still written, flagged in the header,
+ * but the command fails once every pair has been drained.
+ */
+struct osa_drain_hdr {
+	char magic[4];
+	u8 cxl_mem_id;
+	u8 lane_id;
+	u8 lane_dir;
+	u8 wrap;
+	__le32 nr_entries;
+} __attribute__((packed));
+
+#define OSA_DRAIN_MAGIC "OSAD"
+#define OSA_DRAIN_MAX_LANES 32
+
+static int osa_drain_fd(void)
+{
+	struct _osa_data_read_params *p = &osa_data_read_params;
+
+	if (p->fd >= 0)
+		return p->fd;
+	if (!p->outfile || strcmp(p->outfile, "-") == 0)
+		p->fd = STDOUT_FILENO;
+	else {
+		p->fd = open(p->outfile, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (p->fd < 0) {
+			fprintf(stderr, "failed to open %s: %s\n", p->outfile,
+				strerror(errno));
+			return -errno;
+		}
+		p->close_fd = true;
+	}
+	return p->fd;
+}
+
+static int osa_data_drain(struct cxl_memdev *memdev)
+{
+	struct _osa_data_read_params *p = &osa_data_read_params;
+	u32 lanes[OSA_DRAIN_MAX_LANES], dirs[OSA_DRAIN_MAX_LANES];
+	int nr_lanes, nr_dirs, fd, rc, l, d, wrapped = 0;
+	struct osa_drain_hdr hdr;
+	u32 *entries;
+	u8 wrap;
+
+	nr_lanes = p->lanes ? parse_counter_list(p->lanes, lanes, ARRAY_SIZE(lanes)) : 1;
+	if (!p->lanes)
+		lanes[0] = p->lane_id;
+	nr_dirs = p->dirs ? parse_counter_list(p->dirs, dirs, ARRAY_SIZE(dirs)) : 1;
+	if (!p->dirs)
+		dirs[0] = p->lane_dir;
+	if (nr_lanes <= 0 || nr_dirs <= 0) {
+		fprintf(stderr, "%s: invalid --lanes/--dirs list\n",
+			cxl_memdev_get_devname(memdev));
+		return -EINVAL;
+	}
+	/* the header stores lane and direction in a byte each */
+	for (l = 0; l < nr_lanes; l++)
+		if (lanes[l] >= OSA_DRAIN_MAX_LANES)
+			goto out_of_range;
+	for (d = 0; d < nr_dirs; d++)
+		if (dirs[d] >= OSA_DRAIN_MAX_LANES)
+			goto out_of_range;
+
+	fd = osa_drain_fd();
+	if (fd < 0)
+		return fd;
+
+	for (l = 0; l < nr_lanes; l++) {
+		for (d = 0; d < nr_dirs; d++) {
+			rc = cxl_memdev_osa_data_drain(memdev, p->cxl_mem_id,
+				lanes[l], dirs[d], &entries, &wrap);
+			if (rc < 0)
+				return rc;
+
+			memcpy(hdr.magic, OSA_DRAIN_MAGIC, sizeof(hdr.magic));
+			hdr.cxl_mem_id = p->cxl_mem_id;
+			hdr.lane_id = lanes[l];
+			hdr.lane_dir = dirs[d];
+			hdr.wrap = wrap;
+			hdr.nr_entries = cpu_to_le32(rc);
+			fprintf(stderr, "%s: lane %u dir %u: %d entries%s\n",
+				cxl_memdev_get_devname(memdev), lanes[l], dirs[d],
+				rc, wrap ? " (wrapped, oldest entries lost)" : "");
+			wrapped += !!wrap;
+
+			rc = util_write_all(fd, &hdr, sizeof(hdr));
+			if (!rc)
+				rc = util_write_all(fd, entries,
+					le32_to_cpu(hdr.nr_entries) * sizeof(u32));
+			free(entries);
+			if (rc) {
+				fprintf(stderr, "%s: write failed: %s\n",
+					cxl_memdev_get_devname(memdev), strerror(-rc));
+				return rc;
+			}
+		}
+	}
+	if (wrapped) {
+		fprintf(stderr, "%s: %d capture(s) wrapped, drained data is incomplete\n",
+			cxl_memdev_get_devname(memdev), wrapped);
+		return -EOVERFLOW;
+	}
+	return 0;
+
+out_of_range:
+	fprintf(stderr, "%s: --lanes/--dirs entries must be below %d\n",
+		cxl_memdev_get_devname(memdev), OSA_DRAIN_MAX_LANES);
+	return -EINVAL;
+}
+
 static int action_cmd_osa_data_read(struct cxl_memdev *memdev, struct action_context *actx)
 {
 	if (cxl_memdev_is_active(memdev)) {
@@ -4052,6 +5847,9 @@ static int action_cmd_osa_data_read(struct cxl_memdev *memdev, struct action_con
 		return -EBUSY;
 	}
 
+	if (osa_data_read_params.drain)
+		return osa_data_drain(memdev);
+
 	return cxl_memdev_osa_data_read(memdev, osa_data_read_params.cxl_mem_id,
 		osa_data_read_params.lane_id, osa_data_read_params.lane_dir, osa_data_read_params.start_entry,
 		osa_data_read_params.num_entries);
@@ -4091,6 +5889,97 @@ static int action_cmd_dimm_slot_info(struct cxl_memdev *memdev, struct action_co
 	return cxl_memdev_dimm_slot_info(memdev);
 }
 
+static int action_cmd_ddr_inventory(struct cxl_memdev *memdev, struct action_context *actx)
+{
+	struct _ddr_inventory_params *p = &ddr_inventory_params;
+	struct cxl_dimm_inventory dimms[CXL_DIMM_MAX_SLOTS], *d;
+	struct json_object *jdev, *jdimms, *jdimm, *jobj;
+	unsigned long long serial;
+	char silk[2] = { 0 };
+	int nr, i;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort ddr_inventory\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	nr = cxl_memdev_dimm_inventory(memdev, dimms, ARRAY_SIZE(dimms));
+	if (nr < 0)
+		return nr;
+
+	if (!p->jdevs) {
+		p->jdevs = json_object_new_array();
+		if (!p->jdevs)
+			return -ENOMEM;
+	}
+	jdev = json_object_new_object();
+	if (!jdev)
+		return -ENOMEM;
+	json_object_array_add(p->jdevs, jdev);
+
+	jobj = json_object_new_string(cxl_memdev_get_devname(memdev));
+	if (jobj)
+		json_object_object_add(jdev, "memdev", jobj);
+	serial = cxl_memdev_get_serial(memdev);
+	if (serial != ULLONG_MAX) {
+		jobj = util_json_object_hex(serial, 0);
+		if (jobj)
+			json_object_object_add(jdev, "serial", jobj);
+	}
+	jdimms = json_object_new_array();
+	if (!jdimms)
+		return -ENOMEM;
+	json_object_object_add(jdev, "dimms", jdimms);
+
+	for (i = 0; i < nr; i++) {
+		d = &dimms[i];
+		jdimm = json_object_new_object();
+		if (!jdimm)
+			return -ENOMEM;
+		json_object_array_add(jdimms, jdimm);
+
+		jobj = json_object_new_int(d->spd_id);
+		if (jobj)
+			json_object_object_add(jdimm, "spd_id", jobj);
+		jobj = json_object_new_int(d->channel_id);
+		if (jobj)
+			json_object_object_add(jdimm, "channel_id", jobj);
+		silk[0] = d->silk_screen;
+		jobj = json_object_new_string(silk);
+		if (jobj)
+			json_object_object_add(jdimm, "silk_screen", jobj);
+		jobj = json_object_new_string(d->ram_type);
+		if (jobj)
+			json_object_object_add(jdimm, "type", jobj);
+		if (d->module_type) {
+			jobj = json_object_new_string(d->module_type);
+			if (jobj)
+				json_object_object_add(jdimm, "module_type", jobj);
+		}
+		jobj = json_object_new_int(d->size_gb);
+		if (jobj)
+			json_object_object_add(jdimm, "size_gb", jobj);
+		jobj = json_object_new_int(d->speed_mts);
+		if (jobj)
+			json_object_object_add(jdimm, "speed_mts", jobj);
+		if (d->manufacturer) {
+			jobj = json_object_new_string(d->manufacturer);
+			if (jobj)
+				json_object_object_add(jdimm, "manufacturer", jobj);
+		}
+		jobj = json_object_new_string(d->serial);
+		if (jobj)
+			json_object_object_add(jdimm, "serial", jobj);
+		if (p->verbose) {
+			jobj = json_object_new_boolean(d->cached);
+			if (jobj)
+				json_object_object_add(jdimm, "cached", jobj);
+		}
+	}
+	return 0;
+}
+
 static int action_cmd_pmic_vtmon_info(struct cxl_memdev *memdev, struct action_context *actx)
 {
 	if (cxl_memdev_is_active(memdev)) {
@@ -4128,6 +6017,49 @@ static int action_cmd_ddr_margin_status(struct cxl_memdev *memdev,
 	return cxl_memdev_ddr_margin_status(memdev);
 }
 
+/*
+ * ddr-margin-execute only gathers the memdevs here; the sweep runs once
+ * over all of them from cmd_ddr_margin_execute() so the devices margin
+ * concurrently instead of one after the other.
+ */
+static int action_cmd_ddr_margin_execute(struct cxl_memdev *memdev,
+				   struct action_context *actx)
+{
+	struct _ddr_margin_execute_params *p = &ddr_margin_execute_params;
+	struct cxl_memdev **memdevs;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort ddr_margin_execute\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	memdevs = realloc(p->memdevs, (p->nr_memdevs + 1) * sizeof(*memdevs));
+	if (!memdevs)
+		return -ENOMEM;
+	memdevs[p->nr_memdevs++] = memdev;
+	p->memdevs = memdevs;
+	return 0;
+}
+
+static int ddr_margin_execute_mask(const char *list, const char *dflt,
+		int max, u32 *mask)
+{
+	u32 ids[32];
+	int nr, i;
+
+	nr = parse_counter_list(list ? list : dflt, ids, ARRAY_SIZE(ids));
+	if (nr <= 0)
+		return -EINVAL;
+	*mask = 0;
+	for (i = 0; i < nr; i++) {
+		if (ids[i] >= (u32)max)
+			return -EINVAL;
+		*mask |= 1u << ids[i];
+	}
+	return 0;
+}
+
 static int action_cmd_ddr_margin_get(struct cxl_memdev *memdev,
 				   struct action_context *actx)
 {
@@ -4165,9 +6097,37 @@ static int action_cmd_ddr_stats_run(struct cxl_memdev *memdev,
 									ddr_stats_run_params.loop_count);
 }
 
+/*
+ * Wait for a ddr-stats-run to finish: sleep through the expected monitor
+ * time first, then poll with a doubling interval.
+ */
+static int ddr_stats_get_wait(struct cxl_memdev *memdev)
+{
+	struct _ddr_stats_get_params *p = &ddr_stats_get_params;
+	u64 expected = (u64)p->monitor_time * p->loop_count;
+	u64 deadline = util_clock_ms(CLOCK_MONOTONIC) + expected + (u64)p->timeout_s * 1000;
+	u32 interval = 10, loop_count;
+	int run_status, rc;
+
+	usleep(expected * 1000);
+	for (;;) {
+		rc = cxl_memdev_ddr_stats_status_fetch(memdev, &run_status,
+				&loop_count);
+		if (rc || !run_status)
+			return rc;
+		if (util_clock_ms(CLOCK_MONOTONIC) > deadline)
+			return -ETIMEDOUT;
+		usleep(interval * 1000);
+		interval = min(interval * 2, 1000u);
+	}
+}
+
 static int action_cmd_ddr_stats_get(struct cxl_memdev *memdev,
 				   struct action_context *actx)
 {
+	struct _ddr_stats_get_params *p = &ddr_stats_get_params;
+	enum cxl_ddr_stats_format format;
+	u32 snapshot;
 	int rc = 0;
 
 	if (cxl_memdev_is_active(memdev)) {
@@ -4176,16 +6136,40 @@ static int action_cmd_ddr_stats_get(struct cxl_memdev *memdev,
 		return -EBUSY;
 	}
 
-	rc = cxl_memdev_ddr_stats_get(memdev);
-	if(rc)
-	{
-		fprintf(stderr,
-			"ddr_stats_get read failed");
-		goto abort;
+	if (!p->format || strcmp(p->format, "text") == 0) {
+		format = CXL_DDR_STATS_TEXT;
+	} else if (strcmp(p->format, "csv") == 0) {
+		format = CXL_DDR_STATS_CSV;
+	} else if (strcmp(p->format, "json") == 0) {
+		format = CXL_DDR_STATS_JSON;
+	} else {
+		fprintf(stderr, "%s: --format must be text, csv or json\n",
+			cxl_memdev_get_devname(memdev));
+		return -EINVAL;
 	}
 
-abort:
-  return rc;
+	if (!p->loop) {
+		rc = cxl_memdev_ddr_stats_dump(memdev, format, 0);
+		if (rc)
+			fprintf(stderr, "ddr_stats_get read failed\n");
+		return rc;
+	}
+
+	for (snapshot = 0; snapshot < p->loop; snapshot++) {
+		rc = cxl_memdev_ddr_stats_run(memdev, p->ddr_id,
+				p->monitor_time, p->loop_count);
+		if (rc == 0)
+			rc = ddr_stats_get_wait(memdev);
+		if (rc == 0)
+			rc = cxl_memdev_ddr_stats_dump(memdev, format, snapshot);
+		if (rc) {
+			fprintf(stderr, "%s: ddr stats snapshot %u failed: %s\n",
+				cxl_memdev_get_devname(memdev), snapshot,
+				strerror(rc < 0 ? -rc : ENXIO));
+			return rc < 0 ? rc : -ENXIO;
+		}
+	}
+	return 0;
 }
 
 static int action_cmd_reboot_mode_set(struct cxl_memdev *memdev,
@@ -4332,6 +6316,108 @@ static int action_cmd_read_ddr_temp(struct cxl_memdev *memdev,
 	return cxl_memdev_read_ddr_temp(memdev);
 }
 
+/* one address per line, the first comma/space separated field is used */
+static int hpa_bulk_load(const char *file, u64 **hpa_out)
+{
+	u64 *hpa = NULL, *tmp;
+	int nr = 0, alloc = 0, line = 0, rc = 0;
+	char *buf = NULL, *p, *end;
+	size_t len = 0;
+	FILE *fp;
+
+	fp = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+	if (!fp) {
+		fprintf(stderr, "hpa-to-dpa: %s: %s\n", file, strerror(errno));
+		return -errno;
+	}
+
+	while (getline(&buf, &len, fp) > 0) {
+		line++;
+		buf[strcspn(buf, "#\n")] = '\0';
+		p = buf + strspn(buf, " \t");
+		if (*p == '\0')
+			continue;
+
+		if (nr == alloc) {
+			alloc = alloc ? alloc * 2 : 1024;
+			tmp = realloc(hpa, alloc * sizeof(*hpa));
+			if (!tmp) {
+				rc = -ENOMEM;
+				break;
+			}
+			hpa = tmp;
+		}
+		errno = 0;
+		hpa[nr] = strtoull(p, &end, 0);
+		if (errno || end == p || (*end && !strchr(", \t\r", *end))) {
+			fprintf(stderr, "hpa-to-dpa: %s:%d: invalid address\n",
+				file, line);
+			rc = -EINVAL;
+			break;
+		}
+		nr++;
+	}
+
+	free(buf);
+	if (fp != stdin)
+		fclose(fp);
+	if (rc) {
+		free(hpa);
+		return rc;
+	}
+	*hpa_out = hpa;
+	return nr;
+}
+
+static int hpa_to_dpa_bulk(struct cxl_memdev *memdev)
+{
+	struct _hpa_bulk_params *p = &hpa_bulk_params;
+	struct cxl_hpa_dpa_stats stats;
+	u64 *dpa;
+	int rc, i;
+
+	if (!p->hpa) {
+		rc = hpa_bulk_load(p->file, &p->hpa);
+		if (rc <= 0)
+			return rc ? rc : -EINVAL;
+		p->nr = rc;
+	}
+
+	dpa = calloc(p->nr, sizeof(*dpa));
+	if (!dpa)
+		return -ENOMEM;
+
+	rc = cxl_memdev_hpa_to_dpa_bulk(memdev, p->hpa, dpa, p->nr,
+			p->verify, &stats);
+	if (rc < 0)
+		goto out;
+
+	for (i = 0; i < p->nr; i++) {
+		if (dpa[i] == CXL_DPA_INVALID)
+			fprintf(stdout, "0x%llx,-\n",
+				(unsigned long long)p->hpa[i]);
+		else
+			fprintf(stdout, "0x%llx,0x%llx\n",
+				(unsigned long long)p->hpa[i],
+				(unsigned long long)dpa[i]);
+	}
+
+	if (param.verbose) {
+		fprintf(stderr, "%s: %d/%d translated, mailbox %u, modeled %u, verified %u, mismatches %u\n",
+			cxl_memdev_get_devname(memdev), rc, p->nr, stats.mailbox,
+			stats.modeled, stats.verified, stats.mismatches);
+		if (stats.model_valid)
+			fprintf(stderr, "%s: model granularity %llu ways %u position %u\n",
+				cxl_memdev_get_devname(memdev),
+				(unsigned long long)stats.granularity,
+				stats.ways, stats.position);
+	}
+	rc = rc == p->nr ? 0 : -ENXIO;
+out:
+	free(dpa);
+	return rc;
+}
+
 static int action_cmd_cxl_hpa_to_dpa(struct cxl_memdev *memdev,
                                      struct action_context *actx)
 {
@@ -4341,6 +6427,9 @@ static int action_cmd_cxl_hpa_to_dpa(struct cxl_memdev *memdev,
 		return -EBUSY;
 	}
 
+	if (hpa_bulk_params.file)
+		return hpa_to_dpa_bulk(memdev);
+
 	return cxl_memdev_cxl_hpa_to_dpa(memdev, hpa_address);
 }
 
@@ -4365,6 +6454,10 @@ static int action_cmd_get_ddr_bw(struct cxl_memdev *memdev,
 		return -EBUSY;
 	}
 
+	if (record_params.file)
+		return record_get_ddr_bw(memdev, get_ddr_bw_params.timeout,
+				get_ddr_bw_params.iterations);
+
 	return cxl_memdev_get_ddr_bw(memdev, get_ddr_bw_params.timeout, get_ddr_bw_params.iterations);
 }
 
@@ -4404,6 +6497,166 @@ static int action_cmd_i2c_write(struct cxl_memdev *memdev,
 	return cxl_memdev_i2c_write(memdev, i2c_write_params.slave_addr, i2c_write_params.reg_addr, i2c_write_params.data);
 }
 
+/* parse the i2c-batch op list; blank lines and '#' comments are skipped */
+static int i2c_batch_parse(const char *file, struct cxl_i2c_op **ops_out)
+{
+	struct cxl_i2c_op *ops = NULL, *tmp, *op;
+	unsigned long slave, reg, val;
+	int nr = 0, alloc = 0, line = 0, fields, rc = 0;
+	char *buf = NULL, kind;
+	size_t len = 0;
+	FILE *fp;
+
+	fp = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+	if (!fp) {
+		fprintf(stderr, "i2c-batch: %s: %s\n", file, strerror(errno));
+		return -errno;
+	}
+
+	while (getline(&buf, &len, fp) > 0) {
+		line++;
+		buf[strcspn(buf, "#\n")] = '\0';
+		if (buf[strspn(buf, " \t")] == '\0')
+			continue;
+
+		val = 1;
+		fields = sscanf(buf, " %c %li %li %li", &kind, &slave, &reg, &val);
+		if (fields < 3 || (kind != 'r' && kind != 'w') ||
+		    (kind == 'w' && fields != 4) || slave > USHRT_MAX ||
+		    reg > UCHAR_MAX || val > UCHAR_MAX ||
+		    (kind == 'r' && (val == 0 || val > CXL_I2C_MAX_SIZE_NUM_BYTES))) {
+			fprintf(stderr, "i2c-batch: %s:%d: invalid op\n", file, line);
+			rc = -EINVAL;
+			break;
+		}
+
+		if (nr == alloc) {
+			alloc = alloc ? alloc * 2 : 64;
+			tmp = realloc(ops, alloc * sizeof(*ops));
+			if (!tmp) {
+				rc = -ENOMEM;
+				break;
+			}
+			ops = tmp;
+		}
+		op = &ops[nr++];
+		memset(op, 0, sizeof(*op));
+		op->type = kind == 'r' ? CXL_I2C_OP_READ : CXL_I2C_OP_WRITE;
+		op->slave_addr = slave;
+		op->reg_addr = reg;
+		if (kind == 'r')
+			op->num_bytes = val;
+		else
+			op->data = val;
+	}
+
+	free(buf);
+	if (fp != stdin)
+		fclose(fp);
+	if (rc) {
+		free(ops);
+		return rc;
+	}
+	*ops_out = ops;
+	return nr;
+}
+
+static int action_cmd_i2c_batch(struct cxl_memdev *memdev,
+				      struct action_context *actx)
+{
+	struct _i2c_batch_params *p = &i2c_batch_params;
+	struct json_object *jdev, *jops, *jop, *jdata, *jobj;
+	struct cxl_i2c_op *op;
+	size_t results_len = 0;
+	int rc, i, j;
+	u8 *results;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort i2c_batch\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	if (!p->ops) {
+		if (!p->file) {
+			fprintf(stderr, "i2c-batch: --file is required\n");
+			return -EINVAL;
+		}
+		rc = i2c_batch_parse(p->file, &p->ops);
+		if (rc <= 0)
+			return rc ? rc : -EINVAL;
+		p->nr_ops = rc;
+		p->jdevs = json_object_new_array();
+		if (!p->jdevs)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < p->nr_ops; i++)
+		if (p->ops[i].type == CXL_I2C_OP_READ)
+			results_len += p->ops[i].num_bytes;
+	results = malloc(results_len ? results_len : 1);
+	if (!results)
+		return -ENOMEM;
+
+	rc = cxl_memdev_i2c_batch(memdev, p->ops, p->nr_ops, results,
+			results_len);
+
+	jdev = json_object_new_object();
+	if (!jdev) {
+		free(results);
+		return -ENOMEM;
+	}
+	json_object_array_add(p->jdevs, jdev);
+	jobj = json_object_new_string(cxl_memdev_get_devname(memdev));
+	if (jobj)
+		json_object_object_add(jdev, "memdev", jobj);
+	jops = json_object_new_array();
+	if (jops)
+		json_object_object_add(jdev, "ops", jops);
+
+	for (i = 0; jops && i < p->nr_ops; i++) {
+		op = &p->ops[i];
+		jop = json_object_new_object();
+		if (!jop)
+			break;
+		json_object_array_add(jops, jop);
+		jobj = json_object_new_string(op->type == CXL_I2C_OP_READ ?
+				"r" : "w");
+		if (jobj)
+			json_object_object_add(jop, "op", jobj);
+		jobj = util_json_object_hex(op->slave_addr, 0);
+		if (jobj)
+			json_object_object_add(jop, "slave_addr", jobj);
+		jobj = util_json_object_hex(op->reg_addr, 0);
+		if (jobj)
+			json_object_object_add(jop, "reg_addr", jobj);
+		if (op->status) {
+			jobj = json_object_new_string(strerror(-op->status));
+			if (jobj)
+				json_object_object_add(jop, "error", jobj);
+			continue;
+		}
+		if (op->type == CXL_I2C_OP_WRITE) {
+			jobj = util_json_object_hex(op->data, 0);
+			if (jobj)
+				json_object_object_add(jop, "data", jobj);
+			continue;
+		}
+		jdata = json_object_new_array();
+		if (!jdata)
+			continue;
+		json_object_object_add(jop, "data", jdata);
+		for (j = 0; j < op->num_bytes; j++) {
+			jobj = util_json_object_hex(results[op->result_offset + j], 0);
+			if (jobj)
+				json_object_array_add(jdata, jobj);
+		}
+	}
+
+	free(results);
+	return rc < 0 ? rc : 0;
+}
+
 static int action_cmd_get_ddr_ecc_err_info(struct cxl_memdev *memdev,
 				      struct action_context *actx)
 {
@@ -4843,6 +7096,373 @@ static int action_cmd_cxl_threshold_get(struct cxl_memdev *memdev,
     return cxl_memdev_cxl_threshold_get(memdev);
 }
 
+/*
+ * apply-config: read the desired thresholds, alert, irq and scrub settings,
+ * fetch what every memdev currently has in one parallel pass and only issue
+ * the set commands whose values differ.
+ */
+enum apply_group {
+	APPLY_DDR_THRES,
+	APPLY_CXL_THRES,
+	APPLY_ALERT,
+	APPLY_IRQ,
+	APPLY_SCRUB,
+	APPLY_NR_GROUPS,
+};
+
+#define APPLY_OFF UINT_MAX
+#define APPLY_MAX_KEYS 32
+
+static const struct apply_key {
+	const char *name;
+	enum apply_group group;
+	int field;
+	u32 min;
+	u32 max;
+	bool allow_off;
+} apply_keys[] = {
+	{ "ddr.corr_err_threshold_cnt", APPLY_DDR_THRES, 0, 1, 500 },
+	{ "ddr.corr_err_time_limit", APPLY_DDR_THRES, 1, 1, 5000 },
+	{ "ddr.uncorr_err_threshold_cnt", APPLY_DDR_THRES, 2, 1, 500 },
+	{ "ddr.uncorr_err_time_limit", APPLY_DDR_THRES, 3, 1, 5000 },
+	{ "cxl.corr_err_threshold_cnt", APPLY_CXL_THRES, 0, 1, 500 },
+	{ "cxl.corr_err_time_limit", APPLY_CXL_THRES, 1, 1, 5000 },
+	{ "cxl.uncorr_err_threshold_cnt", APPLY_CXL_THRES, 2, 1, 500 },
+	{ "cxl.uncorr_err_time_limit", APPLY_CXL_THRES, 3, 1, 5000 },
+	{ "alert.life_used_prog_warn_threshold", APPLY_ALERT, 0, 0, 100, true },
+	{ "alert.dev_over_temp_prog_warn_threshold", APPLY_ALERT, 1, 0, USHRT_MAX, true },
+	{ "alert.dev_under_temp_prog_warn_threshold", APPLY_ALERT, 2, 0, USHRT_MAX, true },
+	{ "alert.corr_vol_mem_err_prog_warn_threshold", APPLY_ALERT, 3, 0, USHRT_MAX, true },
+	{ "alert.corr_pers_mem_err_prog_warn_threshold", APPLY_ALERT, 4, 0, USHRT_MAX, true },
+	{ "irq.cxl_corr", APPLY_IRQ, 0, 1, 1 },
+	{ "irq.cxl_uncorr", APPLY_IRQ, 1, 1, 1 },
+	{ "irq.cxl_cfg", APPLY_IRQ, 2, 1, 1 },
+	{ "irq.ddr0", APPLY_IRQ, 3, 1, 1 },
+	{ "irq.ddr1", APPLY_IRQ, 4, 1, 1 },
+	{ "ddr.cont_scrub", APPLY_SCRUB, 0, 0, 1, true },
+};
+
+struct apply_settings {
+	bool set[APPLY_MAX_KEYS];
+	u32 val[APPLY_MAX_KEYS];
+};
+
+struct apply_section {
+	char name[32];
+	struct apply_settings settings;
+};
+
+struct apply_dev {
+	struct cxl_memdev *memdev;
+	struct apply_settings want;
+	bool need[APPLY_NR_GROUPS];
+	struct cxl_error_threshold thres[2];
+	struct cxl_alert_config alert;
+	u8 irq;
+	u32 scrub;
+};
+
+static int apply_config_value(const struct apply_key *key, const char *val,
+		u32 *out)
+{
+	unsigned long v;
+	char *end;
+
+	if (strcmp(val, "on") == 0) {
+		v = 1;
+	} else if (strcmp(val, "off") == 0) {
+		if (!key->allow_off)
+			return -EINVAL;
+		*out = key->group == APPLY_ALERT ? APPLY_OFF : 0;
+		return 0;
+	} else {
+		errno = 0;
+		v = strtoul(val, &end, 0);
+		if (errno || end == val || *end)
+			return -EINVAL;
+	}
+	if (v < key->min || v > key->max)
+		return -ERANGE;
+	*out = v;
+	return 0;
+}
+
+static int apply_config_parse(const char *file, struct apply_section **out)
+{
+	struct apply_section *sections, *tmp, *cur;
+	char *buf = NULL, *key, *val, *end;
+	int nr = 1, line = 0, rc = 0;
+	unsigned int k;
+	size_t len = 0;
+	FILE *fp;
+
+	BUILD_ASSERT(ARRAY_SIZE(apply_keys) <= APPLY_MAX_KEYS);
+
+	/* section 0 holds the settings for every memdev */
+	sections = calloc(1, sizeof(*sections));
+	if (!sections)
+		return -ENOMEM;
+	cur = sections;
+
+	fp = fopen(file, "r");
+	if (!fp) {
+		fprintf(stderr, "apply-config: %s: %s\n", file, strerror(errno));
+		free(sections);
+		return -errno;
+	}
+
+	while (getline(&buf, &len, fp) > 0) {
+		line++;
+		buf[strcspn(buf, "#\n")] = '\0';
+		key = buf + strspn(buf, " \t");
+		end = key + strlen(key);
+		while (end > key && strchr(" \t\r", end[-1]))
+			*--end = '\0';
+		if (*key == '\0')
+			continue;
+
+		if (*key == '[') {
+			if (end[-1] != ']' || end - key - 2 >= (int)sizeof(cur->name)) {
+				fprintf(stderr, "apply-config: %s:%d: invalid section\n",
+					file, line);
+				rc = -EINVAL;
+				break;
+			}
+			tmp = realloc(sections, (nr + 1) * sizeof(*sections));
+			if (!tmp) {
+				rc = -ENOMEM;
+				break;
+			}
+			sections = tmp;
+			cur = &sections[nr++];
+			memset(cur, 0, sizeof(*cur));
+			memcpy(cur->name, key + 1, end - key - 2);
+			continue;
+		}
+
+		val = strchr(key, '=');
+		if (!val) {
+			fprintf(stderr, "apply-config: %s:%d: expected 'key = value'\n",
+				file, line);
+			rc = -EINVAL;
+			break;
+		}
+		end = val++;
+		while (end > key && strchr(" \t", end[-1]))
+			end--;
+		*end = '\0';
+		val += strspn(val, " \t");
+
+		for (k = 0; k < ARRAY_SIZE(apply_keys); k++)
+			if (strcmp(key, apply_keys[k].name) == 0)
+				break;
+		if (k == ARRAY_SIZE(apply_keys)) {
+			fprintf(stderr, "apply-config: %s:%d: unknown key '%s'\n",
+				file, line, key);
+			rc = -EINVAL;
+			break;
+		}
+		rc = apply_config_value(&apply_keys[k], val, &cur->settings.val[k]);
+		if (rc) {
+			fprintf(stderr, "apply-config: %s:%d: invalid value '%s' for %s\n",
+				file, line, val, key);
+			break;
+		}
+		cur->settings.set[k] = true;
+	}
+
+	free(buf);
+	fclose(fp);
+	if (rc) {
+		free(sections);
+		return rc;
+	}
+	*out = sections;
+	return nr;
+}
+
+static u16 *apply_thres_field(struct cxl_error_threshold *t, int field)
+{
+	switch (field) {
+	case 0:
+		return &t->corr_err_threshold_cnt;
+	case 1:
+		return &t->corr_err_time_limit;
+	case 2:
+		return &t->uncorr_err_threshold_cnt;
+	default:
+		return &t->uncorr_err_time_limit;
+	}
+}
+
+static u32 apply_alert_field(const struct cxl_alert_config *a, int field)
+{
+	switch (field) {
+	case 0:
+		return a->life_used_prog_warn_threshold;
+	case 1:
+		return a->dev_over_temp_prog_warn_threshold;
+	case 2:
+		return a->dev_under_temp_prog_warn_threshold;
+	case 3:
+		return a->corr_vol_mem_err_prog_warn_threshold;
+	default:
+		return a->corr_pers_mem_err_prog_warn_threshold;
+	}
+}
+
+static int apply_config_fetch(struct cxl_memdev *memdev, int idx, void *arg)
+{
+	struct apply_dev *dev = (struct apply_dev *)arg + idx;
+	int rc = 0;
+
+	if (dev->need[APPLY_DDR_THRES])
+		rc = cxl_memdev_ddr_threshold_get_fetch(memdev, &dev->thres[0]);
+	if (!rc && dev->need[APPLY_CXL_THRES])
+		rc = cxl_memdev_cxl_threshold_get_fetch(memdev, &dev->thres[1]);
+	if (!rc && dev->need[APPLY_ALERT])
+		rc = cxl_memdev_get_alert_config_fetch(memdev, &dev->alert);
+	if (!rc && dev->need[APPLY_IRQ])
+		rc = cxl_memdev_cxl_ddr_irq_status_fetch(memdev, &dev->irq);
+	if (!rc && dev->need[APPLY_SCRUB])
+		rc = cxl_memdev_ddr_cont_scrub_status_fetch(memdev, &dev->scrub);
+
+	/* some getters hand back the raw mailbox status */
+	return rc > 0 ? -ENXIO : rc;
+}
+
+static void apply_config_report(struct apply_dev *dev, unsigned int k,
+		u32 from, u32 to)
+{
+	char f[16], t[16];
+
+	if (from == APPLY_OFF)
+		strcpy(f, "off");
+	else
+		snprintf(f, sizeof(f), "%u", from);
+	if (to == APPLY_OFF)
+		strcpy(t, "off");
+	else
+		snprintf(t, sizeof(t), "%u", to);
+	fprintf(stdout, "%s: %s: %s -> %s\n",
+		cxl_memdev_get_devname(dev->memdev), apply_keys[k].name, f, t);
+}
+
+/* returns the number of changed settings, or a negative error */
+static int apply_config_diff(struct apply_dev *dev, bool dry_run)
+{
+	struct cxl_error_threshold want_thres[2];
+	u8 alert_valid = 0, alert_enable, enabled;
+	u32 cur, want, alert_val[5], scrub = dev->scrub;
+	bool dirty[APPLY_NR_GROUPS] = { false };
+	int changes = 0, rc = 0, i;
+	unsigned int k;
+	u16 *field;
+
+	want_thres[0] = dev->thres[0];
+	want_thres[1] = dev->thres[1];
+	alert_enable = dev->alert.programmable_alerts;
+	for (i = 0; i < 5; i++)
+		alert_val[i] = apply_alert_field(&dev->alert, i);
+
+	for (k = 0; k < ARRAY_SIZE(apply_keys); k++) {
+		const struct apply_key *key = &apply_keys[k];
+
+		if (!dev->want.set[k])
+			continue;
+		want = dev->want.val[k];
+
+		switch (key->group) {
+		case APPLY_DDR_THRES:
+		case APPLY_CXL_THRES:
+			field = apply_thres_field(&want_thres[key->group], key->field);
+			cur = *field;
+			*field = want;
+			break;
+		case APPLY_ALERT:
+			enabled = dev->alert.programmable_alerts & (1 << key->field);
+			cur = enabled ? alert_val[key->field] : APPLY_OFF;
+			if (cur == want)
+				break;
+			alert_valid |= 1 << key->field;
+			if (want == APPLY_OFF) {
+				alert_enable &= ~(1 << key->field);
+			} else {
+				alert_enable |= 1 << key->field;
+				alert_val[key->field] = want;
+			}
+			break;
+		case APPLY_IRQ:
+			cur = !!(dev->irq & (1 << key->field));
+			break;
+		default:
+			cur = dev->scrub;
+			scrub = want;
+			break;
+		}
+
+		if (cur == want)
+			continue;
+		apply_config_report(dev, k, cur, want);
+		dirty[key->group] = true;
+		changes++;
+
+		/* irq lines are enabled one at a time */
+		if (key->group == APPLY_IRQ && !dry_run && !rc)
+			rc = cxl_memdev_cxl_ddr_irq_enable_set(dev->memdev,
+					key->field + 1);
+	}
+
+	if (dry_run)
+		return changes;
+
+	if (!rc && dirty[APPLY_DDR_THRES])
+		rc = cxl_memdev_ddr_threshold_set(dev->memdev,
+				want_thres[0].corr_err_threshold_cnt,
+				want_thres[0].corr_err_time_limit,
+				want_thres[0].uncorr_err_threshold_cnt,
+				want_thres[0].uncorr_err_time_limit);
+	if (!rc && dirty[APPLY_CXL_THRES])
+		rc = cxl_memdev_cxl_threshold_set(dev->memdev,
+				want_thres[1].corr_err_threshold_cnt,
+				want_thres[1].corr_err_time_limit,
+				want_thres[1].uncorr_err_threshold_cnt,
+				want_thres[1].uncorr_err_time_limit);
+	/* set-alert-config takes its fields packed as in the CLI options */
+	if (!rc && dirty[APPLY_ALERT])
+		rc = cxl_memdev_set_alert_config(dev->memdev,
+				alert_valid << 16 | alert_enable << 8 | alert_val[0],
+				alert_val[1] << 16 | alert_val[2],
+				alert_val[3] << 16 | alert_val[4]);
+	if (!rc && dirty[APPLY_SCRUB])
+		rc = cxl_memdev_ddr_cont_scrub_set(dev->memdev, scrub);
+
+	if (rc)
+		return rc > 0 ? -ENXIO : rc;
+	return changes;
+}
+
+/* like ddr-margin-execute, gather the memdevs and do the work in cmd_ */
+static int action_cmd_apply_config(struct cxl_memdev *memdev,
+				   struct action_context *actx)
+{
+	struct _apply_config_params *p = &apply_config_params;
+	struct cxl_memdev **memdevs;
+
+	if (cxl_memdev_is_active(memdev)) {
+		fprintf(stderr, "%s: memdev active, abort apply_config\n",
+			cxl_memdev_get_devname(memdev));
+		return -EBUSY;
+	}
+
+	memdevs = realloc(p->memdevs, (p->nr_memdevs + 1) * sizeof(*memdevs));
+	if (!memdevs)
+		return -ENOMEM;
+	memdevs[p->nr_memdevs++] = memdev;
+	p->memdevs = memdevs;
+	return 0;
+}
+
 static int action_write(struct cxl_memdev *memdev, struct action_context *actx)
 {
   size_t size = param.len, read_len;
@@ -4862,10 +7482,15 @@ static int action_write(struct cxl_memdev *memdev, struct action_context *actx)
     size = ftell(actx->f_in);
     fseek(actx->f_in, 0L, SEEK_SET);
 
-    if (size > lsa_size) {
+    /* a zero length would mean "to the end of the LSA" below */
+    if (!size) {
+      fprintf(stderr, "Input is empty, aborting\n");
+      return -EINVAL;
+    }
+    if (param.offset > lsa_size || size > lsa_size - param.offset) {
       fprintf(stderr,
-        "File size (%zu) greater than LSA size (%zu), aborting\n",
-        size, lsa_size);
+        "File size (%zu) at offset %u greater than LSA size (%zu), aborting\n",
+        size, param.offset, lsa_size);
       return -EINVAL;
     }
   }
@@ -4880,7 +7505,7 @@ static int action_write(struct cxl_memdev *memdev, struct action_context *actx)
     goto out;
   }
 
-  rc = cxl_memdev_set_lsa(memdev, buf, size, param.offset);
+  rc = memdev_lsa_update(memdev, buf, size);
   if (rc < 0)
     fprintf(stderr, "%s: label write failed: %s\n",
       cxl_memdev_get_devname(memdev), strerror(-rc));
@@ -4893,22 +7518,38 @@ out:
 static int action_read(struct cxl_memdev *memdev, struct action_context *actx)
 {
   size_t size = param.len, write_len;
+  struct cxl_lsa_stats stats;
   char *buf;
   int rc;
 
-  if (!size)
-    size = cxl_memdev_get_lsa_size(memdev);
+  if (!size) {
+    size_t lsa_size = cxl_memdev_get_lsa_size(memdev);
+
+    if (!lsa_size) {
+      fprintf(stderr, "%s: no label storage area to read\n",
+        cxl_memdev_get_devname(memdev));
+      return -ENXIO;
+    }
+    if (param.offset >= lsa_size) {
+      fprintf(stderr, "%s: offset %u is beyond the LSA size (%zu)\n",
+        cxl_memdev_get_devname(memdev), param.offset, lsa_size);
+      return -EINVAL;
+    }
+    size = lsa_size - param.offset;
+  }
 
   buf = calloc(1, size);
   if (!buf)
     return -ENOMEM;
 
-  rc = cxl_memdev_get_lsa(memdev, buf, size, param.offset);
+  rc = cxl_memdev_get_lsa_ext(memdev, buf, size, param.offset,
+      param.verify ? CXL_LSA_VERIFY : 0, &stats);
   if (rc < 0) {
     fprintf(stderr, "%s: label read failed: %s\n",
       cxl_memdev_get_devname(memdev), strerror(-rc));
     goto out;
   }
+  lsa_report(memdev, "read", &stats);
 
   write_len = fwrite(buf, 1, size, actx->f_out);
   if (write_len != size) {
@@ -4922,6 +7563,25 @@ out:
   return rc;
 }
 
+static void memdev_action_one(struct cxl_memdev *memdev,
+    int (*action)(struct cxl_memdev *memdev, struct action_context *actx),
+    struct action_context *actx, struct cxl_memdev **single, int *count,
+    int *err)
+{
+  int rc;
+
+  if (action == action_write) {
+    *single = memdev;
+    rc = 0;
+  } else
+    rc = action(memdev, actx);
+
+  if (rc == 0)
+    (*count)++;
+  else if (rc && !*err)
+    *err = rc;
+}
+
 static int memdev_action(int argc, const char **argv, struct cxl_ctx *ctx,
     int (*action)(struct cxl_memdev *memdev, struct action_context *actx),
     const struct option *options, const char *usage)
@@ -4958,6 +7618,30 @@ static int memdev_action(int argc, const char **argv, struct cxl_ctx *ctx,
     return -EINVAL;
   }
 
+  /*
+   * An unbounded recording runs until SIGINT, which would also end the
+   * recording of every memdev after the first. An hct-stream output holds
+   * the raw entries of a single trace buffer.
+   */
+  if ((record_params.file && !record_params.samples)
+      || action == action_cmd_hct_stream) {
+    int nr = argc - err;
+
+    if (strcmp(argv[0], "all") == 0) {
+      nr = 0;
+      cxl_memdev_foreach (ctx, memdev)
+        nr++;
+    }
+    if (nr > 1) {
+      if (action == action_cmd_hct_stream)
+        error("hct-stream only supports streaming a single memdev\n");
+      else
+        error("--record of more than one memdev requires --samples\n");
+      usage_with_options(u, options);
+      return -EINVAL;
+    }
+  }
+
   if (!param.outfile)
     actx.f_out = stdout;
   else {
@@ -4994,21 +7678,16 @@ static int memdev_action(int argc, const char **argv, struct cxl_ctx *ctx,
         && strcmp(argv[i], "all") != 0)
       continue;
 
-    cxl_memdev_foreach (ctx, memdev) {
-      if (!util_cxl_memdev_filter(memdev, argv[i]))
-        continue;
-
-      if (action == action_write) {
-        single = memdev;
-        rc = 0;
-      } else
-        rc = action(memdev, &actx);
-
-      if (rc == 0)
-        count++;
-      else if (rc && !err)
-        err = rc;
+    /* explicit names load just that memdev instead of the whole bus */
+    if (strcmp(argv[i], "all") != 0) {
+      memdev = cxl_memdev_get_by_name(ctx, argv[i]);
+      if (memdev)
+        memdev_action_one(memdev, action, &actx, &single, &count, &err);
+      continue;
     }
+
+    cxl_memdev_foreach (ctx, memdev)
+      memdev_action_one(memdev, action, &actx, &single, &count, &err);
   }
   rc = err;
 
@@ -5308,6 +7987,11 @@ int cmd_ltmon_capture_log_dmp(int argc, const char **argv, struct cxl_ctx *ctx)
   int rc = memdev_action(argc, argv, ctx, action_cmd_ltmon_capture_log_dmp, cmd_ltmon_capture_log_dmp_options,
       "cxl ltmon_capture_log_dmp <mem0> [<mem1>..<memN>] [<options>]");
 
+  if (ltmon_capture_log_dmp_params.out && ltmon_capture_log_dmp_params.out != stdout &&
+      fclose(ltmon_capture_log_dmp_params.out) && rc >= 0)
+    rc = -errno;
+  ltmon_capture_log_dmp_params.out = NULL;
+
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
@@ -5463,10 +8147,21 @@ int cmd_perfcnt_ddr_generic_select(int argc, const char **argv, struct cxl_ctx *
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_perfcnt_snapshot(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	int rc = memdev_action(argc, argv, ctx, action_cmd_perfcnt_snapshot, cmd_perfcnt_snapshot_options,
+			"cxl perfcnt-snapshot <mem0> [<mem1>..<memN>] [<options>]");
+	if (record_finish() && rc >= 0)
+		rc = -EIO;
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_perfcnt_ddr_generic_capture(int argc, const char **argv, struct cxl_ctx *ctx)
 {
 	int rc = memdev_action(argc, argv, ctx, action_cmd_perfcnt_ddr_generic_capture, cmd_perfcnt_ddr_generic_capture_options,
 			"cxl perfcnt_ddr_generic_capture <mem0> [<mem1>..<memN>] [<options>]");
+	if (record_finish() && rc >= 0)
+		rc = -EIO;
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
@@ -5474,6 +8169,8 @@ int cmd_perfcnt_ddr_dfi_capture(int argc, const char **argv, struct cxl_ctx *ctx
 {
 	int rc = memdev_action(argc, argv, ctx, action_cmd_perfcnt_ddr_dfi_capture, cmd_perfcnt_ddr_dfi_capture_options,
 			"cxl perfcnt_ddr_dfi_capture <mem0> [<mem1>..<memN>] [<options>]");
+	if (record_finish() && rc >= 0)
+		rc = -EIO;
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
@@ -5661,6 +8358,24 @@ int cmd_eh_link_dbg_lane_dump(int argc, const char **argv, struct cxl_ctx *ctx)
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_eh_link_dbg_dump_all(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _eh_link_dbg_dump_all_params *p = &eh_link_dbg_dump_all_params;
+	int rc = memdev_action(argc, argv, ctx, action_cmd_eh_link_dbg_dump_all, cmd_eh_link_dbg_dump_all_options,
+			"cxl eh-link-dbg-dump-all <mem0> [<mem1>..<memN>] [<options>]");
+
+	if (p->jdumps)
+		util_display_json_array(p->out, p->jdumps, 0);
+	if (p->out && p->out != stdout && fclose(p->out) && rc >= 0)
+		rc = -errno;
+	else if (p->out == stdout && fflush(stdout) && rc >= 0)
+		rc = -errno;
+	p->jdumps = NULL;
+	p->out = NULL;
+
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_eh_link_dbg_reset(int argc, const char **argv, struct cxl_ctx *ctx)
 {
 	int rc = memdev_action(argc, argv, ctx, action_cmd_eh_link_dbg_reset, cmd_eh_link_dbg_reset_options,
@@ -5829,6 +8544,23 @@ int cmd_fbist_test_randomsequence(int argc, const char **argv, struct cxl_ctx *c
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_fbist_run(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	int rc = memdev_action(argc, argv, ctx, action_cmd_fbist_run, cmd_fbist_run_options,
+			"cxl fbist-run <mem0> [<mem1>..<memN>] [<options>]");
+
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
+int cmd_eye_scan(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	int rc = memdev_action(argc, argv, ctx, action_cmd_eye_scan, cmd_eye_scan_options,
+			"cxl eye-scan <mem0> [<mem1>..<memN>] [<options>]");
+
+	eye_scan_params.header_done = false;
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_conf_read(int argc, const char **argv, struct cxl_ctx *ctx)
 {
 	int rc = memdev_action(argc, argv, ctx, action_cmd_conf_read, cmd_conf_read_options,
@@ -5861,6 +8593,14 @@ int cmd_hct_set_config(int argc, const char **argv, struct cxl_ctx *ctx)
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_hct_stream(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	int rc = memdev_action(argc, argv, ctx, action_cmd_hct_stream, cmd_hct_stream_options,
+			"cxl hct-stream <mem0> [<mem1>..<memN>] -o <file> [<options>]");
+
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_osa_os_patt_trig_cfg(int argc, const char **argv, struct cxl_ctx *ctx)
 {
 	int rc = memdev_action(argc, argv, ctx, action_cmd_osa_os_patt_trig_cfg, cmd_osa_os_patt_trig_cfg_options,
@@ -5882,6 +8622,10 @@ int cmd_osa_data_read(int argc, const char **argv, struct cxl_ctx *ctx)
 	int rc = memdev_action(argc, argv, ctx, action_cmd_osa_data_read, cmd_osa_data_read_options,
 			"cxl osa_data_read <mem0> [<mem1>..<memN>] [<options>]");
 
+	if (osa_data_read_params.close_fd && close(osa_data_read_params.fd) && rc >= 0)
+		rc = -errno;
+	osa_data_read_params.fd = -1;
+	osa_data_read_params.close_fd = false;
 	return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
@@ -5909,6 +8653,19 @@ int cmd_dimm_slot_info(int argc, const char **argv, struct cxl_ctx *ctx)
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_ddr_inventory(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _ddr_inventory_params *p = &ddr_inventory_params;
+	int rc = memdev_action(argc, argv, ctx, action_cmd_ddr_inventory, cmd_ddr_inventory_options,
+			"cxl ddr-inventory <mem0> [<mem1>..<memN>] [<options>]");
+
+	if (p->jdevs)
+		util_display_json_array(stdout, p->jdevs, 0);
+	p->jdevs = NULL;
+
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_pmic_vtmon_info(int argc, const char **argv, struct cxl_ctx *ctx)
 {
   int rc = memdev_action(argc, argv, ctx, action_cmd_pmic_vtmon_info, cmd_pmic_vtmon_info_options,
@@ -5933,6 +8690,61 @@ int cmd_ddr_margin_status(int argc, const char **argv, struct cxl_ctx *ctx)
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_ddr_margin_execute(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _ddr_margin_execute_params *p = &ddr_margin_execute_params;
+	struct cxl_ddr_margin_result *results = NULL;
+	struct cxl_ddr_margin_window *w;
+	u32 slice_mask, rd_wr_mask, ddr_mask;
+	int rc, i, j;
+
+	rc = memdev_action(argc, argv, ctx, action_cmd_ddr_margin_execute, cmd_ddr_margin_execute_options,
+			"cxl ddr-margin-execute <mem0> [<mem1>..<memN>] [<options>]");
+	if (rc < 0 || !p->nr_memdevs)
+		goto out;
+
+	if (ddr_margin_execute_mask(p->slices, "0-8", 32, &slice_mask) ||
+	    ddr_margin_execute_mask(p->rd_wr_margins, "0-1", 8, &rd_wr_mask) ||
+	    ddr_margin_execute_mask(p->ddr_ids, "0-1", 8, &ddr_mask)) {
+		fprintf(stderr, "ddr-margin-execute: invalid --slices, --rd_wr_margins or --ddr_ids list\n");
+		rc = -EINVAL;
+		goto out;
+	}
+
+	results = calloc(p->nr_memdevs, sizeof(*results));
+	if (!results) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	rc = cxl_memdev_ddr_margin_execute(p->memdevs, p->nr_memdevs,
+			slice_mask, rd_wr_mask, ddr_mask, p->timeout_s * 1000,
+			results);
+
+	fprintf(stdout, "memdev,DdrId,RdWr,SliceNo,bitNo,VrefLv,MinDelay,MaxDelay,MinDly(ps),MaxDly(ps)\n");
+	for (i = 0; i < p->nr_memdevs; i++) {
+		for (j = 0; j < results[i].nr_windows; j++) {
+			w = &results[i].windows[j];
+			fprintf(stdout, "%s,%u,%u,%u,%u,%d,%d,%d,%3.2f,%3.2f\n",
+				cxl_memdev_get_devname(results[i].memdev),
+				w->ddr_id, w->rd_wr_margin, w->slice, w->bit,
+				w->vref_level, w->margin_low, w->margin_high,
+				w->min_delay_ps, w->max_delay_ps);
+		}
+		if (results[i].status)
+			fprintf(stderr, "%s: ddr margin sweep failed: %s\n",
+				cxl_memdev_get_devname(results[i].memdev),
+				strerror(-results[i].status));
+		free(results[i].windows);
+	}
+
+out:
+	free(results);
+	free(p->memdevs);
+	p->memdevs = NULL;
+	p->nr_memdevs = 0;
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_ddr_margin_get(int argc, const char **argv, struct cxl_ctx *ctx)
 {
   int rc = memdev_action(argc, argv, ctx, action_cmd_ddr_margin_get, cmd_ddr_margin_get_options,
@@ -6026,6 +8838,9 @@ int cmd_cxl_hpa_to_dpa(int argc, const char **argv, struct cxl_ctx *ctx)
   int rc = memdev_action(argc, argv, ctx, action_cmd_cxl_hpa_to_dpa, cmd_cxl_hpa_to_dpa_options,
       "cxl hpa to dpa");
 
+  free(hpa_bulk_params.hpa);
+  hpa_bulk_params.hpa = NULL;
+  hpa_bulk_params.nr = 0;
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
@@ -6041,6 +8856,8 @@ int cmd_get_ddr_bw(int argc, const char **argv, struct cxl_ctx *ctx)
 {
   int rc = memdev_action(argc, argv, ctx, action_cmd_get_ddr_bw, cmd_get_ddr_bw_options,
       "cxl get-ddr-bw <mem0> [<mem1>..<memN>] [<options>]");
+  if (record_finish() && rc >= 0)
+    rc = -EIO;
 
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
@@ -6069,6 +8886,22 @@ int cmd_i2c_write(int argc, const char **argv, struct cxl_ctx *ctx)
   return rc >= 0 ? 0 : EXIT_FAILURE;
 }
 
+int cmd_i2c_batch(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _i2c_batch_params *p = &i2c_batch_params;
+	int rc = memdev_action(argc, argv, ctx, action_cmd_i2c_batch, cmd_i2c_batch_options,
+			"cxl i2c-batch <mem0> [<mem1>..<memN>] --file <ops> [<options>]");
+
+	if (p->jdevs)
+		util_display_json_array(stdout, p->jdevs, 0);
+	p->jdevs = NULL;
+	free(p->ops);
+	p->ops = NULL;
+	p->nr_ops = 0;
+
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
+
 int cmd_get_ddr_ecc_err_info(int argc, const char **argv, struct cxl_ctx *ctx)
 {
   int rc = memdev_action(argc, argv, ctx, action_cmd_get_ddr_ecc_err_info, cmd_get_ddr_ecc_err_info_options,
@@ -6463,3 +9296,94 @@ int cmd_cxl_threshold_get(int argc, const char **argv, struct cxl_ctx *ctx)
 
     return rc >= 0 ? 0 : EXIT_FAILURE;
 }
+
+int cmd_apply_config(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _apply_config_params *p = &apply_config_params;
+	struct apply_section *sections = NULL;
+	struct apply_dev *devs = NULL;
+	int *status = NULL;
+	int rc, nr_sections = 0, i, j, changes, total = 0;
+	unsigned int k;
+	bool quiet;
+
+	rc = memdev_action(argc, argv, ctx, action_cmd_apply_config, cmd_apply_config_options,
+			"cxl apply-config <mem0> [<mem1>..<memN>] --config <file> [--dry-run]");
+	if (rc < 0 || !p->nr_memdevs)
+		goto out;
+
+	if (!p->config) {
+		fprintf(stderr, "apply-config: --config is required\n");
+		rc = -EINVAL;
+		goto out;
+	}
+	rc = apply_config_parse(p->config, &sections);
+	if (rc < 0)
+		goto out;
+	nr_sections = rc;
+
+	devs = calloc(p->nr_memdevs, sizeof(*devs));
+	status = calloc(p->nr_memdevs, sizeof(*status));
+	if (!devs || !status) {
+		rc = -ENOMEM;
+		goto out;
+	}
+
+	/* [memN] sections override the global settings for that memdev */
+	for (i = 0; i < p->nr_memdevs; i++) {
+		devs[i].memdev = p->memdevs[i];
+		for (j = 0; j < nr_sections; j++) {
+			if (j && strcmp(sections[j].name,
+					cxl_memdev_get_devname(p->memdevs[i])))
+				continue;
+			for (k = 0; k < ARRAY_SIZE(apply_keys); k++) {
+				if (!sections[j].settings.set[k])
+					continue;
+				devs[i].want.set[k] = true;
+				devs[i].want.val[k] = sections[j].settings.val[k];
+				devs[i].need[apply_keys[k].group] = true;
+			}
+		}
+	}
+
+	rc = memdev_parallel(p->memdevs, p->nr_memdevs, apply_config_fetch,
+			devs, status);
+	if (rc == -ENOMEM)
+		goto out;
+
+	/* set commands are few after the diff, issue them in order */
+	rc = 0;
+	quiet = cxl_get_quiet(ctx);
+	cxl_set_quiet(ctx, true);
+	for (i = 0; i < p->nr_memdevs; i++) {
+		if (status[i]) {
+			fprintf(stderr, "%s: failed to read current settings: %s\n",
+				cxl_memdev_get_devname(devs[i].memdev),
+				strerror(-status[i]));
+			rc = status[i];
+			continue;
+		}
+		changes = apply_config_diff(&devs[i], p->dry_run);
+		if (changes < 0) {
+			fprintf(stderr, "%s: apply failed: %s\n",
+				cxl_memdev_get_devname(devs[i].memdev),
+				strerror(-changes));
+			rc = changes;
+			continue;
+		}
+		total += changes;
+	}
+	cxl_set_quiet(ctx, quiet);
+	fprintf(stdout, "%d change%s %s across %d memdev%s\n", total,
+		total == 1 ? "" : "s", p->dry_run ? "pending" : "applied",
+		p->nr_memdevs, p->nr_memdevs == 1 ? "" : "s");
+
+out:
+	free(status);
+	free(devs);
+	free(sections);
+	free(p->memdevs);
+	p->memdevs = NULL;
+	p->nr_memdevs = 0;
+	return rc >= 0 ? 0 : EXIT_FAILURE;
+}
@@ -0,0 +1,59 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <cxl/libcxl.h>
+#include "parallel.h"
+
+struct memdev_parallel_job {
+	pthread_t thread;
+	bool started;
+	struct cxl_memdev *memdev;
+	int idx;
+	memdev_parallel_fn fn;
+	void *arg;
+	int *status;
+};
+
+static void *memdev_parallel_thread(void *data)
+{
+	struct memdev_parallel_job *job = data;
+
+	*job->status = job->fn(job->memdev, job->idx, job->arg);
+	return NULL;
+}
+
+int memdev_parallel(struct cxl_memdev **memdevs, int nr,
+		memdev_parallel_fn fn, void *arg, int *status)
+{
+	struct memdev_parallel_job *jobs;
+	int i, rc = 0;
+
+	jobs = calloc(nr, sizeof(*jobs));
+	if (!jobs)
+		return -ENOMEM;
+
+	for (i = 0; i < nr; i++) {
+		jobs[i].memdev = memdevs[i];
+		jobs[i].idx = i;
+		jobs[i].fn = fn;
+		jobs[i].arg = arg;
+		jobs[i].status = &status[i];
+		/* fall back to running inline rather than failing the device */
+		if (pthread_create(&jobs[i].thread, NULL, memdev_parallel_thread,
+					&jobs[i]) == 0)
+			jobs[i].started = true;
+		else
+			memdev_parallel_thread(&jobs[i]);
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (jobs[i].started)
+			pthread_join(jobs[i].thread, NULL);
+		if (status[i] < 0 && !rc)
+			rc = status[i];
+	}
+
+	free(jobs);
+	return rc;
+}
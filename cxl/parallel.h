@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _CXL_PARALLEL_H_
+#define _CXL_PARALLEL_H_
+#include <cxl/libcxl.h>
+
+/*
+ * Run @fn once per memdev, each on its own thread. The kernel serializes
+ * mailbox commands per device, so this overlaps work across devices while
+ * everything issued from one @fn call stays in order on its device.
+ * @status[i] receives the return value of @fn for memdevs[i].
+ */
+typedef int (*memdev_parallel_fn)(struct cxl_memdev *memdev, int idx,
+		void *arg);
+int memdev_parallel(struct cxl_memdev **memdevs, int nr,
+		memdev_parallel_fn fn, void *arg, int *status);
+
+#endif /* _CXL_PARALLEL_H_ */
@@ -0,0 +1,529 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <float.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <util/json.h>
+#include <util/time.h>
+#include <json-c/json.h>
+#include <util/parse-options.h>
+#include <ccan/short_types/short_types.h>
+#include <cxl/libcxl.h>
+#include "record.h"
+
+struct record {
+	int fd;
+	u64 block;
+	u32 nrows;
+	u32 ncols;
+	u32 block_size;
+	u32 col_off[RECORD_MAX_COLS];
+	u32 col_width[RECORD_MAX_COLS];
+	void *buf;
+};
+
+/* flush the in-progress block every this many rows */
+#define RECORD_FLUSH_ROWS 64
+
+static volatile sig_atomic_t record_stop;
+
+static void record_sigint(int sig)
+{
+	record_stop = 1;
+}
+
+bool record_interrupted(void)
+{
+	return record_stop != 0;
+}
+
+static u32 record_type_width(enum record_type type)
+{
+	switch (type) {
+	case RECORD_U32:
+	case RECORD_F32:
+		return sizeof(u32);
+	case RECORD_U64:
+		return sizeof(u64);
+	}
+	return 0;
+}
+
+/*
+ * Column offsets within a block and the block size, or 0 when the block
+ * would not fit in 32 bits. @hdr->ncols must be at most RECORD_MAX_COLS.
+ */
+static u32 record_layout(const struct record_hdr *hdr, u32 *col_off,
+		u32 *col_width)
+{
+	u64 off = RECORD_BLOCK_HDR_SIZE;
+	u32 i;
+
+	for (i = 0; i < le32_to_cpu(hdr->ncols); i++) {
+		col_off[i] = off;
+		col_width[i] = le32_to_cpu(hdr->cols[i].width);
+		off += (u64) col_width[i] * le32_to_cpu(hdr->rows_per_block);
+		if (off > UINT_MAX)
+			return 0;
+	}
+
+	/* keep every block page aligned so it can be mapped directly */
+	off = (off + RECORD_HDR_SIZE - 1) & ~(u64) (RECORD_HDR_SIZE - 1);
+	return off > UINT_MAX ? 0 : off;
+}
+
+static int record_build_hdr(struct record_hdr *hdr, const char *source,
+		const struct record_column *cols, int ncols)
+{
+	int i;
+
+	if (ncols + 1 > (int) RECORD_MAX_COLS)
+		return -E2BIG;
+
+	memcpy(hdr->magic, RECORD_MAGIC, sizeof(hdr->magic));
+	hdr->version = cpu_to_le32(RECORD_VERSION);
+	hdr->ncols = cpu_to_le32(ncols + 1);
+	hdr->rows_per_block = cpu_to_le32(RECORD_ROWS_PER_BLOCK);
+	strncpy(hdr->source, source, RECORD_SOURCE_LEN - 1);
+
+	strncpy(hdr->cols[0].name, "ts_ns", RECORD_NAME_LEN - 1);
+	hdr->cols[0].type = cpu_to_le32(RECORD_U64);
+	hdr->cols[0].width = cpu_to_le32(sizeof(u64));
+	for (i = 0; i < ncols; i++) {
+		struct record_col_desc *desc = &hdr->cols[i + 1];
+		u32 width = record_type_width(cols[i].type);
+
+		if (!width)
+			return -EINVAL;
+		strncpy(desc->name, cols[i].name, RECORD_NAME_LEN - 1);
+		desc->type = cpu_to_le32(cols[i].type);
+		desc->width = cpu_to_le32(width);
+	}
+	return 0;
+}
+
+/**
+ * record_open() - open (or create) a capture file for appending
+ * @path: capture file
+ * @source: name of the command producing the samples
+ * @cols: sample columns, the timestamp column is added implicitly
+ * @ncols: number of entries in @cols
+ *
+ * An existing file is only appended to when its schema matches exactly.
+ */
+struct record *record_open(const char *path, const char *source,
+		const struct record_column *cols, int ncols)
+{
+	struct record_hdr *hdr, *cur = NULL;
+	struct record *rec;
+	struct stat st;
+	int rc;
+
+	hdr = calloc(1, RECORD_HDR_SIZE);
+	rec = calloc(1, sizeof(*rec));
+	if (!hdr || !rec)
+		goto err;
+	rec->fd = -1;
+
+	rc = record_build_hdr(hdr, source, cols, ncols);
+	if (rc) {
+		fprintf(stderr, "%s: invalid record schema: %s\n", path,
+				strerror(-rc));
+		goto err;
+	}
+	rec->ncols = ncols + 1;
+	rec->block_size = record_layout(hdr, rec->col_off, rec->col_width);
+	hdr->block_size = cpu_to_le32(rec->block_size);
+
+	rec->fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (rec->fd < 0) {
+		fprintf(stderr, "failed to open: %s: (%s)\n", path,
+				strerror(errno));
+		goto err;
+	}
+	if (fstat(rec->fd, &st) < 0)
+		goto err;
+
+	if (st.st_size == 0) {
+		if (pwrite(rec->fd, hdr, RECORD_HDR_SIZE, 0) != RECORD_HDR_SIZE) {
+			fprintf(stderr, "%s: failed to write header\n", path);
+			goto err;
+		}
+	} else {
+		cur = malloc(RECORD_HDR_SIZE);
+		if (!cur)
+			goto err;
+		if (pread(rec->fd, cur, RECORD_HDR_SIZE, 0) != RECORD_HDR_SIZE
+				|| memcmp(cur, hdr, RECORD_HDR_SIZE) != 0) {
+			fprintf(stderr, "%s: existing capture has a different schema\n",
+					path);
+			goto err;
+		}
+		if ((st.st_size - RECORD_HDR_SIZE) % rec->block_size) {
+			fprintf(stderr, "%s: truncated capture file\n", path);
+			goto err;
+		}
+		rec->block = (st.st_size - RECORD_HDR_SIZE) / rec->block_size;
+		free(cur);
+	}
+
+	rec->buf = calloc(1, rec->block_size);
+	if (!rec->buf)
+		goto err;
+
+	record_stop = 0;
+	signal(SIGINT, record_sigint);
+	free(hdr);
+	return rec;
+
+err:
+	free(cur);
+	free(hdr);
+	if (rec && rec->fd >= 0)
+		close(rec->fd);
+	free(rec);
+	return NULL;
+}
+
+static int record_flush(struct record *rec)
+{
+	struct record_block_hdr *bhdr = rec->buf;
+	off_t off = RECORD_HDR_SIZE + rec->block * rec->block_size;
+
+	bhdr->nrows = cpu_to_le32(rec->nrows);
+	if (pwrite(rec->fd, rec->buf, rec->block_size, off) != rec->block_size)
+		return errno ? -errno : -EIO;
+	return 0;
+}
+
+/* store @cell as a little-endian value of @width bytes at @dst */
+static void record_put_cell(char *dst, u32 width, const union record_cell *cell)
+{
+	le64 v64;
+	le32 v32;
+
+	if (width == sizeof(u64)) {
+		v64 = cpu_to_le64(cell->u64);
+		memcpy(dst, &v64, sizeof(v64));
+	} else {
+		/* u32 and the bit pattern of f32 */
+		v32 = cpu_to_le32(cell->u32);
+		memcpy(dst, &v32, sizeof(v32));
+	}
+}
+
+/**
+ * record_append() - add one sample row
+ * @rec: capture opened by record_open()
+ * @cells: one value per column passed to record_open()
+ */
+int record_append(struct record *rec, const union record_cell *cells)
+{
+	union record_cell ts = { .u64 = util_clock_ns(CLOCK_REALTIME) };
+	char *buf = rec->buf;
+	u32 i;
+	int rc;
+
+	record_put_cell(buf + rec->col_off[0] + rec->nrows * sizeof(u64),
+			sizeof(u64), &ts);
+	for (i = 1; i < rec->ncols; i++)
+		record_put_cell(buf + rec->col_off[i]
+				+ rec->nrows * rec->col_width[i],
+				rec->col_width[i], &cells[i - 1]);
+	rec->nrows++;
+
+	if (rec->nrows == RECORD_ROWS_PER_BLOCK) {
+		rc = record_flush(rec);
+		rec->block++;
+		rec->nrows = 0;
+		memset(rec->buf, 0, rec->block_size);
+		return rc;
+	}
+	if (rec->nrows % RECORD_FLUSH_ROWS == 0)
+		return record_flush(rec);
+	return 0;
+}
+
+int record_close(struct record *rec)
+{
+	int rc = 0;
+
+	if (!rec)
+		return 0;
+	if (rec->nrows)
+		rc = record_flush(rec);
+	if (fsync(rec->fd) < 0 && !rc)
+		rc = -errno;
+	close(rec->fd);
+	free(rec->buf);
+	free(rec);
+	signal(SIGINT, SIG_DFL);
+	return rc;
+}
+
+struct record_agg {
+	u64 count;
+	double sum;
+	double min;
+	double max;
+};
+
+/*
+ * Per-type reductions over one column of one block. These are kept as
+ * straight loops over a contiguous array so the compiler can vectorize
+ * them (the little-endian conversions are no-ops on little-endian
+ * hosts); the u32 variant accumulates in a u64 and only converts to
+ * double once per block.
+ */
+static void record_agg_u32(const le32 *v, u32 n, struct record_agg *agg)
+{
+	u32 lo = UINT_MAX, hi = 0, x;
+	u64 sum = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		x = le32_to_cpu(v[i]);
+		sum += x;
+		lo = x < lo ? x : lo;
+		hi = x > hi ? x : hi;
+	}
+	agg->sum += sum;
+	agg->min = lo < agg->min ? lo : agg->min;
+	agg->max = hi > agg->max ? hi : agg->max;
+}
+
+static void record_agg_u64(const le64 *v, u32 n, struct record_agg *agg)
+{
+	u64 lo = ULLONG_MAX, hi = 0, x;
+	double sum = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		x = le64_to_cpu(v[i]);
+		lo = x < lo ? x : lo;
+		hi = x > hi ? x : hi;
+	}
+	for (i = 0; i < n; i++)
+		sum += le64_to_cpu(v[i]);
+	agg->sum += sum;
+	agg->min = lo < agg->min ? lo : agg->min;
+	agg->max = hi > agg->max ? hi : agg->max;
+}
+
+static float record_get_f32(le32 v)
+{
+	union record_cell cell = { .u32 = le32_to_cpu(v) };
+
+	return cell.f32;
+}
+
+static void record_agg_f32(const le32 *v, u32 n, struct record_agg *agg)
+{
+	float lo = FLT_MAX, hi = -FLT_MAX, x;
+	double sum = 0;
+	u32 i;
+
+	for (i = 0; i < n; i++) {
+		x = record_get_f32(v[i]);
+		lo = x < lo ? x : lo;
+		hi = x > hi ? x : hi;
+	}
+	for (i = 0; i < n; i++)
+		sum += record_get_f32(v[i]);
+	agg->sum += sum;
+	agg->min = lo < agg->min ? lo : agg->min;
+	agg->max = hi > agg->max ? hi : agg->max;
+}
+
+static int record_validate(const struct record_hdr *hdr, size_t size,
+		u32 *col_off)
+{
+	u32 ncols = le32_to_cpu(hdr->ncols);
+	u32 rows_per_block = le32_to_cpu(hdr->rows_per_block);
+	u32 block_size = le32_to_cpu(hdr->block_size);
+	u32 col_width[RECORD_MAX_COLS];
+	u32 i;
+
+	if (size < RECORD_HDR_SIZE || memcmp(hdr->magic, RECORD_MAGIC, 8) != 0)
+		return -EINVAL;
+	if (le32_to_cpu(hdr->version) != RECORD_VERSION || ncols == 0
+			|| ncols > RECORD_MAX_COLS
+			|| rows_per_block == 0
+			|| rows_per_block > RECORD_ROWS_PER_BLOCK)
+		return -EINVAL;
+	/* names are printed as C strings */
+	if (!memchr(hdr->source, 0, RECORD_SOURCE_LEN))
+		return -EINVAL;
+	for (i = 0; i < ncols; i++) {
+		if (le32_to_cpu(hdr->cols[i].width) !=
+				record_type_width(le32_to_cpu(hdr->cols[i].type)))
+			return -EINVAL;
+		if (!memchr(hdr->cols[i].name, 0, RECORD_NAME_LEN))
+			return -EINVAL;
+	}
+	if (block_size == 0
+			|| record_layout(hdr, col_off, col_width) != block_size)
+		return -EINVAL;
+	if ((size - RECORD_HDR_SIZE) % block_size)
+		return -EINVAL;
+	return 0;
+}
+
+int cmd_report(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	const struct option options[] = {
+		OPT_END(),
+	};
+	const char * const u[] = {
+		"cxl report <file>",
+		NULL
+	};
+	struct record_agg agg[RECORD_MAX_COLS];
+	u32 col_off[RECORD_MAX_COLS];
+	struct json_object *jreport, *jcols;
+	const struct record_hdr *hdr;
+	u64 nblocks, b, first_ts = 0, last_ts = 0;
+	u32 ncols, block_size, rows_per_block, i;
+	void *map = MAP_FAILED;
+	struct stat st;
+	int fd, rc = 0;
+
+	argc = parse_options(argc, argv, options, u, 0);
+	if (argc != 1)
+		usage_with_options(u, options);
+
+	fd = open(argv[0], O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "failed to open: %s: (%s)\n", argv[0],
+				strerror(errno));
+		return EXIT_FAILURE;
+	}
+	if (fstat(fd, &st) < 0 || st.st_size < RECORD_HDR_SIZE) {
+		fprintf(stderr, "%s: not a capture file\n", argv[0]);
+		rc = -EINVAL;
+		goto out;
+	}
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	if (map == MAP_FAILED) {
+		rc = -errno;
+		fprintf(stderr, "%s: mmap failed: %s\n", argv[0], strerror(-rc));
+		goto out;
+	}
+	hdr = map;
+	rc = record_validate(hdr, st.st_size, col_off);
+	if (rc) {
+		fprintf(stderr, "%s: not a valid capture file\n", argv[0]);
+		goto out;
+	}
+	ncols = le32_to_cpu(hdr->ncols);
+	block_size = le32_to_cpu(hdr->block_size);
+	rows_per_block = le32_to_cpu(hdr->rows_per_block);
+
+	for (i = 0; i < ncols; i++) {
+		agg[i].count = 0;
+		agg[i].sum = 0;
+		agg[i].min = DBL_MAX;
+		agg[i].max = -DBL_MAX;
+	}
+
+	nblocks = (st.st_size - RECORD_HDR_SIZE) / block_size;
+	for (b = 0; b < nblocks; b++) {
+		const char *blk = (const char *) map + RECORD_HDR_SIZE
+			+ b * block_size;
+		const struct record_block_hdr *bhdr = (const void *) blk;
+		const le64 *ts = (const void *) (blk + col_off[0]);
+		u32 n = le32_to_cpu(bhdr->nrows);
+
+		if (n == 0)
+			continue;
+		if (n > rows_per_block) {
+			fprintf(stderr, "%s: block %llu is corrupt\n", argv[0],
+					(unsigned long long) b);
+			rc = -EINVAL;
+			goto out;
+		}
+		if (agg[0].count == 0)
+			first_ts = le64_to_cpu(ts[0]);
+		last_ts = le64_to_cpu(ts[n - 1]);
+
+		for (i = 0; i < ncols; i++) {
+			const void *col = blk + col_off[i];
+
+			switch (le32_to_cpu(hdr->cols[i].type)) {
+			case RECORD_U32:
+				record_agg_u32(col, n, &agg[i]);
+				break;
+			case RECORD_U64:
+				record_agg_u64(col, n, &agg[i]);
+				break;
+			case RECORD_F32:
+				record_agg_f32(col, n, &agg[i]);
+				break;
+			}
+			agg[i].count += n;
+		}
+	}
+
+	jreport = json_object_new_object();
+	if (!jreport) {
+		rc = -ENOMEM;
+		goto out;
+	}
+	json_object_object_add(jreport, "source",
+			json_object_new_string(hdr->source));
+	json_object_object_add(jreport, "samples",
+			json_object_new_int64(agg[0].count));
+	if (agg[0].count) {
+		double duration = (last_ts - first_ts) / 1e9;
+
+		json_object_object_add(jreport, "first_ts_ns",
+				json_object_new_int64(first_ts));
+		json_object_object_add(jreport, "last_ts_ns",
+				json_object_new_int64(last_ts));
+		json_object_object_add(jreport, "duration_s",
+				json_object_new_double(duration));
+	}
+
+	jcols = json_object_new_array();
+	if (!jcols) {
+		json_object_put(jreport);
+		rc = -ENOMEM;
+		goto out;
+	}
+	for (i = 1; i < ncols && agg[0].count; i++) {
+		struct json_object *jcol = json_object_new_object();
+
+		if (!jcol)
+			continue;
+		json_object_object_add(jcol, "name",
+				json_object_new_string(hdr->cols[i].name));
+		json_object_object_add(jcol, "min",
+				json_object_new_double(agg[i].min));
+		json_object_object_add(jcol, "max",
+				json_object_new_double(agg[i].max));
+		json_object_object_add(jcol, "mean",
+				json_object_new_double(agg[i].sum / agg[i].count));
+		json_object_object_add(jcol, "sum",
+				json_object_new_double(agg[i].sum));
+		json_object_array_add(jcols, jcol);
+	}
+	json_object_object_add(jreport, "columns", jcols);
+
+	fprintf(stdout, "%s\n", json_object_to_json_string_ext(jreport,
+				JSON_C_TO_STRING_PRETTY));
+	json_object_put(jreport);
+
+out:
+	if (map != MAP_FAILED)
+		munmap(map, st.st_size);
+	close(fd);
+	return rc ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,80 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _CXL_RECORD_H_
+#define _CXL_RECORD_H_
+#include <stdbool.h>
+#include <ccan/endian/endian.h>
+#include <ccan/short_types/short_types.h>
+
+/*
+ * Append-only columnar capture file used by 'cxl <capture-cmd> --record'
+ * and read back by 'cxl report'.
+ *
+ * Layout (every field and cell little-endian):
+ *   [header, RECORD_HDR_SIZE bytes]
+ *   [block 0][block 1]...
+ *
+ * Every block has room for rows_per_block rows and is laid out as a small
+ * block header followed by one contiguous array per column, so a reader can
+ * mmap the file and walk each column as a plain C array. Column 0 is always
+ * the sample timestamp in nanoseconds (CLOCK_REALTIME). Blocks have a fixed
+ * size, new samples only ever land in the last block, and a later session
+ * appends fresh blocks rather than rewriting earlier ones.
+ */
+#define RECORD_MAGIC "CXLREC\0\0"
+#define RECORD_VERSION 1
+#define RECORD_HDR_SIZE 4096
+#define RECORD_BLOCK_HDR_SIZE 64
+#define RECORD_ROWS_PER_BLOCK 1024
+#define RECORD_NAME_LEN 24
+#define RECORD_SOURCE_LEN 32
+
+enum record_type {
+	RECORD_U32 = 1,
+	RECORD_U64,
+	RECORD_F32,
+};
+
+struct record_col_desc {
+	char name[RECORD_NAME_LEN];
+	le32 type;
+	le32 width;
+} __attribute__((packed));
+
+struct record_hdr {
+	char magic[8];
+	le32 version;
+	le32 ncols;
+	le32 rows_per_block;
+	le32 block_size;
+	char source[RECORD_SOURCE_LEN];
+	struct record_col_desc cols[];
+} __attribute__((packed));
+
+#define RECORD_MAX_COLS \
+	((RECORD_HDR_SIZE - sizeof(struct record_hdr)) / \
+	 sizeof(struct record_col_desc))
+
+struct record_block_hdr {
+	le32 nrows;
+	le32 rsvd[(RECORD_BLOCK_HDR_SIZE - sizeof(u32)) / sizeof(u32)];
+} __attribute__((packed));
+
+struct record_column {
+	const char *name;
+	enum record_type type;
+};
+
+union record_cell {
+	u32 u32;
+	u64 u64;
+	float f32;
+};
+
+struct record;
+struct record *record_open(const char *path, const char *source,
+		const struct record_column *cols, int ncols);
+int record_append(struct record *rec, const union record_cell *cells);
+int record_close(struct record *rec);
+bool record_interrupted(void);
+
+#endif /* _CXL_RECORD_H_ */
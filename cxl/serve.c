@@ -0,0 +1,481 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <json-c/json.h>
+#include <util/parse-options.h>
+#include <ccan/array_size/array_size.h>
+#include <cxl/libcxl.h>
+#include "builtin.h"
+
+/*
+ * 'cxl serve' keeps one ctx with the memdevs enumerated and their command
+ * fds and tables cached, and answers newline-delimited JSON requests on a
+ * unix socket:
+ *
+ *   {"id": 1, "command": "get-health-info", "args": ["mem0"]}
+ *
+ * Every request runs as a regular subcommand (see cxl_run_command()) and
+ * gets back one line of JSON with its exit status and output. Requests
+ * naming the same memdev are serialized, requests for different memdevs
+ * run concurrently, one thread per connection.
+ */
+#define SERVE_MAX_ARGS 128
+#define SERVE_MAX_UIDS 32
+
+struct serve_dev {
+	int id;
+	pthread_mutex_t lock;
+};
+
+static struct _serve_params {
+	const char *socket;
+	const char *allow_uids;
+	int allow_gid;
+	uid_t uids[SERVE_MAX_UIDS];
+	int nr_uids;
+	struct serve_dev *devs;
+	int nr_devs;
+	struct cxl_ctx *ctx;
+} serve_params = {
+	.socket = "/run/cxl.sock",
+	.allow_gid = -1,
+};
+
+static volatile sig_atomic_t serve_stop;
+
+static void serve_signal(int sig)
+{
+	serve_stop = 1;
+}
+
+static int serve_dev_cmp(const void *a, const void *b)
+{
+	return ((const struct serve_dev *)a)->id -
+		((const struct serve_dev *)b)->id;
+}
+
+/*
+ * Peers let in by --allow-uid/--allow-gid only get these, and none of
+ * them takes a path: everything else can change device state or make the
+ * server read or write a file of the peer's choosing.
+ */
+static const char * const serve_readonly_cmds[] = {
+	"list",
+	"version",
+	"get-fw-info",
+	"device-info-get",
+	"get-supported-logs",
+	"get-event-interrupt-policy",
+	"get-timestamp",
+	"get-alert-config",
+	"get-health-info",
+	"get-ld-info",
+	"ddr-info",
+	"dimm-slot-info",
+	"ddr-inventory",
+	"pmic-vtmon-info",
+	"health-counters-get",
+	"get-cxl-link-status",
+	"get-device-info",
+	"read-ddr-temp",
+	"get-cxl-membridge-errors",
+	"ddr-init-status",
+	"ddr-cont-scrub-status",
+	"curr-cxl-boot-mode-get",
+	"ddr-freq-get",
+};
+
+/* refused from restricted peers even should a command above gain one */
+static const char serve_path_shorts[] = "oR";
+static const char * const serve_path_longs[] = {
+	"--output", "--record", "--config", "--file", "--input",
+	"--trig_config_file",
+};
+
+static bool serve_restricted_ok(int argc, const char **argv)
+{
+	unsigned int i;
+	size_t len;
+	int j;
+
+	for (i = 0; i < ARRAY_SIZE(serve_readonly_cmds); i++)
+		if (strcmp(argv[0], serve_readonly_cmds[i]) == 0)
+			break;
+	if (i == ARRAY_SIZE(serve_readonly_cmds))
+		return false;
+
+	for (j = 1; j < argc; j++) {
+		if (argv[j][0] != '-')
+			continue;
+		/* bundled short options, e.g. -vo<file> */
+		if (argv[j][1] != '-') {
+			if (strpbrk(argv[j], serve_path_shorts))
+				return false;
+			continue;
+		}
+		/* parse_options() also takes unambiguous abbreviations */
+		len = strcspn(argv[j], "=");
+		for (i = 0; i < ARRAY_SIZE(serve_path_longs); i++)
+			if (strncmp(serve_path_longs[i], argv[j], len) == 0)
+				return false;
+	}
+	return true;
+}
+
+/* 1 for root and the server's own uid, 0 for the --allow-* peers */
+static int serve_peer_access(int fd)
+{
+	struct _serve_params *p = &serve_params;
+	struct ucred cred;
+	socklen_t len = sizeof(cred);
+	int i;
+
+	if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) < 0)
+		return -errno;
+	if (cred.uid == 0 || cred.uid == geteuid())
+		return 1;
+	if (p->allow_gid >= 0 && cred.gid == (gid_t)p->allow_gid)
+		return 0;
+	for (i = 0; i < p->nr_uids; i++)
+		if (cred.uid == p->uids[i])
+			return 0;
+	return -EPERM;
+}
+
+/* mark the memdevs a request touches, 'all' takes every one of them */
+static void serve_devs_for_args(int argc, const char **argv, bool *mask)
+{
+	struct _serve_params *p = &serve_params;
+	unsigned long id;
+	int i, j;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "all") == 0) {
+			for (j = 0; j < p->nr_devs; j++)
+				mask[j] = true;
+			return;
+		}
+		if (sscanf(argv[i], "mem%lu", &id) != 1)
+			continue;
+		for (j = 0; j < p->nr_devs; j++)
+			if (p->devs[j].id == (int)id)
+				mask[j] = true;
+	}
+}
+
+struct json_object *cxl_read_output(FILE *f, bool try_json)
+{
+	struct json_object *jobj = NULL;
+	int fd = fileno(f);
+	ssize_t rd;
+	char *buf;
+	off_t len;
+
+	/* the child wrote through its own dup of the fd, bypassing @f */
+	len = lseek(fd, 0, SEEK_END);
+	if (len <= 0 || lseek(fd, 0, SEEK_SET) < 0)
+		return NULL;
+	buf = malloc(len + 1);
+	if (!buf)
+		return NULL;
+	rd = read(fd, buf, len);
+	buf[rd > 0 ? rd : 0] = '\0';
+
+	if (try_json)
+		jobj = json_tokener_parse(buf);
+	if (!jobj)
+		jobj = json_object_new_string(buf);
+	free(buf);
+	return jobj;
+}
+
+static struct json_object *serve_request(const char *line, bool trusted)
+{
+	struct _serve_params *p = &serve_params;
+	struct json_object *jreq, *jresp, *jval, *jargs;
+	const char *argv[SERVE_MAX_ARGS];
+	FILE *out = NULL, *err = NULL;
+	bool *mask = NULL;
+	int argc = 0, i, n, status;
+
+	jresp = json_object_new_object();
+	if (!jresp)
+		return NULL;
+
+	jreq = json_tokener_parse(line);
+	if (!jreq || !json_object_is_type(jreq, json_type_object)) {
+		status = -EINVAL;
+		goto out;
+	}
+	if (json_object_object_get_ex(jreq, "id", &jval))
+		json_object_object_add(jresp, "id", json_object_get(jval));
+
+	if (!json_object_object_get_ex(jreq, "command", &jval) ||
+	    !json_object_is_type(jval, json_type_string)) {
+		status = -EINVAL;
+		goto out;
+	}
+	argv[argc++] = json_object_get_string(jval);
+	if (strcmp(argv[0], "serve") == 0 || strcmp(argv[0], "batch") == 0 ||
+	    strcmp(argv[0], "help") == 0) {
+		status = -EPERM;
+		goto out;
+	}
+
+	if (json_object_object_get_ex(jreq, "args", &jargs)) {
+		if (!json_object_is_type(jargs, json_type_array)) {
+			status = -EINVAL;
+			goto out;
+		}
+		n = json_object_array_length(jargs);
+		if (n >= SERVE_MAX_ARGS - 1) {
+			status = -E2BIG;
+			goto out;
+		}
+		for (i = 0; i < n; i++) {
+			jval = json_object_array_get_idx(jargs, i);
+			if (!json_object_is_type(jval, json_type_string)) {
+				status = -EINVAL;
+				goto out;
+			}
+			argv[argc++] = json_object_get_string(jval);
+		}
+	}
+	argv[argc] = NULL;
+
+	if (!trusted && !serve_restricted_ok(argc, argv)) {
+		status = -EPERM;
+		goto out;
+	}
+
+	mask = calloc(p->nr_devs + 1, sizeof(*mask));
+	out = tmpfile();
+	err = tmpfile();
+	if (!mask || !out || !err) {
+		status = -ENOMEM;
+		goto out;
+	}
+
+	/* devs are sorted by id, so taking the locks in order cannot deadlock */
+	serve_devs_for_args(argc, argv, mask);
+	for (i = 0; i < p->nr_devs; i++)
+		if (mask[i])
+			pthread_mutex_lock(&p->devs[i].lock);
+	status = cxl_run_command(argc, argv, p->ctx, fileno(out), fileno(err));
+	for (i = p->nr_devs - 1; i >= 0; i--)
+		if (mask[i])
+			pthread_mutex_unlock(&p->devs[i].lock);
+
+	if (status >= 0) {
+		jval = cxl_read_output(out, true);
+		if (jval)
+			json_object_object_add(jresp, "output", jval);
+		jval = cxl_read_output(err, false);
+		if (jval)
+			json_object_object_add(jresp, "stderr", jval);
+	}
+
+out:
+	if (status < 0) {
+		jval = json_object_new_string(strerror(-status));
+		if (jval)
+			json_object_object_add(jresp, "error", jval);
+		status = 1;
+	}
+	jval = json_object_new_int(status);
+	if (jval)
+		json_object_object_add(jresp, "status", jval);
+	if (out)
+		fclose(out);
+	if (err)
+		fclose(err);
+	free(mask);
+	json_object_put(jreq);
+	return jresp;
+}
+
+static void *serve_conn(void *arg)
+{
+	int fd = (long)arg, access;
+	struct json_object *jresp;
+	const char *resp;
+	char *buf = NULL;
+	size_t len = 0;
+	FILE *f;
+
+	f = fdopen(fd, "r");
+	if (!f) {
+		close(fd);
+		return NULL;
+	}
+
+	access = serve_peer_access(fd);
+	if (access < 0) {
+		dprintf(fd, "{\"status\":1,\"error\":\"%s\"}\n", strerror(EPERM));
+		goto out;
+	}
+
+	while (getline(&buf, &len, f) > 0) {
+		buf[strcspn(buf, "\r\n")] = '\0';
+		if (buf[0] == '\0')
+			continue;
+		jresp = serve_request(buf, access > 0);
+		if (!jresp)
+			break;
+		resp = json_object_to_json_string_ext(jresp,
+				JSON_C_TO_STRING_PLAIN);
+		/* replies bypass @f, a stdio stream cannot both read and write a socket */
+		dprintf(fd, "%s\n", resp);
+		json_object_put(jresp);
+	}
+
+out:
+	free(buf);
+	fclose(f);
+	return NULL;
+}
+
+static int serve_parse_uids(const char *list)
+{
+	struct _serve_params *p = &serve_params;
+	const char *s = list;
+	unsigned long uid;
+	char *end;
+
+	while (*s) {
+		errno = 0;
+		uid = strtoul(s, &end, 0);
+		if (errno || end == s || uid > UINT_MAX ||
+		    p->nr_uids == SERVE_MAX_UIDS)
+			return -EINVAL;
+		p->uids[p->nr_uids++] = uid;
+		s = end;
+		if (*s == ',')
+			s++;
+		else if (*s)
+			return -EINVAL;
+	}
+	return 0;
+}
+
+int cmd_serve(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _serve_params *p = &serve_params;
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+	struct sigaction sa = { .sa_handler = serve_signal };
+	struct cxl_memdev *memdev;
+	struct serve_dev *devs;
+	pthread_attr_t attr;
+	pthread_t thread;
+	int sock, fd, rc = 0, i;
+	struct stat st;
+	mode_t mask;
+	const struct option options[] = {
+		OPT_STRING('s', "socket", &p->socket, "path",
+			"unix socket to listen on (default /run/cxl.sock)"),
+		OPT_STRING('u', "allow-uid", &p->allow_uids, "list",
+			"comma separated uids allowed besides root and the server's own"),
+		OPT_INTEGER('g', "allow-gid", &p->allow_gid,
+			"gid whose processes are allowed to connect"),
+		OPT_END(),
+	};
+	const char * const u[] = {
+		"cxl serve [--socket <path>] [<options>]",
+		NULL
+	};
+
+	argc = parse_options(argc, argv, options, u, 0);
+	if (argc)
+		usage_with_options(u, options);
+	if (p->allow_uids && serve_parse_uids(p->allow_uids)) {
+		fprintf(stderr, "serve: invalid --allow-uid list\n");
+		return EXIT_FAILURE;
+	}
+	if (strlen(p->socket) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "serve: socket path too long\n");
+		return EXIT_FAILURE;
+	}
+	strcpy(addr.sun_path, p->socket);
+	p->ctx = ctx;
+
+	cxl_memdev_foreach(ctx, memdev) {
+		devs = realloc(p->devs, (p->nr_devs + 1) * sizeof(*devs));
+		if (!devs) {
+			rc = -ENOMEM;
+			goto out;
+		}
+		p->devs = devs;
+		p->devs[p->nr_devs].id = cxl_memdev_get_id(memdev);
+		pthread_mutex_init(&p->devs[p->nr_devs].lock, NULL);
+		p->nr_devs++;
+		rc = cxl_memdev_open(memdev);
+		if (rc)
+			fprintf(stderr, "serve: %s: %s\n",
+				cxl_memdev_get_devname(memdev), strerror(-rc));
+	}
+	if (p->nr_devs)
+		qsort(p->devs, p->nr_devs, sizeof(*p->devs), serve_dev_cmp);
+
+	sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (sock < 0) {
+		rc = -errno;
+		goto out;
+	}
+	/* only replace a stale socket, never some other file */
+	if (lstat(p->socket, &st) == 0 && S_ISSOCK(st.st_mode))
+		unlink(p->socket);
+	/*
+	 * The socket is created with its final mode, there is no window
+	 * where it is more open than intended. SO_PEERCRED does the access
+	 * control once other users may connect.
+	 */
+	mask = umask(p->allow_uids || p->allow_gid >= 0 ? 0111 : 0177);
+	rc = bind(sock, (struct sockaddr *)&addr, sizeof(addr));
+	umask(mask);
+	if (rc < 0 || listen(sock, 16) < 0) {
+		rc = -errno;
+		fprintf(stderr, "serve: %s: %s\n", p->socket, strerror(-rc));
+		close(sock);
+		goto out;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	rc = 0;
+	while (!serve_stop) {
+		fd = accept4(sock, NULL, NULL, SOCK_CLOEXEC);
+		if (fd < 0) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			rc = -errno;
+			break;
+		}
+		if (pthread_create(&thread, &attr, serve_conn, (void *)(long)fd))
+			close(fd);
+	}
+	pthread_attr_destroy(&attr);
+
+	close(sock);
+	unlink(p->socket);
+out:
+	for (i = 0; i < p->nr_devs; i++)
+		pthread_mutex_destroy(&p->devs[i].lock);
+	free(p->devs);
+	if (rc)
+		fprintf(stderr, "serve: %s\n", strerror(-rc));
+	return rc ? EXIT_FAILURE : 0;
+}
@@ -0,0 +1,234 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <json-c/json.h>
+#include <util/time.h>
+#include <util/parse-options.h>
+#include <ccan/array_size/array_size.h>
+#include <cxl/libcxl.h>
+#include "builtin.h"
+#include "parallel.h"
+
+/*
+ * 'cxl snapshot' captures every read-only query we use for triage in one
+ * go. Each command runs as a regular subcommand (see cxl_run_command())
+ * with its output captured, commands for one memdev run back to back, and
+ * memdevs are handled concurrently. A command that does not finish within
+ * --timeout is killed and reported as timed out.
+ */
+static const char *snapshot_cmds[] = {
+	"id-cmd",
+	"get-health-info",
+	"health-counters-get",
+	"get-fw-info",
+	"get-cxl-link-status",
+	"read-ltssm-states",
+	"get-ddr-ecc-err-info",
+	"get-cxl-membridge-errors",
+	"ddr-init-status",
+	"dimm-slot-info",
+	"read-ddr-temp",
+	"pmic-vtmon-info",
+};
+
+static struct _snapshot_params {
+	int timeout_ms;
+	struct cxl_ctx *ctx;
+	struct json_object **jdevs;
+} snapshot_params = {
+	.timeout_ms = 5000,
+};
+
+static double snapshot_elapsed_ms(u64 t0)
+{
+	return (util_clock_ns(CLOCK_MONOTONIC) - t0) / 1e6;
+}
+
+static struct json_object *snapshot_run(struct cxl_memdev *memdev,
+		const char *cmd, int *rc)
+{
+	struct _snapshot_params *p = &snapshot_params;
+	const char *argv[] = { cmd, cxl_memdev_get_devname(memdev), NULL };
+	struct json_object *jcmd, *jval;
+	FILE *out, *err;
+	u64 t0;
+	int status;
+
+	jcmd = json_object_new_object();
+	if (!jcmd)
+		return NULL;
+	json_object_object_add(jcmd, "command", json_object_new_string(cmd));
+
+	out = tmpfile();
+	err = tmpfile();
+	if (!out || !err) {
+		status = -ENOMEM;
+		goto out;
+	}
+
+	t0 = util_clock_ns(CLOCK_MONOTONIC);
+	status = cxl_run_command_timeout(2, argv, p->ctx, fileno(out),
+			fileno(err), p->timeout_ms);
+	json_object_object_add(jcmd, "elapsed_ms",
+			json_object_new_double(snapshot_elapsed_ms(t0)));
+
+	if (status >= 0) {
+		jval = cxl_read_output(out, true);
+		if (jval)
+			json_object_object_add(jcmd, "output", jval);
+		jval = cxl_read_output(err, false);
+		if (jval)
+			json_object_object_add(jcmd, "stderr", jval);
+	}
+
+out:
+	if (status < 0) {
+		json_object_object_add(jcmd, "error",
+				json_object_new_string(status == -ETIMEDOUT ?
+					"timed out" : strerror(-status)));
+		status = 1;
+	}
+	json_object_object_add(jcmd, "status", json_object_new_int(status));
+	*rc = status;
+	if (out)
+		fclose(out);
+	if (err)
+		fclose(err);
+	return jcmd;
+}
+
+static int snapshot_memdev(struct cxl_memdev *memdev, int idx, void *arg)
+{
+	struct _snapshot_params *p = &snapshot_params;
+	struct json_object *jdev, *jcmds, *jcmd;
+	u64 t0;
+	unsigned int i;
+	int failed = 0, rc;
+
+	jdev = json_object_new_object();
+	jcmds = json_object_new_array();
+	if (!jdev || !jcmds) {
+		json_object_put(jdev);
+		json_object_put(jcmds);
+		return -ENOMEM;
+	}
+
+	t0 = util_clock_ns(CLOCK_MONOTONIC);
+	for (i = 0; i < ARRAY_SIZE(snapshot_cmds); i++) {
+		jcmd = snapshot_run(memdev, snapshot_cmds[i], &rc);
+		if (!jcmd || rc)
+			failed++;
+		if (jcmd)
+			json_object_array_add(jcmds, jcmd);
+	}
+
+	json_object_object_add(jdev, "memdev",
+			json_object_new_string(cxl_memdev_get_devname(memdev)));
+	json_object_object_add(jdev, "elapsed_ms",
+			json_object_new_double(snapshot_elapsed_ms(t0)));
+	json_object_object_add(jdev, "failed", json_object_new_int(failed));
+	json_object_object_add(jdev, "commands", jcmds);
+	p->jdevs[idx] = jdev;
+	return failed ? -EIO : 0;
+}
+
+int cmd_snapshot(int argc, const char **argv, struct cxl_ctx *ctx)
+{
+	struct _snapshot_params *p = &snapshot_params;
+	struct json_object *jsnap, *jdevs;
+	struct cxl_memdev **memdevs = NULL, **tmp, *memdev;
+	int i, nr = 0, *status = NULL, rc = EXIT_FAILURE;
+	u64 t0;
+	bool all = false;
+	const struct option options[] = {
+		OPT_INTEGER('t', "timeout", &p->timeout_ms,
+			"per-command timeout in milliseconds (default 5000)"),
+		OPT_END(),
+	};
+	const char * const u[] = {
+		"cxl snapshot [all | <mem0> [<mem1>..<memN>]] [<options>]",
+		NULL
+	};
+
+	argc = parse_options(argc, argv, options, u, 0);
+	if (p->timeout_ms <= 0) {
+		fprintf(stderr, "snapshot: --timeout must be positive\n");
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < argc; i++)
+		if (strcmp(argv[i], "all") == 0)
+			all = true;
+
+	if (argc == 0 || all) {
+		cxl_memdev_foreach(ctx, memdev) {
+			tmp = realloc(memdevs, (nr + 1) * sizeof(*memdevs));
+			if (!tmp)
+				goto out;
+			memdevs = tmp;
+			memdevs[nr++] = memdev;
+		}
+	} else {
+		for (i = 0; i < argc; i++) {
+			memdev = cxl_memdev_get_by_name(ctx, argv[i]);
+			if (!memdev) {
+				fprintf(stderr, "snapshot: %s: not found\n",
+					argv[i]);
+				continue;
+			}
+			tmp = realloc(memdevs, (nr + 1) * sizeof(*memdevs));
+			if (!tmp)
+				goto out;
+			memdevs = tmp;
+			memdevs[nr++] = memdev;
+		}
+	}
+
+	if (nr == 0) {
+		fprintf(stderr, "snapshot: no memdevs\n");
+		goto out;
+	}
+
+	/* open once up front so every child inherits the fds and tables */
+	for (i = 0; i < nr; i++)
+		cxl_memdev_open(memdevs[i]);
+
+	p->ctx = ctx;
+	p->jdevs = calloc(nr, sizeof(*p->jdevs));
+	status = calloc(nr, sizeof(*status));
+	jsnap = json_object_new_object();
+	jdevs = json_object_new_array();
+	if (!p->jdevs || !status || !jsnap || !jdevs) {
+		json_object_put(jsnap);
+		json_object_put(jdevs);
+		goto out;
+	}
+
+	t0 = util_clock_ns(CLOCK_MONOTONIC);
+	memdev_parallel(memdevs, nr, snapshot_memdev, NULL, status);
+
+	rc = 0;
+	for (i = 0; i < nr; i++) {
+		if (status[i])
+			rc = EXIT_FAILURE;
+		if (p->jdevs[i])
+			json_object_array_add(jdevs, p->jdevs[i]);
+	}
+	json_object_object_add(jsnap, "timeout_ms",
+			json_object_new_int(p->timeout_ms));
+	json_object_object_add(jsnap, "elapsed_ms",
+			json_object_new_double(snapshot_elapsed_ms(t0)));
+	json_object_object_add(jsnap, "memdevs", jdevs);
+
+	printf("%s\n", json_object_to_json_string_ext(jsnap,
+				JSON_C_TO_STRING_PRETTY));
+	json_object_put(jsnap);
+
+out:
+	free(p->jdevs);
+	free(status);
+	free(memdevs);
+	return rc;
+}
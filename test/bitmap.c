@@ -0,0 +1,102 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <ccan/array_size/array_size.h>
+#include <util/bitmap.h>
+
+/*
+ * find_next_bit(), find_next_zero_bit() and bitmap_full() against bit
+ * patterns that straddle word boundaries.
+ */
+#define NBITS 150
+
+static int check(const char *what, unsigned long got, unsigned long want)
+{
+	if (got == want)
+		return 0;
+	fprintf(stderr, "%s: got %lu, expected %lu\n", what, got, want);
+	return -ENXIO;
+}
+
+static int test_bitmap_find_next(void)
+{
+	unsigned long *map = bitmap_alloc(NBITS);
+	int rc = -ENOMEM;
+
+	if (!map)
+		return rc;
+
+	bitmap_set(map, 0, 1);
+	bitmap_set(map, 63, 3);
+	bitmap_set(map, 140, 1);
+	rc = check("first set", find_next_bit(map, NBITS, 0), 0);
+	if (!rc)
+		rc = check("set after 1", find_next_bit(map, NBITS, 1), 63);
+	if (!rc)
+		rc = check("set at 64", find_next_bit(map, NBITS, 64), 64);
+	if (!rc)
+		rc = check("set after 66", find_next_bit(map, NBITS, 66), 140);
+	if (!rc)
+		rc = check("none after 141", find_next_bit(map, NBITS, 141),
+				NBITS);
+	if (!rc)
+		rc = check("first zero", find_next_zero_bit(map, NBITS, 0), 1);
+	if (!rc)
+		rc = check("zero after 63", find_next_zero_bit(map, NBITS, 63),
+				66);
+	if (!rc)
+		rc = check("zero in a short map",
+				find_next_zero_bit(map, 66, 63), 66);
+	free(map);
+	return rc;
+}
+
+static int test_bitmap_full(void)
+{
+	unsigned long *map = bitmap_alloc(NBITS);
+	int rc = -ENXIO;
+
+	if (!map)
+		return -ENOMEM;
+
+	bitmap_set(map, 0, NBITS);
+	if (!bitmap_full(map, NBITS)) {
+		fprintf(stderr, "%s: full map not full\n", __func__);
+		goto out;
+	}
+	/* only the last bit clear */
+	bitmap_clear(map, NBITS - 1, 1);
+	if (bitmap_full(map, NBITS)) {
+		fprintf(stderr, "%s: last bit clear but full\n", __func__);
+		goto out;
+	}
+	rc = check("last zero", find_next_zero_bit(map, NBITS, 0), NBITS - 1);
+out:
+	free(map);
+	return rc;
+}
+
+typedef int (*do_test_fn)(void);
+
+static do_test_fn do_test[] = {
+	test_bitmap_find_next,
+	test_bitmap_full,
+};
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int rc = 0;
+
+	for (i = 0; i < ARRAY_SIZE(do_test); i++) {
+		rc = do_test[i]();
+		if (rc < 0) {
+			fprintf(stderr, "test[%d] failed: %d\n", i, rc);
+			break;
+		}
+		fprintf(stderr, "test[%d]: PASS\n", i);
+	}
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
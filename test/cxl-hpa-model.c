@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+
+#include "../cxl/lib/hpa-model.h"
+
+/*
+ * HPA to DPA model fit and lookup for the bulk translation fast path, no
+ * hardware required.
+ */
+struct decoder {
+	u64 gran;
+	unsigned int ways;
+	unsigned int position;
+	u64 skew;
+};
+
+static bool decoder_owns(const struct decoder *d, u64 hpa)
+{
+	return (hpa / d->gran) % d->ways == d->position;
+}
+
+static u64 decoder_map(const struct decoder *d, u64 hpa)
+{
+	return d->skew + (hpa / (d->gran * d->ways)) * d->gran + hpa % d->gran;
+}
+
+/* feed @nr owned addresses from @base, @stride apart, like the mailbox would */
+static void feed(struct hpa_model *m, const struct decoder *d, u64 base,
+		u64 stride, int nr)
+{
+	u64 hpa;
+	int i;
+
+	for (i = 0, hpa = base; i < nr; hpa += stride) {
+		if (!decoder_owns(d, hpa))
+			continue;
+		hpa_model_add(m, hpa, decoder_map(d, hpa));
+		i++;
+	}
+}
+
+static int check_lookup(const struct hpa_model *m, const struct decoder *d,
+		u64 hpa, bool expect)
+{
+	u64 dpa;
+	bool found = hpa_model_lookup(m, hpa, &dpa);
+
+	if (found != expect) {
+		fprintf(stderr, "hpa %#llx: %s, expected %s\n",
+				(unsigned long long) hpa, found ? "found" : "missed",
+				expect ? "found" : "missed");
+		return -ENXIO;
+	}
+	if (found && dpa != decoder_map(d, hpa)) {
+		fprintf(stderr, "hpa %#llx: dpa %#llx, expected %#llx\n",
+				(unsigned long long) hpa, (unsigned long long) dpa,
+				(unsigned long long) decoder_map(d, hpa));
+		return -ENXIO;
+	}
+	return 0;
+}
+
+/* no interleave: the model must stay inside the sampled window */
+static int test_hpa_model_window(void)
+{
+	const struct decoder d = { 4096, 1, 0, 0x1000 };
+	const u64 base = 0x100000000ULL;
+	struct hpa_model m = { 0 };
+	int rc;
+
+	feed(&m, &d, base, 0x1230, 8);
+	if (!m.valid || m.ways != 1) {
+		fprintf(stderr, "%s: no 1-way fit\n", __func__);
+		return -ENXIO;
+	}
+	rc = check_lookup(&m, &d, base + 0x4000, true);
+	if (rc)
+		return rc;
+	rc = check_lookup(&m, &d, base - 1, false);
+	if (rc)
+		return rc;
+	rc = check_lookup(&m, &d, 0, false);
+	if (rc)
+		return rc;
+	return check_lookup(&m, &d, base + 8 * 0x1230, false);
+}
+
+static int test_hpa_model_interleave(void)
+{
+	const struct decoder d = { 1024, 4, 2, 0x40000 };
+	struct hpa_model m = { 0 };
+	u64 hpa;
+	int rc;
+
+	feed(&m, &d, 0x200000000ULL, 0x311, 16);
+	if (!m.valid || m.gran != d.gran || m.ways != d.ways
+			|| m.position != d.position) {
+		fprintf(stderr, "%s: wrong fit\n", __func__);
+		return -ENXIO;
+	}
+	for (hpa = m.hpa_min; hpa <= m.hpa_max; hpa += 0x101) {
+		rc = check_lookup(&m, &d, hpa, decoder_owns(&d, hpa));
+		if (rc)
+			return rc;
+	}
+	return 0;
+}
+
+/* too few or ambiguous samples must not produce a model */
+static int test_hpa_model_ambiguous(void)
+{
+	const struct decoder d = { 4096, 2, 0, 0 };
+	struct hpa_model m = { 0 };
+
+	feed(&m, &d, 0, 1, HPA_MODEL_MIN_SAMPLES - 1);
+	if (m.valid) {
+		fprintf(stderr, "%s: fit from too few samples\n", __func__);
+		return -ENXIO;
+	}
+	/* all inside one granule: every interleave explains them */
+	feed(&m, &d, 0x10, 0x10, 8);
+	if (m.valid) {
+		fprintf(stderr, "%s: fit from ambiguous samples\n", __func__);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+/* a full sample ring must still follow a changed decoder */
+static int test_hpa_model_refit(void)
+{
+	const struct decoder d1 = { 256, 2, 0, 0 };
+	const struct decoder d2 = { 512, 2, 1, 0x80000 };
+	struct hpa_model m = { 0 };
+
+	feed(&m, &d1, 0x10000, 0x95, 2 * HPA_MODEL_MAX_SAMPLES);
+	if (!m.valid || m.gran != d1.gran) {
+		fprintf(stderr, "%s: no initial fit\n", __func__);
+		return -ENXIO;
+	}
+
+	feed(&m, &d2, 0x10000, 0x95, 1);
+	if (m.valid) {
+		fprintf(stderr, "%s: model survived a contradicting sample\n",
+				__func__);
+		return -ENXIO;
+	}
+
+	feed(&m, &d2, 0x20000, 0x95, HPA_MODEL_MAX_SAMPLES);
+	if (!m.valid || m.gran != d2.gran || m.position != d2.position) {
+		fprintf(stderr, "%s: no refit after the decoder changed\n",
+				__func__);
+		return -ENXIO;
+	}
+
+	hpa_model_reset(&m);
+	return check_lookup(&m, &d2, 0x20000, false);
+}
+
+typedef int (*do_test_fn)(void);
+
+static do_test_fn do_test[] = {
+	test_hpa_model_window,
+	test_hpa_model_interleave,
+	test_hpa_model_ambiguous,
+	test_hpa_model_refit,
+};
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int rc = 0;
+
+	for (i = 0; i < ARRAY_SIZE(do_test); i++) {
+		rc = do_test[i]();
+		if (rc < 0) {
+			fprintf(stderr, "test[%d] failed: %d\n", i, rc);
+			break;
+		}
+		fprintf(stderr, "test[%d]: PASS\n", i);
+	}
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+
+#include "../cxl/lib/lsa-shadow.h"
+
+/*
+ * Loaded and dirty slot tracking of the LSA shadow behind cxl_lsa_load()
+ * and cxl_lsa_commit(), no hardware required.
+ */
+#define LSA_SIZE 4000
+#define SLOT_SIZE 256
+
+/* expect exactly the runs in @runs, as { start, end } pairs */
+static int check_dirty_runs(const struct lsa_shadow *s, const char *what,
+		const unsigned int runs[][2], int nr)
+{
+	unsigned int start = 0, end;
+	int i = 0;
+
+	while (lsa_shadow_next_dirty(s, &start, &end)) {
+		if (i >= nr || start != runs[i][0] || end != runs[i][1]) {
+			fprintf(stderr, "%s: unexpected dirty run [%u, %u)\n",
+					what, start, end);
+			return -ENXIO;
+		}
+		i++;
+		start = end;
+	}
+	if (i != nr) {
+		fprintf(stderr, "%s: %d dirty runs, expected %d\n", what, i, nr);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+static int shadow_init_loaded(struct lsa_shadow *s)
+{
+	int rc;
+
+	rc = lsa_shadow_init(s, LSA_SIZE, SLOT_SIZE);
+	if (rc)
+		return rc;
+	lsa_shadow_set_loaded(s, 0, s->nr_slots);
+	return 0;
+}
+
+static int test_lsa_shadow_init(void)
+{
+	struct lsa_shadow s;
+	size_t length = 0;
+	int rc;
+
+	if (lsa_shadow_init(&s, LSA_SIZE, 102) != -EINVAL ||
+			lsa_shadow_init(&s, 0, SLOT_SIZE) != -EINVAL) {
+		fprintf(stderr, "%s: accepted a bad geometry\n", __func__);
+		return -ENXIO;
+	}
+
+	rc = lsa_shadow_init(&s, LSA_SIZE, SLOT_SIZE);
+	if (rc)
+		return rc;
+	rc = -ENXIO;
+	if (s.nr_slots != 16 || lsa_shadow_slot_len(&s, 15, 16) != 160) {
+		fprintf(stderr, "%s: wrong slot geometry\n", __func__);
+		goto out;
+	}
+	if (lsa_shadow_range(&s, &length, 1000) || length != 3000 ||
+			lsa_shadow_range(&s, &length, 1001) == 0 ||
+			lsa_shadow_range(&s, &length, LSA_SIZE + 1) == 0) {
+		fprintf(stderr, "%s: wrong range checks\n", __func__);
+		goto out;
+	}
+	rc = 0;
+out:
+	lsa_shadow_release(&s);
+	return rc;
+}
+
+/* only slots that were never loaded are fetched, one run per gap */
+static int test_lsa_shadow_missing(void)
+{
+	unsigned int start = 0, end;
+	struct lsa_shadow s;
+	int rc;
+
+	rc = lsa_shadow_init(&s, LSA_SIZE, SLOT_SIZE);
+	if (rc)
+		return rc;
+	rc = -ENXIO;
+
+	lsa_shadow_set_loaded(&s, 4, 6);
+	/* bytes 600..1999 touch slots 2..7 */
+	if (!lsa_shadow_next_missing(&s, 1400, 600, &start, &end) ||
+			start != 2 || end != 4) {
+		fprintf(stderr, "%s: wrong first gap\n", __func__);
+		goto out;
+	}
+	lsa_shadow_set_loaded(&s, start, end);
+	start = end;
+	if (!lsa_shadow_next_missing(&s, 1400, 600, &start, &end) ||
+			start != 6 || end != 8) {
+		fprintf(stderr, "%s: wrong second gap\n", __func__);
+		goto out;
+	}
+	lsa_shadow_set_loaded(&s, start, end);
+	start = 0;
+	if (lsa_shadow_next_missing(&s, 1400, 600, &start, &end)) {
+		fprintf(stderr, "%s: loaded range still missing\n", __func__);
+		goto out;
+	}
+	rc = 0;
+out:
+	lsa_shadow_release(&s);
+	return rc;
+}
+
+/* rewriting identical data or zeroing zeroes dirties nothing */
+static int test_lsa_shadow_clean_update(void)
+{
+	struct lsa_shadow s;
+	u8 buf[1024];
+	int rc;
+
+	rc = shadow_init_loaded(&s);
+	if (rc)
+		return rc;
+
+	lsa_shadow_update(&s, NULL, LSA_SIZE, 0);
+	memset(buf, 0, sizeof(buf));
+	lsa_shadow_update(&s, buf, sizeof(buf), 300);
+	rc = check_dirty_runs(&s, __func__, NULL, 0);
+	lsa_shadow_release(&s);
+	return rc;
+}
+
+/* a change dirties exactly the slots it touches */
+static int test_lsa_shadow_dirty(void)
+{
+	const unsigned int runs[][2] = { { 1, 3 }, { 5, 6 }, { 15, 16 } };
+	struct lsa_shadow s;
+	u8 buf[16];
+	int rc;
+
+	rc = shadow_init_loaded(&s);
+	if (rc)
+		return rc;
+
+	memset(buf, 0xa5, sizeof(buf));
+	/* straddles the slot 1 / slot 2 boundary */
+	lsa_shadow_update(&s, buf, sizeof(buf), 2 * SLOT_SIZE - 8);
+	lsa_shadow_update(&s, buf, 1, 5 * SLOT_SIZE + 17);
+	/* last, short slot */
+	lsa_shadow_update(&s, buf, 1, LSA_SIZE - 1);
+	/* same bytes again, slot 5 must not pull in slot 4 or 6 */
+	lsa_shadow_update(&s, buf, 1, 5 * SLOT_SIZE + 17);
+
+	rc = check_dirty_runs(&s, __func__, runs, ARRAY_SIZE(runs));
+	if (rc)
+		goto out;
+	if (lsa_shadow_nr_dirty(&s) != 4 ||
+			s.data[2 * SLOT_SIZE - 9] != 0 ||
+			s.data[2 * SLOT_SIZE + 7] != 0xa5) {
+		fprintf(stderr, "%s: wrong shadow contents\n", __func__);
+		rc = -ENXIO;
+		goto out;
+	}
+
+	/* zeroing a dirty slot back keeps it dirty until committed */
+	lsa_shadow_update(&s, NULL, 1, 5 * SLOT_SIZE + 17);
+	rc = check_dirty_runs(&s, __func__, runs, ARRAY_SIZE(runs));
+out:
+	lsa_shadow_release(&s);
+	return rc;
+}
+
+/* committing a run cleans just that run */
+static int test_lsa_shadow_commit(void)
+{
+	const unsigned int runs[][2] = { { 9, 10 } };
+	unsigned int start = 0, end;
+	struct lsa_shadow s;
+	u8 val = 1;
+	int rc;
+
+	rc = shadow_init_loaded(&s);
+	if (rc)
+		return rc;
+
+	lsa_shadow_update(&s, &val, 1, 0);
+	lsa_shadow_update(&s, &val, 1, 9 * SLOT_SIZE);
+	if (!lsa_shadow_next_dirty(&s, &start, &end) || start != 0 ||
+			end != 1) {
+		fprintf(stderr, "%s: wrong first run\n", __func__);
+		rc = -ENXIO;
+		goto out;
+	}
+	lsa_shadow_set_clean(&s, start, end);
+	rc = check_dirty_runs(&s, __func__, runs, ARRAY_SIZE(runs));
+	if (rc)
+		goto out;
+	lsa_shadow_set_clean(&s, 9, 10);
+	rc = check_dirty_runs(&s, __func__, NULL, 0);
+out:
+	lsa_shadow_release(&s);
+	return rc;
+}
+
+typedef int (*do_test_fn)(void);
+
+static do_test_fn do_test[] = {
+	test_lsa_shadow_init,
+	test_lsa_shadow_missing,
+	test_lsa_shadow_clean_update,
+	test_lsa_shadow_dirty,
+	test_lsa_shadow_commit,
+};
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int rc = 0;
+
+	for (i = 0; i < ARRAY_SIZE(do_test); i++) {
+		rc = do_test[i]();
+		if (rc < 0) {
+			fprintf(stderr, "test[%d] failed: %d\n", i, rc);
+			break;
+		}
+		fprintf(stderr, "test[%d]: PASS\n", i);
+	}
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: GPL-2.0
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <ccan/array_size/array_size.h>
+#include <ccan/short_types/short_types.h>
+
+#include "../cxl/record.h"
+
+/*
+ * Capture file round trip and 'cxl report' input validation, no
+ * hardware required.
+ */
+struct cxl_ctx;
+int cmd_report(int argc, const char **argv, struct cxl_ctx *ctx);
+
+static char path[] = "/tmp/cxl-record-XXXXXX";
+
+static const struct record_column cols[] = {
+	{ "memdev", RECORD_U32 },
+	{ "bytes", RECORD_U64 },
+	{ "bw", RECORD_F32 },
+};
+
+static int report(void)
+{
+	const char *argv[] = { "report", path, NULL };
+
+	return cmd_report(2, argv, NULL);
+}
+
+static int record_rows(u32 first, u32 nr)
+{
+	union record_cell cells[ARRAY_SIZE(cols)];
+	struct record *rec;
+	u32 i;
+	int rc;
+
+	rec = record_open(path, "test", cols, ARRAY_SIZE(cols));
+	if (!rec)
+		return -EINVAL;
+	for (i = first; i < first + nr; i++) {
+		cells[0].u32 = i;
+		cells[1].u64 = (u64) i << 32;
+		cells[2].f32 = i / 2.0f;
+		rc = record_append(rec, cells);
+		if (rc) {
+			record_close(rec);
+			return rc;
+		}
+	}
+	return record_close(rec);
+}
+
+/* more than a block in one session, then a second session appending */
+static int test_record_round_trip(void)
+{
+	const u32 nr1 = RECORD_ROWS_PER_BLOCK + 100, nr2 = 10;
+	struct record_hdr *hdr;
+	struct record_block_hdr bhdr;
+	u32 block_size, total = 0;
+	le32 vals[4];
+	struct stat st;
+	off_t off;
+	int fd, rc;
+
+	rc = record_rows(0, nr1);
+	if (rc)
+		return rc;
+	rc = record_rows(nr1, nr2);
+	if (rc)
+		return rc;
+
+	hdr = calloc(1, RECORD_HDR_SIZE);
+	if (!hdr)
+		return -ENOMEM;
+	fd = open(path, O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) < 0
+			|| pread(fd, hdr, RECORD_HDR_SIZE, 0) != RECORD_HDR_SIZE) {
+		rc = -EIO;
+		goto out;
+	}
+	block_size = le32_to_cpu(hdr->block_size);
+	if (le32_to_cpu(hdr->ncols) != ARRAY_SIZE(cols) + 1
+			|| strcmp(hdr->source, "test")
+			|| strcmp(hdr->cols[2].name, "bytes")) {
+		fprintf(stderr, "%s: unexpected header\n", __func__);
+		rc = -ENXIO;
+		goto out;
+	}
+
+	/* full block, partial block, then the second session's block */
+	if (st.st_size != RECORD_HDR_SIZE + 3 * block_size) {
+		fprintf(stderr, "%s: unexpected size %lld\n", __func__,
+				(long long) st.st_size);
+		rc = -ENXIO;
+		goto out;
+	}
+	for (off = RECORD_HDR_SIZE; off < st.st_size; off += block_size) {
+		if (pread(fd, &bhdr, sizeof(bhdr), off) != sizeof(bhdr)) {
+			rc = -EIO;
+			goto out;
+		}
+		total += le32_to_cpu(bhdr.nrows);
+	}
+	if (total != nr1 + nr2) {
+		fprintf(stderr, "%s: %u rows, expected %u\n", __func__, total,
+				nr1 + nr2);
+		rc = -ENXIO;
+		goto out;
+	}
+
+	/* memdev column of the first row of the last block */
+	off = RECORD_HDR_SIZE + 2 * block_size + RECORD_BLOCK_HDR_SIZE
+		+ le32_to_cpu(hdr->rows_per_block) * sizeof(u64);
+	if (pread(fd, vals, sizeof(vals), off) != sizeof(vals)
+			|| le32_to_cpu(vals[0]) != nr1
+			|| le32_to_cpu(vals[1]) != nr1 + 1) {
+		fprintf(stderr, "%s: unexpected cell values\n", __func__);
+		rc = -ENXIO;
+		goto out;
+	}
+
+	rc = report() == 0 ? 0 : -ENXIO;
+out:
+	if (fd >= 0)
+		close(fd);
+	free(hdr);
+	return rc;
+}
+
+static int test_record_schema_mismatch(void)
+{
+	struct record *rec;
+
+	rec = record_open(path, "test", cols, ARRAY_SIZE(cols) - 1);
+	if (rec) {
+		record_close(rec);
+		fprintf(stderr, "%s: appended with a different schema\n",
+				__func__);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+/*
+ * Write a fresh one row capture, patch @len bytes of its header at @off
+ * and expect report to refuse it.
+ */
+static int corrupt_hdr(off_t off, const void *buf, size_t len)
+{
+	int fd, rc;
+
+	unlink(path);
+	rc = record_rows(0, 1);
+	if (rc)
+		return rc;
+
+	fd = open(path, O_RDWR);
+	if (fd < 0)
+		return -errno;
+	rc = pwrite(fd, buf, len, off) == (ssize_t) len ? 0 : -EIO;
+	close(fd);
+	if (rc)
+		return rc;
+	if (report() == 0) {
+		fprintf(stderr, "%s: accepted corrupt header at %lld\n",
+				__func__, (long long) off);
+		return -ENXIO;
+	}
+	return 0;
+}
+
+static int test_record_corrupt(void)
+{
+	const le32 huge = cpu_to_le32(0x40000000);
+	const le32 many = cpu_to_le32(0xffffffff);
+	char fill[RECORD_SOURCE_LEN];
+	int rc;
+
+	memset(fill, 'x', sizeof(fill));
+
+	/* unterminated source and column names */
+	rc = corrupt_hdr(offsetof(struct record_hdr, source), fill,
+			RECORD_SOURCE_LEN);
+	if (rc)
+		return rc;
+	rc = corrupt_hdr(sizeof(struct record_hdr)
+			+ sizeof(struct record_col_desc), fill,
+			RECORD_NAME_LEN);
+	if (rc)
+		return rc;
+
+	/* layouts that would overflow or run past the column table */
+	rc = corrupt_hdr(offsetof(struct record_hdr, rows_per_block), &huge,
+			sizeof(huge));
+	if (rc)
+		return rc;
+	return corrupt_hdr(offsetof(struct record_hdr, ncols), &many,
+			sizeof(many));
+}
+
+typedef int (*do_test_fn)(void);
+
+static do_test_fn do_test[] = {
+	test_record_round_trip,
+	test_record_schema_mismatch,
+	test_record_corrupt,
+};
+
+int main(int argc, char *argv[])
+{
+	unsigned int i;
+	int fd, rc = 0;
+
+	fd = mkstemp(path);
+	if (fd < 0) {
+		perror("mkstemp");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+	unlink(path);
+
+	for (i = 0; i < ARRAY_SIZE(do_test); i++) {
+		rc = do_test[i]();
+		if (rc < 0) {
+			fprintf(stderr, "test[%d] failed: %d\n", i, rc);
+			break;
+		}
+		fprintf(stderr, "test[%d]: PASS\n", i);
+	}
+
+	unlink(path);
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
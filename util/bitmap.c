@@ -94,7 +94,7 @@ static unsigned long _find_next_bit(const unsigned long *addr,
 		tmp = addr[start / BITS_PER_LONG] ^ invert;
 	}
 
-	return min(start + __builtin_ffsl(tmp), nbits);
+	return min(start + __builtin_ctzl(tmp), nbits);
 }
 
 /*
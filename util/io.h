@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _NDCTL_IO_H_
+#define _NDCTL_IO_H_
+#include <errno.h>
+#include <unistd.h>
+
+/* write all of @buf, retrying short writes and EINTR */
+static inline int util_write_all(int fd, const void *buf, size_t len)
+{
+	ssize_t n;
+
+	while (len) {
+		n = write(fd, buf, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		buf = (const char *)buf + n;
+		len -= n;
+	}
+	return 0;
+}
+
+#endif /* _NDCTL_IO_H_ */
@@ -21,6 +21,10 @@
   struct json_object *_j = JSON_NEW_U32_FROM_LE32((le32_val)); \
   if (_j) json_object_object_add((parent), (key), _j); \
 } while (0)
+#define JSON_ADD_U64(parent, key, val) do { \
+  struct json_object *_j = json_object_new_uint64((uint64_t)(val)); \
+  if (_j) json_object_object_add((parent), (key), _j); \
+} while (0)
 
 /* adapted from mdadm::human_size_brief() */
 static int display_size(struct json_object *jobj, struct printbuf *pbuf,
@@ -1450,11 +1454,59 @@ struct json_object *util_badblock_rec_to_json(u64 block, u64 count,
 	return NULL;
 }
 
+static struct json_object *util_cxl_memdev_health_to_json(
+		struct cxl_memdev *memdev)
+{
+	struct json_object *jhealth = NULL, *jobj;
+	struct cxl_cmd *cmd;
+	int rc;
+
+	cmd = cxl_cmd_new_get_health_info(memdev);
+	if (!cmd)
+		return NULL;
+	rc = cxl_cmd_submit(cmd);
+	if (rc < 0 || cxl_cmd_get_mbox_status(cmd) != 0)
+		goto out;
+
+	jhealth = json_object_new_object();
+	if (!jhealth)
+		goto out;
+
+	jobj = util_json_object_hex(
+			cxl_cmd_get_health_info_get_health_status(cmd), 0);
+	if (jobj)
+		json_object_object_add(jhealth, "health_status", jobj);
+	jobj = util_json_object_hex(
+			cxl_cmd_get_health_info_get_media_status(cmd), 0);
+	if (jobj)
+		json_object_object_add(jhealth, "media_status", jobj);
+	jobj = util_json_object_hex(
+			cxl_cmd_get_health_info_get_ext_status(cmd), 0);
+	if (jobj)
+		json_object_object_add(jhealth, "ext_status", jobj);
+	jobj = json_object_new_int(cxl_cmd_get_health_info_get_life_used(cmd));
+	if (jobj)
+		json_object_object_add(jhealth, "life_used_percent", jobj);
+	jobj = json_object_new_int(
+			cxl_cmd_get_health_info_get_temperature(cmd));
+	if (jobj)
+		json_object_object_add(jhealth, "temperature", jobj);
+	jobj = json_object_new_int(
+			cxl_cmd_get_health_info_get_dirty_shutdowns(cmd));
+	if (jobj)
+		json_object_object_add(jhealth, "dirty_shutdowns", jobj);
+
+out:
+	cxl_cmd_unref(cmd);
+	return jhealth;
+}
+
 struct json_object *util_cxl_memdev_to_json(struct cxl_memdev *memdev,
 		unsigned long flags)
 {
 	const char *devname = cxl_memdev_get_devname(memdev);
 	struct json_object *jdev, *jobj;
+	unsigned long long size;
 
 	jdev = json_object_new_object();
 	if (!devname || !jdev)
@@ -1464,17 +1516,150 @@ struct json_object *util_cxl_memdev_to_json(struct cxl_memdev *memdev,
 	if (jobj)
 		json_object_object_add(jdev, "memdev", jobj);
 
-	jobj = util_json_object_size(cxl_memdev_get_pmem_size(memdev), flags);
-	if (jobj)
-		json_object_object_add(jdev, "pmem_size", jobj);
+	size = cxl_memdev_get_pmem_size(memdev);
+	if (size < ULLONG_MAX) {
+		jobj = util_json_object_size(size, flags);
+		if (jobj)
+			json_object_object_add(jdev, "pmem_size", jobj);
+	}
 
-	jobj = util_json_object_size(cxl_memdev_get_ram_size(memdev), flags);
-	if (jobj)
-		json_object_object_add(jdev, "ram_size", jobj);
+	size = cxl_memdev_get_ram_size(memdev);
+	if (size < ULLONG_MAX) {
+		jobj = util_json_object_size(size, flags);
+		if (jobj)
+			json_object_object_add(jdev, "ram_size", jobj);
+	}
+
+	if (flags & UTIL_JSON_SERIAL) {
+		unsigned long long serial = cxl_memdev_get_serial(memdev);
+
+		if (serial < ULLONG_MAX) {
+			jobj = util_json_object_hex(serial, flags);
+			if (jobj)
+				json_object_object_add(jdev, "serial", jobj);
+		}
+	}
+
+	if (flags & UTIL_JSON_FIRMWARE) {
+		const char *fw = cxl_memdev_get_firmware_verison(memdev);
+
+		if (fw) {
+			jobj = json_object_new_string(fw);
+			if (jobj)
+				json_object_object_add(jdev,
+						"firmware_version", jobj);
+		}
+	}
+
+	if (flags & UTIL_JSON_PAYLOAD_MAX) {
+		int payload_max = cxl_memdev_get_payload_max(memdev);
+
+		if (payload_max >= 0) {
+			jobj = util_json_object_size(payload_max, flags);
+			if (jobj)
+				json_object_object_add(jdev, "payload_max",
+						jobj);
+		}
+	}
+
+	if (flags & UTIL_JSON_NUMA) {
+		int node = cxl_memdev_get_numa_node(memdev);
+
+		if (node >= 0) {
+			jobj = json_object_new_int(node);
+			if (jobj)
+				json_object_object_add(jdev, "numa_node", jobj);
+		}
+	}
+
+	if (flags & UTIL_JSON_LINK) {
+		int width = cxl_memdev_get_link_width(memdev);
+		int speed = cxl_memdev_get_link_speed(memdev);
+		char buf[32];
+
+		if (width > 0) {
+			jobj = json_object_new_int(width);
+			if (jobj)
+				json_object_object_add(jdev, "link_width", jobj);
+		}
+		if (speed > 0) {
+			snprintf(buf, sizeof(buf), "%d.%d GT/s", speed / 1000,
+					speed % 1000 / 100);
+			jobj = json_object_new_string(buf);
+			if (jobj)
+				json_object_object_add(jdev, "link_speed", jobj);
+		}
+	}
+
+	/* the only field that costs a mailbox command */
+	if (flags & UTIL_JSON_HEALTH) {
+		jobj = util_cxl_memdev_health_to_json(memdev);
+		if (jobj)
+			json_object_object_add(jdev, "health", jobj);
+	}
 
 	return jdev;
 }
 
+/*
+ * List the dax regions, and their devices, carved out of CXL regions that
+ * @memdev is a target of. A dax region created for a CXL region sits
+ * directly below it in sysfs (.../regionN/dax_regionM).
+ */
+struct json_object *util_cxl_memdev_regions_to_json(struct cxl_memdev *memdev,
+		struct daxctl_ctx *daxctl_ctx, unsigned long flags)
+{
+	struct json_object *jregions = NULL, *jregion, *jobj;
+	char *path, *name, *cxl_path, buf[PATH_MAX];
+	struct daxctl_region *region;
+	bool is_cxl;
+	int id;
+
+	daxctl_region_foreach(daxctl_ctx, region) {
+		path = realpath(daxctl_region_get_path(region), NULL);
+		if (!path)
+			continue;
+		name = strrchr(path, '/');
+		if (name)
+			*name = '\0';
+		name = strrchr(path, '/');
+		if (!name || sscanf(name, "/region%d", &id) != 1) {
+			free(path);
+			continue;
+		}
+
+		/* libnvdimm names its regions regionN too, only take cxl ones */
+		snprintf(buf, sizeof(buf), "/sys/bus/cxl/devices%s", name);
+		cxl_path = realpath(buf, NULL);
+		is_cxl = cxl_path && strcmp(cxl_path, path) == 0;
+		free(cxl_path);
+		if (!is_cxl || !cxl_memdev_in_region(memdev, name + 1)) {
+			free(path);
+			continue;
+		}
+
+		if (!jregions) {
+			jregions = json_object_new_array();
+			if (!jregions) {
+				free(path);
+				return NULL;
+			}
+		}
+
+		jregion = util_daxctl_region_to_json(region, NULL,
+				flags | UTIL_JSON_DAX | UTIL_JSON_DAX_DEVS);
+		if (jregion) {
+			jobj = json_object_new_string(name + 1);
+			if (jobj)
+				json_object_object_add(jregion, "region", jobj);
+			json_object_array_add(jregions, jregion);
+		}
+		free(path);
+	}
+
+	return jregions;
+}
+
 /* Forward declaration of the health counters structure */
 struct cxl_mbox_health_counters_get_out;
 
@@ -1526,3 +1711,324 @@ struct json_object *util_cxl_memdev_health_counters_to_json(
 
 	return jhealth;
 }
+
+static struct json_object *eh_link_dbg_lane_to_json(
+		const struct cxl_mbox_eh_link_dbg_lane_dump_out *l)
+{
+	struct json_object *jlane = json_object_new_object();
+
+	if (!jlane)
+		return NULL;
+
+	JSON_ADD_U64(jlane, "lane", l->cap_info & 0xf);
+	JSON_ADD_U64(jlane, "pga_gain", l->pga_gain);
+	JSON_ADD_U64(jlane, "pga_off2", l->pga_off2);
+	JSON_ADD_U64(jlane, "pga_off1", l->pga_off1);
+	JSON_ADD_U64(jlane, "cdfe_a2", l->cdfe_a2);
+	JSON_ADD_U64(jlane, "cdfe_a3", l->cdfe_a3);
+	JSON_ADD_U64(jlane, "cdfe_a4", l->cdfe_a4);
+	JSON_ADD_U64(jlane, "cdfe_a5", l->cdfe_a5);
+	JSON_ADD_U64(jlane, "cdfe_a6", l->cdfe_a6);
+	JSON_ADD_U64(jlane, "cdfe_a7", l->cdfe_a7);
+	JSON_ADD_U64(jlane, "cdfe_a8", l->cdfe_a8);
+	JSON_ADD_U64(jlane, "cdfe_a9", l->cdfe_a9);
+	JSON_ADD_U64(jlane, "cdfe_a10", l->cdfe_a10);
+	JSON_ADD_U64(jlane, "zobel_a_gain", l->zobel_a_gain);
+	JSON_ADD_U64(jlane, "zobel_b_gain", l->zobel_b_gain);
+	JSON_ADD_U64(jlane, "zobel_dc_offset", le16_to_cpu(l->zobel_dc_offset));
+	JSON_ADD_U64(jlane, "udfe_thr_0", le16_to_cpu(l->udfe_thr_0));
+	JSON_ADD_U64(jlane, "udfe_thr_1", le16_to_cpu(l->udfe_thr_1));
+	JSON_ADD_U64(jlane, "dc_offset", le16_to_cpu(l->dc_offset));
+	JSON_ADD_U64(jlane, "median_amp", le16_to_cpu(l->median_amp));
+	JSON_ADD_U64(jlane, "ph_ofs_t", l->ph_ofs_t);
+	JSON_ADD_U64(jlane, "cdru_lock_time", le16_to_cpu(l->cdru_lock_time));
+	JSON_ADD_U64(jlane, "eh_workaround_stat", le16_to_cpu(l->eh_workaround_stat));
+	JSON_ADD_U64(jlane, "los_toggle_cnt", le16_to_cpu(l->los_toggle_cnt));
+	JSON_ADD_U64(jlane, "adapt_time", le16_to_cpu(l->adapt_time));
+	JSON_ADD_U64(jlane, "cdr_lock_toggle_cnt_0", le16_to_cpu(l->cdr_lock_toggle_cnt_0));
+	JSON_ADD_U64(jlane, "jat_stat_0", le16_to_cpu(l->jat_stat_0));
+	JSON_ADD_U32_FROM_LE32(jlane, "db_err", l->db_err);
+	JSON_ADD_U32_FROM_LE32(jlane, "reg_val0", l->reg_val0);
+	JSON_ADD_U64(jlane, "reg_val1", l->reg_val1);
+	JSON_ADD_U32_FROM_LE32(jlane, "reg_val2", l->reg_val2);
+	JSON_ADD_U32_FROM_LE32(jlane, "reg_val3", l->reg_val3);
+	JSON_ADD_U32_FROM_LE32(jlane, "reg_val4", l->reg_val4);
+
+	return jlane;
+}
+
+/*
+ * Convert the buffer built by cxl_memdev_eh_link_dbg_dump_all() into
+ * { "memdev", "entries": [ { entry fields..., "lanes": [ ... ] } ] }.
+ */
+struct json_object *util_cxl_memdev_eh_link_dbg_to_json(const char *devname,
+		u16 lane_mask, const void *buf, int nr_entries)
+{
+	const struct cxl_mbox_eh_link_dbg_entry_dump_out *e;
+	const struct cxl_mbox_eh_link_dbg_lane_dump_out *l;
+	struct json_object *jdump, *jentries, *jentry, *jlanes, *jobj;
+	int nr_lanes = __builtin_popcount(lane_mask);
+	const u8 *pos = buf;
+	int i, j;
+
+	jdump = json_object_new_object();
+	if (!jdump)
+		return NULL;
+
+	if (devname) {
+		jobj = json_object_new_string(devname);
+		if (jobj)
+			json_object_object_add(jdump, "memdev", jobj);
+	}
+
+	jentries = json_object_new_array();
+	if (!jentries)
+		goto err;
+	json_object_object_add(jdump, "entries", jentries);
+
+	for (i = 0; i < nr_entries; i++) {
+		e = (const void *)pos;
+		pos += sizeof(*e);
+
+		jentry = json_object_new_object();
+		if (!jentry)
+			goto err;
+		json_object_array_add(jentries, jentry);
+
+		JSON_ADD_U64(jentry, "entry", e->cap_info & 0xf);
+		JSON_ADD_U64(jentry, "cap_reason", e->cap_reason);
+		JSON_ADD_U32_FROM_LE32(jentry, "l2r_reason", e->l2r_reason);
+		JSON_ADD_U64(jentry, "start_time", le64_to_cpu(e->start_time));
+		JSON_ADD_U64(jentry, "end_time", le64_to_cpu(e->end_time));
+		JSON_ADD_U64(jentry, "start_rate", e->start_rate);
+		JSON_ADD_U64(jentry, "end_rate", e->end_rate);
+		JSON_ADD_U64(jentry, "start_state", e->start_state);
+		JSON_ADD_U64(jentry, "end_state", e->end_state);
+		JSON_ADD_U32_FROM_LE32(jentry, "start_status", e->start_status);
+		JSON_ADD_U32_FROM_LE32(jentry, "end_status", e->end_status);
+
+		jlanes = json_object_new_array();
+		if (!jlanes)
+			goto err;
+		json_object_object_add(jentry, "lanes", jlanes);
+
+		for (j = 0; j < nr_lanes; j++) {
+			l = (const void *)pos;
+			pos += sizeof(*l);
+			jobj = eh_link_dbg_lane_to_json(l);
+			if (!jobj)
+				goto err;
+			json_object_array_add(jlanes, jobj);
+		}
+	}
+
+	return jdump;
+err:
+	json_object_put(jdump);
+	return NULL;
+}
+
+/* one LTMON capture log entry, a line of ltmon-capture-log-dmp --all */
+struct json_object *util_cxl_memdev_ltmon_log_entry_to_json(const char *devname,
+		u8 cxl_mem_id, int idx, const struct cxl_ltmon_log_entry *e)
+{
+	struct json_object *jentry, *jobj;
+	char arc[16];
+
+	jentry = json_object_new_object();
+	if (!jentry)
+		return NULL;
+
+	if (devname) {
+		jobj = json_object_new_string(devname);
+		if (jobj)
+			json_object_object_add(jentry, "memdev", jobj);
+	}
+	JSON_ADD_U64(jentry, "cxl_mem_id", cxl_mem_id);
+	JSON_ADD_U64(jentry, "idx", idx);
+	JSON_ADD_U64(jentry, "timestamp", e->timestamp);
+	JSON_ADD_U64(jentry, "timestamp_rollover", e->timestamp_rollover);
+	JSON_ADD_U64(jentry, "main_state", e->main_state);
+	JSON_ADD_U64(jentry, "substate", e->substate);
+	JSON_ADD_U64(jentry, "rx_l0s_substate", e->rx_l0s_substate);
+	JSON_ADD_U64(jentry, "link_rate", e->link_rate);
+	JSON_ADD_U64(jentry, "link_width", e->link_width);
+	snprintf(arc, sizeof(arc), "%#x", e->arc);
+	jobj = json_object_new_string(arc);
+	if (jobj)
+		json_object_object_add(jentry, "arc", jobj);
+
+	return jentry;
+}
+
+#define JSON_ADD_DDR_STAT(parent, s, field) \
+	JSON_ADD_U64(parent, #field, (s)->field)
+
+static struct json_object *ddr_stats_pmon_to_json(const struct ddr_pmon_data *p)
+{
+	struct json_object *jpmon = json_object_new_object();
+
+	if (!jpmon)
+		return NULL;
+	JSON_ADD_DDR_STAT(jpmon, p, fr_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, idle_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_ot_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_ot_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wrd_ot_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_cmd_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_cmd_busy_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_cmd_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_cmd_busy_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_data_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_data_busy_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_data_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_data_busy_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_avg_lat);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_avg_lat);
+	JSON_ADD_DDR_STAT(jpmon, p, rd_trans_smpl_cnt);
+	JSON_ADD_DDR_STAT(jpmon, p, wr_trans_smpl_cnt);
+	return jpmon;
+}
+
+static struct json_object *ddr_stats_cs_to_json(const struct ddr_data *d,
+		int rank)
+{
+	const struct dfi_cs_pm *cs = &d->cs_pm[rank];
+	const struct dfi_cs_bank_pm *b;
+	struct json_object *jcs, *jbanks, *jbank;
+	int bank;
+
+	jcs = json_object_new_object();
+	if (!jcs)
+		return NULL;
+	JSON_ADD_U64(jcs, "rank", rank);
+	JSON_ADD_DDR_STAT(jcs, cs, mrw_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, refresh_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, act_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, write_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, read_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, pre_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, rr_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, ww_cnt);
+	JSON_ADD_DDR_STAT(jcs, cs, rw_cnt);
+
+	jbanks = json_object_new_array();
+	if (!jbanks)
+		goto err;
+	json_object_object_add(jcs, "banks", jbanks);
+	for (bank = 0; bank < NUM_BANK; bank++) {
+		b = &d->cs_bank_pm[rank][bank];
+		jbank = json_object_new_object();
+		if (!jbank)
+			goto err;
+		json_object_array_add(jbanks, jbank);
+		JSON_ADD_DDR_STAT(jbank, b, bank_act_cnt);
+		JSON_ADD_DDR_STAT(jbank, b, bank_wr_cnt);
+		JSON_ADD_DDR_STAT(jbank, b, bank_rd_cnt);
+		JSON_ADD_DDR_STAT(jbank, b, bank_pre_cnt);
+	}
+	return jcs;
+err:
+	json_object_put(jcs);
+	return NULL;
+}
+
+static struct json_object *ddr_stats_mc_to_json(const struct dfi_mc_pm *m)
+{
+	struct json_object *jmc = json_object_new_object();
+
+	if (!jmc)
+		return NULL;
+	JSON_ADD_DDR_STAT(jmc, m, cmd_queue_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, info_fifo_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, wrdata_hold_fifo_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_cmd_fifo0_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_wrresp_fifo0_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_wr_fifo0_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_rd_fifo0_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_cmd_fifo1_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_wrresp_fifo1_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_wr_fifo1_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, port_rd_fifo1_full_events);
+	JSON_ADD_DDR_STAT(jmc, m, ecc_dataout_corrected);
+	JSON_ADD_DDR_STAT(jmc, m, ecc_dataout_uncorrected);
+	JSON_ADD_DDR_STAT(jmc, m, pd_ex);
+	JSON_ADD_DDR_STAT(jmc, m, pd_en);
+	JSON_ADD_DDR_STAT(jmc, m, srex);
+	JSON_ADD_DDR_STAT(jmc, m, sren);
+	JSON_ADD_DDR_STAT(jmc, m, write);
+	JSON_ADD_DDR_STAT(jmc, m, read);
+	JSON_ADD_DDR_STAT(jmc, m, rmw);
+	JSON_ADD_DDR_STAT(jmc, m, bank_act);
+	JSON_ADD_DDR_STAT(jmc, m, precharge);
+	JSON_ADD_DDR_STAT(jmc, m, precharge_all);
+	JSON_ADD_DDR_STAT(jmc, m, mrw);
+	JSON_ADD_DDR_STAT(jmc, m, auto_ref);
+	JSON_ADD_DDR_STAT(jmc, m, rw_auto_pre);
+	JSON_ADD_DDR_STAT(jmc, m, zq_cal_short);
+	JSON_ADD_DDR_STAT(jmc, m, zq_cal_long);
+	JSON_ADD_DDR_STAT(jmc, m, same_addr_ww_collision);
+	JSON_ADD_DDR_STAT(jmc, m, same_addr_wr_collision);
+	JSON_ADD_DDR_STAT(jmc, m, same_addr_rw_collision);
+	JSON_ADD_DDR_STAT(jmc, m, same_addr_rr_collision);
+	return jmc;
+}
+
+struct json_object *util_cxl_memdev_ddr_stats_to_json(const char *devname,
+		int snapshot, const struct ddr_stats_data *stats, u32 nr)
+{
+	struct json_object *jstats, *jiters, *jiter, *jcs, *jobj;
+	const struct ddr_data *d;
+	u32 i;
+	int rank;
+
+	jstats = json_object_new_object();
+	if (!jstats)
+		return NULL;
+
+	if (devname) {
+		jobj = json_object_new_string(devname);
+		if (jobj)
+			json_object_object_add(jstats, "memdev", jobj);
+	}
+	JSON_ADD_U64(jstats, "snapshot", snapshot);
+
+	jiters = json_object_new_array();
+	if (!jiters)
+		goto err;
+	json_object_object_add(jstats, "iterations", jiters);
+
+	for (i = 0; i < nr; i++) {
+		d = &stats[i].stats;
+		jiter = json_object_new_object();
+		if (!jiter)
+			goto err;
+		json_object_array_add(jiters, jiter);
+
+		jobj = ddr_stats_pmon_to_json(&d->pmon);
+		if (!jobj)
+			goto err;
+		json_object_object_add(jiter, "pmon", jobj);
+
+		jcs = json_object_new_array();
+		if (!jcs)
+			goto err;
+		json_object_object_add(jiter, "cs_pm", jcs);
+		for (rank = 0; rank < NUM_CS; rank++) {
+			jobj = ddr_stats_cs_to_json(d, rank);
+			if (!jobj)
+				goto err;
+			json_object_array_add(jcs, jobj);
+		}
+
+		jobj = ddr_stats_mc_to_json(&d->mc_pm);
+		if (!jobj)
+			goto err;
+		json_object_object_add(jiter, "mc_pm", jobj);
+	}
+
+	return jstats;
+err:
+	json_object_put(jstats);
+	return NULL;
+}
@@ -19,6 +19,11 @@ enum util_json_flags {
 	UTIL_JSON_CONFIGURED	= (1 << 7),
 	UTIL_JSON_FIRMWARE	= (1 << 8),
 	UTIL_JSON_DAX_MAPPINGS	= (1 << 9),
+	UTIL_JSON_HEALTH	= (1 << 10),
+	UTIL_JSON_SERIAL	= (1 << 11),
+	UTIL_JSON_PAYLOAD_MAX	= (1 << 12),
+	UTIL_JSON_NUMA		= (1 << 13),
+	UTIL_JSON_LINK		= (1 << 14),
 };
 
 struct json_object;
@@ -59,7 +64,17 @@ struct cxl_memdev;
 struct cxl_mbox_health_counters_get_out;
 struct json_object *util_cxl_memdev_to_json(struct cxl_memdev *memdev,
 		unsigned long flags);
+struct json_object *util_cxl_memdev_regions_to_json(struct cxl_memdev *memdev,
+		struct daxctl_ctx *daxctl_ctx, unsigned long flags);
 struct json_object *util_cxl_memdev_health_counters_to_json(
 		const char *devname,
 		struct cxl_mbox_health_counters_get_out *health_counters);
+struct json_object *util_cxl_memdev_eh_link_dbg_to_json(const char *devname,
+		u16 lane_mask, const void *buf, int nr_entries);
+struct cxl_ltmon_log_entry;
+struct json_object *util_cxl_memdev_ltmon_log_entry_to_json(const char *devname,
+		u8 cxl_mem_id, int idx, const struct cxl_ltmon_log_entry *e);
+struct ddr_stats_data;
+struct json_object *util_cxl_memdev_ddr_stats_to_json(const char *devname,
+		int snapshot, const struct ddr_stats_data *stats, u32 nr);
 #endif /* __NDCTL_JSON_H__ */
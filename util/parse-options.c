@@ -463,6 +463,88 @@ int parse_options_end(struct parse_opt_ctx_t *ctx)
 	return ctx->cpidx + ctx->argc;
 }
 
+/*
+ * A process that runs several commands in turn (cxl batch) parses the same
+ * option tables repeatedly. With restore_defaults set, every option value
+ * is put back to what it held when its table was first parsed, so options
+ * given to one command do not carry over into the next.
+ */
+static bool restore_defaults;
+
+static struct option_default {
+	void *value;
+	size_t size;
+	uint64_t saved;
+} *option_defaults;
+static int nr_option_defaults;
+
+void parse_options_restore_defaults(bool enable)
+{
+	restore_defaults = enable;
+}
+
+static size_t option_value_size(const struct option *opt)
+{
+	switch (opt->type) {
+	case OPTION_BOOLEAN:
+		return sizeof(bool);
+	case OPTION_BIT:
+	case OPTION_INCR:
+	case OPTION_INTEGER:
+		return sizeof(int);
+	case OPTION_SET_UINT:
+	case OPTION_UINTEGER:
+		return sizeof(unsigned int);
+	case OPTION_LONG:
+		return sizeof(long);
+	case OPTION_U64:
+		return sizeof(uint64_t);
+	case OPTION_SET_PTR:
+	case OPTION_STRING:
+	case OPTION_FILENAME:
+		return sizeof(void *);
+	default:
+		/* callbacks own their storage */
+		return 0;
+	}
+}
+
+static void option_default_restore(void *value, size_t size)
+{
+	struct option_default *d;
+	int i;
+
+	for (i = 0; i < nr_option_defaults; i++) {
+		d = &option_defaults[i];
+		if (d->value == value) {
+			memcpy(value, &d->saved, d->size);
+			return;
+		}
+	}
+
+	d = realloc(option_defaults, (nr_option_defaults + 1) * sizeof(*d));
+	if (!d)
+		return;
+	option_defaults = d;
+	d = &option_defaults[nr_option_defaults++];
+	d->value = value;
+	d->size = size;
+	memcpy(&d->saved, value, size);
+}
+
+static void options_restore_defaults(const struct option *opts)
+{
+	size_t size;
+
+	for (; opts->type != OPTION_END; opts++) {
+		size = option_value_size(opts);
+		if (size && opts->value)
+			option_default_restore(opts->value, size);
+		if (opts->set)
+			option_default_restore(opts->set, sizeof(bool));
+	}
+}
+
 static int parse_options_subcommand_prefix(int argc, const char **argv,
 			const char *prefix, const struct option *options,
 			const char *const subcommands[],
@@ -470,6 +552,9 @@ static int parse_options_subcommand_prefix(int argc, const char **argv,
 {
 	struct parse_opt_ctx_t ctx;
 
+	if (restore_defaults)
+		options_restore_defaults(options);
+
 	/* build usage string if it's not provided */
 	if (subcommands && !usagestr[0]) {
 		struct strbuf buf = STRBUF_INIT;
@@ -157,6 +157,8 @@ extern int parse_options_subcommand(int argc, const char **argv,
 				const char *const subcommands[],
 				const char *usagestr[], int flags);
 
+extern void parse_options_restore_defaults(bool enable);
+
 extern NORETURN void usage_with_options(const char * const *usagestr,
                                         const struct option *options);
 
@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: GPL-2.0 */
+#ifndef _NDCTL_TIME_H_
+#define _NDCTL_TIME_H_
+#include <time.h>
+#include <ccan/short_types/short_types.h>
+
+/* current value of @clk, e.g. CLOCK_MONOTONIC for intervals */
+static inline u64 util_clock_ns(clockid_t clk)
+{
+	struct timespec ts;
+
+	clock_gettime(clk, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline u64 util_clock_ms(clockid_t clk)
+{
+	return util_clock_ns(clk) / 1000000;
+}
+
+#endif /* _NDCTL_TIME_H_ */